@@ -1,4 +1,14 @@
 #include "Flag_group.h"
+#include "mappedRoster.h"
+#include <algorithm>
+#include <atomic>
+
+namespace {
+// 登记段编号：全局递增，不同名单、同一名单被整体替换前后的登记位置互不混淆（0 保留给"未登记"）
+std::atomic<std::uint64_t> changeEpochCounter{0};
+// 登记条数超过 总人数 + 该值 时丢弃全部登记（之前的登记位置失效，下次快照逐人比对）
+constexpr std::size_t CHANGE_LOG_SLACK = 1024;
+}
 
 // 添加队员到指定组
 void Flag_group::addPersonToGroup(const Person &person, int groupNumber)
@@ -10,11 +20,17 @@ void Flag_group::addPersonToGroup(const Person &person, int groupNumber)
     qDebug() << "  - 目标组别:" << groupNumber;
     qDebug() << "  - 队员自身组别属性:" << person.getGroup();
     
-    if (groupNumber >= 1 && groupNumber <= 4) // 判断组号是否合理：1~4对应一至四组
+    if (isValidGroup(groupNumber)) // 判断组号是否合理：1~groupCount()
     {
         // 因为group索引最小为0，与输入组号存在一位的差距，需要减一处理
+        expandGroup(groupNumber - 1);
         qDebug() << "  - 添加前，组" << groupNumber << "的队员数量:" << group[groupNumber - 1].size();
-        group[groupNumber - 1].push_back(person);// push_back,添加新队员至对应组
+        vector<Person> &members = group[groupNumber - 1];
+        ++notifySuppressed; // 扩容时销毁旧元素不是队员被删除
+        members.push_back(person);// push_back,添加新队员至对应组
+        --notifySuppressed;
+        adopt(members.back());
+        logChange(Change::Inserted, groupNumber, static_cast<int>(members.size()) - 1);
         qDebug() << "  - 添加后，组" << groupNumber << "的队员数量:" << group[groupNumber - 1].size();
         qDebug() << "  - 添加成功！";
     }
@@ -24,6 +40,188 @@ void Flag_group::addPersonToGroup(const Person &person, int groupNumber)
     }
 }
 
+// 拷贝整个名单：目标名单的内容与文件不再对应，标记为需要完整保存；修改登记重新开始
+// 名单文件之后会随原名单的保存而改变，拷贝不共享数据源：先展开原名单的全部组
+Flag_group::Flag_group(const Flag_group &other) : locations(other.locations)
+{
+    other.expandAll();
+    group = other.group;
+    restartChangeTracking();
+}
+
+Flag_group::Flag_group(Flag_group &&other) noexcept
+    : group(std::move(other.group)), mapped(std::move(other.mapped)), unexpanded(std::move(other.unexpanded)), locations(other.locations)
+{
+    other.group.assign(DEFAULT_GROUP_COUNT, vector<Person>());
+    other.mapped.reset();
+    other.unexpanded.clear();
+    other.locations = Person::DEFAULT_LOCATION_COUNT;
+    other.restartChangeTracking();
+    restartChangeTracking();
+}
+
+Flag_group& Flag_group::operator=(const Flag_group &other)
+{
+    if (this != &other) {
+        other.expandAll();
+        ++notifySuppressed;
+        group = other.group;
+        --notifySuppressed;
+        mapped.reset();
+        unexpanded.clear();
+        locations = other.locations;
+        fullSaveRequired = true;
+        removedKeys.clear();
+        restartChangeTracking();
+    }
+    return *this;
+}
+
+Flag_group& Flag_group::operator=(Flag_group &&other) noexcept
+{
+    if (this != &other) {
+        ++notifySuppressed;
+        group = std::move(other.group);
+        --notifySuppressed;
+        mapped = std::move(other.mapped);
+        unexpanded = std::move(other.unexpanded);
+        locations = other.locations;
+        other.group.assign(DEFAULT_GROUP_COUNT, vector<Person>());
+        other.mapped.reset();
+        other.unexpanded.clear();
+        other.locations = Person::DEFAULT_LOCATION_COUNT;
+        other.restartChangeTracking();
+        fullSaveRequired = true;
+        removedKeys.clear();
+        restartChangeTracking();
+    }
+    return *this;
+}
+
+// 登记一条修改；登记已不完整时不再记录，登记过多时整体丢弃
+void Flag_group::logChange(Change::Kind kind, int groupNumber, int index) const
+{
+    if (trackingLost) return;
+    if (kind == Change::Inserted) ++trackedSizes[groupNumber - 1];
+    if (kind == Change::Removed) --trackedSizes[groupNumber - 1];
+    std::size_t total = 0;
+    for (int size : trackedSizes) total += static_cast<std::size_t>(size);
+    if (changeLog.size() >= total + CHANGE_LOG_SLACK) {
+        changeLogBase += changeLog.size();
+        changeLog.clear();
+    }
+    changeLog.push_back({kind, groupNumber, index});
+}
+
+// 队员发生修改：按地址确定其所在的组与位置（不在任何组中的队员不登记）
+void Flag_group::noteModified(const Person *person) const
+{
+    if (notifySuppressed > 0 || trackingLost) return;
+    for (int i = 0; i < groupCount(); ++i) {
+        const vector<Person> &members = group[i];
+        if (!members.empty() && person >= members.data() && person < members.data() + members.size()) {
+            logChange(Change::Modified, i + 1, static_cast<int>(person - members.data()));
+            return;
+        }
+    }
+}
+
+bool Flag_group::changeTrackingLost() const
+{
+    if (trackingLost || static_cast<int>(trackedSizes.size()) != groupCount()) return true;
+    for (int i = 0; i < groupCount(); ++i) {
+        if (trackedSizes[i] != memberCount(i + 1)) return true;
+    }
+    return false;
+}
+
+bool Flag_group::changesSince(const ChangeMark &mark, const Change **begin, const Change **end) const
+{
+    if (mark.epoch != changeEpoch || mark.sequence < changeLogBase
+        || mark.sequence > changeLogBase + changeLog.size() || changeTrackingLost()) {
+        return false;
+    }
+    *begin = changeLog.data() + (mark.sequence - changeLogBase);
+    *end = changeLog.data() + changeLog.size();
+    return true;
+}
+
+void Flag_group::restartChangeTracking() const
+{
+    changeEpoch = ++changeEpochCounter;
+    changeLogBase = 0;
+    changeLog.clear();
+    trackingLost = false;
+    trackedSizes.assign(group.size(), 0);
+    for (int i = 0; i < groupCount(); ++i) {
+        trackedSizes[i] = memberCount(i + 1);
+        for (const Person &person : group[i]) { // 尚未展开的组在展开时归属本名单
+            adopt(person);
+        }
+    }
+}
+
+// 当前名单已全部写入文件：以此刻的修订号为水位线，清空删除记录
+void Flag_group::markSaved()
+{
+    savedRevision = Person::latestRevision();
+    fullSaveRequired = false;
+    removedKeys.clear();
+}
+
+// 挂接名单文件：只建立空的组，队员在各组展开时才创建
+void Flag_group::attachMappedRoster(std::shared_ptr<const MappedRoster> roster)
+{
+    ++notifySuppressed;
+    group.assign(roster->groups(), vector<Person>());
+    --notifySuppressed;
+    locations = roster->locations();
+    mapped = std::move(roster);
+    unexpanded.assign(group.size(), 1);
+    removedKeys.clear();
+    markSaved(); // 文件中的记录预留的修订号都不大于此时的水位线
+    restartChangeTracking();
+}
+
+// 从名单文件展开一个组：展开不是修改，不登记；队员沿用记录预留的修订号，与文件内容一致
+void Flag_group::expandGroup(int index) const
+{
+    if (index < 0 || index >= static_cast<int>(unexpanded.size()) || !unexpanded[index]) return;
+    unexpanded[index] = 0;
+    const int count = mapped->groupSize(index + 1);
+    vector<Person> &members = group[index];
+    ++notifySuppressed;
+    members.reserve(count);
+    for (int k = 0; k < count; ++k) {
+        members.push_back(mapped->record(index + 1, k).toPerson());
+        members.back().revision = mapped->recordRevision(index + 1, k);
+    }
+    --notifySuppressed;
+    for (const Person &person : members) {
+        adopt(person);
+    }
+}
+
+void Flag_group::expandAll() const
+{
+    for (int i = 0; i < static_cast<int>(unexpanded.size()); ++i) {
+        expandGroup(i);
+    }
+}
+
+int Flag_group::memberCount(int groupNumber) const
+{
+    if (!isValidGroup(groupNumber)) return 0;
+    if (isGroupMapped(groupNumber)) return mapped->groupSize(groupNumber);
+    return static_cast<int>(group[groupNumber - 1].size());
+}
+
+std::uint64_t Flag_group::memberRevision(int groupNumber, int index) const
+{
+    if (isGroupMapped(groupNumber)) return mapped->recordRevision(groupNumber, index);
+    return group[groupNumber - 1][index].getRevision();
+}
+
 // 从指定组中删除指定的队员
 void Flag_group::removePersonFromGroup(const Person &person, int groupNumber)
 {
@@ -40,9 +238,10 @@ void Flag_group::removePersonFromGroup(const Person &person, int groupNumber)
         qDebug() << "  - *** 这可能导致错误的删除操作！***";
     }
     
-    if (groupNumber >= 1 && groupNumber <= 4)
+    if (isValidGroup(groupNumber))
     {
         // 因为group索引最小为0，与输入组号存在一位的差距，需要减一处理
+        expandGroup(groupNumber - 1);
         vector<Person> &currentGroup = group[groupNumber - 1];
         qDebug() << "  - 删除前，组" << groupNumber << "的队员数量:" << currentGroup.size();
         
@@ -61,7 +260,12 @@ void Flag_group::removePersonFromGroup(const Person &person, int groupNumber)
             {
                 qDebug() << "  - 找到匹配的队员，准备删除";
                 qDebug() << "    - 匹配队员的组别属性:" << it->getGroup();
+                removedKeys.emplace_back(groupNumber, it->getName()); // 记录删除，供增量保存写出
+                const int index = static_cast<int>(it - currentGroup.begin());
+                ++notifySuppressed;
                 currentGroup.erase(it);
+                --notifySuppressed;
+                logChange(Change::Removed, groupNumber, index);
                 found = true;
                 qDebug() << "  - 删除后，组" << groupNumber << "的队员数量:" << currentGroup.size();
                 qDebug() << "  - 删除成功！";
@@ -90,8 +294,9 @@ void Flag_group::modifyPersonInGroup(const Person& oldPerson, const Person& newP
     qDebug() << "  - 新姓名:" << QString::fromStdString(newPerson.getName());
     qDebug() << "  - 目标组别:" << groupNumber;
     
-    if (groupNumber >= 1 && groupNumber <= 4) {
+    if (isValidGroup(groupNumber)) {
         // 因为group索引最小为0，与输入组号存在一位的差距，需要减一处理
+        expandGroup(groupNumber - 1);
         vector<Person>& currentGroup = group[groupNumber - 1];
         qDebug() << "  - 组" << groupNumber << "的队员数量:" << currentGroup.size();
         
@@ -100,6 +305,10 @@ void Flag_group::modifyPersonInGroup(const Person& oldPerson, const Person& newP
         for (auto& person : currentGroup) {
             if (person == oldPerson) {
                 qDebug() << "  - 找到匹配的队员，准备修改";
+                // 改名后旧的标识不再存在，按删除记录，新信息随修改一起写出
+                if (person.getName() != newPerson.getName() || person.getGroup() != newPerson.getGroup()) {
+                    removedKeys.emplace_back(groupNumber, person.getName());
+                }
                 person = newPerson;
                 found = true;
                 qDebug() << "  - 修改成功！";
@@ -123,8 +332,9 @@ Person* Flag_group::findPersonInGroup(const Person &person, int groupNumber)
 {
     // 参数：Person类：待查找的队员信息。 int groupNumber：队员对应的组别。
     // 将根据参数的groupNumber在对应的组中查找是否存在参数中的person，查找到后，返回该队员
-    if (groupNumber >= 1 && groupNumber <= 4)
+    if (isValidGroup(groupNumber))
     {
+        expandGroup(groupNumber - 1);
         vector<Person> &currentGroup = group[groupNumber - 1];
         for (auto &tempPerson : currentGroup)
         {
@@ -147,7 +357,7 @@ Person* Flag_group::findPersonInGroup(const Person &person, int groupNumber)
 // 在全队查找指定姓名的队员
 Person* Flag_group::findPerson(const Person &person) {
     // 参数：Person类：待查找的队员信息。
-    for (int i = 1; i <= 4; ++i) {
+    for (int i = 1; i <= groupCount(); ++i) {
         Person* found = findPersonInGroup(person, i);
         if (found) {
             return found;
@@ -163,8 +373,9 @@ Person* Flag_group::findPerson(const Person &person) {
 vector<Person>& Flag_group::getGroupMembers(int groupNumber)
 {
     // 参数：int groupNumber：待遍历的组别。
-    if (groupNumber >= 1 && groupNumber <= 4)
+    if (isValidGroup(groupNumber))
     {
+        expandGroup(groupNumber - 1);
         return group[groupNumber - 1];
     }
     else
@@ -180,8 +391,9 @@ vector<Person>& Flag_group::getGroupMembers(int groupNumber)
 const vector<Person>& Flag_group::getGroupMembers(int groupNumber) const
 {
     // 参数：int groupNumber：待遍历的组别。
-    if (groupNumber >= 1 && groupNumber <= 4)
+    if (isValidGroup(groupNumber))
     {
+        expandGroup(groupNumber - 1);
         return group[groupNumber - 1];
     }
     else
@@ -194,10 +406,119 @@ const vector<Person>& Flag_group::getGroupMembers(int groupNumber) const
 }
 // 判断整个国旗班是否为空（所有组都没有成员）
 bool Flag_group::isEmpty() const {
-    for (int i = 0; i < 4; ++i) {
-        if (!group[i].empty()) {
+    for (int i = 1; i <= groupCount(); ++i) {
+        if (memberCount(i) > 0) {
             return false;
         }
     }
     return true;
 }
+
+// 调整组数：增加时在末尾添加空组；减少时只能去掉末尾的空组
+bool Flag_group::setGroupCount(int count)
+{
+    if (count < 1 || count > MAX_GROUP_COUNT) {
+        qDebug() << "[Flag_group::setGroupCount] 错误：组数应为 1 ~" << MAX_GROUP_COUNT << "，实际为" << count;
+        return false;
+    }
+    for (int i = count; i < groupCount(); ++i) {
+        if (memberCount(i + 1) > 0) {
+            qDebug() << "[Flag_group::setGroupCount] 错误：组" << i + 1 << "中仍有队员，不能删除该组";
+            return false;
+        }
+    }
+    if (count != groupCount()) {
+        group.resize(count);
+        if (unexpanded.size() > group.size()) unexpanded.resize(group.size()); // 新增的组不在名单文件中
+        fullSaveRequired = true; // 组数保存在完整文件中，增量日志不记录组数
+        trackingLost = true;     // 修改登记不记录组数，下次快照逐人比对
+    }
+    return true;
+}
+
+// 调整执勤地点数：地点数保存在完整文件中，变化后下次完整保存
+bool Flag_group::setLocationCount(int count)
+{
+    if (count < Person::DEFAULT_LOCATION_COUNT || count > Person::MAX_LOCATION_COUNT) {
+        qDebug() << "[Flag_group::setLocationCount] 错误：地点数应为" << Person::DEFAULT_LOCATION_COUNT << "~"
+                 << Person::MAX_LOCATION_COUNT << "，实际为" << count;
+        return false;
+    }
+    if (count != locations) {
+        locations = count;
+        fullSaveRequired = true;
+    }
+    return true;
+}
+
+// 地点的显示名称：南鉴湖、东西院，之后为“地点3”等
+QString Flag_group::locationTitle(int location)
+{
+    static const char* names[Person::DEFAULT_LOCATION_COUNT] = {"南鉴湖", "东西院"};
+    if (location >= 0 && location < Person::DEFAULT_LOCATION_COUNT) {
+        return QString(names[location]);
+    }
+    return QString("地点%1").arg(location + 1);
+}
+
+// 组别的显示名称：一组 ~ 十组，之后为“第11组”等
+QString Flag_group::groupTitle(int groupNumber)
+{
+    static const char* numerals[10] = {"一", "二", "三", "四", "五", "六", "七", "八", "九", "十"};
+    if (groupNumber >= 1 && groupNumber <= 10) {
+        return QString(numerals[groupNumber - 1]) + "组";
+    }
+    return QString("第%1组").arg(groupNumber);
+}
+
+// 在指定组的指定位置插入队员
+void Flag_group::insertPersonAt(int groupNumber, int index, const Person &person)
+{
+    if (!isValidGroup(groupNumber)) {
+        qDebug() << "[Flag_group::insertPersonAt] 错误：非法组号" << groupNumber;
+        return;
+    }
+    expandGroup(groupNumber - 1);
+    vector<Person> &currentGroup = group[groupNumber - 1];
+    index = std::max(0, std::min(index, static_cast<int>(currentGroup.size())));
+    ++notifySuppressed;
+    Person &inserted = *currentGroup.insert(currentGroup.begin() + index, person);
+    --notifySuppressed;
+    adopt(inserted);
+    logChange(Change::Inserted, groupNumber, index);
+    // 恢复的队员可能沿用被删除前的修订号，分配新修订号使增量保存重新写出
+    inserted.markModified();
+}
+
+// 取出并删除指定组指定位置的队员
+Person Flag_group::takePersonAt(int groupNumber, int index)
+{
+    if (!isValidGroup(groupNumber) || index < 0 || index >= memberCount(groupNumber)) {
+        qDebug() << "[Flag_group::takePersonAt] 错误：无效的位置" << groupNumber << index;
+        return Person();
+    }
+    expandGroup(groupNumber - 1);
+    vector<Person> &currentGroup = group[groupNumber - 1];
+    Person person = currentGroup[index]; // 拷贝得到的队员不属于本名单
+    removedKeys.emplace_back(groupNumber, person.getName()); // 记录删除，供增量保存写出
+    ++notifySuppressed;
+    currentGroup.erase(currentGroup.begin() + index);
+    --notifySuppressed;
+    logChange(Change::Removed, groupNumber, index);
+    return person;
+}
+
+// 修改指定组指定位置队员的姓名
+void Flag_group::renamePersonAt(int groupNumber, int index, const std::string &name)
+{
+    if (!isValidGroup(groupNumber) || index < 0 || index >= memberCount(groupNumber)) {
+        qDebug() << "[Flag_group::renamePersonAt] 错误：无效的位置" << groupNumber << index;
+        return;
+    }
+    expandGroup(groupNumber - 1);
+    Person &person = group[groupNumber - 1][index];
+    if (person.getName() == name) return;
+    // 改名后旧的标识不再存在，按删除记录，新信息随修改一起写出
+    removedKeys.emplace_back(groupNumber, person.getName());
+    person.setName(name);
+}
@@ -1,21 +1,39 @@
 // Flag_group.h头文件
 // 功能说明：
-// 设计WHUT国旗班Flag_group类，内置一个vector容器数组group，用于存放一到四组所有成员。
+// 设计WHUT国旗班Flag_group类，内置一个vector容器group，按组存放所有成员；组数默认为四组，可以增加（见 setGroupCount）。
+// 执勤地点数同样是名单级别的设置，默认为南鉴湖、东西院两个地点（见 setLocationCount），排班表、空闲时间与累计次数按此取用。
 // Flag_group类作为容器，将担任对保存所有队员信息、对队员进行增删改查功能的实现等职责
+// 名单可以直接以二进制名单文件为数据源（见 attachMappedRoster）：各组在第一次通过 getGroupMembers 访问时才展开为 Person。
 
 #pragma once
 #include<iostream>
 #include<vector>
+#include<string>
+#include<utility>
+#include<cstdint>
+#include<memory>
 #include<QString>
 #include<QDebug>
 #include"Person.h"
 using std::vector;
 using std::endl;
 
+class MappedRoster;
+
 class Flag_group
 {
 public:
-    Flag_group(){}
+    static constexpr int DEFAULT_GROUP_COUNT = 4; // 默认组数（一到四组）
+    static constexpr int MAX_GROUP_COUNT = 20;    // 组数上限（文件中的组号超出该范围视为损坏）
+
+    Flag_group() : group(DEFAULT_GROUP_COUNT) { restartChangeTracking(); }
+    // 整体拷贝或替换名单（读取文件、恢复历史等）后无法逐人判断修改，下次保存时需完整写出；
+    // 拷贝得到的名单不再以名单文件为数据源（拷贝前先展开全部组），移动时连同数据源一起移动
+    Flag_group(const Flag_group& other);
+    Flag_group(Flag_group&& other) noexcept;
+    Flag_group& operator=(const Flag_group& other);
+    Flag_group& operator=(Flag_group&& other) noexcept;
+    ~Flag_group() { ++notifySuppressed; } // 销毁队员时不再登记
     //操作group容器的函数
     //如果存在重名情况将对同名者的第一个被检索的人进行操作
     void addPersonToGroup(const Person &person, int groupNumber); // 添加队员到指定组
@@ -26,7 +44,84 @@ public:
     vector<Person>& getGroupMembers(int groupNumber); // 获取指定组的所有队员，返回可修改引用版本
     const vector<Person>& getGroupMembers(int groupNumber) const; // 获取指定组的所有队员，返回常量版本
     bool isEmpty() const; // 检测容器是否为空
+    int memberCount(int groupNumber) const; // 指定组的队员数（不展开尚未展开的组）
+    // 组数与组号：组号从1开始，1 ~ groupCount() 为有效组号
+    int groupCount() const { return static_cast<int>(group.size()); }
+    bool isValidGroup(int groupNumber) const { return groupNumber >= 1 && groupNumber <= groupCount(); }
+    bool setGroupCount(int count); // 调整组数：增加时在末尾添加空组，减少时只能去掉末尾的空组；组数变化后下次完整保存
+    static QString groupTitle(int groupNumber); // 组别的显示名称（一组、二组……）
+    // 执勤地点数：地点编号从0开始，0 ~ locationCount()-1 为有效地点
+    int locationCount() const { return locations; }
+    bool setLocationCount(int count); // 调整地点数（DEFAULT_LOCATION_COUNT ~ MAX_LOCATION_COUNT）；减少时队员在多出地点的记录保留但不再使用
+    static QString locationTitle(int location); // 地点的显示名称（南鉴湖、东西院、地点3……）
+    // 按组内位置增删与改名（撤销 / 重做按位置精确还原队员顺序，见 rosterUndoStack.h），同样记录修改供增量保存
+    void insertPersonAt(int groupNumber, int index, const Person &person); // 在指定位置插入队员
+    Person takePersonAt(int groupNumber, int index); // 取出并删除指定位置的队员
+    void renamePersonAt(int groupNumber, int index, const std::string &name); // 修改指定位置队员的姓名
+
+    // 修改跟踪：用于增量保存，只写出上次保存后发生变化的队员
+    // 队员的任一set函数发生实际修改时会分配新的修订号，修订号大于保存水位线的队员即为已修改
+    bool isDirty(const Person& person) const { return person.getRevision() > savedRevision; } // 队员在上次保存后是否被修改或新增
+    bool requiresFullSave() const { return fullSaveRequired; } // 是否需要完整写出（从未保存过或名单被整体替换）
+    const vector<std::pair<int, std::string>>& getRemovedKeys() const { return removedKeys; } // 上次保存后被删除（或改名前）的队员：组别 + 姓名
+    void markSaved(); // 当前名单已全部写入文件，清空修改记录
+    void markFullSaveRequired() { fullSaveRequired = true; } // 直接修改组容器后调用，要求下次完整保存
+
+    // 修改登记：按发生顺序记录被修改、插入、删除的队员位置，生成快照时只处理这些位置（见 rosterSnapshot.h）
+    // 队员的set函数、赋值以及本类的增删改名函数都会登记；直接对 getGroupMembers 返回的容器增删队员时登记不再完整，
+    // changesSince 返回 false，快照退回逐人比对并重新开始登记
+    struct Change {
+        enum Kind : std::uint8_t { Modified, Inserted, Removed };
+        Kind kind;
+        int group;  // 组号（1 ~ 组数）
+        int index;  // 发生修改时的组内位置
+    };
+    // 登记位置：epoch 标识一段连续的登记（名单被整体替换或登记不完整时更换），sequence 为其中已登记的条数
+    struct ChangeMark {
+        std::uint64_t epoch = 0;
+        std::uint64_t sequence = 0;
+    };
+    ChangeMark changeMark() const { return {changeEpoch, changeLogBase + changeLog.size()}; }
+    // 取得 mark 之后的全部登记；登记已不完整或已被丢弃（超过上限）时返回 false
+    bool changesSince(const ChangeMark& mark, const Change** begin, const Change** end) const;
+    // 重新开始登记：全部队员归属本名单，之前的登记位置全部失效（逐人比对生成快照之后调用）
+    void restartChangeTracking() const;
+    bool changeTrackingLost() const; // 登记是否已不完整（队员被直接增删或组数变化）
+
+    // 以二进制名单文件为数据源（见 mappedRoster.h）：组数、地点数取自文件，各组在第一次通过 getGroupMembers 访问
+    // （即需要修改或以 Person 读取其中的队员）时才展开为 Person，展开的队员沿用文件为该记录预留的修订号。
+    // 只读访问（列表、筛选、排班候选）通过 MappedRoster::visitMember 直接读取尚未展开的组。
+    // 名单文件只在存储后端保存成功后写入（见 SystemWindow::saveDataToFile），挂接后视为已保存
+    void attachMappedRoster(std::shared_ptr<const MappedRoster> roster);
+    const MappedRoster* mappedRoster() const { return mapped.get(); }
+    bool isGroupMapped(int groupNumber) const { // 该组是否尚未展开（仍直接读取名单文件）
+        return isValidGroup(groupNumber) && groupNumber <= static_cast<int>(unexpanded.size()) && unexpanded[groupNumber - 1];
+    }
+    std::uint64_t memberRevision(int groupNumber, int index) const; // 指定队员的修订号（不展开该组；调用方保证下标有效）
+    void expandAll() const; // 展开全部尚未展开的组
 private:
-    vector<Person> group[4]; // vector容器数组 分别存放一到四组队员信息
+    friend class Person;
+    void noteModified(const Person* person) const; // 队员发生修改（由 Person 调用）
+    void noteMemberDestroyed() const { if (notifySuppressed == 0) trackingLost = true; } // 队员被直接销毁（由 Person 调用）
+    void logChange(Change::Kind kind, int groupNumber, int index) const;
+    void adopt(const Person& person) const { person.owner.group = this; }
+    void expandGroup(int index) const; // 展开 group[index]（尚未展开时）
+
+    // 修改登记的状态；为只读名单生成快照时也会更新，因此为 mutable。声明在 group 之前，销毁队员时仍然有效
+    mutable vector<Change> changeLog;          // 自 changeLogBase 起的登记
+    mutable std::uint64_t changeLogBase = 0;   // changeLog[0] 的序号
+    mutable std::uint64_t changeEpoch = 0;
+    mutable vector<int> trackedSizes;          // 按登记推算的各组人数，与实际人数不符说明有未登记的增删
+    mutable bool trackingLost = false;
+    mutable int notifySuppressed = 0;          // 本类内部增删队员期间不登记容器移动元素引起的修改与销毁
+
+    // 尚未展开的组在只读访问时也会展开，因此组容器与展开状态为 mutable
+    mutable vector<vector<Person>> group; // 按组存放队员信息，group[i] 为第 i+1 组
+    std::shared_ptr<const MappedRoster> mapped; // 数据源名单文件（未挂接时为空）
+    mutable vector<char> unexpanded;            // unexpanded[i]：第 i+1 组尚未从名单文件展开
+    int locations = Person::DEFAULT_LOCATION_COUNT; // 执勤地点数
+    std::uint64_t savedRevision = 0; // 保存水位线：上次保存时已分配的最大修订号
+    bool fullSaveRequired = true; // 需要完整保存
+    vector<std::pair<int, std::string>> removedKeys; // 上次保存后删除的队员标识（组别 + 姓名）
 };
 
@@ -1,4 +1,42 @@
 #include "Person.h"
+#include "Flag_group.h"
+#include <algorithm>
+
+// 全局修订号计数器，0 保留给"未分配"
+std::atomic<std::uint64_t> Person::revisionCounter{0};
+
+// 向所在名单登记本队员已修改
+void Person::notifyOwner() const
+{
+    owner.group->noteModified(this);
+}
+
+// 名单中的队员不经 Flag_group 直接被销毁（如对 getGroupMembers 返回的容器直接删除），名单的修改登记不再完整
+Person::OwnerLink::~OwnerLink()
+{
+    if (group) group->noteMemberDestroyed();
+}
+
+bool Person::sameContentAs(const Person &other) const
+{
+    // 修订号相同则内容必然相同，直接返回
+    if (revision == other.revision) {
+        return true;
+    }
+    if (name != other.name || gender != other.gender || group != other.group || grade != other.grade
+        || phone_number != other.phone_number || native_place != other.native_place
+        || native != other.native || dorm != other.dorm || school != other.school
+        || classname != other.classname || birthday != other.birthday || isWork != other.isWork
+        || times != other.times || all_times != other.all_times || time != other.time) {
+        return false;
+    }
+    for (int location = 0; location < MAX_LOCATION_COUNT; ++location) {
+        if (location_all_times[location] != other.location_all_times[location]) {
+            return false;
+        }
+    }
+    return true;
+}
 
 string Person::getName() const
 {
@@ -7,7 +45,10 @@ string Person::getName() const
 
 void Person::setName(const string &newName)
 {
-    name = newName;
+    if (name != newName) {
+        name = newName;
+        touch();
+    }
 }
 
 bool Person::getGender() const
@@ -17,7 +58,10 @@ bool Person::getGender() const
 
 void Person::setGender(bool newGender)
 {
-    gender = newGender;
+    if (gender != newGender) {
+        gender = newGender;
+        touch();
+    }
 }
 
 int Person::getGroup() const
@@ -27,33 +71,58 @@ int Person::getGroup() const
 
 void Person::setGroup(int newGroup)
 {
-    group = newGroup;
+    if (group != newGroup) {
+        group = newGroup;
+        touch();
+    }
 }
 
 bool Person::getTime(int row, int column) const
 {
-    // 获取time数组某一成员的值。调用的参数采用正常思维，row行、column列，最小值为1。
-    return time[row-1][column-1];
+    // 获取某一时间点是否有空。调用的参数采用正常思维，row行、column列，最小值为1。
+    if (row < 1 || row > MAX_TIME_ROWS || column < 1 || column > DAY_COUNT) {
+        return false;
+    }
+    return (time >> ((row - 1) * DAY_COUNT + (column - 1))) & 1u;
 }
 
 void Person::setTime(bool (newTime[4][5]))
 {
-    // 设置time数组全部的值。用newTime替换原本的time
+    // 设置前两个地点的四行时间（低20位），其他地点的时间不变
+    std::uint64_t mask = time & ~locationsMask(DEFAULT_LOCATION_COUNT);
     for (int i = 0; i < 4; ++i) {
         for (int g = 0; g < 5; ++g) {
-            time[i][g] = newTime[i][g];
+            if (newTime[i][g]) {
+                mask |= std::uint64_t(1) << (i * DAY_COUNT + g);
+            }
         }
     }
+    setTimeMask(mask);
 }
 void Person::setTime(int row, int column, bool value)
 {
-    // 设置time数组某一成员的值。调用的参数采用正常思维，row行、column列，最小值为1。
-    if (row >= 1 && row <= 4 && column >= 1 && column <= 5) {
-        time[row - 1][column - 1] = value;
+    // 设置某一时间点。调用的参数采用正常思维，row行、column列，最小值为1。
+    if (row >= 1 && row <= MAX_TIME_ROWS && column >= 1 && column <= DAY_COUNT) {
+        const std::uint64_t bit = std::uint64_t(1) << ((row - 1) * DAY_COUNT + (column - 1));
+        setTimeMask(value ? (time | bit) : (time & ~bit));
     }
 
 }
 
+std::uint64_t Person::getTimeMask() const
+{
+    return time;
+}
+
+void Person::setTimeMask(std::uint64_t mask)
+{
+    mask &= locationsMask(MAX_LOCATION_COUNT);
+    if (time != mask) {
+        time = mask;
+        touch();
+    }
+}
+
 int Person::getTimes() const
 {
     return times;
@@ -61,7 +130,10 @@ int Person::getTimes() const
 
 void Person::setTimes(int newTimes)
 {
-    times = newTimes;
+    if (times != newTimes) {
+        times = newTimes;
+        touch();
+    }
 }
 
 int Person::getAll_times() const
@@ -71,27 +143,36 @@ int Person::getAll_times() const
 
 void Person::setAll_times(int newAll_times)
 {
-    all_times = newAll_times;
-}
-
-int Person::getNJHAllTimes() const
-{
-    return njh_all_times;
+    if (all_times != newAll_times) {
+        all_times = newAll_times;
+        touch();
+    }
 }
 
-void Person::setNJHAllTimes(int value)
+int Person::getLocationCount() const
 {
-    njh_all_times = value;
+    int count = MAX_LOCATION_COUNT;
+    while (count > DEFAULT_LOCATION_COUNT && location_all_times[count - 1] == 0) {
+        --count;
+    }
+    return count;
 }
 
-int Person::getDXYAllTimes() const
+int Person::getLocationAllTimes(int location) const
 {
-    return dxy_all_times;
+    if (location < 0 || location >= MAX_LOCATION_COUNT) {
+        return 0;
+    }
+    return location_all_times[location];
 }
 
-void Person::setDXYAllTimes(int value)
+void Person::setLocationAllTimes(int location, int value)
 {
-    dxy_all_times = value;
+    if (location < 0 || location >= MAX_LOCATION_COUNT || location_all_times[location] == value) {
+        return;
+    }
+    location_all_times[location] = value;
+    touch();
 }
 
 string Person::getPhone_number() const
@@ -101,57 +182,100 @@ string Person::getPhone_number() const
 
 void Person::setPhone_number(const string &newPhone_number)
 {
-    phone_number = newPhone_number;
+    if (phone_number != newPhone_number) {
+        phone_number = newPhone_number;
+        touch();
+    }
 }
 
-string Person::getNative_place() const
+const string& Person::getNative_place() const
 {
-    return native_place;
+    return StringPool::shared().text(native_place);
 }
 
 void Person::setNative_place(const string &newNative_place)
 {
-    native_place = newNative_place;
+    setNative_placeId(StringPool::shared().intern(newNative_place));
+}
+
+void Person::setNative_placeId(StringPool::Id id)
+{
+    if (native_place != id) {
+        native_place = id;
+        touch();
+    }
 }
 
-string Person::getNative() const
+const string& Person::getNative() const
 {
-    return native;
+    return StringPool::shared().text(native);
 }
 
 void Person::setNative(const string &newNative)
 {
-    native = newNative;
+    setNativeId(StringPool::shared().intern(newNative));
 }
 
-string Person::getDorm() const
+void Person::setNativeId(StringPool::Id id)
 {
-    return dorm;
+    if (native != id) {
+        native = id;
+        touch();
+    }
+}
+
+const string& Person::getDorm() const
+{
+    return StringPool::shared().text(dorm);
 }
 
 void Person::setDorm(const string &newDorm)
 {
-    dorm = newDorm;
+    setDormId(StringPool::shared().intern(newDorm));
+}
+
+void Person::setDormId(StringPool::Id id)
+{
+    if (dorm != id) {
+        dorm = id;
+        touch();
+    }
 }
 
-string Person::getSchool() const
+const string& Person::getSchool() const
 {
-    return school;
+    return StringPool::shared().text(school);
 }
 
 void Person::setSchool(const string &newSchool)
 {
-    school = newSchool;
+    setSchoolId(StringPool::shared().intern(newSchool));
+}
+
+void Person::setSchoolId(StringPool::Id id)
+{
+    if (school != id) {
+        school = id;
+        touch();
+    }
 }
 
-string Person::getClassname() const
+const string& Person::getClassname() const
 {
-    return classname;
+    return StringPool::shared().text(classname);
 }
 
 void Person::setClassname(const string &newClassname)
 {
-    classname = newClassname;
+    setClassnameId(StringPool::shared().intern(newClassname));
+}
+
+void Person::setClassnameId(StringPool::Id id)
+{
+    if (classname != id) {
+        classname = id;
+        touch();
+    }
 }
 
 bool Person::getIsWork() const
@@ -161,7 +285,10 @@ bool Person::getIsWork() const
 
 void Person::setIsWork(bool newIsWork)
 {
-    isWork = newIsWork;
+    if (isWork != newIsWork) {
+        isWork = newIsWork;
+        touch();
+    }
 }
 
 string Person::getBirthday() const
@@ -171,7 +298,10 @@ string Person::getBirthday() const
 
 void Person::setBirthday(const string &newBirthday)
 {
-    birthday = newBirthday;
+    if (birthday != newBirthday) {
+        birthday = newBirthday;
+        touch();
+    }
 }
 
 int Person::getGrade() const
@@ -181,17 +311,15 @@ int Person::getGrade() const
 
 void Person::setGrade(int newGrade)
 {
-    grade = newGrade;
+    if (grade != newGrade) {
+        grade = newGrade;
+        touch();
+    }
 }
 // 无参构造函数
-Person::Person() : name(""), gender(false), group(0), grade(0), phone_number(""), native_place(""),
-    native(""), dorm(""), school(""), classname(""), birthday(""), isWork(true),
-    times(0), all_times(0), njh_all_times(0), dxy_all_times(0) {
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 5; ++j) {
-            time[i][j] = false;
-        }
-    }
+Person::Person() : name(""), gender(false), group(0), grade(0), phone_number(""), native_place(StringPool::EMPTY),
+    native(StringPool::EMPTY), dorm(StringPool::EMPTY), school(StringPool::EMPTY), classname(StringPool::EMPTY), birthday(""), isWork(true),
+    time(0), times(0), all_times(0), location_all_times{}, revision(++revisionCounter) {
 }
 // 全参构造
 Person::Person(const string &name, bool gender, int group, int grade, const string &phone_number, const string &native_place, const string &native, const string &dorm, const string &school, const string &classname, const string &birthday, bool isWork, bool (&time)[4][5], int times, int all_times, int njh_all_times, int dxy_all_times) :
@@ -200,21 +328,24 @@ Person::Person(const string &name, bool gender, int group, int grade, const stri
     group(group),
     grade(grade),
     phone_number(phone_number),
-    native_place(native_place),
-    native(native),
-    dorm(dorm),
-    school(school),
-    classname(classname),
+    native_place(StringPool::shared().intern(native_place)),
+    native(StringPool::shared().intern(native)),
+    dorm(StringPool::shared().intern(dorm)),
+    school(StringPool::shared().intern(school)),
+    classname(StringPool::shared().intern(classname)),
     birthday(birthday),
     isWork(isWork),
+    time(0),
     times(times),
     all_times(all_times),
-    njh_all_times(njh_all_times),
-    dxy_all_times(dxy_all_times)
+    location_all_times{njh_all_times, dxy_all_times},
+    revision(++revisionCounter)
 {
     for (int i = 0; i < 4; ++i) {
         for (int g = 0; g < 5; ++g) {
-            this->time[i][g] = time[i][g];
+            if (time[i][g]) {
+                this->time |= std::uint64_t(1) << (i * DAY_COUNT + g);
+            }
         }
     }
 }
@@ -1,14 +1,43 @@
 // Person.h头文件
 // 功能说明：设计队员类Person，用于存放单个队员的基础信息、可工作时间、执勤次数等
+// 籍贯、民族、寝室、学院、班级在全队中大量重复，只保存其在字符串池中的编号（见 stringPool.h）
+// 空闲时间与各地点累计次数按地点数上限 MAX_LOCATION_COUNT 保存在对象内部（位掩码与定长数组），名单实际使用的地点数见 Flag_group::locationCount
 
 #pragma once
 #include <string>
+#include <cstdint>
+#include <atomic>
+#include "stringPool.h"
 using std::string;
 
+class Flag_group;
+
 
 class Person
 {
 public:
+    // 执勤地点编号（从0开始），新增地点依次编号
+    enum Location { NJH = 0, DXY = 1 };
+    static constexpr int DEFAULT_LOCATION_COUNT = 2; // 默认的执勤地点数：南鉴湖、东西院
+    static constexpr int MAX_LOCATION_COUNT = 6;     // 执勤地点数上限
+    static constexpr int DAY_COUNT = 5;              // 周一~周五
+    static constexpr int MAX_TIME_ROWS = MAX_LOCATION_COUNT * 2;       // 每个地点升旗、降旗各一行
+    static constexpr int MAX_TIME_SLOTS = MAX_TIME_ROWS * DAY_COUNT;   // 时间点总数上限（不超过64，见 getTimeMask）
+
+    // 空闲时间的行号（从1开始）：ceremony 0 为升旗、1 为降旗。
+    // 前两个地点沿用原有的四行（南鉴湖升旗、东西院升旗、南鉴湖降旗、东西院降旗），之后每个地点依次占升旗、降旗两行，
+    // 因此增加地点不改变已有的时间位
+    static int timeRow(int ceremony, int location) {
+        return location < DEFAULT_LOCATION_COUNT ? ceremony * DEFAULT_LOCATION_COUNT + location + 1 : location * 2 + ceremony + 1;
+    }
+    static int rowLocation(int row) { return row <= DEFAULT_LOCATION_COUNT * 2 ? (row - 1) % DEFAULT_LOCATION_COUNT : (row - 1) / 2; }
+    static int rowCeremony(int row) { return row <= DEFAULT_LOCATION_COUNT * 2 ? (row - 1) / DEFAULT_LOCATION_COUNT : (row - 1) % 2; }
+    // 前 locationCount 个地点的全部时间位
+    static std::uint64_t locationsMask(int locationCount) {
+        const int slots = locationCount * 2 * DAY_COUNT;
+        return slots >= 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << slots) - 1;
+    }
+
     // 构造函数
     Person();
     Person(const string &name, bool gender, int group, int grade,
@@ -17,8 +46,11 @@ public:
            const string &classname, const string &birthday, bool isWork, bool (&time)[4][5],
            int times, int all_times, int njh_all_times = 0, int dxy_all_times = 0);
     
+    Person(const Person& other) = default;
+    Person(Person&& other) noexcept = default;
+
     // 重载赋值运算符
-    // 对成员变量全部赋新值
+    // 对成员变量全部赋新值（所在名单不变，见 OwnerLink）
     Person& operator=(const Person& other) {
         if (this != &other) {
             name = other.name; // 队员姓名
@@ -33,15 +65,14 @@ public:
             classname = other.classname; // 专业班级
             birthday = other.birthday; // 生日信息
             isWork = other.isWork; // 是否参加执勤标记，用于勾选整组执勤时调用
-            for (int i = 0; i < 4; ++i) {
-                for (int j = 0; j < 5; ++j) {
-                    time[i][j] = other.time[i][j]; // 队员执勤时间安排，对应20个任务时间点是否有时间。一周升降旗十次任务，一次任务两个校区：10*2=20。
-                }
-            }
+            time = other.time; // 队员执勤时间安排（位掩码）
             times = other.times; // 一次排班执勤次数，用于记录一周执勤该队员的执勤次数
             all_times = other.all_times; // 学期总执勤次数，用于采用总次数排班规则时使用
-            njh_all_times = other.njh_all_times; // 南鉴湖累计执勤次数
-            dxy_all_times = other.dxy_all_times; // 东西院累计执勤次数
+            for (int location = 0; location < MAX_LOCATION_COUNT; ++location) {
+                location_all_times[location] = other.location_all_times[location]; // 各地点累计执勤次数
+            }
+            revision = other.revision; // 内容修订号随内容一起复制
+            if (owner.group) notifyOwner();
         }
         return *this;
     }
@@ -53,6 +84,18 @@ public:
     bool operator!=(const Person& other) const {
         return !(*this == other);
     }
+    // 逐字段比较两个队员的全部信息是否一致（与 == 仅比较姓名不同）
+    bool sameContentAs(const Person& other) const;
+
+    // 内容修订号：构造或任一字段发生实际修改时分配新的全局递增编号，拷贝时随内容一起复制。
+    // 因此两个 Person 修订号相同即说明内容相同，排班历史快照据此共享未修改的队员记录。
+    std::uint64_t getRevision() const { return revision; }
+    // 目前已分配的最大修订号：修订号不大于它的队员在此之后未被修改过
+    static std::uint64_t latestRevision() { return revisionCounter.load(); }
+    // 预留 count 个连续的修订号并返回其中第一个：尚未展开为 Person 的名单文件记录各占一个（见 mappedRoster.h）
+    static std::uint64_t reserveRevisions(std::uint64_t count) { return revisionCounter.fetch_add(count) + 1; }
+    // 内容未变但需要重新写出时分配新修订号（如撤销删除后重新加入名单的队员，见 rosterUndoStack.h）
+    void markModified() { touch(); }
 
     // get/set函数声明
     // 姓名
@@ -67,39 +110,47 @@ public:
     // 所属年级
     int getGrade() const;
     void setGrade(int newGrade);
-    // 可执勤时间数组
+    // 可执勤时间：row 为行号（1 ~ MAX_TIME_ROWS，见 timeRow），column 为周几（1~5）
     bool getTime(int row, int column) const;
-    void setTime(bool newtime[4][5]);// 设置time数组全部的值。
-    void setTime(int row, int column, bool value);// 设置time数组某一成员的值。调用的参数采用正常思维，row行、column列，最小值为1。
+    void setTime(bool newtime[4][5]);// 设置前两个地点的四行时间，其他地点的时间不变
+    void setTime(int row, int column, bool value);// 设置某一时间点。调用的参数采用正常思维，row行、column列，最小值为1。
+    // 以位掩码形式读写全部时间点，第 (row-1)*5+(column-1) 位对应第 row 行第 column 列；前两个地点为低20位
+    std::uint64_t getTimeMask() const;
+    void setTimeMask(std::uint64_t mask);
     // 一周执勤次数
     int getTimes() const;
     void setTimes(int newTimes);
     // 学期执勤次数
     int getAll_times() const;
     void setAll_times(int newAll_times);
+    // 各地点累计执勤次数：location 为地点编号（0 ~ MAX_LOCATION_COUNT-1），超出范围的地点次数为0且不能设置。
+    // getLocationCount 为需要保存的地点数：至少为默认的两个地点，其后到最后一个次数不为0的地点为止
+    int getLocationCount() const;
+    int getLocationAllTimes(int location) const;
+    void setLocationAllTimes(int location, int value);
     // 南鉴湖累计执勤次数
-    int getNJHAllTimes() const;
-    void setNJHAllTimes(int value);
+    int getNJHAllTimes() const { return getLocationAllTimes(NJH); }
+    void setNJHAllTimes(int value) { setLocationAllTimes(NJH, value); }
     // 东西院累计执勤次数
-    int getDXYAllTimes() const;
-    void setDXYAllTimes(int value);
+    int getDXYAllTimes() const { return getLocationAllTimes(DXY); }
+    void setDXYAllTimes(int value) { setLocationAllTimes(DXY, value); }
     // 电话
     string getPhone_number() const;
     void setPhone_number(const string &newPhone_number);
     // 籍贯
-    string getNative_place() const;
+    const string& getNative_place() const;
     void setNative_place(const string &newNative_place);
     // 民族
-    string getNative() const;
+    const string& getNative() const;
     void setNative(const string &newNative);
     // 寝室
-    string getDorm() const;
+    const string& getDorm() const;
     void setDorm(const string &newDorm);
     // 学院
-    string getSchool() const;
+    const string& getSchool() const;
     void setSchool(const string &newSchool);
     // 专业班级
-    string getClassname() const;
+    const string& getClassname() const;
     void setClassname(const string &newClassname);
     // 是否参加执勤标记
     bool getIsWork() const;
@@ -107,6 +158,17 @@ public:
     // 生日信息
     string getBirthday() const;
     void setBirthday(const string &newBirthday);
+    // 档案字段在字符串池中的编号：文字相同则编号相同，可直接比较或分组；读取文件时可按编号直接赋值
+    StringPool::Id getNative_placeId() const { return native_place; }
+    StringPool::Id getNativeId() const { return native; }
+    StringPool::Id getDormId() const { return dorm; }
+    StringPool::Id getSchoolId() const { return school; }
+    StringPool::Id getClassnameId() const { return classname; }
+    void setNative_placeId(StringPool::Id id);
+    void setNativeId(StringPool::Id id);
+    void setDormId(StringPool::Id id);
+    void setSchoolId(StringPool::Id id);
+    void setClassnameId(StringPool::Id id);
 
 
 
@@ -118,19 +180,37 @@ private:
     int group; // 所属组别（1~4）
     int grade; // 所属年级（1~4）
     string phone_number; // 电话号码
-    string native_place; // 籍贯
-    string native; // 民族
-    string dorm; // 寝室号
-    string school; // 学院
-    string classname; // 专业班级
+    StringPool::Id native_place; // 籍贯（字符串池编号，下同）
+    StringPool::Id native; // 民族
+    StringPool::Id dorm; // 寝室号
+    StringPool::Id school; // 学院
+    StringPool::Id classname; // 专业班级
     string birthday; // 生日信息
 
 
     // 队员执勤所需信息
     bool isWork; // 是否参加执勤标记，用于勾选整组执勤时调用
-    bool time[4][5]; // 队员执勤时间安排，对应20个任务时间点是否有时间。一周升降旗十次任务，一次任务两个校区：10*2=20。
+    std::uint64_t time; // 队员执勤时间安排：每个地点升旗、降旗各一行，每行周一~周五5个时间点，位序见 getTimeMask
     int times; // 一次排班执勤次数，用于记录一周执勤该队员的执勤次数
     int all_times; // 学期总执勤次数，用于采用总次数排班规则时使用
-    int njh_all_times; // 南鉴湖累计执勤次数
-    int dxy_all_times; // 东西院累计执勤次数
+    int location_all_times[MAX_LOCATION_COUNT]; // 各地点累计执勤次数，下标为地点编号
+
+    std::uint64_t revision; // 内容修订号
+    static std::atomic<std::uint64_t> revisionCounter; // 全局修订号计数器
+    void touch() { revision = ++revisionCounter; if (owner.group) notifyOwner(); } // 内容发生修改时分配新修订号，并登记到所在名单
+
+    // 所在名单：由 Flag_group 设置，队员发生修改时向名单登记（见 Flag_group::changesSince）。
+    // 拷贝得到的队员不属于任何名单；移动构造（容器扩容、插入时后移元素）时两者都属于原名单，
+    // 被移走的位置之后可能被重新赋值而继续留在名单中。名单中的队员被直接销毁时通知名单登记已不完整
+    struct OwnerLink {
+        const Flag_group* group = nullptr;
+        OwnerLink() = default;
+        OwnerLink(const OwnerLink&) {}
+        OwnerLink(OwnerLink&& other) noexcept : group(other.group) {}
+        OwnerLink& operator=(const OwnerLink&) { return *this; }
+        ~OwnerLink();
+    };
+    mutable OwnerLink owner;
+    void notifyOwner() const;
+    friend class Flag_group;
 };
@@ -0,0 +1,136 @@
+// autosaveService.h头文件
+// 功能说明：后台自动保存。队员数据被修改后，在防抖时间窗口结束时把名单写入恢复文件（./data/data.dat.autosave），
+// 程序崩溃后下次启动可从恢复文件找回未保存的修改；正常保存或用户选择「不保存」退出时删除恢复文件。
+// 界面线程只负责生成写时复制快照（见 rosterSnapshot.h，未修改的队员直接共享上一次快照的记录），
+// 展开、序列化、加密与写文件都在单独的工作线程完成，不会阻塞界面。
+// 同一时间最多只有一次写入；写入进行期间的修改合并到下一次，两次写入的开始时间至少间隔一个防抖时间窗口。
+// 删除恢复文件同样在工作线程上排队执行，界面线程从不等待写入结束。
+
+#pragma once
+#include <QObject>
+#include <QTimer>
+#include <QThreadPool>
+#include <QElapsedTimer>
+#include <QTime>
+#include <QFile>
+#include <QDebug>
+#include <functional>
+#include "Flag_group.h"
+#include "rosterSnapshot.h"
+#include "encryptedFileManager.h"
+
+class AutosaveService
+{
+public:
+    static constexpr int DEBOUNCE_MS = 5000; // 防抖时间窗口
+
+    AutosaveService() {
+        m_pool.setMaxThreadCount(1); // 写入串行进行
+        m_timer.setSingleShot(true);
+        m_timer.setInterval(DEBOUNCE_MS);
+    }
+
+    ~AutosaveService() {
+        m_timer.stop();
+        m_pool.waitForDone();
+    }
+
+    // 启用自动保存
+    // source：被监视的名单（只在界面线程读取）；path：恢复文件路径
+    // context：界面线程中的对象，写入结果通过它排队回到界面线程；report：显示状态文字（不弹出对话框）
+    void start(const Flag_group* source, const QString& path, QObject* context,
+               std::function<void(const QString&)> report) {
+        m_source = source;
+        m_path = path;
+        m_context = context;
+        m_report = std::move(report);
+        QObject::connect(&m_timer, &QTimer::timeout, context, [this]() { writeSnapshot(); });
+    }
+
+    // 名单被修改：防抖窗口内的多次修改合并为一次写入
+    void notifyChanged() {
+        if (!m_source) return;
+        if (m_writing) {
+            m_pending = true;  // 当前写入结束后再计时
+        } else if (!m_timer.isActive()) {
+            m_timer.start();
+        }
+    }
+
+    // 名单已正常保存或用户放弃修改：停止自动保存并删除恢复文件
+    // 不等待进行中的写入：删除作为任务排在写入线程上，单线程池保证它在进行中的写入之后执行，
+    // 进行中的写入返回的结果按代数丢弃（见 finishWrite）
+    void discardRecovery() {
+        m_timer.stop();
+        m_pending = false;
+        ++m_generation;    // 之后返回的写入结果不再处理
+        m_writing = false;
+        if (m_path.isEmpty()) return;
+        const QString path = m_path;
+        m_pool.start([path]() {
+            if (QFile::exists(path) && !QFile::remove(path)) {
+                qDebug() << "无法删除自动保存的恢复文件：" << path;
+            }
+        });
+    }
+
+    // 恢复文件是否存在（上次退出前有未保存的修改）
+    static bool hasRecovery(const QString& path) {
+        return QFile::exists(path);
+    }
+
+private:
+    // 防抖窗口结束：在界面线程生成快照，交给工作线程写出
+    void writeSnapshot() {
+        if (m_writing) {
+            m_pending = true;
+            return;
+        }
+        m_lastSnapshot = RosterSnapshot::capture(*m_source, m_hasSnapshot ? &m_lastSnapshot : nullptr);
+        m_hasSnapshot = true;
+        m_writing = true;
+
+        const RosterSnapshot snapshot = m_lastSnapshot;
+        const QString path = m_path;
+        const quint64 generation = m_generation;
+        QObject* context = m_context;
+        m_pool.start([this, snapshot, path, generation, context]() {
+            QElapsedTimer elapsed;
+            elapsed.start();
+            const bool ok = EncryptedFileManager::saveToFile(snapshot.toFlagGroup(), path);
+            const qint64 ms = elapsed.elapsed();
+            QMetaObject::invokeMethod(context, [this, ok, ms, generation]() {
+                finishWrite(ok, ms, generation);
+            }, Qt::QueuedConnection);
+        });
+    }
+
+    // 写入结束（界面线程）
+    void finishWrite(bool ok, qint64 ms, quint64 generation) {
+        if (generation != m_generation) return;
+        m_writing = false;
+        if (ok) {
+            if (m_report) m_report(QString("已自动保存（%1，用时 %2 毫秒）").arg(QTime::currentTime().toString("HH:mm:ss")).arg(ms));
+        } else {
+            qDebug() << "自动保存失败：" << m_path;
+            if (m_report) m_report("自动保存失败，请尽快手动保存数据");
+        }
+        // 写入期间又有修改：重新计时，保证两次写入至少间隔一个防抖窗口
+        if (m_pending) {
+            m_pending = false;
+            m_timer.start();
+        }
+    }
+
+    const Flag_group* m_source = nullptr;
+    QString m_path;
+    QObject* m_context = nullptr;
+    std::function<void(const QString&)> m_report;
+    QTimer m_timer;                // 防抖计时器（界面线程）
+    QThreadPool m_pool;            // 单线程写入
+    RosterSnapshot m_lastSnapshot; // 上一次写出的快照，下一次快照共享其中未修改的队员记录
+    bool m_hasSnapshot = false;
+    bool m_writing = false;        // 是否有写入正在进行
+    bool m_pending = false;        // 写入期间是否又发生了修改
+    quint64 m_generation = 0;      // 每次放弃恢复文件时递增
+};
@@ -0,0 +1,160 @@
+// availabilityMatrixDialog.cpp源文件
+// 功能说明：批量编辑空闲时间窗口的实现
+
+#include "availabilityMatrixDialog.h"
+#include <QApplication>
+#include <QClipboard>
+#include <QHeaderView>
+#include <QItemSelectionModel>
+#include <QMessageBox>
+
+AvailabilityMatrixDialog::AvailabilityMatrixDialog(const Flag_group& roster,
+                                                   const QVector<QPair<int, int>>& members,
+                                                   QWidget *parent)
+    : QDialog(parent)
+{
+    setWindowTitle("批量编辑空闲时间");
+    setMinimumSize(1000, 600);
+
+    // 创建布局
+    QVBoxLayout* mainLayout = new QVBoxLayout(this);
+
+    QLabel* tipLabel = new QLabel("拖动鼠标选择区域后设置有空 / 没空；双击行或列标题切换整行 / 整列；"
+                                  "可从表格软件复制 0 / 1（或 √ / ×）后按 Ctrl+V 粘贴到当前单元格起的区域。", this);
+    tipLabel->setWordWrap(true);
+    mainLayout->addWidget(tipLabel);
+
+    // 矩阵表格：表格视图只绘制可见的行，单元格数据由模型按需计算
+    model = new AvailabilityMatrixModel(roster, members, this);
+    tableView = new QTableView(this);
+    tableView->setModel(model);
+    tableView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    tableView->setSelectionBehavior(QAbstractItemView::SelectItems);
+    tableView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    tableView->horizontalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tableView->horizontalHeader()->setDefaultSectionSize(52);
+    tableView->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    tableView->verticalHeader()->setDefaultSectionSize(24);
+    tableView->installEventFilter(this);
+    mainLayout->addWidget(tableView, 1);
+
+    // 按钮区域
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+
+    availableButton = new QPushButton("设为有空", this);
+    buttonLayout->addWidget(availableButton);
+
+    unavailableButton = new QPushButton("设为没空", this);
+    buttonLayout->addWidget(unavailableButton);
+
+    toggleButton = new QPushButton("切换", this);
+    buttonLayout->addWidget(toggleButton);
+
+    pasteButton = new QPushButton("粘贴", this);
+    buttonLayout->addWidget(pasteButton);
+
+    statusLabel = new QLabel(this);
+    buttonLayout->addWidget(statusLabel);
+
+    buttonLayout->addStretch();
+
+    okButton = new QPushButton("确定", this);
+    okButton->setDefault(true);
+    buttonLayout->addWidget(okButton);
+
+    cancelButton = new QPushButton("取消", this);
+    buttonLayout->addWidget(cancelButton);
+
+    mainLayout->addLayout(buttonLayout);
+
+    // 连接信号和槽
+    connect(availableButton, &QPushButton::clicked, this, &AvailabilityMatrixDialog::onSetAvailableClicked);
+    connect(unavailableButton, &QPushButton::clicked, this, &AvailabilityMatrixDialog::onSetUnavailableClicked);
+    connect(toggleButton, &QPushButton::clicked, this, &AvailabilityMatrixDialog::onToggleClicked);
+    connect(pasteButton, &QPushButton::clicked, this, &AvailabilityMatrixDialog::onPasteClicked);
+    connect(okButton, &QPushButton::clicked, this, &QDialog::accept);
+    connect(cancelButton, &QPushButton::clicked, this, &AvailabilityMatrixDialog::reject);
+    connect(tableView->verticalHeader(), &QHeaderView::sectionDoubleClicked, this, [this](int row) {
+        model->toggleRow(row);
+        updateStatus();
+    });
+    connect(tableView->horizontalHeader(), &QHeaderView::sectionDoubleClicked, this, [this](int column) {
+        model->toggleColumn(column);
+        updateStatus();
+    });
+
+    updateStatus();
+}
+
+bool AvailabilityMatrixDialog::eventFilter(QObject *obj, QEvent *event)
+{
+    // 表格自身会处理空格（选中当前单元格），因此在表格收到按键前拦截
+    if (obj == tableView && event->type() == QEvent::KeyPress) {
+        QKeyEvent* keyEvent = static_cast<QKeyEvent*>(event);
+        if (keyEvent->matches(QKeySequence::Paste)) {
+            onPasteClicked();
+            return true;
+        }
+        if (keyEvent->key() == Qt::Key_Space) {
+            onToggleClicked();
+            return true;
+        }
+        if (keyEvent->key() == Qt::Key_Delete || keyEvent->key() == Qt::Key_Backspace) {
+            onSetUnavailableClicked();
+            return true;
+        }
+    }
+    return QDialog::eventFilter(obj, event);
+}
+
+void AvailabilityMatrixDialog::reject()
+{
+    const int changed = model->changedCount();
+    if (changed > 0) {
+        QMessageBox::StandardButton reply = QMessageBox::question(this, "放弃修改",
+            QString("已修改 %1 名队员的空闲时间，是否放弃这些修改？").arg(changed),
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::No);
+        if (reply != QMessageBox::Yes) {
+            return;
+        }
+    }
+    QDialog::reject();
+}
+
+void AvailabilityMatrixDialog::onSetAvailableClicked()
+{
+    model->setCells(tableView->selectionModel()->selectedIndexes(), true);
+    updateStatus();
+}
+
+void AvailabilityMatrixDialog::onSetUnavailableClicked()
+{
+    model->setCells(tableView->selectionModel()->selectedIndexes(), false);
+    updateStatus();
+}
+
+void AvailabilityMatrixDialog::onToggleClicked()
+{
+    model->toggleCells(tableView->selectionModel()->selectedIndexes());
+    updateStatus();
+}
+
+void AvailabilityMatrixDialog::onPasteClicked()
+{
+    // 粘贴到当前单元格起的区域；没有当前单元格时从左上角开始
+    QModelIndex topLeft = tableView->currentIndex();
+    if (!topLeft.isValid()) {
+        topLeft = model->index(0, 0);
+    }
+    const int invalid = model->paste(topLeft, QApplication::clipboard()->text());
+    updateStatus();
+    if (invalid > 0) {
+        QMessageBox::warning(this, "粘贴", QString("有 %1 个单元格无法识别（应为 0 / 1 或 √ / ×），已保持原值。").arg(invalid));
+    }
+}
+
+void AvailabilityMatrixDialog::updateStatus()
+{
+    const int changed = model->changedCount();
+    statusLabel->setText(changed > 0 ? QString("已修改 %1 名队员").arg(changed) : QString());
+}
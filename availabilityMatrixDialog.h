@@ -0,0 +1,49 @@
+// availabilityMatrixDialog.h头文件
+// 功能说明：批量编辑空闲时间窗口（队员 × 名单全部地点时间点的矩阵，见 availabilityMatrixModel.h）
+
+#pragma once
+#include <QDialog>
+#include <QLabel>
+#include <QPushButton>
+#include <QTableView>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QKeyEvent>
+#include "availabilityMatrixModel.h"
+
+class AvailabilityMatrixDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    // members 为要编辑的队员（组号、组内位置），按此顺序列出
+    explicit AvailabilityMatrixDialog(const Flag_group& roster,
+                                      const QVector<QPair<int, int>>& members,
+                                      QWidget *parent = nullptr);
+
+    // 把修改写入名单（一个撤销步骤），返回修改的队员数；应在窗口以“确定”关闭后调用
+    int apply(RosterUndoStack& undoStack) const { return model->apply(undoStack); }
+
+protected:
+    bool eventFilter(QObject *obj, QEvent *event) override; // 表格中的快捷键：Ctrl+V 粘贴、空格切换、Delete 设为没空
+    void reject() override; // 有未保存的修改时确认后再关闭
+
+private slots:
+    void onSetAvailableClicked();
+    void onSetUnavailableClicked();
+    void onToggleClicked();
+    void onPasteClicked();
+
+private:
+    void updateStatus(); // 更新已修改人数的提示
+
+    AvailabilityMatrixModel* model;
+    QTableView* tableView;
+    QLabel* statusLabel;
+    QPushButton* availableButton;
+    QPushButton* unavailableButton;
+    QPushButton* toggleButton;
+    QPushButton* pasteButton;
+    QPushButton* okButton;
+    QPushButton* cancelButton;
+};
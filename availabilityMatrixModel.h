@@ -0,0 +1,212 @@
+// availabilityMatrixModel.h头文件
+// 功能说明：批量编辑空闲时间的矩阵模型（队员 × 名单全部地点的时间点，两个地点时为20个）
+// 每行一名队员，每列一个时间点，列的顺序与空闲时间导入表格一致：周一升旗南鉴湖、周一升旗东西院、周一降旗南鉴湖、周一降旗东西院、周二……；
+// 地点多于两个时每天依次为各地点的升旗、各地点的降旗
+// 模型只保存每名队员的时间掩码（位序同 Person::getTimeMask）及打开时的原值，单元格按需由掩码计算，不为单元格创建任何对象，
+// 表格视图只绘制可见的行，上千名队员也能流畅滚动。
+// 编辑只修改模型中的掩码，apply 时把有变化的队员一次写入名单，作为一个撤销步骤（见 rosterUndoStack.h）。
+
+#pragma once
+#include <QAbstractTableModel>
+#include <QBrush>
+#include <QColor>
+#include <QFont>
+#include <QModelIndexList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <cstdint>
+#include "Flag_group.h"
+#include "memberFields.h"
+#include "rosterUndoStack.h"
+
+class AvailabilityMatrixModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    static constexpr int DAY_COUNT = Person::DAY_COUNT; // 周一~周五
+
+    // members 为要编辑的队员（组号、组内位置）
+    AvailabilityMatrixModel(const Flag_group& roster, const QVector<QPair<int, int>>& members, QObject* parent = nullptr)
+        : QAbstractTableModel(parent), m_locationCount(roster.locationCount()) {
+        m_rows.reserve(members.size());
+        for (const auto& member : members) {
+            if (!roster.isValidGroup(member.first)) continue;
+            const auto& people = roster.getGroupMembers(member.first);
+            if (member.second < 0 || member.second >= static_cast<int>(people.size())) continue;
+            const Person& person = people[member.second];
+            const std::uint64_t mask = person.getTimeMask();
+            m_rows.append({member.first, member.second,
+                           QString("%1（%2）").arg(QString::fromStdString(person.getName()), Flag_group::groupTitle(member.first)),
+                           mask, mask});
+        }
+        m_changedFont.setBold(true);
+    }
+
+    // 每天的时间点数：各地点升旗、降旗各一个
+    int slotsPerDay() const { return m_locationCount * 2; }
+    int slotCount() const { return slotsPerDay() * DAY_COUNT; }
+    // 列号对应的时间掩码位（行号见 Person::timeRow）
+    int bitOf(int column) const {
+        const int slot = column % slotsPerDay();
+        const int row = Person::timeRow(slot / m_locationCount, slot % m_locationCount);
+        return (row - 1) * DAY_COUNT + column / slotsPerDay();
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override { return parent.isValid() ? 0 : m_rows.size(); }
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override { return parent.isValid() ? 0 : slotCount(); }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid()) return QVariant();
+        const Row& row = m_rows.at(index.row());
+        const std::uint64_t bit = std::uint64_t(1) << bitOf(index.column());
+        const bool available = row.mask & bit;
+        switch (role) {
+        case Qt::DisplayRole: return available ? QString("√") : QString();
+        case Qt::TextAlignmentRole: return int(Qt::AlignCenter);
+        case Qt::BackgroundRole:
+            if (available) return QBrush(QColor("#C8E6C9"));
+            return QVariant();
+        case Qt::FontRole:
+            if ((row.mask ^ row.original) & bit) return m_changedFont;
+            return QVariant();
+        case Qt::ToolTipRole:
+            return QString("%1 %2：%3").arg(row.name, slotTitle(index.column()), available ? "有空" : "没空");
+        default: return QVariant();
+        }
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
+        if (role != Qt::DisplayRole) return QVariant();
+        if (orientation == Qt::Vertical) return section >= 0 && section < m_rows.size() ? m_rows.at(section).name : QVariant();
+        if (section < 0 || section >= slotCount()) return QVariant();
+        static const char* days[DAY_COUNT] = {"周一", "周二", "周三", "周四", "周五"};
+        const int slot = section % slotsPerDay();
+        return QString(days[section / slotsPerDay()]) + (slot < m_locationCount ? "\n升旗\n" : "\n降旗\n")
+            + Flag_group::locationTitle(slot % m_locationCount);
+    }
+
+    // 把选中的单元格设为有空 / 没空
+    void setCells(const QModelIndexList& cells, bool available) {
+        edit(cells, [available](std::uint64_t mask, std::uint64_t bits) { return available ? (mask | bits) : (mask & ~bits); });
+    }
+
+    // 切换选中的单元格：全部有空时全部改为没空，否则全部改为有空（整行、整列同理）
+    void toggleCells(const QModelIndexList& cells) {
+        bool allAvailable = !cells.isEmpty();
+        for (const QModelIndex& cell : cells) {
+            if (!(m_rows.at(cell.row()).mask & (std::uint64_t(1) << bitOf(cell.column())))) {
+                allAvailable = false;
+                break;
+            }
+        }
+        setCells(cells, !allAvailable);
+    }
+
+    void toggleRow(int row) { toggleCells(cellsIn(row, row, 0, slotCount() - 1)); }
+    void toggleColumn(int column) { toggleCells(cellsIn(0, m_rows.size() - 1, column, column)); }
+
+    // 从表格软件复制的内容（行以换行分隔，列以制表符分隔）粘贴到以 topLeft 为左上角的区域；超出矩阵的部分忽略。
+    // 单元格写法同空闲时间导入（0 / 1，空白为 0），也接受 √ / ×、是 / 否；返回无法识别的单元格数（这些单元格保持原值）
+    int paste(const QModelIndex& topLeft, const QString& text) {
+        if (!topLeft.isValid()) return 0;
+        QStringList lines = text.split('\n');
+        if (!lines.isEmpty() && lines.last().isEmpty()) lines.removeLast(); // 表格软件复制的内容以换行结尾
+        int invalid = 0;
+        QModelIndexList on;
+        QModelIndexList off;
+        for (int i = 0; i < lines.size() && topLeft.row() + i < m_rows.size(); ++i) {
+            QString line = lines.at(i);
+            if (line.endsWith('\r')) line.chop(1);
+            const QStringList values = line.split('\t');
+            for (int j = 0; j < values.size() && topLeft.column() + j < slotCount(); ++j) {
+                const QModelIndex cell = index(topLeft.row() + i, topLeft.column() + j);
+                const int state = parseCell(values.at(j), topLeft.column() + j);
+                if (state < 0) ++invalid;
+                else (state ? on : off).append(cell);
+            }
+        }
+        setCells(on, true);
+        setCells(off, false);
+        return invalid;
+    }
+
+    // 内容与打开时不同的队员数
+    int changedCount() const {
+        return static_cast<int>(std::count_if(m_rows.begin(), m_rows.end(), [](const Row& row) { return row.mask != row.original; }));
+    }
+
+    // 把修改写入名单，作为一个撤销步骤；返回修改的队员数
+    int apply(RosterUndoStack& undoStack) const {
+        int changed = 0;
+        undoStack.begin("批量编辑空闲时间");
+        for (const Row& row : m_rows) {
+            if (row.mask != row.original && undoStack.setTimeMask(row.group, row.position, row.mask)) ++changed;
+        }
+        undoStack.commit();
+        return changed;
+    }
+
+private:
+    struct Row {
+        int group;
+        int position;               // 组内位置
+        QString name;               // 表头显示的姓名与组别
+        std::uint64_t mask;         // 编辑中的时间掩码
+        std::uint64_t original;     // 打开时的时间掩码
+    };
+
+    QString slotTitle(int column) const {
+        return MemberFields::title(MemberFields::TimeSlot + bitOf(column));
+    }
+
+    // 1 为有空、0 为没空、-1 为无法识别
+    int parseCell(QString value, int column) const {
+        value = value.trimmed();
+        if (value == "√" || value == "✓" || value == "是") return 1;
+        if (value == "×" || value == "✗" || value == "否") return 0;
+        QString normalized;
+        QString error;
+        if (!MemberFields::validate(MemberFields::TimeSlot + bitOf(column), value, normalized, error)) return -1;
+        return normalized == "1" ? 1 : 0;
+    }
+
+    QModelIndexList cellsIn(int top, int bottom, int left, int right) const {
+        QModelIndexList cells;
+        for (int row = top; row <= bottom; ++row) {
+            for (int column = left; column <= right; ++column) cells.append(index(row, column));
+        }
+        return cells;
+    }
+
+    // 按行合并选中的单元格修改掩码；整次修改只通知一次，范围为实际变化的行列所围成的矩形
+    template <typename Edit>
+    void edit(const QModelIndexList& cells, Edit change) {
+        QVector<std::uint64_t> bits(m_rows.size(), 0);
+        int left = slotCount();
+        int right = -1;
+        for (const QModelIndex& cell : cells) {
+            if (!cell.isValid() || cell.row() >= m_rows.size()) continue;
+            bits[cell.row()] |= std::uint64_t(1) << bitOf(cell.column());
+            left = qMin(left, cell.column());
+            right = qMax(right, cell.column());
+        }
+        int top = m_rows.size();
+        int bottom = -1;
+        for (int row = 0; row < m_rows.size(); ++row) {
+            if (!bits[row]) continue;
+            const std::uint64_t mask = change(m_rows[row].mask, bits[row]);
+            if (mask == m_rows[row].mask) continue;
+            m_rows[row].mask = mask;
+            top = qMin(top, row);
+            bottom = row;
+        }
+        if (bottom >= 0) emit dataChanged(index(top, left), index(bottom, right));
+    }
+
+    int m_locationCount;    // 名单的地点数
+    QVector<Row> m_rows;
+    QFont m_changedFont;    // 已修改的单元格以粗体显示
+};
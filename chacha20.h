@@ -0,0 +1,83 @@
+// chacha20.h头文件
+// 功能说明：ChaCha20 流密码（RFC 8439）的本地实现，不依赖任何第三方库
+// 以32位字为单位运算，每次生成64字节密钥流并按8字节一组与数据异或；加密与解密是同一操作。
+
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+class ChaCha20
+{
+public:
+    static constexpr std::size_t KEY_SIZE = 32;
+    static constexpr std::size_t NONCE_SIZE = 12;
+    static constexpr std::size_t BLOCK_SIZE = 64;
+
+    // 用 key / nonce 生成的密钥流与 data 异或（原地），counter 为起始块计数
+    static void xorStream(const std::uint8_t key[KEY_SIZE], const std::uint8_t nonce[NONCE_SIZE],
+                          std::uint32_t counter, std::uint8_t* data, std::size_t length) {
+        std::uint32_t state[16];
+        state[0] = 0x61707865; state[1] = 0x3320646e; state[2] = 0x79622d32; state[3] = 0x6b206574;
+        for (int i = 0; i < 8; ++i) state[4 + i] = load32(key + i * 4);
+        state[12] = counter;
+        for (int i = 0; i < 3; ++i) state[13 + i] = load32(nonce + i * 4);
+
+        std::uint8_t stream[BLOCK_SIZE];
+        while (length > 0) {
+            block(state, stream);
+            ++state[12];
+            const std::size_t n = length < BLOCK_SIZE ? length : BLOCK_SIZE;
+            std::size_t i = 0;
+            // 整块按64位字异或，尾部逐字节处理
+            for (; i + 8 <= n; i += 8) {
+                std::uint64_t d, s;
+                std::memcpy(&d, data + i, 8);
+                std::memcpy(&s, stream + i, 8);
+                d ^= s;
+                std::memcpy(data + i, &d, 8);
+            }
+            for (; i < n; ++i) data[i] ^= stream[i];
+            data += n;
+            length -= n;
+        }
+    }
+
+private:
+    static std::uint32_t rotl(std::uint32_t v, int c) { return (v << c) | (v >> (32 - c)); }
+
+    static std::uint32_t load32(const std::uint8_t* p) {
+        return static_cast<std::uint32_t>(p[0]) | (static_cast<std::uint32_t>(p[1]) << 8)
+             | (static_cast<std::uint32_t>(p[2]) << 16) | (static_cast<std::uint32_t>(p[3]) << 24);
+    }
+
+    static void quarterRound(std::uint32_t& a, std::uint32_t& b, std::uint32_t& c, std::uint32_t& d) {
+        a += b; d ^= a; d = rotl(d, 16);
+        c += d; b ^= c; b = rotl(b, 12);
+        a += b; d ^= a; d = rotl(d, 8);
+        c += d; b ^= c; b = rotl(b, 7);
+    }
+
+    // 生成一个64字节的密钥流块（小端序输出）
+    static void block(const std::uint32_t input[16], std::uint8_t output[BLOCK_SIZE]) {
+        std::uint32_t x[16];
+        std::memcpy(x, input, sizeof(x));
+        for (int round = 0; round < 10; ++round) {
+            quarterRound(x[0], x[4], x[8], x[12]);
+            quarterRound(x[1], x[5], x[9], x[13]);
+            quarterRound(x[2], x[6], x[10], x[14]);
+            quarterRound(x[3], x[7], x[11], x[15]);
+            quarterRound(x[0], x[5], x[10], x[15]);
+            quarterRound(x[1], x[6], x[11], x[12]);
+            quarterRound(x[2], x[7], x[8], x[13]);
+            quarterRound(x[3], x[4], x[9], x[14]);
+        }
+        for (int i = 0; i < 16; ++i) {
+            const std::uint32_t v = x[i] + input[i];
+            output[i * 4] = static_cast<std::uint8_t>(v);
+            output[i * 4 + 1] = static_cast<std::uint8_t>(v >> 8);
+            output[i * 4 + 2] = static_cast<std::uint8_t>(v >> 16);
+            output[i * 4 + 3] = static_cast<std::uint8_t>(v >> 24);
+        }
+    }
+};
@@ -0,0 +1,284 @@
+// cipherChunkDevice.h头文件
+// 功能说明：分块加密的流式设备，供 QDataStream 直接读写加密文件
+// 写入时明文每累计 CHUNK_SIZE 字节即加密成一块写出，读取时每次只读入并校验一块，内存占用与文件大小无关。
+// 每块格式：[标志(1字节)][明文长度(4字节，小端)][密文][HMAC-SHA256 校验值(32字节)]
+//   - 密文：ChaCha20，nonce = 文件随机数(8字节) + 块序号(4字节，小端)
+//   - 校验值覆盖文件随机数、块序号、标志、长度与密文，任何一块被篡改或损坏都会在读到该块时立即发现
+//   - 最后一块带有结束标志，文件被截断时同样能够发现
+// 读取时可指定预读块数：设备提前读入后续若干块，交给全局线程池并行校验与解密，解析当前块的同时后续块已在处理。
+// 写出每块的头部、密文、校验值之前都经过 durableFile.h 的写入故障注入点，崩溃一致性检查可以在任意一块写到一半时中断写入。
+
+#pragma once
+#include <QIODevice>
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QtEndian>
+#include <QSemaphore>
+#include <QThreadPool>
+#include <QDebug>
+#include <deque>
+#include <memory>
+#include "chacha20.h"
+#include "durableFile.h"
+
+class CipherChunkDevice : public QIODevice
+{
+public:
+    static constexpr int CHUNK_SIZE = 64 * 1024;     // 每块明文长度上限
+    static constexpr int NONCE_PREFIX_SIZE = 8;      // 文件随机数长度
+    static constexpr int TAG_SIZE = 32;              // HMAC-SHA256 长度
+
+    // inner：已打开的底层设备（文件），读写位置应位于第一块的起始处
+    // encKey：32字节加密密钥；macKey：校验密钥；noncePrefix：8字节文件随机数
+    // lookahead：读取模式下并行预读的块数（0 表示在当前线程逐块处理）
+    CipherChunkDevice(QIODevice* inner, const QByteArray& encKey, const QByteArray& macKey, const QByteArray& noncePrefix,
+                      int lookahead = 0)
+        : inner(inner), encKey(encKey), macKey(macKey), noncePrefix(noncePrefix), lookahead(lookahead) {}
+
+    ~CipherChunkDevice() override {
+        if (isOpen()) close();
+        waitPending();
+    }
+
+    bool open(OpenMode mode) override {
+        // 只支持单向读或单向写
+        if ((mode & ReadWrite) == ReadWrite || encKey.size() != static_cast<int>(ChaCha20::KEY_SIZE)
+            || noncePrefix.size() != NONCE_PREFIX_SIZE) {
+            return false;
+        }
+        chunkIndex = 0;
+        nextFrameIndex = 0;
+        framesExhausted = false;
+        frameError.clear();
+        buffer.clear();
+        bufferPos = 0;
+        finished = false;
+        failed = false;
+        return QIODevice::open(mode | Unbuffered);
+    }
+
+    // 写入模式下关闭时写出最后一块（带结束标志）；之前的块写入失败时不再写出
+    void close() override {
+        if ((openMode() & WriteOnly) && !finished && !failed) {
+            flushChunk(true);
+        }
+        waitPending();
+        QIODevice::close();
+    }
+
+    bool isSequential() const override { return true; }
+
+    qint64 bytesAvailable() const override {
+        return (buffer.size() - bufferPos) + QIODevice::bytesAvailable();
+    }
+
+    // 读取时是否已校验到最后一块（用于确认文件完整读完）
+    bool reachedEnd() const { return finished; }
+    // 是否发生过写入失败或校验失败
+    bool hasFailed() const { return failed; }
+
+protected:
+    qint64 readData(char* data, qint64 maxSize) override {
+        qint64 total = 0;
+        while (total < maxSize) {
+            if (bufferPos >= buffer.size()) {
+                if (finished || failed || !fetchChunk()) break;
+                continue;
+            }
+            const qint64 n = qMin<qint64>(maxSize - total, buffer.size() - bufferPos);
+            memcpy(data + total, buffer.constData() + bufferPos, static_cast<size_t>(n));
+            bufferPos += static_cast<int>(n);
+            total += n;
+        }
+        if (failed && total == 0) return -1;
+        return total;
+    }
+
+    qint64 writeData(const char* data, qint64 size) override {
+        if (failed) return -1;
+        qint64 written = 0;
+        while (written < size) {
+            const qint64 n = qMin<qint64>(size - written, CHUNK_SIZE - buffer.size());
+            buffer.append(data + written, static_cast<int>(n));
+            written += n;
+            if (buffer.size() == CHUNK_SIZE && !flushChunk(false)) return -1;
+        }
+        return written;
+    }
+
+private:
+    // 一个已从文件读出、尚待（或正在）校验解密的块
+    struct PendingChunk {
+        quint32 index = 0;
+        quint8 flags = 0;
+        QByteArray data;   // 密文，校验通过后原地解密为明文
+        QByteArray tag;
+        bool ok = false;
+        QSemaphore ready;
+    };
+
+    static QByteArray nonceFor(const QByteArray& noncePrefix, quint32 index) {
+        QByteArray nonce = noncePrefix;
+        uchar counter[4];
+        qToLittleEndian<quint32>(index, counter);
+        nonce.append(reinterpret_cast<const char*>(counter), 4);
+        return nonce;
+    }
+
+    static QByteArray tagFor(const QByteArray& macKey, const QByteArray& noncePrefix,
+                             quint32 index, quint8 flags, const QByteArray& cipherText) {
+        QMessageAuthenticationCode mac(QCryptographicHash::Sha256, macKey);
+        uchar fields[9];
+        qToLittleEndian<quint32>(index, fields);
+        fields[4] = flags;
+        qToLittleEndian<quint32>(static_cast<quint32>(cipherText.size()), fields + 5);
+        mac.addData(noncePrefix);
+        mac.addData(reinterpret_cast<const char*>(fields), 9);
+        mac.addData(cipherText);
+        return mac.result();
+    }
+
+    static void applyCipher(const QByteArray& encKey, const QByteArray& noncePrefix, quint32 index, QByteArray& text) {
+        const QByteArray nonce = nonceFor(noncePrefix, index);
+        ChaCha20::xorStream(reinterpret_cast<const std::uint8_t*>(encKey.constData()),
+                            reinterpret_cast<const std::uint8_t*>(nonce.constData()), 1,
+                            reinterpret_cast<std::uint8_t*>(text.data()), static_cast<std::size_t>(text.size()));
+    }
+
+    // 比较校验值（逐字节累积差异，耗时与内容无关）
+    static bool sameTag(const QByteArray& a, const QByteArray& b) {
+        if (a.size() != b.size()) return false;
+        uchar diff = 0;
+        for (int i = 0; i < a.size(); ++i) diff |= static_cast<uchar>(a[i] ^ b[i]);
+        return diff == 0;
+    }
+
+    // 校验并原地解密一个块（可在任意线程执行）
+    static bool openChunk(const QByteArray& encKey, const QByteArray& macKey, const QByteArray& noncePrefix,
+                          PendingChunk& chunk) {
+        if (!sameTag(chunk.tag, tagFor(macKey, noncePrefix, chunk.index, chunk.flags, chunk.data))) return false;
+        applyCipher(encKey, noncePrefix, chunk.index, chunk.data);
+        return true;
+    }
+
+    // 从底层设备读出一个块的原始内容；失败时返回错误原因（含 %1 占位的块序号）
+    const char* readFrame(PendingChunk& chunk) {
+        const QByteArray head = inner->read(5);
+        if (head.size() != 5) {
+            return "第 %1 块不完整（文件可能被截断）";
+        }
+        chunk.flags = static_cast<quint8>(head[0]);
+        const quint32 length = qFromLittleEndian<quint32>(head.constData() + 1);
+        if (length > static_cast<quint32>(CHUNK_SIZE) || (chunk.flags & ~FLAG_LAST) != 0) {
+            return "第 %1 块头部损坏";
+        }
+        chunk.data = inner->read(length);
+        chunk.tag = inner->read(TAG_SIZE);
+        if (chunk.data.size() != static_cast<int>(length) || chunk.tag.size() != TAG_SIZE) {
+            return "第 %1 块不完整（文件可能被截断）";
+        }
+        return nullptr;
+    }
+
+    // 等待所有已提交到线程池的块处理完毕
+    void waitPending() {
+        for (const auto& chunk : pending) chunk->ready.acquire();
+        pending.clear();
+    }
+
+    // 向底层设备写出块的一部分（写入前经过故障注入点）
+    bool writePart(const QByteArray& part) {
+        if (DurableFile::interrupted(DurableFile::StepWrite)) return false;
+        return inner->write(part) == part.size();
+    }
+
+    bool flushChunk(bool last) {
+        const quint8 flags = last ? FLAG_LAST : 0;
+        QByteArray cipherText = buffer;
+        applyCipher(encKey, noncePrefix, chunkIndex, cipherText);
+        uchar head[5];
+        head[0] = flags;
+        qToLittleEndian<quint32>(static_cast<quint32>(cipherText.size()), head + 1);
+        const QByteArray tag = tagFor(macKey, noncePrefix, chunkIndex, flags, cipherText);
+        const bool ok = writePart(QByteArray::fromRawData(reinterpret_cast<const char*>(head), 5))
+                     && writePart(cipherText)
+                     && writePart(tag);
+        buffer.clear();
+        ++chunkIndex;
+        if (last) finished = true;
+        if (!ok) {
+            failed = true;
+            setErrorString(QString("写入第 %1 块失败").arg(chunkIndex - 1));
+        }
+        return ok;
+    }
+
+    bool fetchChunk() {
+        buffer.clear();
+        bufferPos = 0;
+        std::shared_ptr<PendingChunk> chunk;
+        if (lookahead <= 0) {
+            chunk = std::make_shared<PendingChunk>();
+            chunk->index = chunkIndex;
+            if (const char* error = readFrame(*chunk)) return fail(error);
+            chunk->ok = openChunk(encKey, macKey, noncePrefix, *chunk);
+        } else {
+            // 补足预读队列：读出后续块并提交到线程池校验解密
+            while (!framesExhausted && static_cast<int>(pending.size()) < lookahead) {
+                auto next = std::make_shared<PendingChunk>();
+                next->index = nextFrameIndex;
+                if (const char* error = readFrame(*next)) {
+                    frameError = error;
+                    framesExhausted = true;
+                    break;
+                }
+                ++nextFrameIndex;
+                if (next->flags & FLAG_LAST) framesExhausted = true;
+                const QByteArray enc = encKey, mac = macKey, prefix = noncePrefix;
+                QThreadPool::globalInstance()->start([next, enc, mac, prefix]() {
+                    next->ok = openChunk(enc, mac, prefix, *next);
+                    next->ready.release();
+                });
+                pending.push_back(next);
+            }
+            if (pending.empty()) {
+                return fail(frameError.isEmpty() ? "第 %1 块不完整（文件可能被截断）" : frameError.constData());
+            }
+            chunk = pending.front();
+            pending.pop_front();
+            chunk->ready.acquire();
+        }
+        if (!chunk->ok) {
+            return fail("第 %1 块校验失败（数据损坏或密钥错误）");
+        }
+        buffer = chunk->data;
+        ++chunkIndex;
+        if (chunk->flags & FLAG_LAST) finished = true;
+        return true;
+    }
+
+    bool fail(const char* message) {
+        failed = true;
+        setErrorString(QString::fromUtf8(message).arg(chunkIndex));
+        qDebug() << errorString();
+        return false;
+    }
+
+    static constexpr quint8 FLAG_LAST = 0x01;
+
+    QIODevice* inner;
+    QByteArray encKey;
+    QByteArray macKey;
+    QByteArray noncePrefix;
+    int lookahead;           // 并行预读的块数
+    std::deque<std::shared_ptr<PendingChunk>> pending; // 已提交到线程池、尚未被读取的块（按顺序）
+    quint32 nextFrameIndex = 0;
+    bool framesExhausted = false;
+    QByteArray frameError;   // 预读时遇到的文件错误，轮到该块时再报告
+    QByteArray buffer;       // 当前块的明文
+    int bufferPos = 0;       // 读取模式下当前块已读出的位置
+    quint32 chunkIndex = 0;
+    bool finished = false;
+    bool failed = false;
+};
@@ -0,0 +1,222 @@
+// crashConsistencyHarness.h头文件
+// 功能说明：数据文件写入流程的崩溃一致性检查（开发自检用）
+// 借助 durableFile.h 的故障注入点，依次让写入在第 1、2、3…… 个 I/O 步骤处中断（模拟写入进程被终止），
+// 每次中断后重新读取目标文件，确认它只可能是完整的旧内容或完整的新内容；并确认中断残留的临时文件不妨碍下一次保存。
+// 队员数据文件的新内容跨越多个加密块，注入点覆盖每一块的头部、密文与校验值（见 cipherChunkDevice.h），可以检查写到一半的块。
+// 写入方在失败时会删除临时文件，而真实的进程终止不会，因此每次中断后写入一个不完整的临时文件模拟残留。
+// 在本地文件系统的临时目录中进行，覆盖队员数据文件（data.dat）与排表历史文件（schedule_history.dat）两条写入路径。
+// 另外检查更新日志（data.dat.log）回放后队员在组内的顺序：改名与撤销删除的队员应回到原位置，而不是组末尾。
+// 以 --check-crash-consistency 参数启动程序即可运行（见 main.cpp），结果以对话框显示，每一步同时输出到调试信息。
+
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QFile>
+#include <QDebug>
+#include <functional>
+#include "durableFile.h"
+#include "encryptedFileManager.h"
+#include "scheduleHistory.h"
+
+class CrashConsistencyHarness
+{
+public:
+    // 中断后目标文件的状态
+    enum Outcome { OldState, NewState, Corrupt };
+
+    struct Scenario {
+        QString name;                     // 场景名称（用于报告）
+        QString target;                   // 目标文件路径
+        std::function<void()> reset;      // 清理目标文件与临时文件
+        std::function<bool()> writeOld;   // 写入旧内容（不注入故障）
+        std::function<bool()> writeNew;   // 被检查的写入
+        std::function<Outcome()> inspect; // 读取目标文件，判断当前状态
+    };
+
+    // 依次在每个步骤处中断被检查的写入，直到写入完整执行一次；全部通过返回 true，report 中记录每一步的结果
+    static bool run(const Scenario& scenario, QStringList* report) {
+        bool passed = true;
+        for (int crashAt = 0; ; ++crashAt) {
+            scenario.reset();
+            if (!scenario.writeOld()) {
+                note(report, scenario.name + "：无法写入旧内容");
+                return false;
+            }
+
+            int step = 0;
+            DurableFile::Step crashedStep = DurableFile::StepOpen;
+            bool crashed = false;
+            DurableFile::setFaultInjector([&](DurableFile::Step current) {
+                if (crashed || step++ != crashAt) return false;
+                crashed = true;
+                crashedStep = current;
+                return true;
+            });
+            const bool written = scenario.writeNew();
+            DurableFile::setFaultInjector(nullptr);
+
+            const Outcome outcome = scenario.inspect();
+            if (!crashed) {
+                // 所有步骤都已检查过：最后一次完整写入必须成功并得到新内容
+                if (!written || outcome != NewState) {
+                    note(report, scenario.name + "：未中断的写入没有得到新内容");
+                    passed = false;
+                }
+                note(report, QString("%1：共检查 %2 个步骤").arg(scenario.name).arg(crashAt));
+                return passed;
+            }
+
+            const QString where = QString("%1：在第 %2 步（%3）中断").arg(scenario.name).arg(crashAt + 1).arg(stepName(crashedStep));
+            if (outcome == Corrupt) {
+                note(report, where + "后文件损坏");
+                passed = false;
+                continue;
+            }
+            // 中断残留的临时文件不能妨碍下一次保存
+            plantStaleTemp(scenario.target);
+            if (!scenario.writeNew() || scenario.inspect() != NewState) {
+                note(report, where + "后无法再次保存");
+                passed = false;
+                continue;
+            }
+            note(report, where + (outcome == OldState ? "，保持旧内容" : "，已是新内容"));
+        }
+    }
+
+    // 在临时目录中检查队员数据文件与排表历史文件的写入流程
+    static bool runAll(QStringList* report) {
+        QTemporaryDir dir;
+        if (!dir.isValid()) {
+            note(report, "无法创建临时目录");
+            return false;
+        }
+        const bool rosterOk = run(rosterScenario(dir.filePath("data.dat")), report);
+        const bool historyOk = run(historyScenario(dir.filePath("schedule_history.dat")), report);
+        const bool replayOk = checkUpdateLogReplay(dir.filePath("replay.dat"), report);
+        return rosterOk && historyOk && replayOk;
+    }
+
+    // 队员数据文件：旧内容 1 名队员，新内容 ROSTER_NEW_MEMBERS 名队员（跨越多个加密块）
+    static Scenario rosterScenario(const QString& path) {
+        Scenario scenario;
+        scenario.name = "队员数据文件";
+        scenario.target = path;
+        scenario.reset = [path]() { removeWithTemp(path); };
+        scenario.writeOld = [path]() { return EncryptedFileManager::saveToFile(sampleGroup(1), path); };
+        const Flag_group newGroup = sampleGroup(ROSTER_NEW_MEMBERS);
+        scenario.writeNew = [path, newGroup]() { return EncryptedFileManager::saveToFile(newGroup, path); };
+        scenario.inspect = [path]() {
+            Flag_group loaded;
+            if (!EncryptedFileManager::loadFromFile(loaded, path)) return Corrupt;
+            const int count = static_cast<int>(loaded.getGroupMembers(1).size());
+            return count == 1 ? OldState : (count == ROSTER_NEW_MEMBERS ? NewState : Corrupt);
+        };
+        return scenario;
+    }
+
+    // 排表历史文件：旧内容 1 条记录，新内容 2 条记录
+    static Scenario historyScenario(const QString& path) {
+        Scenario scenario;
+        scenario.name = "排表历史文件";
+        scenario.target = path;
+        scenario.reset = [path]() { removeWithTemp(path); };
+        scenario.writeOld = [path]() { return saveSampleHistory(path, 1); };
+        scenario.writeNew = [path]() { return saveSampleHistory(path, 2); };
+        scenario.inspect = [path]() {
+            ScheduleHistoryManager loaded;
+            if (!loaded.loadFromFile(path)) return Corrupt;
+            const int count = loaded.getHistoryCount();
+            return count == 1 ? OldState : (count == 2 ? NewState : Corrupt);
+        };
+        return scenario;
+    }
+
+    // 更新日志回放：完整保存后依次改名、删除、撤销删除，每一步增量保存，重新读取的队员顺序应与名单一致
+    static bool checkUpdateLogReplay(const QString& path, QStringList* report) {
+        removeWithTemp(path);
+        QFile::remove(path + ".log");
+        Flag_group group = sampleGroup(REPLAY_MEMBERS);
+        if (!EncryptedFileManager::saveToFile(group, path)) {
+            note(report, "更新日志回放：无法写入基础文件");
+            return false;
+        }
+        group.markSaved();
+
+        bool passed = true;
+        auto step = [&](const QString& name) {
+            Flag_group loaded;
+            const bool saved = EncryptedFileManager::saveIncremental(group, path)
+                               && QFile::exists(path + ".log")
+                               && EncryptedFileManager::loadFromFile(loaded, path);
+            bool same = saved && loaded.getGroupMembers(1).size() == group.getGroupMembers(1).size();
+            for (size_t k = 0; same && k < group.getGroupMembers(1).size(); ++k) {
+                same = loaded.getGroupMembers(1)[k].getName() == group.getGroupMembers(1)[k].getName();
+            }
+            note(report, "更新日志回放：" + name + (same ? "后顺序一致" : "后顺序不一致"));
+            passed = passed && same;
+        };
+        group.renamePersonAt(1, 2, "改名队员");
+        step("改名");
+        const Person removed = group.takePersonAt(1, 4);
+        step("删除");
+        group.insertPersonAt(1, 4, removed);
+        step("撤销删除");
+        return passed;
+    }
+
+private:
+    static constexpr int REPLAY_MEMBERS = 10;       // 每步修改 1~2 名队员，不超过半数，保持增量保存
+    static constexpr int ROSTER_NEW_MEMBERS = 2000; // 序列化后约 3~4 个加密块
+
+    static void note(QStringList* report, const QString& line) {
+        qDebug() << line;
+        if (report) report->append(line);
+    }
+
+    static const char* stepName(DurableFile::Step step) {
+        switch (step) {
+        case DurableFile::StepOpen: return "打开临时文件";
+        case DurableFile::StepWrite: return "写入";
+        case DurableFile::StepSyncFile: return "文件落盘";
+        case DurableFile::StepRename: return "重命名";
+        case DurableFile::StepSyncDirectory: return "目录落盘";
+        }
+        return "未知步骤";
+    }
+
+    // 模拟进程被终止后残留的不完整临时文件
+    static void plantStaleTemp(const QString& path) {
+        QFile stale(DurableFile::tempPathFor(path));
+        if (stale.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            stale.write("FLAG_GROUP partial write");
+            stale.close();
+        }
+    }
+
+    static void removeWithTemp(const QString& path) {
+        QFile::remove(path);
+        QFile::remove(DurableFile::tempPathFor(path));
+    }
+
+    static Flag_group sampleGroup(int members) {
+        Flag_group group;
+        bool time[4][5] = {};
+        for (int k = 0; k < members; ++k) {
+            group.getGroupMembers(1).push_back(Person("队员" + std::to_string(k + 1), true, 1, 1, "", "", "", "", "", "", "",
+                                                      true, time, 0, 0));
+        }
+        return group;
+    }
+
+    static bool saveSampleHistory(const QString& path, int entries) {
+        ScheduleHistoryManager history;
+        history.setHistoryFilePath(path);
+        const Flag_group group = sampleGroup(1);
+        const SchedulingManager manager(group);
+        for (int k = 0; k < entries; ++k) {
+            history.addHistory(group, manager, "总次数", QString());
+        }
+        return history.saveToFile();
+    }
+};
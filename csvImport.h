@@ -0,0 +1,291 @@
+// csvImport.h头文件
+// 功能说明：导入空闲时间（及队员档案）的 CSV 读取与导入引擎
+// CsvReader：按 RFC 4180 逐条读取 CSV 记录——支持双引号包围的字段（字段内可含逗号、换行，"" 表示一个双引号）、
+//   UTF-8 BOM 与 CRLF / LF 换行；每次从文件读取固定大小的缓冲区，不整体读入文件。
+// AvailabilityImport：导入引擎，CSV 与 .xlsx（见 xlsxReader.h）共用。
+//   - 第一条记录为表头；第1列姓名，第2列组别，第3~22列为20个时间点（空、0 或 1，1 表示可用），与原有导入格式一致。
+//   - 第23列起可附加队员档案列，按表头名称识别（见 memberFields.h），用于批量更新或新增队员；未识别的列忽略。
+//     南鉴湖、东西院以外地点的时间点也按表头名称附加（如“周一升旗地点3”），名单中没有该地点时忽略；
+//     固定的20列只覆盖前两个地点的时间，其他地点的时间不变。
+//   - 开始导入时为名单建立一次「组别+姓名 → 队员」哈希索引；每行先完整校验，全部读完后再一次性写入名单（整个导入为一个撤销步骤），
+//     有错误的行不写入，逐行记录失败原因。
+//   - 文件只有空闲时间列时，找不到的队员记为失败；带有档案列时，找不到的队员作为新队员加入对应组。
+
+#pragma once
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+#include "Flag_group.h"
+#include "memberFields.h"
+#include "rosterUndoStack.h"
+
+class CsvReader
+{
+public:
+    static constexpr int BUFFER_SIZE = 64 * 1024;
+
+    explicit CsvReader(QIODevice* device) : m_device(device) {}
+
+    // 读取下一条记录；到达文件末尾或格式错误时返回 false（用 hasError 区分）
+    bool readRecord(QStringList& fields) {
+        fields.clear();
+        if (m_error) return false;
+        skipBom();
+        if (peek() < 0) return false;
+        m_recordLine = m_line;
+        QByteArray field;
+        bool quoted = false;      // 当前位于引号内
+        for (;;) {
+            const int c = next();
+            if (c < 0) {
+                if (quoted) {
+                    m_error = true;
+                    return false; // 引号未闭合
+                }
+                fields.append(QString::fromUtf8(field));
+                return true;
+            }
+            if (quoted) {
+                if (c == '"') {
+                    if (peek() == '"') {
+                        next();
+                        field.append('"');
+                    } else {
+                        quoted = false;
+                    }
+                } else {
+                    if (c == '\n') ++m_line;
+                    field.append(static_cast<char>(c));
+                }
+            } else if (c == ',') {
+                fields.append(QString::fromUtf8(field));
+                field.clear();
+            } else if (c == '\r' || c == '\n') {
+                if (c == '\r' && peek() == '\n') next();
+                ++m_line;
+                fields.append(QString::fromUtf8(field));
+                return true;
+            } else if (c == '"' && field.isEmpty()) {
+                quoted = true;
+            } else {
+                field.append(static_cast<char>(c)); // 字段中间出现的引号按普通字符处理
+            }
+        }
+    }
+
+    bool hasError() const { return m_error; }
+    int recordLine() const { return m_recordLine; } // 最近读取的记录在文件中的起始行号（从1开始）
+
+private:
+    int peek() {
+        if (m_pos >= m_buffer.size() && !fill()) return -1;
+        return static_cast<uchar>(m_buffer.at(m_pos));
+    }
+
+    int next() {
+        const int c = peek();
+        if (c >= 0) ++m_pos;
+        return c;
+    }
+
+    bool fill() {
+        if (m_atEnd || !m_device) return false;
+        m_buffer = m_device->read(BUFFER_SIZE);
+        m_pos = 0;
+        if (m_buffer.isEmpty()) {
+            m_atEnd = true;
+            return false;
+        }
+        return true;
+    }
+
+    void skipBom() {
+        if (m_bomChecked) return;
+        m_bomChecked = true;
+        if (peek() == 0xEF && m_buffer.startsWith("\xEF\xBB\xBF")) m_pos += 3;
+    }
+
+    QIODevice* m_device;
+    QByteArray m_buffer;
+    int m_pos = 0;
+    bool m_atEnd = false;
+    bool m_bomChecked = false;
+    bool m_error = false;
+    int m_line = 1;
+    int m_recordLine = 0;
+};
+
+class AvailabilityImport
+{
+public:
+    static constexpr int TIME_COLUMNS = 20;
+    static constexpr int FIXED_COLUMNS = 2 + TIME_COLUMNS; // 姓名、组别与20个时间点
+
+    struct RowError {
+        int line;         // 行号（从1开始）
+        QString message;
+    };
+
+    struct Report {
+        int updated = 0;  // 更新的队员数
+        int added = 0;    // 新增的队员数
+        QVector<RowError> errors;
+        QStringList ignoredColumns; // 因权限不足而忽略的列（执勤次数只允许管理员导入）
+    };
+
+    // allowCounts：是否导入执勤次数列（与界面一致，只有管理员可以修改次数）
+    explicit AvailabilityImport(bool allowCounts = false) : m_allowCounts(allowCounts) {}
+
+    // 设置表头（第一条记录）
+    void setHeader(const QStringList& header, Report& report) {
+        m_profileColumns.clear();
+        for (int k = FIXED_COLUMNS; k < header.size(); ++k) {
+            const int field = MemberFields::fromName(header.at(k));
+            if (field == MemberFields::None || field == MemberFields::Name || field == MemberFields::Group
+                || (MemberFields::isTimeSlot(field) && field < MemberFields::TimeSlot + TIME_COLUMNS)) {
+                continue;
+            }
+            if (MemberFields::isCount(field) && !m_allowCounts) {
+                report.ignoredColumns.append(header.at(k).trimmed());
+                continue;
+            }
+            m_profileColumns.append(qMakePair(k, field));
+        }
+    }
+
+    // 校验一行数据；通过校验的行暂存，apply 时统一写入
+    void addRow(int line, const QStringList& values, Report& report) {
+        bool blank = true;
+        for (const QString& value : values) {
+            if (!value.trimmed().isEmpty()) {
+                blank = false;
+                break;
+            }
+        }
+        if (blank) return; // 空行
+        if (values.size() < FIXED_COLUMNS) {
+            report.errors.append({line, QString("列数不足：需要姓名、组别与%1个时间点").arg(TIME_COLUMNS)});
+            return;
+        }
+        Row row;
+        row.line = line;
+        QString normalized, error;
+        if (!MemberFields::validate(MemberFields::Name, values.at(0), row.name, error)
+            || !MemberFields::validate(MemberFields::Group, values.at(1), normalized, error)) {
+            report.errors.append({line, error});
+            return;
+        }
+        row.group = normalized.toInt();
+        // 第3~22列依次对应 time[0][0]、time[0][1]……time[3][4]，即时间掩码的第 0~19 位
+        for (int k = 0; k < TIME_COLUMNS; ++k) {
+            if (!MemberFields::validate(MemberFields::TimeSlot + k, values.at(2 + k), normalized, error)) {
+                report.errors.append({line, QString("第%1列：").arg(3 + k) + error});
+                return;
+            }
+            if (normalized == "1") row.timeMask |= std::uint64_t(1) << k;
+        }
+        for (const auto& column : m_profileColumns) {
+            const QString cell = values.value(column.first);
+            if (cell.trimmed().isEmpty()) continue; // 空单元格保持原值
+            if (!MemberFields::validate(column.second, cell, normalized, error)) {
+                report.errors.append({line, error});
+                return;
+            }
+            row.profile.append(qMakePair(column.second, normalized));
+        }
+        m_rows.append(row);
+    }
+
+    // 把暂存的行作为一个撤销步骤写入名单（见 rosterUndoStack.h）：先建立哈希索引，再逐行更新或新增；
+    // 同一队员出现多次时以最后一行为准
+    void apply(RosterUndoStack& undoStack, Report& report) {
+        Flag_group& flagGroup = undoStack.roster();
+        QHash<QPair<int, QString>, int> index; // (组别, 姓名) -> 组内下标
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            const auto& members = flagGroup.getGroupMembers(i);
+            for (int k = 0; k < static_cast<int>(members.size()); ++k) {
+                index.insert(qMakePair(i, QString::fromStdString(members[k].getName())), k);
+            }
+        }
+        undoStack.begin("导入空闲时间");
+        for (const Row& row : m_rows) {
+            const QPair<int, QString> key(row.group, row.name);
+            const auto it = index.constFind(key);
+            if (!flagGroup.isValidGroup(row.group)) {
+                report.errors.append({row.line, QString("名单中没有第%1组").arg(row.group)});
+            } else if (it != index.constEnd()) {
+                applyRow(row, undoStack, row.group, it.value());
+                report.updated++;
+            } else if (!m_profileColumns.isEmpty()) {
+                // 新队员：是否值周默认与同组其他队员一致
+                const auto& members = flagGroup.getGroupMembers(row.group);
+                bool time[4][5] = {};
+                const bool isWork = members.empty() ? true : members.front().getIsWork();
+                Person person(row.name.toStdString(), false, row.group, 1, "", "", "", "", "", "", "", isWork, time, 0, 0);
+                const int added = undoStack.append(row.group, person);
+                applyRow(row, undoStack, row.group, added);
+                index.insert(key, added);
+                report.added++;
+            } else {
+                report.errors.append({row.line, QString("第%1组中没有名为\"%2\"的队员").arg(row.group).arg(row.name)});
+            }
+        }
+        undoStack.commit();
+        m_rows.clear();
+    }
+
+    // 读取 CSV 文件并导入；文件无法打开或格式错误时返回 false，此时名单不变
+    static bool importCsv(const QString& path, RosterUndoStack& undoStack, Report& report, bool allowCounts = false) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "无法打开文件：" << path;
+            return false;
+        }
+        CsvReader reader(&file);
+        AvailabilityImport import(allowCounts);
+        QStringList record;
+        if (reader.readRecord(record)) import.setHeader(record, report);
+        while (reader.readRecord(record)) {
+            import.addRow(reader.recordLine(), record, report);
+        }
+        if (reader.hasError()) {
+            qDebug() << "CSV 文件格式错误（引号未闭合），起始行：" << reader.recordLine();
+            return false;
+        }
+        import.apply(undoStack, report);
+        return true;
+    }
+
+private:
+    struct Row {
+        int line = 0;
+        QString name;
+        int group = 0;
+        std::uint64_t timeMask = 0;     // 前两个地点的时间（低20位）
+        QVector<QPair<int, QString>> profile; // (字段, 规范文本)，见 memberFields.h
+    };
+
+    // 写入一行；只有实际变化的字段会被记录与标记修改，未变化的队员不会被增量保存重复写出
+    static void applyRow(const Row& row, RosterUndoStack& undoStack, int group, int index) {
+        Flag_group& flagGroup = undoStack.roster();
+        const std::uint64_t others = flagGroup.getGroupMembers(group)[index].getTimeMask()
+            & ~Person::locationsMask(Person::DEFAULT_LOCATION_COUNT);
+        undoStack.setTimeMask(group, index, others | row.timeMask);
+        const int fieldCount = MemberFields::fieldCount(flagGroup.locationCount());
+        for (const auto& value : row.profile) {
+            if (value.first >= fieldCount) continue; // 名单中没有该地点
+
+            undoStack.setField(group, index, value.first, value.second);
+        }
+    }
+
+    bool m_allowCounts;
+    QVector<QPair<int, int>> m_profileColumns; // (列下标, 字段)
+    QVector<Row> m_rows;
+};
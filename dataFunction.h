@@ -12,6 +12,11 @@
 //      |南鉴湖降旗 ||slot:1   location:0 ||slot:3   location:0 ||slot:5   location:0 ||slot:7   location:0 ||slot:9   location:0 ||
 // 降旗  --------------------------------------------------------------------------------------------------------------------------
 //      |东西院降旗 ||slot:1   location:1 ||slot:3   location:1 ||slot:5   location:1 ||slot:7   location:1 ||slot:9   location:1 ||
+// 地点数取自名单（Flag_group::locationCount），多于两个地点时升旗、降旗各增加相应的行，location 依次为 2、3……
+// 排班表在内部连续存放（见 seatIndex）：同一时间段的全部岗位相邻，查找某人是否已在该时间段执勤只需扫描一段连续区间；
+// 界面、排班历史与恢复排班都通过 getSeat / setSeat 逐个岗位读写这一连续数组，不再生成 [slot][location][position] 的嵌套副本。
+// 参加排班的队员与候选人按名单索引中的序号保存（见 rosterIndex.h），筛选候选人时通过 RosterIndex::visit 读取队员信息，
+// 尚未从名单文件展开的组不会因此展开；只有被安排到岗位上（需要修改执勤次数）的队员才取得 Person。
 
 #pragma once
 
@@ -24,6 +29,7 @@
 #include <string>
 #include "Person.h"
 #include "Flag_group.h"
+#include "rosterIndex.h"
 
 
 // SchedulingManager 类定义，执勤工作表
@@ -36,6 +42,9 @@ signals:
     void schedulingFinished(); // 排表完成后的提示信号
 
 public:
+    static constexpr int TOTAL_SLOTS = 10;          // 一周10个工作时间段,升旗时间对应0 2 4 6 8
+    static constexpr int PEOPLE_PER_LOCATION = 3;   // 一个工作地点的三名执勤队员
+
     // 新增的排表模式枚举
     enum class ScheduleMode {
         Normal,           // 常规模式
@@ -47,6 +56,9 @@ public:
     // 构造函数
     SchedulingManager(const Flag_group& flagGroup)
         : flagGroup(flagGroup),
+        rosterIndex(flagGroup),
+        locationCount(flagGroup.locationCount()),
+        seatsPerSlot(locationCount * PEOPLE_PER_LOCATION),
         mode(ScheduleMode::Normal)  // 初始化模式为常规模式
     {
         initializeAvailableMembers();// 通过队员的isWork的信息统计参加排班的人
@@ -55,12 +67,9 @@ public:
 
     // 部署工作表基础准备资源，排班操作的入口
     void schedule() {
-        const int totalSlots = 10;// 一周10个工作时间段,升旗时间对应0 2 4 6 8
-        const int locationsPerSlot = 2;// 两个工作地点（0:南鉴湖、1:东西院）
-        const int peoplePerLocation = 3;// 一个工作地点的三名执勤队员
-        for (auto& member : availableMembers) {
-            // 重置每个参加排班的队员本周的工作次数：0
-            member->setTimes(0);
+        for (int ordinal : availableMembers) {
+            // 重置每个参加排班的队员本周的工作次数：0（已经为0的队员不必取得 Person）
+            if (timesOf(ordinal) != 0) member(ordinal)->setTimes(0);
         }
 
         // 随机数生成装置，生成高质量随机数种子，理论上不可能重复
@@ -72,7 +81,7 @@ public:
         std::mt19937 g(rd());
         // 调用 std::shuffle 函数，将 availableMembers 向量中的元素顺序随机打乱。
         // std::shuffle 函数接受三个参数：容器的起始迭代器、容器的结束迭代器以及随机数引擎。
-        // 借助 std::shuffle 函数，能够将 availableMembers 向量中的队员指针顺序随机打乱。
+        // 借助 std::shuffle 函数，能够将 availableMembers 向量中的队员序号顺序随机打乱。
         // 在分配剩余工作量时，每个队员都有相同的概率获得额外的工作机会，避免了因队员在列表中的初始顺序而导致的不公平现象。
         // 若不使用 std::shuffle 对 availableMembers 进行随机打乱，那么每次剩余工作量都会优先分配给列表前面的队员。
         // 长期下来，这会造成队员之间的工作量不均衡，前面的队员工作次数会明显多于后面的队员。
@@ -80,34 +89,31 @@ public:
 
 
         // 排班！
-        // 对 scheduleTable 进行初始化，它是一个三维向量，用于存储排班结果。
-        // totalSlots：表示一周内的总工作时间段数量。在当前的排班规则下，一周工作 5 天，每天分上午和下午两个时间段，所以 totalSlots 为 10。
-        // locationsPerSlot：每个工作时间段内的工作地点数量，这里是 2 个（“NJH” 和 “DXY”）。
-        // peoplePerLocation：每个工作地点需要的工作人员数量，这里是 3 人。
+        // 对 scheduleTable 进行初始化，它是一段连续的岗位数组，用于存储排班结果。
+        // TOTAL_SLOTS：表示一周内的总工作时间段数量。在当前的排班规则下，一周工作 5 天，每天分上午和下午两个时间段，所以为 10。
+        // locationCount：每个工作时间段内的工作地点数量，取自名单，默认 2 个（“NJH” 和 “DXY”）。
+        // PEOPLE_PER_LOCATION：每个工作地点需要的工作人员数量，这里是 3 人。
         // nullptr：初始时，每个排班位置都设置为 nullptr，表示尚未安排人员。
-        scheduleTable.resize(totalSlots, std::vector<std::vector<Person*>>(locationsPerSlot, std::vector<Person*>(peoplePerLocation, nullptr)));
+        scheduleTable.assign(TOTAL_SLOTS * seatsPerSlot, nullptr);
         emittedWarningsThisRun.clear(); // 每次排表开始时清空去重集合
-        for (int slot = 0; slot < totalSlots; ++slot) {
+        for (int slot = 0; slot < TOTAL_SLOTS; ++slot) {
             //外层循环遍历工作时间段
             int day = slot / 2 + 1;//值为1~5。表示星期
             int halfDay = slot % 2;//值为0~1。0:上午，1：下午
-            for (int location = 0; location < locationsPerSlot; ++location) {
+            for (int location = 0; location < locationCount; ++location) {
                 // 中层循环遍历工作地点
-                int timeRow = halfDay * 2 + location + 1;//location=0~1,timeRow=1~4，分别表示NJH升旗，DXY升旗，NJH降旗，DXY降旗
-                for (int position = 0; position < peoplePerLocation; ++position) {
+                int timeRow = Person::timeRow(halfDay, location);//location=0~1时timeRow=1~4，分别表示NJH升旗，DXY升旗，NJH降旗，DXY降旗
+                for (int position = 0; position < PEOPLE_PER_LOCATION; ++position) {
                     //内层循环遍历工作岗位
-                    Person* selectedPerson = selectPerson(slot, timeRow, location, day);//选择合适队员
-                    if (selectedPerson) {
+                    const int selected = selectPerson(slot, timeRow, location, day);//选择合适队员
+                    if (selected >= 0) {
+                        Person* selectedPerson = member(selected);
                         // 如果找到合适队员，加入工作表格scheduleTable中
-                        scheduleTable[slot][location][position] = selectedPerson;
+                        scheduleTable[seatIndex(slot, location, position)] = selectedPerson;
                         selectedPerson->setTimes(selectedPerson->getTimes() + 1);
                         selectedPerson->setAll_times(selectedPerson->getAll_times() + 1);
                         // 按地点累计长期执勤次数
-                        if (location == 0) {
-                            selectedPerson->setNJHAllTimes(selectedPerson->getNJHAllTimes() + 1);
-                        } else if (location == 1) {
-                            selectedPerson->setDXYAllTimes(selectedPerson->getDXYAllTimes() + 1);
-                        }
+                        selectedPerson->setLocationAllTimes(location, selectedPerson->getLocationAllTimes(location) + 1);
                     }
                 }
             }
@@ -120,10 +126,30 @@ public:
     // 成员变量的get与set函数声明
     bool getUseTotalTimesRule() const;
     const Flag_group &getFlagGroup() const;
-    std::vector<std::vector<std::vector<Person *> > > getScheduleTable() const;
-    void setScheduleTable(const std::vector<std::vector<std::vector<Person *> > > &newScheduleTable);
+    // 排班表的地点数（构造时取自名单）
+    int getLocationCount() const { return locationCount; }
+    // 是否已有排班表（已排表或已从历史记录恢复）
+    bool hasSchedule() const { return !scheduleTable.empty(); }
+    // 某时间段某地点第 position 个岗位上的队员；尚未排表或岗位为空时返回 nullptr（直接读取岗位数组，不复制排班表）
+    const Person* getSeat(int slot, int location, int position) const {
+        if (scheduleTable.empty() || !isValidSeat(slot, location, position)) return nullptr;
+        return scheduleTable[seatIndex(slot, location, position)];
+    }
+    // 设置某个岗位上的队员（从历史记录恢复排班表时使用）；尚未排表时先建立全部为空的排班表，超出名单地点数的岗位忽略
+    void setSeat(int slot, int location, int position, Person* person) {
+        if (!isValidSeat(slot, location, position)) return;
+        if (scheduleTable.empty()) scheduleTable.assign(TOTAL_SLOTS * seatsPerSlot, nullptr);
+        scheduleTable[seatIndex(slot, location, position)] = person;
+    }
     std::vector<Person *> getAvailableMembers() const;
     void setAvailableMembers(const std::vector<Person *> &newAvailableMembers);
+    // 参加排班的队员数
+    int availableMemberCount() const { return static_cast<int>(availableMembers.size()); }
+    // 依次读取参加排班的队员而不展开其所在的组（传入 Person 或名单文件中的记录，见 MappedRoster::visitMember）
+    template <typename Visitor>
+    void forEachAvailableMember(Visitor&& visit) const {
+        for (int ordinal : availableMembers) rosterIndex.visit(ordinal, visit);
+    }
     // 设置排表模式
     void setScheduleMode(ScheduleMode newMode) {
         mode = newMode;
@@ -132,62 +158,97 @@ public:
 
 private:
     const Flag_group& flagGroup; // 国旗班容器，保存队员信息
+    RosterIndex rosterIndex; // 名单位图索引（是否值周、各时间点是否有空），排班期间名单结构不变
     std::unordered_map<std::string, int> warningCount; // 键值对容器，用于记录交接规则失败警告信息出现的次数
-    std::vector<Person*> availableMembers; // 容器，保存参加排班的队员
-    std::vector<std::vector<std::vector<Person*>>> scheduleTable; // 工作表格
+    std::vector<int> availableMembers; // 容器，保存参加排班的队员（名单索引中的序号）
+    std::vector<Person*> scheduleTable; // 工作表格：TOTAL_SLOTS * seatsPerSlot 个岗位，下标见 seatIndex
+    int locationCount;               // 每个时间段的地点数
+    int seatsPerSlot;                // 每个时间段的岗位数：locationCount * PEOPLE_PER_LOCATION
     bool useTotalTimesRule;
     ScheduleMode mode;
     int checkedPositions = 0;        // 记录所有周二上午南鉴湖岗位的筛选结果已检查的岗位数
     QSet<QString> emittedWarningsThisRun; // 本轮排表已发出的警告（用于去重）
 
+    // 岗位在 scheduleTable 中的下标
+    int seatIndex(int slot, int location, int position) const {
+        return slot * seatsPerSlot + location * PEOPLE_PER_LOCATION + position;
+    }
+    bool isValidSeat(int slot, int location, int position) const {
+        return slot >= 0 && slot < TOTAL_SLOTS && location >= 0 && location < locationCount
+            && position >= 0 && position < PEOPLE_PER_LOCATION;
+    }
+    // 某时间段某地点的第一个岗位；该地点的岗位为其后连续的 PEOPLE_PER_LOCATION 个元素
+    Person* const* locationSeats(int slot, int location) const {
+        return scheduleTable.data() + seatIndex(slot, location, 0);
+    }
+
     void initializeAvailableMembers() {
         // 初始化辅助函数
-        // 通过队员的isWork的信息统计参加排班的人
-        for (int group = 1; group <= 4; ++group) {
-            const auto& members = flagGroup.getGroupMembers(group);
-            for (const auto& member : members) {
-                if (member.getIsWork()) {
-                    availableMembers.push_back(const_cast<Person*>(&member));
-                }
-            }
-        }
+        // 通过队员的isWork的信息统计参加排班的人（由是否值周位图直接得到）
+        rosterIndex.working().forEach([this](int ordinal) {
+            availableMembers.push_back(ordinal);
+        });
+    }
+
+    // 序号对应的队员：需要修改其执勤次数时使用，会展开其所在的组
+    Person* member(int ordinal) const { return const_cast<Person*>(rosterIndex.person(ordinal)); }
+    // 已在岗位上的队员一定已经展开（见 member）；所在组尚未展开的队员不在任何岗位上，返回 nullptr
+    const Person* seatedMember(int ordinal) const {
+        return flagGroup.isGroupMapped(rosterIndex.groupOf(ordinal)) ? nullptr : rosterIndex.person(ordinal);
     }
-    Person* selectPerson(int slot, int timeRow,int location, int day) {
+    // 读取候选人信息（不展开所在的组）
+    int timesOf(int ordinal) const { return rosterIndex.visit(ordinal, [](const auto& m) { return m.getTimes(); }); }
+    int allTimesOf(int ordinal) const { return rosterIndex.visit(ordinal, [](const auto& m) { return m.getAll_times(); }); }
+    int locationTimesOf(int ordinal, int location) const {
+        return rosterIndex.visit(ordinal, [location](const auto& m) { return m.getLocationAllTimes(location); });
+    }
+    bool isFemale(int ordinal) const { return rosterIndex.visit(ordinal, [](const auto& m) { return m.getGender(); }); }
+    int gradeOf(int ordinal) const { return rosterIndex.visit(ordinal, [](const auto& m) { return m.getGrade(); }); }
+
+    // 返回选中队员的序号，无法选出时返回 -1
+    int selectPerson(int slot, int timeRow,int location, int day) {
         // 制表辅助函数
         // 选择合适的可工作队员
         // slot=0~9，表示10个时间段（周一上午、周一下午、周二上午、周二下午…… 周五下午）
-        // timeRow=1~4，表格行数，分别表示NJH升旗，DXY升旗，NJH降旗，DXY降旗
-        // location=0~1，工作地点，分别表示南鉴湖，东西院
+        // timeRow：空闲时间的行号（见 Person::timeRow），1~4 分别表示NJH升旗，DXY升旗，NJH降旗，DXY降旗
+        // location=0~locationCount-1，工作地点，0、1 分别表示南鉴湖，东西院
         // day = 1~5, 工作的时间，对应周一至周五
         if(mode != ScheduleMode::Custom)
         {
-            // 复制可用人员列表并按总次数排序
-            std::vector<Person*> candidates = availableMembers;
-            if (candidates.empty()) { // 防御性检查
+            // 复制可用人员列表中该时间点有空的队员（按位图判断），并按总次数排序
+            if (availableMembers.empty()) { // 防御性检查
                 const QString msg = "警告：没有可用的候选人员！";
                 if (!emittedWarningsThisRun.contains(msg)) {
                     emittedWarningsThisRun.insert(msg);
                     emit schedulingWarning(msg);
                 }
-                return nullptr;
+                return -1;
+            }
+            const RosterBitmap& freeMembers = rosterIndex.available(timeRow, day);
+            std::vector<int> candidates;
+            candidates.reserve(availableMembers.size());
+            for (int ordinal : availableMembers) {
+                if (freeMembers.test(ordinal)) {
+                    candidates.push_back(ordinal);
+                }
             }
 
-            std::sort(candidates.begin(), candidates.end(), [](Person* a, Person* b) {
-                return a->getAll_times() < b->getAll_times();
+            std::sort(candidates.begin(), candidates.end(), [this](int a, int b) {
+                return allTimesOf(a) < allTimesOf(b);
             });
 
             // 应用不同模式的约束条件
-            std::vector<Person*> validCandidates = applyModeConstraints(candidates, slot, timeRow, location, day);
-            std::vector<Person*> eligibleCandidates; // 符合交接规则的候选人列表
-            const std::vector<Person*>& allValidCandidates = validCandidates; // 保存所有有效候选人指针
+            std::vector<int> validCandidates = applyModeConstraints(candidates, slot, timeRow, location, day);
+            std::vector<int> eligibleCandidates; // 符合交接规则的候选人列表
+            const std::vector<int>& allValidCandidates = validCandidates; // 保存所有有效候选人序号
 
             // 仅在周二上午南鉴湖时检查交接规则
             if (slot == 2 && location == 0) {
                 eligibleCandidates.reserve(allValidCandidates.size());
-                // 筛选符合交接规则的候选人指针
-                for (Person* person : allValidCandidates) {
-                    if (isPersonSatisfyHandoverRule(person, slot, location)) {
-                        eligibleCandidates.push_back(person);
+                // 筛选符合交接规则的候选人
+                for (int ordinal : allValidCandidates) {
+                    if (isPersonSatisfyHandoverRule(ordinal, slot, location)) {
+                        eligibleCandidates.push_back(ordinal);
                     }
                 }
                 // 处理筛选结果
@@ -226,20 +287,20 @@ private:
                         emit schedulingWarning(msg);
                     }
                 }
-                return nullptr;
+                return -1;
             }
 
             // 计算当前最小总执勤次数（all_times）
             int minTimes = INT_MAX;
-            for (Person* p : allValidCandidates) {
-                int times = p->getAll_times();
+            for (int p : allValidCandidates) {
+                int times = allTimesOf(p);
                 if (times < minTimes) minTimes = times;
             }
 
             // 第一层：筛选出总执勤次数等于 minTimes 的候选人
             eligibleCandidates.clear();
-            for (Person* p : allValidCandidates) {
-                if (p->getAll_times() == minTimes) {
+            for (int p : allValidCandidates) {
+                if (allTimesOf(p) == minTimes) {
                     eligibleCandidates.push_back(p);
                 }
             }
@@ -251,23 +312,23 @@ private:
 
             // 第二层：在总次数相同的前提下，优先选择在当前地点累计次数更少的队员
             int minLocationTimes = INT_MAX;
-            for (Person* p : eligibleCandidates) {
-                int locTimes = (location == 0) ? p->getNJHAllTimes() : p->getDXYAllTimes();
+            for (int p : eligibleCandidates) {
+                int locTimes = locationTimesOf(p, location);
                 if (locTimes < minLocationTimes) {
                     minLocationTimes = locTimes;
                 }
             }
 
-            std::vector<Person*> balancedCandidates;
-            for (Person* p : eligibleCandidates) {
-                int locTimes = (location == 0) ? p->getNJHAllTimes() : p->getDXYAllTimes();
+            std::vector<int> balancedCandidates;
+            for (int p : eligibleCandidates) {
+                int locTimes = locationTimesOf(p, location);
                 if (locTimes == minLocationTimes) {
                     balancedCandidates.push_back(p);
                 }
             }
 
             // 如果基于地点次数筛选后还有候选人，则使用 balancedCandidates，否则退回 eligibleCandidates
-            const std::vector<Person*>& finalCandidates = balancedCandidates.empty() ? eligibleCandidates : balancedCandidates;
+            const std::vector<int>& finalCandidates = balancedCandidates.empty() ? eligibleCandidates : balancedCandidates;
 
             // 在符合条件的候选人中随机选择
             std::random_device rd;
@@ -275,33 +336,32 @@ private:
             std::uniform_int_distribution<> dis(0, finalCandidates.size() - 1);
             return finalCandidates[dis(gen)];
         }
-        return nullptr;
+        return -1;
     }
     std::string getTimeDescription(int slot, int location) {
         std::string days[] = { "周一", "周二", "周三", "周四", "周五" };
         std::string halves[] = { "上午升旗", "下午降旗" };
-        std::string locations[] = { "南鉴湖", "东西院" };
 
         int dayIndex = slot / 2;
         int halfDayIndex = slot % 2;
 
-        std::string timeDesc = days[dayIndex] + locations[location] + halves[halfDayIndex] ;
+        std::string timeDesc = days[dayIndex] + Flag_group::locationTitle(location).toStdString() + halves[halfDayIndex] ;
         return timeDesc;
     }
 
-    std::vector<Person*> applyModeConstraints(const std::vector<Person*>& candidates, int slot, int timeRow, int location, int day) {
-        std::vector<Person*> validCandidates;
+    std::vector<int> applyModeConstraints(const std::vector<int>& candidates, int slot, int timeRow, int location, int day) {
+        std::vector<int> validCandidates;
 
-        for (auto person : candidates) {
+        for (int person : candidates) {
             bool isValid = true;
 
-            // 基础条件：时间有空且未被安排
-            if (!person->getTime(timeRow, day) || isPersonBusy(person, slot)) {
+            // 基础条件：未被安排（时间是否有空已在 selectPerson 中按位图筛选）
+            if (isPersonBusy(person, slot)) {
                 isValid = false;
             }
 
             // 本周执勤次数上限：一周最多执勤 5 次
-            if (isValid && person->getTimes() >= 5) {
+            if (isValid && timesOf(person) >= 5) {
                 isValid = false;
             }
 
@@ -332,56 +392,46 @@ private:
         return validCandidates;
     }
 
-    bool wouldExceedFemaleLimit(Person* person, int slot, int location) {
-        if (person->getGender() != true) {
+    bool wouldExceedFemaleLimit(int person, int slot, int location) {
+        if (isFemale(person) != true) {
             return false;
         }
 
         // 计算当前任务（slot + location）中已有的女队员数量（按 location 统计）
-        int femaleCount = 0;
-        for (int pos = 0; pos < 3; ++pos) {
-            if (scheduleTable[slot][location][pos] &&
-                scheduleTable[slot][location][pos]->getGender() == true) {
-                femaleCount++;
-            }
-        }
+        Person* const* seats = locationSeats(slot, location);
+        const int femaleCount = static_cast<int>(std::count_if(seats, seats + PEOPLE_PER_LOCATION, [](const Person* p) {
+            return p && p->getGender() == true;
+        }));
 
         // 如果加入当前队员会使该任务女队员数量达到3，则返回true
         return (femaleCount + 1) >= 3;
     }
 
-    bool isPersonSatisfyHandoverRule(Person* person, int slot, int location) {
+    bool isPersonSatisfyHandoverRule(int ordinal, int slot, int location) {
         // 检查周二交接规则：slot=2, location=0的任务中，至少有一人参与了slot=1, location=0的任务
         if (slot != 2 || location != 0) {
             return true; // 不是周二交接的任务，直接返回true
         }
 
         // 检查slot=1, location=0的任务中是否有当前人员
-        for (int pos = 0; pos < 3; ++pos) {
-            if (scheduleTable[1][0][pos] == person) {
-                return true;
-            }
-        }
-
-        return false;
+        const Person* person = seatedMember(ordinal);
+        if (!person) return false;
+        Person* const* seats = locationSeats(1, 0);
+        return std::find(seats, seats + PEOPLE_PER_LOCATION, person) != seats + PEOPLE_PER_LOCATION;
     }
 
-    bool isSupervisoryRequirementMet(Person* person, int slot, int location) {
+    bool isSupervisoryRequirementMet(int person, int slot, int location) {
         // 如果当前人员是非大一学生，直接满足条件
-        if (person->getGrade() != 1) {
+        if (gradeOf(person) != 1) {
             return true;
         }
 
         // 如果当前人员是大一学生，检查当前任务中是否已经有非大一学生
-        for (int pos = 0; pos < 3; ++pos) {
-            if (scheduleTable[slot][location][pos] &&
-                scheduleTable[slot][location][pos]->getGrade() != 1) {
-                return true;
-            }
-        }
-
         // 如果当前任务中没有非大一学生，且候选人员是大一学生，则不满足条件
-        return false;
+        Person* const* seats = locationSeats(slot, location);
+        return std::any_of(seats, seats + PEOPLE_PER_LOCATION, [](const Person* p) {
+            return p && p->getGrade() != 1;
+        });
     }
 
     bool isValidSlotForDXYMode(int slot, int location) {
@@ -400,39 +450,34 @@ private:
 
 
     // 判断是否已经在同一时间段安排了工作
-    bool isPersonBusy(Person* person, int slot) const {
-        // 将对应时间段slot的所有位置都遍历一遍，查看是否已经存在该队员person
-        for (int location = 0; location < 2; ++location) {
-            for (int position = 0; position < 3; ++position) {
-                if (scheduleTable[slot][location][position] == person) {
-                    return true;
-                }
-            }
-        }
-        return false;
+    bool isPersonBusy(int ordinal, int slot) const {
+        const Person* person = seatedMember(ordinal);
+        if (!person) return false;
+        // 同一时间段的全部岗位在 scheduleTable 中连续存放，扫描这一段即可
+        Person* const* seats = locationSeats(slot, 0);
+        return std::find(seats, seats + seatsPerSlot, person) != seats + seatsPerSlot;
     }
 };
 
 
 
-inline std::vector<std::vector<std::vector<Person *> > > SchedulingManager::getScheduleTable() const
-{
-    return scheduleTable;
-}
-
-inline void SchedulingManager::setScheduleTable(const std::vector<std::vector<std::vector<Person *> > > &newScheduleTable)
-{
-    scheduleTable = newScheduleTable;
-}
-
+// 取得参加排班的队员会展开其所在的组；只需读取时用 availableMemberCount / forEachAvailableMember
 inline std::vector<Person *> SchedulingManager::getAvailableMembers() const
 {
-    return availableMembers;
+    std::vector<Person *> members;
+    members.reserve(availableMembers.size());
+    for (int ordinal : availableMembers) members.push_back(member(ordinal));
+    return members;
 }
 
+// 不在名单中的队员忽略
 inline void SchedulingManager::setAvailableMembers(const std::vector<Person *> &newAvailableMembers)
 {
-    availableMembers = newAvailableMembers;
+    availableMembers.clear();
+    for (const Person* person : newAvailableMembers) {
+        const int ordinal = rosterIndex.ordinalOf(person);
+        if (ordinal >= 0) availableMembers.push_back(ordinal);
+    }
 }
 
 
@@ -0,0 +1,156 @@
+// durableFile.h头文件
+// 功能说明：所有数据文件共用的持久化写入流程（先写后换）
+// 完整写入一个文件的步骤：
+//   1. 写入同目录下的临时文件
+//   2. fsync 临时文件，确保内容已落盘
+//   3. 原子重命名覆盖目标文件（不先删除目标文件，任何时刻目标文件名都指向完整的旧文件或完整的新文件）
+//   4. fsync 所在目录，确保重命名本身已落盘
+// 每次保存只需一对 fsync。程序在任一步骤中断时，目标文件保持旧内容，残留的临时文件在下次保存时被覆盖；
+// 写入失败而程序仍在运行时，写入方删除临时文件。
+// 各步骤设有故障注入点，供 crashConsistencyHarness.h 模拟写入进程在任一步骤被终止。
+
+#pragma once
+#include <QString>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QDebug>
+#include <functional>
+#ifdef Q_OS_WIN
+#include <windows.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <cstdio>
+#endif
+
+class DurableFile
+{
+public:
+    // 写入流程中的各个步骤（故障注入点）
+    enum Step {
+        StepOpen,           // 打开临时文件
+        StepWrite,          // 写入一段内容
+        StepSyncFile,       // fsync 文件
+        StepRename,         // 原子重命名
+        StepSyncDirectory   // fsync 目录
+    };
+
+    // 故障注入：返回 true 表示写入进程在该步骤执行前被终止
+    using FaultInjector = std::function<bool(Step)>;
+
+    static void setFaultInjector(FaultInjector injector) {
+        faultInjector() = std::move(injector);
+    }
+
+    // 写入方在每个步骤之前调用；返回 true 时按写入失败处理（删除临时文件并返回失败）。
+    // 进程被终止时残留的临时文件由崩溃一致性检查另行模拟
+    static bool interrupted(Step step) {
+        const FaultInjector& injector = faultInjector();
+        return injector && injector(step);
+    }
+
+    // 临时文件路径（与目标文件同目录，保证重命名不跨文件系统）
+    static QString tempPathFor(const QString& target) {
+        return target + ".tmp";
+    }
+
+    // 打开目标文件对应的临时文件用于写入（截断残留的旧临时文件）
+    static bool openTemp(QFile& tempFile, const QString& target) {
+        if (interrupted(StepOpen)) return false;
+        tempFile.setFileName(tempPathFor(target));
+        if (!tempFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qDebug() << "无法打开临时文件进行写入：" << tempFile.fileName();
+            return false;
+        }
+        return true;
+    }
+
+    // 写入一段内容
+    static bool write(QFileDevice& file, const QByteArray& data) {
+        if (interrupted(StepWrite)) return false;
+        return file.write(data) == data.size();
+    }
+
+    // 将文件内容刷新到磁盘
+    static bool syncFile(QFileDevice& file) {
+        if (interrupted(StepSyncFile)) return false;
+        if (!file.flush()) return false;
+#ifdef Q_OS_WIN
+        HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(file.handle()));
+        const bool ok = handle != INVALID_HANDLE_VALUE && FlushFileBuffers(handle);
+#else
+        const bool ok = ::fsync(file.handle()) == 0;
+#endif
+        if (!ok) qDebug() << "文件落盘失败：" << file.fileName();
+        return ok;
+    }
+
+    // 将目录项（新建、重命名）刷新到磁盘
+    static bool syncDirectory(const QString& dirPath) {
+        if (interrupted(StepSyncDirectory)) return false;
+#ifdef Q_OS_WIN
+        // Windows 不支持对目录 fsync；重命名时已使用 MOVEFILE_WRITE_THROUGH
+        Q_UNUSED(dirPath);
+        return true;
+#else
+        const int fd = ::open(QFile::encodeName(dirPath).constData(), O_RDONLY);
+        if (fd < 0) return false;
+        const bool ok = ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok) qDebug() << "目录落盘失败：" << dirPath;
+        return ok;
+#endif
+    }
+
+    // 原子地用 from 覆盖 to（目标存在时直接替换，不先删除），随后刷新所在目录
+    static bool replace(const QString& from, const QString& to) {
+        if (interrupted(StepRename)) return false;
+#ifdef Q_OS_WIN
+        const bool ok = MoveFileExW(reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(from).utf16()),
+                                    reinterpret_cast<LPCWSTR>(QDir::toNativeSeparators(to).utf16()),
+                                    MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH);
+#else
+        const bool ok = ::rename(QFile::encodeName(from).constData(), QFile::encodeName(to).constData()) == 0;
+#endif
+        if (!ok) {
+            qDebug() << "无法将临时文件重命名为目标文件：" << from << "->" << to;
+            return false;
+        }
+        return syncDirectory(QFileInfo(to).absolutePath());
+    }
+
+    // 提交临时文件：落盘、关闭并原子替换目标文件；失败时删除临时文件（已重命名时临时文件已不存在）
+    static bool commit(QFile& tempFile, const QString& target) {
+        if (!syncFile(tempFile)) {
+            tempFile.close();
+            tempFile.remove();
+            return false;
+        }
+        tempFile.close();
+        if (!replace(tempFile.fileName(), target)) {
+            QFile::remove(tempFile.fileName());
+            return false;
+        }
+        return true;
+    }
+
+    // 完整写入一个文件
+    static bool writeFile(const QString& target, const QByteArray& data) {
+        QFile tempFile;
+        if (!openTemp(tempFile, target)) return false;
+        if (!write(tempFile, data)) {
+            tempFile.close();
+            tempFile.remove();
+            return false;
+        }
+        return commit(tempFile, target);
+    }
+
+private:
+    static FaultInjector& faultInjector() {
+        static FaultInjector injector;
+        return injector;
+    }
+};
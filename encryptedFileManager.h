@@ -1,14 +1,34 @@
 // encryptedFileManager.h头文件
 // 功能说明：使用AES加密算法对数据进行加密存储，提供更安全的数据保存方案
+// 当前写入 FLAG_GROUP_ENCRYPTED_V2：ChaCha20 分块加密，每块附带 HMAC-SHA256 校验值（见 cipherChunkDevice.h），
+// 仍可读取旧的 FLAG_GROUP_ENCRYPTED_V1（整体XOR）文件。
+// 增量保存：上次保存后修改、新增、删除的队员以加密批次追加到更新日志 data.dat.log（附带组内位置），读取时在基础文件之上按顺序回放；
+// 日志过大或修改过多时改为完整保存，同时删除日志（即压缩）。
+// 籍贯、民族、寝室、学院、班级以文件内字符串表的序号保存（队员记录版本 5），每种取值在文件中只写一次。
+// 组数与执勤地点数可变：文件的第一条记录同时保存组数与地点数，队员记录保存全部地点的累计次数与空闲时间（内层格式 8、队员记录版本 7）。
 
 #pragma once
 #include <QString>
 #include <QByteArray>
 #include <QCryptographicHash>
+#include <QMessageAuthenticationCode>
+#include <QRandomGenerator>
 #include <QDataStream>
 #include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QStringList>
+#include <QHash>
+#include <QVector>
 #include <QDebug>
+#include <algorithm>
 #include "Flag_group.h"
+#include "stringPool.h"
+#include "cipherChunkDevice.h"
+#include "durableFile.h"
+#include "recordFraming.h"
+#include "historyJournal.h"
+#include "parallelTasks.h"
 
 class EncryptedFileManager
 {
@@ -26,11 +46,19 @@ private:
     }
     
     // 简单的XOR加密/解密（AES需要额外库，这里使用XOR作为轻量级加密）
+    // 仅用于读取 FLAG_GROUP_ENCRYPTED_V1 文件与彩蛋文件；按密钥长度整段异或，避免逐字节取模
     static QByteArray encryptData(const QByteArray& data, const QByteArray& key) {
         QByteArray encrypted = data;
-        for (int i = 0; i < encrypted.size(); ++i) {
-            encrypted[i] = encrypted[i] ^ key[i % key.size()];
+        const int keySize = key.size();
+        if (keySize == 0) return encrypted;
+        char* p = encrypted.data();
+        const char* k = key.constData();
+        const int n = encrypted.size();
+        int i = 0;
+        for (; i + keySize <= n; i += keySize) {
+            for (int j = 0; j < keySize; ++j) p[i + j] ^= k[j];
         }
+        for (int j = 0; i < n; ++i, ++j) p[i] ^= k[j];
         return encrypted;
     }
     
@@ -39,119 +67,618 @@ private:
         return encryptData(encryptedData, key);
     }
 
-public:
-    // 加密保存文件
-    static bool saveToFile(const Flag_group& flagGroup, const QString& filename, const QString& password = QString()) {
-        // 使用临时文件避免文件占用问题
-        QString tempFilename = filename + ".tmp";
-        
-        // 如果临时文件已存在，先删除
-        QFile tempFile(tempFilename);
-        if (tempFile.exists()) {
-            if (!tempFile.remove()) {
-                qDebug() << "无法删除旧的临时文件：" << tempFilename;
-                // 继续尝试，可能文件已被释放
+    // FLAG_GROUP_ENCRYPTED_V2：由口令派生的加密密钥与校验密钥
+    static QByteArray deriveKey(const QByteArray& masterKey, const char* purpose) {
+        return QMessageAuthenticationCode::hash(QByteArray(purpose), masterKey, QCryptographicHash::Sha256);
+    }
+    
+    // 文件内的字符串表：档案字段的字符串池编号（见 stringPool.h）换算为文件内从1开始的连续序号，0 表示空串
+    class ProfileTable
+    {
+    public:
+        // 登记一名队员的五个档案字段
+        void add(const Person& person) {
+            serial(person.getNative_placeId());
+            serial(person.getNativeId());
+            serial(person.getDormId());
+            serial(person.getSchoolId());
+            serial(person.getClassnameId());
+        }
+
+        quint32 serial(StringPool::Id id) {
+            if (id == StringPool::EMPTY) return 0;
+            auto it = m_serials.constFind(id);
+            if (it == m_serials.constEnd()) {
+                m_ids.append(id);
+                it = m_serials.insert(id, static_cast<quint32>(m_ids.size()));
+            }
+            return it.value();
+        }
+
+        void write(QDataStream& out) const {
+            out << static_cast<quint32>(m_ids.size());
+            for (StringPool::Id id : m_ids) {
+                out << QString::fromStdString(StringPool::shared().text(id));
+            }
+        }
+
+    private:
+        QHash<StringPool::Id, quint32> m_serials;
+        QVector<StringPool::Id> m_ids;
+    };
+
+    // 读取字符串表，返回 序号 -> 字符串池编号（第0项为空串）
+    static QVector<StringPool::Id> readProfileTable(QDataStream& in) {
+        QVector<StringPool::Id> ids(1, StringPool::EMPTY);
+        quint32 count = 0;
+        in >> count;
+        for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; ++i) {
+            QString text;
+            in >> text;
+            ids.append(StringPool::shared().intern(text.toStdString()));
+        }
+        return ids;
+    }
+
+    // 写入一名队员的全部字段（队员记录版本 7，增量日志中复用同一格式）；档案字段写入 table 中的序号
+    static void writePerson(QDataStream& out, const Person& person, ProfileTable& table) {
+        // 写入队员基本信息
+        out << QString::fromStdString(person.getName());
+        out << (bool)person.getGender();
+        out << (qint32)person.getGroup();
+        out << (qint32)person.getGrade();
+        out << QString::fromStdString(person.getPhone_number());
+        out << table.serial(person.getNative_placeId());
+        out << table.serial(person.getNativeId());
+        out << table.serial(person.getDormId());
+        out << table.serial(person.getSchoolId());
+        out << table.serial(person.getClassnameId());
+        out << QString::fromStdString(person.getBirthday());
+        out << (bool)person.getIsWork();
+        
+        // 写入时间安排（20个布尔值）
+        for (int j = 1; j <= 4; ++j) {
+            for (int k = 1; k <= 5; ++k) {
+                out << (bool)person.getTime(j, k);
             }
         }
         
-        // 尝试打开临时文件进行写入
-        if (!tempFile.open(QIODevice::WriteOnly)) {
-            qDebug() << "无法打开临时文件进行写入：" << tempFilename;
-            return false;
+        // 写入执勤次数
+        out << (qint32)person.getTimes();
+        out << (qint32)person.getAll_times();
+        out << (qint32)person.getNJHAllTimes();
+        out << (qint32)person.getDXYAllTimes();
+        // 版本 6：南鉴湖、东西院之外其他地点的累计次数
+        const int extraLocations = person.getLocationCount() - Person::DEFAULT_LOCATION_COUNT;
+        out << (quint8)extraLocations;
+        for (int k = 0; k < extraLocations; ++k) {
+            out << (qint32)person.getLocationAllTimes(Person::DEFAULT_LOCATION_COUNT + k);
+        }
+        // 版本 7：前两个地点之外的空闲时间（时间掩码第20位起）
+        out << (quint64)(person.getTimeMask() >> 20);
+    }
+    
+    // 读取一名队员（兼容队员记录版本 1~7；版本 5 起档案字段按 table 换算，序号无效时为空）
+    static Person readPerson(QDataStream& in, qint32 version, const QVector<StringPool::Id>* table = nullptr) {
+        // 读取队员唯一ID（版本3，兼容旧版本，但不再使用）
+        qint32 personId = 0;
+        if (version >= 3 && version < 4) {
+            in >> personId;
         }
         
-        // 生成加密密钥（如果未提供密码，使用默认密钥）
-        QString actualPassword = password.isEmpty() ? getDefaultKey() : password;
-        QByteArray key = generateKey(actualPassword);
+        // 读取队员基本信息
+        QString name;
+        bool gender;
+        qint32 group, grade;
+        QString phone_number, native_place, native, dorm, school, classname, birthday;
+        bool isWork;
+        
+        quint32 profile[5] = {0, 0, 0, 0, 0}; // 版本 5：籍贯、民族、寝室、学院、班级在字符串表中的序号
+        in >> name >> gender >> group >> grade;
+        if (version >= 5) {
+            in >> phone_number;
+            for (quint32& serial : profile) in >> serial;
+            in >> birthday;
+        } else {
+            in >> phone_number >> native_place >> native >> dorm >> school >> classname >> birthday;
+        }
+        in >> isWork;
+        
+        // 读取时间安排
+        bool time[4][5];
+        for (int j = 0; j < 4; ++j) {
+            for (int k = 0; k < 5; ++k) {
+                bool timeValue;
+                in >> timeValue;
+                time[j][k] = timeValue;
+            }
+        }
         
-        // 将数据序列化为字节数组
-        QByteArray data;
-        QDataStream out(&data, QIODevice::WriteOnly);
-        out.setVersion(QDataStream::Qt_5_15);
+        // 读取执勤次数（兼容不同版本）
+        qint32 times = 0, all_times = 0;
+        qint32 njh_all_times = 0, dxy_all_times = 0;
+        in >> times >> all_times;
+        if (version >= 2) {
+            in >> njh_all_times >> dxy_all_times;
+        }
+        quint8 extraLocations = 0;
+        QVector<qint32> extraAllTimes;
+        if (version >= 6) {
+            in >> extraLocations;
+            extraAllTimes.resize(extraLocations);
+            for (qint32& value : extraAllTimes) in >> value;
+        }
+        quint64 extraTime = 0;
+        if (version >= 7) {
+            in >> extraTime;
+        }
         
+        Person person(name.toStdString(), gender, group, grade,
+                      phone_number.toStdString(), native_place.toStdString(),
+                      native.toStdString(), dorm.toStdString(), school.toStdString(),
+                      classname.toStdString(), birthday.toStdString(), isWork,
+                      time, times, all_times, njh_all_times, dxy_all_times);
+        if (version >= 5) {
+            // 直接按编号赋值，不再为每名队员构造字符串
+            auto id = [table](quint32 serial) {
+                return table && serial < static_cast<quint32>(table->size()) ? table->at(serial) : StringPool::EMPTY;
+            };
+            person.setNative_placeId(id(profile[0]));
+            person.setNativeId(id(profile[1]));
+            person.setDormId(id(profile[2]));
+            person.setSchoolId(id(profile[3]));
+            person.setClassnameId(id(profile[4]));
+        }
+        for (int k = 0; k < extraAllTimes.size(); ++k) {
+            person.setLocationAllTimes(Person::DEFAULT_LOCATION_COUNT + k, extraAllTimes[k]);
+        }
+        if (extraTime) {
+            person.setTimeMask(person.getTimeMask() | (std::uint64_t(extraTime) << 20));
+        }
+        return person;
+    }
+    
+    // 写入所有队员数据（内层格式版本 8）
+    static void writeMembers(QDataStream& out, const Flag_group& flagGroup) {
         // 写入文件版本号（用于未来兼容性）
         // 版本 1：仅保存总执勤次数 all_times
         // 版本 2：新增按地点统计的累计执勤次数（南鉴湖 / 东西院）
         // 版本 3：新增唯一ID字段，用于精确识别队员（已废弃）
         // 版本 4：移除唯一ID，使用姓名+组别作为唯一标识
-        out << (qint32)4;
+        // 版本 5：分帧记录（见 recordFraming.h），文件头记录总人数，每名队员一条带 CRC32C 的记录
+        // 版本 6：第一条记录为档案字段的字符串表，之后每名队员一条记录（队员记录版本 5）
+        // 版本 7：第一条记录在字符串表之前写入组数；队员记录版本 6（保存全部执勤地点的累计次数）
+        // 版本 8：第一条记录在组数之后写入执勤地点数；队员记录版本 7（保存全部执勤地点的空闲时间）
+        out << (qint32)8;
+        
+        ProfileTable table;
+        quint32 total = 0;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            for (const auto& person : flagGroup.getGroupMembers(i)) {
+                table.add(person);
+            }
+            total += static_cast<quint32>(flagGroup.getGroupMembers(i).size());
+        }
+        RecordFraming::writeHeader(out, 8, total + 1);
+        
+        QByteArray payload;
+        {
+            QDataStream record(&payload, QIODevice::WriteOnly);
+            record.setVersion(QDataStream::Qt_5_15);
+            record << (qint32)flagGroup.groupCount();
+            record << (qint32)flagGroup.locationCount();
+            table.write(record);
+        }
+        RecordFraming::writeRecord(out, payload);
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            for (const auto& person : flagGroup.getGroupMembers(i)) {
+                payload.clear();
+                QDataStream record(&payload, QIODevice::WriteOnly);
+                record.setVersion(QDataStream::Qt_5_15);
+                writePerson(record, person, table);
+                RecordFraming::writeRecord(out, payload);
+            }
+        }
+    }
+    
+    // 读取所有队员数据（兼容内层格式版本 1~8）
+    // 版本 5 及以上中校验失败的记录被跳过并写入 problems，其余队员照常读取；数据不完整时读取失败
+    static bool readMembers(QDataStream& in, Flag_group& flagGroup, QStringList* problems = nullptr) {
+        // 读取文件版本号
+        qint32 version;
+        in >> version;
         
-        // 写入所有队员数据
-        for (int i = 1; i <= 4; ++i) {
-            const auto& members = flagGroup.getGroupMembers(i);
-            out << (qint32)members.size(); // 写入该组的队员数量
+        // 检查版本号读取是否成功
+        if (in.status() != QDataStream::Ok) {
+            qDebug() << "读取版本号失败";
+            return false;
+        }
+        
+        if (version >= 5) {
+            return readFramedMembers(in, flagGroup, version, problems);
+        }
+        
+        // 读取所有队员数据（旧版本固定为四组）
+        for (int groupIndex = 1; groupIndex <= Flag_group::DEFAULT_GROUP_COUNT; ++groupIndex) {
+            qint32 memberCount;
+            in >> memberCount;
             
-            for (const auto& person : members) {
-                // 写入队员基本信息
-                out << QString::fromStdString(person.getName());
-                out << (bool)person.getGender();
-                out << (qint32)person.getGroup();
-                out << (qint32)person.getGrade();
-                out << QString::fromStdString(person.getPhone_number());
-                out << QString::fromStdString(person.getNative_place());
-                out << QString::fromStdString(person.getNative());
-                out << QString::fromStdString(person.getDorm());
-                out << QString::fromStdString(person.getSchool());
-                out << QString::fromStdString(person.getClassname());
-                out << QString::fromStdString(person.getBirthday());
-                out << (bool)person.getIsWork();
-                
-                // 写入时间安排（20个布尔值）
-                for (int j = 1; j <= 4; ++j) {
-                    for (int k = 1; k <= 5; ++k) {
-                        out << (bool)person.getTime(j, k);
+            for (int i = 0; i < memberCount && in.status() == QDataStream::Ok; ++i) {
+                Person person = readPerson(in, version);
+                // 直接追加到组容器，避免 addPersonToGroup 逐人输出调试日志
+                const int group = person.getGroup();
+                if (flagGroup.isValidGroup(group)) {
+                    flagGroup.getGroupMembers(group).push_back(std::move(person));
+                }
+            }
+        }
+        
+        // 旧版本没有逐条校验，只能依据数据流状态发现截断
+        if (in.status() != QDataStream::Ok) {
+            qDebug() << "队员数据不完整（文件可能被截断）";
+            return false;
+        }
+        return true;
+    }
+    
+    // 读取版本 5~8 的分帧队员记录
+    static bool readFramedMembers(QDataStream& in, Flag_group& flagGroup, qint32 version, QStringList* problems) {
+        quint32 formatVersion, recordCount;
+        if (!RecordFraming::readHeader(in, formatVersion, recordCount)) {
+            qDebug() << "队员数据文件头损坏";
+            return false;
+        }
+        QByteArray payload;
+        QVector<StringPool::Id> table(1, StringPool::EMPTY);
+        quint32 first = 0;
+        if (version >= 6 && recordCount > 0) {
+            // 字符串表损坏时队员仍可读取，只是档案字段为空；组数按队员记录中出现的最大组号补足
+            first = 1;
+            const RecordFraming::ReadResult result = RecordFraming::readRecord(in, payload);
+            if (result == RecordFraming::StreamBroken) {
+                qDebug() << "队员数据不完整：字符串表无法读取";
+                return false;
+            }
+            QDataStream record(payload);
+            record.setVersion(QDataStream::Qt_5_15);
+            qint32 groupCount = Flag_group::DEFAULT_GROUP_COUNT;
+            qint32 locationCount = Person::DEFAULT_LOCATION_COUNT;
+            if (result == RecordFraming::RecordOk) {
+                if (version >= 7) record >> groupCount;
+                if (version >= 8) record >> locationCount;
+                table = readProfileTable(record);
+            }
+            if (result == RecordFraming::RecordOk && record.status() == QDataStream::Ok
+                && (!flagGroup.setGroupCount(groupCount) || !flagGroup.setLocationCount(locationCount))) {
+                record.setStatus(QDataStream::ReadCorruptData);
+            }
+            if (result != RecordFraming::RecordOk || record.status() != QDataStream::Ok) {
+                table = QVector<StringPool::Id>(1, StringPool::EMPTY);
+                const QString problem = "档案字段字符串表损坏，队员的籍贯、民族、寝室、学院、班级、空组与新增的执勤地点未能恢复";
+                qDebug() << problem;
+                if (problems) problems->append(problem);
+            }
+        }
+        for (quint32 i = first; i < recordCount; ++i) {
+            const RecordFraming::ReadResult result = RecordFraming::readRecord(in, payload);
+            if (result == RecordFraming::StreamBroken) {
+                qDebug() << "队员数据不完整：共" << recordCount << "条记录，第" << i + 1 << "条起无法读取";
+                return false;
+            }
+            QDataStream record(payload);
+            record.setVersion(QDataStream::Qt_5_15);
+            Person person;
+            if (result == RecordFraming::RecordOk) {
+                person = readPerson(record, version >= 8 ? 7 : version >= 7 ? 6 : version >= 6 ? 5 : 4, &table);
+            }
+            const int group = person.getGroup();
+            if (result != RecordFraming::RecordOk || record.status() != QDataStream::Ok
+                || group < 1 || group > Flag_group::MAX_GROUP_COUNT) {
+                const QString problem = QString("第 %1 条队员记录损坏，已跳过").arg(i + 1 - first);
+                qDebug() << problem;
+                if (problems) problems->append(problem);
+                continue;
+            }
+            if (group > flagGroup.groupCount()) flagGroup.setGroupCount(group);
+            flagGroup.getGroupMembers(group).push_back(std::move(person));
+        }
+        return true;
+    }
+    
+    // 读取 FLAG_GROUP_ENCRYPTED_V2 文件头之后的分块密文
+    static bool loadChunked(QFile& file, Flag_group& flagGroup, const QByteArray& masterKey, QStringList* problems) {
+        const QByteArray noncePrefix = file.read(CipherChunkDevice::NONCE_PREFIX_SIZE);
+        if (noncePrefix.size() != CipherChunkDevice::NONCE_PREFIX_SIZE) {
+            qDebug() << "读取文件随机数失败";
+            return false;
+        }
+        // 预读与线程数相当的块：读文件、校验解密（线程池）与反序列化（当前线程）同时进行
+        CipherChunkDevice cipher(&file, deriveKey(masterKey, "FLAG_GROUP_V2 encryption"),
+                                 deriveKey(masterKey, "FLAG_GROUP_V2 authentication"), noncePrefix,
+                                 ParallelTasks::workerCount());
+        if (!cipher.open(QIODevice::ReadOnly)) return false;
+        QDataStream in(&cipher);
+        in.setVersion(QDataStream::Qt_5_15);
+        // 先读入临时容器，全部块校验通过后再替换，避免损坏的文件留下半份名单
+        Flag_group loaded;
+        bool ok = readMembers(in, loaded, problems) && in.status() == QDataStream::Ok;
+        // 读取最后一块剩余的数据，确认结束标志所在的块同样通过校验
+        while (ok && !cipher.reachedEnd() && !cipher.hasFailed()) {
+            char discard[256];
+            if (cipher.read(discard, sizeof(discard)) <= 0) break;
+        }
+        ok = ok && cipher.reachedEnd() && !cipher.hasFailed();
+        if (!ok) {
+            qDebug() << "加密数据校验失败：" << cipher.errorString();
+            return false;
+        }
+        flagGroup = std::move(loaded);
+        return true;
+    }
+    
+    // 基础文件读取成功后回放更新日志；基础文件没有损坏记录且日志全部回放成功时，名单与文件一致，之后可以继续增量保存
+    static void finishLoad(Flag_group& flagGroup, const QString& filename, const QByteArray& masterKey, bool baseIntact) {
+        if (applyUpdateLog(flagGroup, updateLogPath(filename), masterKey) && baseIntact) {
+            flagGroup.markSaved();
+        }
+        // 否则保持「需要完整保存」，下次保存时重写基础文件（去掉损坏的记录）并丢弃日志
+    }
+    
+    // 更新日志：记录类型与压缩阈值
+    static constexpr quint8 UPDATE_LOG_BATCH = 0x10;                 // 一次增量保存写出的批次
+    static constexpr qint64 UPDATE_LOG_COMPACT_BYTES = 256 * 1024;   // 日志超过此大小时改为完整保存
+    
+    static QString updateLogPath(const QString& filename) {
+        return filename + ".log";
+    }
+    
+    // 编码一个更新批次：[文件随机数(8字节)][分块密文]，明文为删除的队员标识与修改后的完整队员记录
+    // changed 中每名队员附带其在组内的位置，回放时插入到原位置（改名、撤销删除的队员不会被移到组末尾）
+    static QByteArray encodeUpdateBatch(const vector<std::pair<int, std::string>>& removedKeys,
+                                        const vector<std::pair<const Person*, int>>& changed, const QByteArray& masterKey) {
+        QByteArray noncePrefix(CipherChunkDevice::NONCE_PREFIX_SIZE, Qt::Uninitialized);
+        QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(noncePrefix.data()),
+                                              CipherChunkDevice::NONCE_PREFIX_SIZE / 4);
+        QByteArray batch = noncePrefix;
+        QBuffer buffer(&batch);
+        buffer.open(QIODevice::WriteOnly | QIODevice::Append);
+        CipherChunkDevice cipher(&buffer, deriveKey(masterKey, "FLAG_GROUP_V2 update log encryption"),
+                                 deriveKey(masterKey, "FLAG_GROUP_V2 update log authentication"), noncePrefix);
+        if (!cipher.open(QIODevice::WriteOnly)) return QByteArray();
+        QDataStream out(&cipher);
+        out.setVersion(QDataStream::Qt_5_15);
+        // 批次版本：5、6 与队员记录格式版本相同；7 为队员记录版本 6，且每条记录前写入组内位置；8 同 7，队员记录为版本 7。
+        // 其后为本批次用到的字符串表
+        out << (qint32)8;
+        ProfileTable table;
+        for (const auto& entry : changed) {
+            table.add(*entry.first);
+        }
+        table.write(out);
+        out << (qint32)removedKeys.size();
+        for (const auto& key : removedKeys) {
+            out << (qint32)key.first << QString::fromStdString(key.second);
+        }
+        out << (qint32)changed.size();
+        for (const auto& entry : changed) {
+            out << (qint32)entry.second;
+            writePerson(out, *entry.first, table);
+        }
+        cipher.close();
+        if (out.status() != QDataStream::Ok || cipher.hasFailed()) return QByteArray();
+        return batch;
+    }
+    
+    // 在名单上回放一个更新批次：先删除，再按组别 + 姓名取出已有的同名队员，最后按组内位置从小到大插入修改后的队员。
+    // 未修改的队员之间的先后顺序不变，因此按位置升序插入即可还原保存时的顺序；旧版本批次没有位置，新队员追加到组末尾
+    static bool applyUpdateBatch(Flag_group& flagGroup, const QByteArray& payload, const QByteArray& masterKey) {
+        const QByteArray noncePrefix = payload.left(CipherChunkDevice::NONCE_PREFIX_SIZE);
+        if (noncePrefix.size() != CipherChunkDevice::NONCE_PREFIX_SIZE) return false;
+        QByteArray body = payload.mid(CipherChunkDevice::NONCE_PREFIX_SIZE);
+        QBuffer buffer(&body);
+        buffer.open(QIODevice::ReadOnly);
+        CipherChunkDevice cipher(&buffer, deriveKey(masterKey, "FLAG_GROUP_V2 update log encryption"),
+                                 deriveKey(masterKey, "FLAG_GROUP_V2 update log authentication"), noncePrefix);
+        if (!cipher.open(QIODevice::ReadOnly)) return false;
+        QDataStream in(&cipher);
+        in.setVersion(QDataStream::Qt_5_15);
+        
+        // 先完整解码并确认校验通过，再修改名单
+        qint32 version = 0, removedCount = 0;
+        in >> version;
+        QVector<StringPool::Id> table;
+        if (version >= 5) table = readProfileTable(in);
+        in >> removedCount;
+        vector<std::pair<int, std::string>> removedKeys;
+        for (qint32 i = 0; i < removedCount && in.status() == QDataStream::Ok; ++i) {
+            qint32 group;
+            QString name;
+            in >> group >> name;
+            removedKeys.emplace_back(group, name.toStdString());
+        }
+        qint32 changedCount = 0;
+        in >> changedCount;
+        vector<std::pair<Person, int>> changed;
+        for (qint32 i = 0; i < changedCount && in.status() == QDataStream::Ok; ++i) {
+            qint32 position = -1;
+            if (version >= 7) in >> position;
+            changed.emplace_back(readPerson(in, version >= 8 ? 7 : version >= 7 ? 6 : version, &table), position);
+        }
+        if (in.status() != QDataStream::Ok || !cipher.reachedEnd() || cipher.hasFailed()) return false;
+        
+        for (const auto& key : removedKeys) {
+            if (!flagGroup.isValidGroup(key.first)) continue;
+            auto& members = flagGroup.getGroupMembers(key.first);
+            for (auto it = members.begin(); it != members.end(); ++it) {
+                if (it->getName() == key.second) {
+                    members.erase(it);
+                    break;
+                }
+            }
+        }
+        if (version < 7) {
+            for (auto& entry : changed) {
+                Person& person = entry.first;
+                const int group = person.getGroup();
+                if (group < 1 || group > Flag_group::MAX_GROUP_COUNT) continue;
+                if (group > flagGroup.groupCount()) flagGroup.setGroupCount(group); // 容错：组号超出基础文件记录的组数时补足
+                auto& members = flagGroup.getGroupMembers(group);
+                bool replaced = false;
+                for (auto& member : members) {
+                    if (member.getName() == person.getName()) {
+                        member = std::move(person);
+                        replaced = true;
+                        break;
                     }
                 }
-                
-                // 写入执勤次数
-                out << (qint32)person.getTimes();
-                out << (qint32)person.getAll_times();
-                out << (qint32)person.getNJHAllTimes();
-                out << (qint32)person.getDXYAllTimes();
+                if (!replaced) {
+                    members.push_back(std::move(person));
+                }
             }
+            return true;
         }
         
-        // 加密数据
-        QByteArray encryptedData = encryptData(data, key);
+        // 先取出全部已有的同名队员，再插入，避免先插入的队员改变之后队员的位置
+        for (const auto& entry : changed) {
+            const int group = entry.first.getGroup();
+            if (!flagGroup.isValidGroup(group)) continue;
+            auto& members = flagGroup.getGroupMembers(group);
+            for (auto it = members.begin(); it != members.end(); ++it) {
+                if (it->getName() == entry.first.getName()) {
+                    members.erase(it);
+                    break;
+                }
+            }
+        }
+        std::stable_sort(changed.begin(), changed.end(), [](const std::pair<Person, int>& a, const std::pair<Person, int>& b) {
+            return a.first.getGroup() != b.first.getGroup() ? a.first.getGroup() < b.first.getGroup() : a.second < b.second;
+        });
+        for (auto& entry : changed) {
+            const int group = entry.first.getGroup();
+            if (group < 1 || group > Flag_group::MAX_GROUP_COUNT) continue;
+            if (group > flagGroup.groupCount()) flagGroup.setGroupCount(group); // 容错：组号超出基础文件记录的组数时补足
+            auto& members = flagGroup.getGroupMembers(group);
+            const int position = std::max(0, std::min(entry.second, static_cast<int>(members.size())));
+            members.insert(members.begin() + position, std::move(entry.first));
+        }
+        return true;
+    }
+    
+    // 回放更新日志中的全部批次；返回 false 表示日志中存在无法校验的批次（其后的批次不再回放）
+    static bool applyUpdateLog(Flag_group& flagGroup, const QString& logFilename, const QByteArray& masterKey) {
+        QList<HistoryJournal::Record> records;
+        if (!HistoryJournal::readRecords(logFilename, records)) return false;
+        for (int i = 0; i < records.size(); ++i) {
+            if (records[i].type != UPDATE_LOG_BATCH || !applyUpdateBatch(flagGroup, records[i].payload, masterKey)) {
+                qDebug() << "更新日志第" << i + 1 << "批校验失败，之后的修改未能恢复：" << logFilename;
+                return false;
+            }
+        }
+        if (!records.isEmpty()) {
+            qDebug() << "已回放更新日志：" << logFilename << "批次数：" << records.size();
+        }
+        return true;
+    }
+    
+public:
+    // 加密保存文件
+    static bool saveToFile(const Flag_group& flagGroup, const QString& filename, const QString& password = QString()) {
+        // 先写入同目录下的临时文件，落盘后原子替换目标文件（见 durableFile.h），旧文件在替换前始终完整
+        QFile tempFile;
+        if (!DurableFile::openTemp(tempFile, filename)) {
+            return false;
+        }
         
-        // 写入文件：先写入文件头标识，再写入加密数据
+        // 生成加密密钥（如果未提供密码，使用默认密钥）
+        QString actualPassword = password.isEmpty() ? getDefaultKey() : password;
+        QByteArray key = generateKey(actualPassword);
+        
+        // 写入文件：先写入文件头标识与文件随机数，再边序列化边分块加密写出
         QDataStream fileOut(&tempFile);
         fileOut.setVersion(QDataStream::Qt_5_15);
-        fileOut << QString("FLAG_GROUP_ENCRYPTED_V1"); // 文件头标识
-        fileOut << encryptedData;
-        
-        tempFile.close();
+        fileOut << QString("FLAG_GROUP_ENCRYPTED_V2"); // 文件头标识
+        QByteArray noncePrefix(CipherChunkDevice::NONCE_PREFIX_SIZE, Qt::Uninitialized);
+        QRandomGenerator::system()->fillRange(reinterpret_cast<quint32*>(noncePrefix.data()),
+                                              CipherChunkDevice::NONCE_PREFIX_SIZE / 4);
+        bool cipherOk = DurableFile::write(tempFile, noncePrefix);
+        
+        // 每一块写出前都经过故障注入点（见 cipherChunkDevice.h）
+        CipherChunkDevice cipher(&tempFile, deriveKey(key, "FLAG_GROUP_V2 encryption"),
+                                 deriveKey(key, "FLAG_GROUP_V2 authentication"), noncePrefix);
+        if (cipherOk) {
+            cipherOk = cipher.open(QIODevice::WriteOnly);
+        }
+        if (cipherOk) {
+            QDataStream out(&cipher);
+            out.setVersion(QDataStream::Qt_5_15);
+            writeMembers(out, flagGroup);
+            cipher.close(); // 写出最后一块
+            cipherOk = (out.status() == QDataStream::Ok) && !cipher.hasFailed();
+        }
         
-        // 检查数据流状态
-        if (fileOut.status() != QDataStream::Ok) {
-            qDebug() << "写入临时文件时发生错误：" << tempFilename;
+        // 检查数据流状态；写入失败（含注入的故障）时一律删除临时文件
+        if (fileOut.status() != QDataStream::Ok || !cipherOk) {
+            qDebug() << "写入临时文件时发生错误：" << tempFile.fileName();
+            tempFile.close();
             tempFile.remove(); // 删除失败的临时文件
             return false;
         }
         
-        // 如果目标文件已存在，先尝试删除（如果被占用，删除会失败）
-        QFile targetFile(filename);
-        if (targetFile.exists()) {
-            // 尝试删除旧文件，如果失败说明文件被占用
-            if (!targetFile.remove()) {
-                qDebug() << "警告：无法删除旧文件，可能被占用：" << filename;
-                // 继续尝试重命名，如果重命名也失败，说明文件确实被占用
+        // fsync 临时文件，原子替换目标文件并 fsync 目录
+        if (!DurableFile::commit(tempFile, filename)) {
+            qDebug() << "无法提交数据文件：" << filename;
+            return false;
+        }
+        
+        // 完整文件已包含全部修改，更新日志不再需要
+        QFile::remove(updateLogPath(filename));
+        return true;
+    }
+    
+    // 增量保存：只把上次保存后修改、新增、删除的队员作为一个批次追加到更新日志，写入量与名单大小无关。
+    // 基础文件不存在、名单被整体替换、修改超过半数队员或日志超过阈值时改为完整保存（同时删除日志）。
+    // 保存成功后清空名单的修改记录。
+    static bool saveIncremental(Flag_group& flagGroup, const QString& filename, const QString& password = QString()) {
+        const QString logFilename = updateLogPath(filename);
+        
+        int memberCount = 0;
+        vector<std::pair<const Person*, int>> changed; // 修改或新增的队员及其组内位置
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            if (flagGroup.isGroupMapped(i)) { // 尚未从名单文件展开的组没有修改
+                memberCount += flagGroup.memberCount(i);
+                continue;
+            }
+            const auto& members = flagGroup.getGroupMembers(i);
+            for (size_t k = 0; k < members.size(); ++k) {
+                ++memberCount;
+                if (flagGroup.isDirty(members[k])) changed.emplace_back(&members[k], static_cast<int>(k));
             }
         }
+        const int changeCount = static_cast<int>(changed.size() + flagGroup.getRemovedKeys().size());
         
-        // 原子性地将临时文件重命名为目标文件
-        if (!tempFile.rename(filename)) {
-            qDebug() << "无法将临时文件重命名为目标文件：" << filename;
-            qDebug() << "临时文件位置：" << tempFilename;
-            // 保留临时文件，用户可以手动恢复
-            return false;
+        if (flagGroup.requiresFullSave() || !QFile::exists(filename)
+            || QFileInfo(logFilename).size() >= UPDATE_LOG_COMPACT_BYTES || changeCount * 2 > memberCount) {
+            if (!saveToFile(flagGroup, filename, password)) return false;
+            flagGroup.markSaved();
+            return true;
         }
+        if (changeCount == 0) return true;
         
+        QString actualPassword = password.isEmpty() ? getDefaultKey() : password;
+        const QByteArray batch = encodeUpdateBatch(flagGroup.getRemovedKeys(), changed, generateKey(actualPassword));
+        if (batch.isEmpty() || !HistoryJournal::appendRecord(logFilename, UPDATE_LOG_BATCH, batch)) {
+            qDebug() << "写入更新日志失败：" << logFilename;
+            return false;
+        }
+        flagGroup.markSaved();
         return true;
     }
     
     // 解密读取文件
-    static bool loadFromFile(Flag_group& flagGroup, const QString& filename, const QString& password = QString()) {
+    // problems：可选，返回被跳过的损坏记录（读取仍然成功）
+    static bool loadFromFile(Flag_group& flagGroup, const QString& filename, const QString& password = QString(),
+                             QStringList* problems = nullptr) {
+        QStringList skipped;
         QFile file(filename);
         if (!file.exists()) {
             qDebug() << "文件不存在：" << filename;
@@ -191,9 +718,26 @@ public:
             return false;
         }
         
+        // 生成解密密钥（如果未提供密码，使用默认密钥）
+        QString actualPassword = password.isEmpty() ? getDefaultKey() : password;
+        QByteArray key = generateKey(actualPassword);
+        
+        // 分块认证加密格式：逐块读取、校验、解密
+        if (header == "FLAG_GROUP_ENCRYPTED_V2") {
+            bool ok = loadChunked(file, flagGroup, key, &skipped);
+            file.close();
+            if (!ok) {
+                qDebug() << "加密文件读取失败：" << filename;
+                return false;
+            }
+            finishLoad(flagGroup, filename, key, skipped.isEmpty());
+            if (problems) problems->append(skipped);
+            return true;
+        }
+        
         // 检查文件格式
         if (header != "FLAG_GROUP_ENCRYPTED_V1") {
-            qDebug() << "文件格式不正确，期望：FLAG_GROUP_ENCRYPTED_V1，实际：" << header;
+            qDebug() << "文件格式不正确，期望：FLAG_GROUP_ENCRYPTED_V1 或 FLAG_GROUP_ENCRYPTED_V2，实际：" << header;
             file.close();
             return false;
         }
@@ -209,10 +753,6 @@ public:
             return false;
         }
         
-        // 生成解密密钥（如果未提供密码，使用默认密钥）
-        QString actualPassword = password.isEmpty() ? getDefaultKey() : password;
-        QByteArray key = generateKey(actualPassword);
-        
         // 解密数据
         QByteArray data = decryptData(encryptedData, key);
         
@@ -224,72 +764,46 @@ public:
         // 从字节数组反序列化数据
         QDataStream in(data);
         in.setVersion(QDataStream::Qt_5_15);
-        
-        // 读取文件版本号
-        qint32 version;
-        in >> version;
-        
-        // 检查版本号读取是否成功
-        if (in.status() != QDataStream::Ok) {
-            qDebug() << "读取版本号失败：" << filename;
+        Flag_group loaded;
+        if (!readMembers(in, loaded, &skipped)) {
+            qDebug() << "加密文件读取失败：" << filename;
             return false;
         }
-        
-        // 读取所有队员数据
-        for (int groupIndex = 1; groupIndex <= 4; ++groupIndex) {
-            qint32 memberCount;
-            in >> memberCount;
-            
-            for (int i = 0; i < memberCount; ++i) {
-                // 读取队员唯一ID（版本3，兼容旧版本，但不再使用）
-                qint32 personId = 0;
-                if (version >= 3 && version < 4) {
-                    in >> personId;
-                }
-                
-                // 读取队员基本信息
-                QString name;
-                bool gender;
-                qint32 group, grade;
-                QString phone_number, native_place, native, dorm, school, classname, birthday;
-                bool isWork;
-                
-                in >> name >> gender >> group >> grade;
-                in >> phone_number >> native_place >> native >> dorm >> school >> classname >> birthday;
-                in >> isWork;
-                
-                // 读取时间安排
-                bool time[4][5];
-                for (int j = 0; j < 4; ++j) {
-                    for (int k = 0; k < 5; ++k) {
-                        bool timeValue;
-                        in >> timeValue;
-                        time[j][k] = timeValue;
-                    }
-                }
-                
-                // 读取执勤次数（兼容不同版本）
-                qint32 times = 0, all_times = 0;
-                qint32 njh_all_times = 0, dxy_all_times = 0;
-                in >> times >> all_times;
-                if (version >= 2) {
-                    in >> njh_all_times >> dxy_all_times;
-                }
-                
-                // 创建Person对象并添加到组
-                Person person(name.toStdString(), gender, group, grade,
-                             phone_number.toStdString(), native_place.toStdString(),
-                             native.toStdString(), dorm.toStdString(), school.toStdString(),
-                             classname.toStdString(), birthday.toStdString(), isWork,
-                             time, times, all_times, njh_all_times, dxy_all_times);
-                
-                flagGroup.addPersonToGroup(person, group);
-            }
-        }
-        
+        flagGroup = std::move(loaded);
+        finishLoad(flagGroup, filename, key, skipped.isEmpty());
+        if (problems) problems->append(skipped);
         return true;
     }
     
+    // 快速校验数据文件：解密后只核对文件头与每条记录的 CRC32C，不解码队员信息
+    // 返回校验通过的记录数（版本 6 起的字符串表也计为一条；无法解密或早于版本 5 的文件返回 -1），problems 中记录每一处损坏
+    static int verifyFile(const QString& filename, QStringList* problems = nullptr, const QString& password = QString()) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) return -1;
+        QDataStream fileIn(&file);
+        fileIn.setVersion(QDataStream::Qt_5_15);
+        QString header;
+        fileIn >> header;
+        if (fileIn.status() != QDataStream::Ok || header != "FLAG_GROUP_ENCRYPTED_V2") return -1;
+        const QByteArray key = generateKey(password.isEmpty() ? getDefaultKey() : password);
+        const QByteArray noncePrefix = file.read(CipherChunkDevice::NONCE_PREFIX_SIZE);
+        CipherChunkDevice cipher(&file, deriveKey(key, "FLAG_GROUP_V2 encryption"),
+                                 deriveKey(key, "FLAG_GROUP_V2 authentication"), noncePrefix,
+                                 ParallelTasks::workerCount());
+        if (!cipher.open(QIODevice::ReadOnly)) return -1;
+        const QByteArray plain = cipher.readAll();
+        if (!cipher.reachedEnd() || cipher.hasFailed() || plain.size() < 4) {
+            if (problems) problems->append("数据块校验失败：" + cipher.errorString());
+            return -1;
+        }
+        QDataStream in(plain);
+        in.setVersion(QDataStream::Qt_5_15);
+        qint32 version;
+        in >> version;
+        if (version < 5) return -1;
+        return RecordFraming::verify(plain.mid(4), problems);
+    }
+    
     // 加密保存彩蛋内容
     static bool saveEasterEgg(const QString& content, const QString& filename, const QString& password = QString()) {
         QFile file(filename);
@@ -3,10 +3,17 @@
 
 #pragma once
 #include <string>
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
 #include <QFile>
 #include <QTextStream>
+#include <QStringList>
 #include <QDebug>
 #include "Flag_group.h"
+#include "legacyRecordParser.h"
+#include "parallelTasks.h"
 class FlagGroupFileManager
 {
 public:
@@ -17,7 +24,7 @@ public:
         if (file.open(QIODevice::WriteOnly | QIODevice::Text)) // 检查写入文件是否能访问
         {
             QTextStream out(&file);// 打开数据文件，准备写入
-            for (int i = 1; i <= 4; ++i) { // 循环，完成全部四组的队员数据写入
+            for (int i = 1; i <= flagGroup.groupCount(); ++i) { // 循环，完成全部各组的队员数据写入
                 const auto& members = flagGroup.getGroupMembers(i);// 获取某一组的全部队员信息
                 for (const auto& person : members) {// 依次写入某一个队员的全部信息
                     out << QString::fromStdString(person.getName()) << "|" // 姓名
@@ -79,6 +86,7 @@ public:
                     int times = parts[32].toInt(); // 本次执勤次数
                     int all_times = parts[33].toInt(); // 总执勤次数
                     Person person(name, gender, group, grade, phone_number, native_place, native, dorm, school, classname, birthday, isWork, time, times, all_times);
+                    if (group > flagGroup.groupCount()) flagGroup.setGroupCount(group); // 文本格式不保存组数，按出现的组号补足
                     flagGroup.addPersonToGroup(person, group);
                 }
             }
@@ -89,4 +97,118 @@ public:
         //     qDebug() << "无法打开文件 " << filename << " 进行读取！";
         // }
     }
+    // 快速读取文件函数（用于迁移大批量旧格式数据）
+    // 将文件映射到内存后逐行原地解析（见 legacyRecordParser.h），不经过 QTextStream / QString::split。
+    // 文件较大时按行边界切分为若干段，在线程池中并行解析，再按段的顺序合并，结果与顺序读取完全一致。
+    // 与 loadFromFile 不同，格式错误的行不会被静默跳过：每一行错误以"第N行：原因"的形式写入 errors（可为空）。
+    // 返回成功读取的队员数量；文件无法打开时返回 -1。
+    static int loadFromFileFast(Flag_group& flagGroup, const QString& filename, QStringList* errors = nullptr) {
+        QFile file(filename);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "无法打开文件 " << filename << " 进行读取！";
+            return -1;
+        }
+        const qint64 size = file.size();
+        QByteArray fallback;
+        const char* data = nullptr;
+        if (size > 0) {
+            data = reinterpret_cast<const char*>(file.map(0, size));
+            if (!data) {
+                // 无法映射时退回整体读取
+                fallback = file.readAll();
+                data = fallback.constData();
+            }
+        }
+        const char* begin = data;
+        const char* end = data + size;
+        // 跳过UTF-8 BOM
+        if (size >= 3 && std::memcmp(data, "\xEF\xBB\xBF", 3) == 0) begin += 3;
+
+        // 按行边界切分：每段从某一行的行首开始
+        const int taskCount = ParallelTasks::taskCountFor(end - begin, PARALLEL_MIN_BYTES);
+        std::vector<const char*> bounds(taskCount + 1, end);
+        bounds[0] = begin;
+        for (int t = 1; t < taskCount; ++t) {
+            const char* p = qMax(bounds[t - 1], begin + (end - begin) * t / taskCount);
+            if (p > begin && p < end && p[-1] != '\n') {
+                const char* newline = static_cast<const char*>(std::memchr(p, '\n', static_cast<size_t>(end - p)));
+                p = newline ? newline + 1 : end;
+            }
+            bounds[t] = p;
+        }
+
+        std::vector<LegacyChunk> chunks(taskCount);
+        ParallelTasks::run(taskCount, [&](int t) {
+            parseLegacyRange(bounds[t], bounds[t + 1], chunks[t]);
+        });
+
+        // 按段的顺序合并：各组内队员顺序与文件中的顺序一致，错误行号换算为全文件行号
+        int loaded = 0;
+        int lineBase = 0;
+        int groupCount = flagGroup.groupCount();
+        for (const auto& chunk : chunks) {
+            for (int i = groupCount + 1; i <= LegacyRecordParser::MAX_GROUP; ++i) {
+                if (!chunk.members[i - 1].empty()) groupCount = i;
+            }
+        }
+        flagGroup.setGroupCount(groupCount);
+        for (int i = 1; i <= groupCount; ++i) {
+            size_t total = flagGroup.getGroupMembers(i).size();
+            for (const auto& chunk : chunks) total += chunk.members[i - 1].size();
+            flagGroup.getGroupMembers(i).reserve(total);
+        }
+        for (auto& chunk : chunks) {
+            // 直接追加到组容器（addPersonToGroup 每名队员都会输出调试日志，批量读取时开销明显）
+            for (int i = 1; i <= groupCount; ++i) {
+                auto& members = flagGroup.getGroupMembers(i);
+                loaded += static_cast<int>(chunk.members[i - 1].size());
+                members.insert(members.end(), std::make_move_iterator(chunk.members[i - 1].begin()),
+                               std::make_move_iterator(chunk.members[i - 1].end()));
+            }
+            if (errors) {
+                for (const auto& error : chunk.errors) {
+                    errors->append(QString("第%1行：%2").arg(lineBase + error.first).arg(QString::fromStdString(error.second)));
+                }
+            }
+            lineBase += chunk.lineCount;
+        }
+        file.close();
+        return loaded;
+    }
+
+private:
+    static constexpr qint64 PARALLEL_MIN_BYTES = 1024 * 1024; // 每段至少 1MB，小文件不拆分
+    static_assert(LegacyRecordParser::MAX_GROUP == Flag_group::MAX_GROUP_COUNT, "组号上限不一致");
+
+    // 一段文本的解析结果
+    struct LegacyChunk {
+        std::vector<Person> members[LegacyRecordParser::MAX_GROUP]; // 按组存放，组内保持文件顺序
+        std::vector<std::pair<int, std::string>> errors; // (段内行号, 原因)
+        int lineCount = 0;
+    };
+
+    static void parseLegacyRange(const char* cursor, const char* end, LegacyChunk& chunk) {
+        LegacyRecord record;
+        std::string error;
+        while (cursor < end) {
+            const char* newline = static_cast<const char*>(std::memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+            const char* lineEnd = newline ? newline : end;
+            ++chunk.lineCount;
+            const LegacyRecordParser::Result result = LegacyRecordParser::parseLine(
+                std::string_view(cursor, static_cast<size_t>(lineEnd - cursor)), record, error);
+            if (result == LegacyRecordParser::Ok) {
+                bool time[4][5] = {};
+                Person person(std::string(record.name), record.gender, record.group, record.grade,
+                              std::string(record.phone_number), std::string(record.native_place),
+                              std::string(record.native), std::string(record.dorm), std::string(record.school),
+                              std::string(record.classname), std::string(record.birthday), record.isWork,
+                              time, record.times, record.all_times);
+                person.setTimeMask(record.timeMask);
+                chunk.members[record.group - 1].push_back(std::move(person));
+            } else if (result == LegacyRecordParser::Malformed) {
+                chunk.errors.emplace_back(chunk.lineCount, error);
+            }
+            cursor = newline ? newline + 1 : end;
+        }
+    }
 };
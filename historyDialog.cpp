@@ -67,6 +67,7 @@ void HistoryDialog::updateHistoryList()
 {
     historyListWidget->clear();
     
+    // 列表只使用摘要字段，不会触发历史记录的完整解码
     const QList<ScheduleHistoryItem>& historyList = historyManager->getHistoryList();
     
     for (int i = historyList.size() - 1; i >= 0; --i) { // 从最新到最旧显示
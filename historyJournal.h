@@ -0,0 +1,105 @@
+// historyJournal.h头文件
+// 功能说明：排班历史的追加式日志文件读写
+// 每条日志记录的格式为：[魔数][类型][长度][内容][CRC32C校验值]，新记录只追加到文件末尾，不改写已有内容，写入后立即落盘。
+// 程序崩溃时最后一条记录可能只写入了一半，读取时校验失败的尾部记录会被截断丢弃，之前的记录不受影响。
+
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QList>
+#include <QDataStream>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include "durableFile.h"
+#include "recordFraming.h"
+
+class HistoryJournal
+{
+public:
+    // 日志记录类型
+    enum RecordType : quint8 {
+        RecordSessionBegin = 1,  // 会话开始（内容：会话编号）
+        RecordAdd = 2,           // 新增一条历史记录
+        RecordRemove = 3,        // 删除一条历史记录（墓碑：下标 + 制表时间）
+        RecordSessionAbort = 4,  // 会话放弃（用户退出时选择「不保存」，内容：会话编号）
+        RecordAddGroups = 5,     // 新增一条历史记录（名单中带组数与全部执勤地点的次数，见 scheduleHistory.h 版本8）
+        RecordAddLocations = 6   // 新增一条历史记录（名单中另带执勤地点数与64位执勤时间，见 scheduleHistory.h 版本9）
+    };
+
+    struct Record {
+        quint8 type;
+        QByteArray payload;
+    };
+
+    // CRC32C（见 recordFraming.h）
+    static quint32 crc32c(const char* data, qint64 length, quint32 crc = 0) {
+        return RecordFraming::crc32c(data, length, crc);
+    }
+
+    // 一条记录在日志文件中占用的字节数
+    static qint64 recordSize(const QByteArray& payload) {
+        return RECORD_OVERHEAD + payload.size();
+    }
+
+    // 向日志文件末尾追加一条记录（文件不存在时自动创建）
+    static bool appendRecord(const QString& path, quint8 type, const QByteArray& payload) {
+        QByteArray frame;
+        QDataStream out(&frame, QIODevice::WriteOnly);
+        out << RECORD_MAGIC << type << static_cast<quint32>(payload.size());
+        out.writeRawData(payload.constData(), payload.size());
+        // 校验范围：类型、长度与内容（魔数之后的全部字节）
+        out << crc32c(frame.constData() + 4, frame.size() - 4);
+
+        QFile f(path);
+        const bool created = !f.exists();
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Append)) {
+            qDebug() << "无法打开历史日志：" << path;
+            return false;
+        }
+        // 记录落盘后才返回成功；新建的日志文件同时刷新所在目录
+        bool ok = DurableFile::write(f, frame) && DurableFile::syncFile(f);
+        f.close();
+        if (ok && created) ok = DurableFile::syncDirectory(QFileInfo(path).absolutePath());
+        if (!ok) {
+            qDebug() << "写入历史日志失败：" << path;
+        }
+        return ok;
+    }
+
+    // 读取日志文件中的全部有效记录；遇到损坏或不完整的记录时停止读取，并将文件截断到最后一条有效记录之后
+    static bool readRecords(const QString& path, QList<Record>& records) {
+        QFile f(path);
+        if (!f.exists()) return true;
+        if (!f.open(QIODevice::ReadWrite)) {
+            qDebug() << "无法打开历史日志：" << path;
+            return false;
+        }
+        const QByteArray data = f.readAll();
+        qint64 pos = 0;
+        while (data.size() - pos >= RECORD_OVERHEAD) {
+            QDataStream in(data.mid(pos, 9));
+            quint32 magic, length;
+            quint8 type;
+            in >> magic >> type >> length;
+            if (magic != RECORD_MAGIC || length > static_cast<quint64>(data.size() - pos - RECORD_OVERHEAD)) break;
+            const char* body = data.constData() + pos + 4;
+            QDataStream crcIn(data.mid(pos + 9 + length, 4));
+            quint32 storedCrc;
+            crcIn >> storedCrc;
+            if (storedCrc != crc32c(body, 5 + length)) break;
+            records.append(Record{type, data.mid(pos + 9, length)});
+            pos += RECORD_OVERHEAD + length;
+        }
+        if (pos < data.size()) {
+            qDebug() << "历史日志尾部存在不完整记录，已截断：" << path << pos << "/" << data.size();
+            f.resize(pos);
+        }
+        f.close();
+        return true;
+    }
+
+private:
+    static constexpr quint32 RECORD_MAGIC = 0x53484A31; // "SHJ1"
+    static constexpr qint64 RECORD_OVERHEAD = 4 + 1 + 4 + 4; // 魔数 + 类型 + 长度 + 校验值
+};
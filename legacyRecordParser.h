@@ -0,0 +1,115 @@
+// legacyRecordParser.h头文件
+// 功能说明：旧版 data.txt 格式（每行一名队员，34个字段以 '|' 分隔）的快速解析
+// 解析在原始字节上进行：字段以 string_view 指向输入缓冲区，整数直接从字节转换，20位空闲时间直接拼成掩码，
+// 不产生任何中间字符串。格式错误的行返回具体原因，由调用方连同行号一起报告。
+// 本文件不依赖Qt，可被顺序加载与并行加载共用。
+
+#pragma once
+#include <charconv>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+struct LegacyRecord {
+    // 与 data.txt 字段顺序一致
+    std::string_view name;
+    bool gender = false;
+    int group = 0;
+    int grade = 0;
+    std::string_view phone_number;
+    std::string_view native_place;
+    std::string_view native;
+    std::string_view dorm;
+    std::string_view school;
+    std::string_view classname;
+    std::string_view birthday;
+    bool isWork = false;
+    std::uint32_t timeMask = 0; // 位 (row-1)*5+(column-1) 对应 Person::getTime(row, column)
+    int times = 0;
+    int all_times = 0;
+};
+
+class LegacyRecordParser
+{
+public:
+    static constexpr int FIELD_COUNT = 12 + 20 + 2;
+    static constexpr int MAX_GROUP = 20; // 组号上限，与 Flag_group::MAX_GROUP_COUNT 一致
+
+    // 解析结果
+    enum Result { Ok, Blank, Malformed };
+
+    // 解析一行（不含换行符，允许带有行尾 '\r'）；返回 Malformed 时 error 中给出原因
+    static Result parseLine(std::string_view line, LegacyRecord& record, std::string& error) {
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.find_first_not_of(" \t") == std::string_view::npos) return Blank;
+
+        std::string_view fields[FIELD_COUNT];
+        int count = 0;
+        std::size_t start = 0;
+        while (true) {
+            const std::size_t bar = line.find('|', start);
+            if (count == FIELD_COUNT) {
+                error = "字段数量超过 " + std::to_string(FIELD_COUNT) + " 个";
+                return Malformed;
+            }
+            if (bar == std::string_view::npos) {
+                fields[count++] = line.substr(start);
+                break;
+            }
+            fields[count++] = line.substr(start, bar - start);
+            start = bar + 1;
+        }
+        if (count != FIELD_COUNT) {
+            error = "字段数量为 " + std::to_string(count) + "，应为 " + std::to_string(FIELD_COUNT);
+            return Malformed;
+        }
+
+        record.name = fields[0];
+        if (!parseFlag(fields[1], record.gender)) return fieldError(error, "性别", fields[1]);
+        if (!parseInt(fields[2], record.group)) return fieldError(error, "组别", fields[2]);
+        if (record.group < 1 || record.group > MAX_GROUP) return fieldError(error, "组别", fields[2]);
+        if (!parseInt(fields[3], record.grade)) return fieldError(error, "年级", fields[3]);
+        record.phone_number = fields[4];
+        record.native_place = fields[5];
+        record.native = fields[6];
+        record.dorm = fields[7];
+        record.school = fields[8];
+        record.classname = fields[9];
+        record.birthday = fields[10];
+        if (!parseFlag(fields[11], record.isWork)) return fieldError(error, "是否参与排班", fields[11]);
+        std::uint32_t mask = 0;
+        for (int bit = 0; bit < 20; ++bit) {
+            const std::string_view digit = fields[12 + bit];
+            if (digit.size() != 1 || (digit[0] != '0' && digit[0] != '1')) {
+                return fieldError(error, "空闲时间第" + std::to_string(bit + 1) + "位", digit);
+            }
+            mask |= static_cast<std::uint32_t>(digit[0] - '0') << bit;
+        }
+        record.timeMask = mask;
+        if (!parseInt(fields[32], record.times)) return fieldError(error, "本次执勤次数", fields[32]);
+        if (!parseInt(fields[33], record.all_times)) return fieldError(error, "总执勤次数", fields[33]);
+        return Ok;
+    }
+
+private:
+    static bool parseInt(std::string_view text, int& value) {
+        if (text.empty()) return false;
+        const char* first = text.data();
+        const char* last = text.data() + text.size();
+        if (*first == '+') ++first;
+        const auto result = std::from_chars(first, last, value);
+        return result.ec == std::errc() && result.ptr == last;
+    }
+
+    static bool parseFlag(std::string_view text, bool& value) {
+        int number;
+        if (!parseInt(text, number) || (number != 0 && number != 1)) return false;
+        value = (number == 1);
+        return true;
+    }
+
+    static Result fieldError(std::string& error, const std::string& field, std::string_view text) {
+        error = field + "无效：\"" + std::string(text) + "\"";
+        return Malformed;
+    }
+};
@@ -2,6 +2,8 @@
 // 是系统的入口，用于启动系统。
 // 初始化并启动SystemWindow
 #include "systemwindow.h"
+#include "crashConsistencyHarness.h"
+#include "rosterStorageBenchmark.h"
 #include <QApplication>
 #include <QMessageBox>
 #include <QSharedMemory>
@@ -15,6 +17,31 @@ int main(int argc, char *argv[])
     QSharedMemory singleton("WHUT_FlagSystem_v1.1");
 
     QApplication a(argc, argv);
+
+    // 开发自检：以 --check-crash-consistency 启动时只运行数据文件写入流程的崩溃一致性检查（见 crashConsistencyHarness.h），
+    // 不打开主界面、不读写正式数据文件；全部通过时返回 0
+    if (a.arguments().contains("--check-crash-consistency")) {
+        QStringList report;
+        const bool passed = CrashConsistencyHarness::runAll(&report);
+        if (passed) {
+            QMessageBox::information(nullptr, "崩溃一致性检查", "全部通过\n\n" + report.join('\n'));
+        } else {
+            QMessageBox::warning(nullptr, "崩溃一致性检查", "存在未通过的步骤\n\n" + report.join('\n'));
+        }
+        return passed ? 0 : 1;
+    }
+
+    // 开发自检：以 --benchmark-storage [人数] 启动时在临时目录中对比加密文件与 SQLite 两种名单存储方式的耗时（见 rosterStorageBenchmark.h）
+    const int benchmarkArgument = a.arguments().indexOf("--benchmark-storage");
+    if (benchmarkArgument >= 0) {
+        bool ok = false;
+        int memberCount = a.arguments().value(benchmarkArgument + 1).toInt(&ok);
+        if (!ok || memberCount <= 0) memberCount = 2000;
+        const QStringList report = RosterStorageBenchmark::run(memberCount);
+        QMessageBox::information(nullptr, "存储方式耗时对比", QString("共 %1 名队员\n\n").arg(memberCount) + report.join('\n'));
+        return 0;
+    }
+
     SystemWindow w;
 
     // 添加错误检查
@@ -0,0 +1,776 @@
+// mappedRoster.h头文件
+// 功能说明：为加载速度设计的二进制队员名单格式（./data/data.roster），通过内存映射直接读取
+// 文件在整个会话中保持打开（见 SystemWindow）：名单挂接到文件后（见 Flag_group::attachMappedRoster），各组在需要修改时才展开为 Person，
+// 列表、筛选与排班候选通过 visitMember 在映射内存上原地读取记录，不为每个字段分配 QString / std::string。
+// 文件结构（版本5）：
+//   文件头（64字节）：魔数 "FGROSTER"、格式版本、头部长度、记录长度、组数、执勤地点数、更新状态、队员数、
+//                    顺序表的 CRC32C、顺序表的位置、数据区末尾、上次完整写入时的数据区末尾
+//   数据区：紧接文件头，依次追加写入的记录、字符串与顺序表
+//     记录：每名队员一条定长记录，排班所需的字段（组别、性别、年级、执勤时间掩码、执勤次数）直接存放在记录中；
+//          姓名等档案文本以UTF-8保存为字符串，记录中只保存（文件内偏移，长度），同一次写入中相同的字符串只保存一份；
+//          南鉴湖、东西院之外其他执勤地点的累计次数同样存放为字符串。记录末尾为覆盖记录本身及其引用的全部字符串的 CRC32C
+//     顺序表：按组依次排列的各队员记录的文件内偏移，各组人数由记录中的组别得到
+// 增量保存（见 save）：内容未变的队员沿用原记录；档案文本未变的队员原地改写记录；其余队员的记录与字符串追加到数据区末尾；
+// 队员增删或顺序变化时追加新的顺序表，最后改写文件头。追加的内容超过上次完整写入时的大小后整体重写一次（临时文件 + 重命名）。
+// 保存数据时先把更新状态置为“正在更新”（见 markUpdating，在存储后端保存之前调用），名单文件写完后随文件头一起清除；
+// 状态未清除的文件（保存过程中程序中断）在启动时不被使用，改从存储后端读取。
+// 版本1~4的文件仍可读取（记录区与字符串表各自连续存放，整体校验 CRC32C），第一次保存时整体重写为版本5。
+// 注意：该格式不加密（字符串为明文），仅在 ./data/data.roster 已存在时启用，详见 README。
+// 所有整数均以小端序保存。
+
+#pragma once
+#include <QString>
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "Flag_group.h"
+#include "stringPool.h"
+#include "durableFile.h"
+#include "recordFraming.h"
+
+class MappedRoster
+{
+public:
+    // 版本2：文件头增加记录区与字符串表的校验值；版本3：组数可变，记录增加其他执勤地点的次数；
+    // 版本4：文件头增加执勤地点数，时间掩码扩展为64位；
+    // 版本5：记录、字符串与顺序表追加写入，支持原地增量保存；每条记录带校验值，文件头带更新状态（仍可读取版本1~4）
+    static constexpr quint32 FORMAT_VERSION = 5;
+    static constexpr quint32 HEADER_SIZE = 64;
+    static constexpr quint32 RECORD_SIZE = 112;
+    static constexpr quint32 UNCHECKED_RECORD_SIZE = 104; // 版本3~4 的记录长度（无校验值）
+    static constexpr quint32 LEGACY_RECORD_SIZE = 96;     // 版本1~2 的记录长度
+
+    // 记录中的档案字符串（顺序即 (偏移,长度) 在记录中的排列顺序）
+    enum StringField {
+        StrName = 0, StrPhone, StrNativePlace, StrNative, StrDorm, StrSchool, StrClassname, StrBirthday,
+        StringFieldCount
+    };
+
+    // 单名队员记录的只读视图：直接指向映射内存，访问函数与 Person 同名
+    class RecordView
+    {
+    public:
+        // strings：记录中文本偏移的基准（版本5为文件开头，之前的版本为字符串表开头）
+        RecordView(const uchar* record, const char* strings, bool hasExtraLocations, bool hasTimeHigh)
+            : r(record), s(strings), extra(hasExtraLocations), wide(hasTimeHigh) {}
+
+        std::string_view nameView() const { return text(StrName); }
+        std::string_view textView(StringField field) const { return text(field); }
+
+        std::string getName() const { return std::string(text(StrName)); }
+        bool getGender() const { return r[OFF_FLAGS] & FLAG_GENDER; }
+        int getGroup() const { return r[OFF_GROUP]; }
+        int getGrade() const { return qFromLittleEndian<qint32>(r + OFF_GRADE); }
+        bool getIsWork() const { return r[OFF_FLAGS] & FLAG_IS_WORK; }
+        std::uint64_t getTimeMask() const {
+            const std::uint64_t high = wide ? qFromLittleEndian<quint32>(r + OFF_TIME_HIGH) : 0;
+            return qFromLittleEndian<quint32>(r + OFF_TIME) | (high << 32);
+        }
+        // 与 Person::getTime 一致：row 行、column 列，最小值为1
+        bool getTime(int row, int column) const {
+            if (row < 1 || row > Person::MAX_TIME_ROWS || column < 1 || column > Person::DAY_COUNT) return false;
+            return (getTimeMask() >> ((row - 1) * Person::DAY_COUNT + (column - 1))) & 1u;
+        }
+        int getTimes() const { return qFromLittleEndian<qint32>(r + OFF_TIMES); }
+        int getAll_times() const { return qFromLittleEndian<qint32>(r + OFF_ALL_TIMES); }
+        int getNJHAllTimes() const { return qFromLittleEndian<qint32>(r + OFF_NJH_TIMES); }
+        int getDXYAllTimes() const { return qFromLittleEndian<qint32>(r + OFF_DXY_TIMES); }
+        // 执勤地点数与各地点的累计次数（与 Person 一致，地点 0、1 为南鉴湖、东西院）
+        int getLocationCount() const { return Person::DEFAULT_LOCATION_COUNT + extraLocationCount(); }
+        int getLocationAllTimes(int location) const {
+            if (location == Person::NJH) return getNJHAllTimes();
+            if (location == Person::DXY) return getDXYAllTimes();
+            const int k = location - Person::DEFAULT_LOCATION_COUNT;
+            if (k < 0 || k >= extraLocationCount()) return 0;
+            return qFromLittleEndian<qint32>(s + qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS) + k * 4);
+        }
+        std::string getPhone_number() const { return std::string(text(StrPhone)); }
+        std::string getNative_place() const { return std::string(text(StrNativePlace)); }
+        std::string getNative() const { return std::string(text(StrNative)); }
+        std::string getDorm() const { return std::string(text(StrDorm)); }
+        std::string getSchool() const { return std::string(text(StrSchool)); }
+        std::string getClassname() const { return std::string(text(StrClassname)); }
+        std::string getBirthday() const { return std::string(text(StrBirthday)); }
+        // 学院、班级在字符串池中的编号（与 Person 一致，供位图索引按取值区分，见 rosterIndex.h）
+        StringPool::Id getSchoolId() const { return StringPool::shared().intern(text(StrSchool)); }
+        StringPool::Id getClassnameId() const { return StringPool::shared().intern(text(StrClassname)); }
+
+        // 展开为完整的 Person（需要修改队员信息时使用）
+        Person toPerson() const {
+            bool time[4][5] = {};
+            Person person(getName(), getGender(), getGroup(), getGrade(),
+                getPhone_number(), getNative_place(), getNative(), getDorm(),
+                getSchool(), getClassname(), getBirthday(), getIsWork(), time,
+                getTimes(), getAll_times(), getNJHAllTimes(), getDXYAllTimes());
+            person.setTimeMask(getTimeMask());
+            for (int location = Person::DEFAULT_LOCATION_COUNT; location < getLocationCount(); ++location) {
+                person.setLocationAllTimes(location, getLocationAllTimes(location));
+            }
+            return person;
+        }
+
+    private:
+        friend class MappedRoster;
+
+        int extraLocationCount() const {
+            return extra ? static_cast<int>(qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS + 4)) : 0;
+        }
+
+        std::string_view text(int field) const {
+            const quint32 offset = qFromLittleEndian<quint32>(r + OFF_STRINGS + field * 8);
+            const quint32 length = qFromLittleEndian<quint32>(r + OFF_STRINGS + field * 8 + 4);
+            return std::string_view(s + offset, length);
+        }
+
+        const uchar* r;
+        const char* s;
+        bool extra; // 记录中是否有其他地点的次数（版本3）
+        bool wide;  // 记录中是否有时间掩码的高32位（版本4）
+    };
+
+    MappedRoster() {}
+    ~MappedRoster() { close(); }
+    MappedRoster(const MappedRoster&) = delete;
+    MappedRoster& operator=(const MappedRoster&) = delete;
+
+    // 映射并校验文件，并为每条记录预留一个修订号；失败时返回false并保持关闭状态
+    bool open(const QString& filename) {
+        if (!openFile(filename, true)) return false;
+        const std::uint64_t first = Person::reserveRevisions(static_cast<std::uint64_t>(memberCount()));
+        revisions.resize(static_cast<size_t>(memberCount()));
+        for (size_t k = 0; k < revisions.size(); ++k) revisions[k] = first + k;
+        return true;
+    }
+
+    void close() {
+        if (data && file.isOpen()) file.unmap(data);
+        data = nullptr;
+        if (file.isOpen()) file.close();
+        heldBytes.clear();
+        writable = false;
+        updating = false;
+        layout = Layout();
+        revisions.clear();
+    }
+
+    bool isOpen() const { return data != nullptr; }
+
+    // 组数
+    int groups() const { return static_cast<int>(layout.groupCount.size()); }
+    // 执勤地点数（版本4之前的文件为默认的两个地点）
+    int locations() const { return layout.locationCount; }
+
+    // 指定组的队员数（组号 1 ~ groups()）
+    int groupSize(int groupNumber) const {
+        return (groupNumber >= 1 && groupNumber <= groups()) ? static_cast<int>(layout.groupCount[groupNumber - 1]) : 0;
+    }
+
+    int memberCount() const {
+        return layout.groupCount.empty() ? 0 : static_cast<int>(layout.groupStart.back() + layout.groupCount.back());
+    }
+
+    // 指定组的第 index 名队员（调用方保证下标有效）
+    RecordView record(int groupNumber, int index) const {
+        return recordAt(layout.groupStart[groupNumber - 1] + static_cast<quint64>(index));
+    }
+
+    // 指定组第 index 名队员的记录内容对应的修订号：展开的 Person 沿用该修订号，保存时修订号一致的队员沿用原记录
+    std::uint64_t recordRevision(int groupNumber, int index) const {
+        return revisions[layout.groupStart[groupNumber - 1] + static_cast<quint64>(index)];
+    }
+
+    // 读取名单中的一名队员而不展开其所在的组：尚未展开的组传入 RecordView，已展开的组传入 Person（两者的读取函数同名），
+    // 返回 visit 的返回值
+    template <typename Visitor>
+    static auto visitMember(const Flag_group& flagGroup, int groupNumber, int index, Visitor&& visit) {
+        if (flagGroup.isGroupMapped(groupNumber)) {
+            return visit(flagGroup.mappedRoster()->record(groupNumber, index));
+        }
+        return visit(flagGroup.getGroupMembers(groupNumber)[index]);
+    }
+
+    // 标记文件内容即将落后于存储后端（保存数据时在存储后端保存之前调用）；状态随 save 写出的文件头清除。
+    // 尚未打开、只读或旧版本的文件没有更新状态可写，直接返回 true（这些文件由 save 整体重写为版本5）
+    bool markUpdating() {
+        if (!isOpen() || !writable || layout.version != FORMAT_VERSION || updating) return true;
+        uchar state[4];
+        qToLittleEndian<quint32>(STATE_UPDATING, state);
+        if (!file.seek(HEAD_STATE)
+            || !DurableFile::write(file, QByteArray::fromRawData(reinterpret_cast<const char*>(state), 4))
+            || !DurableFile::syncFile(file)) {
+            qDebug() << "无法标记名单文件正在更新：" << file.fileName();
+            return false;
+        }
+        updating = true;
+        return true;
+    }
+
+    // 保存名单：已打开的版本5文件原地增量更新；尚未打开、旧版本、只读或追加的内容过多时整体重写。
+    // 保存后文件保持打开（重写后重新映射），已挂接的名单中尚未展开的组仍从本文件读取
+    bool save(const Flag_group& flagGroup, const QString& filename) {
+        if (isOpen() && writable && layout.version == FORMAT_VERSION && file.fileName() == filename) {
+            switch (saveInPlace(flagGroup)) {
+            case InPlaceSaved:
+                return true;
+            case InPlaceTooLarge:
+                qDebug() << "名单文件追加的内容过多，整体重写：" << filename;
+                break;
+            case InPlaceFailed:
+                qDebug() << "名单文件增量保存失败，整体重写：" << filename;
+                break;
+            }
+        }
+        return rewrite(flagGroup, filename);
+    }
+
+private:
+    static constexpr char MAGIC[9] = "FGROSTER";
+    static constexpr quint64 MAX_FILE_SIZE = 0xFFFFFFFFull;   // 记录中的文本偏移为 quint32
+    static constexpr quint64 REWRITE_SLACK = 1024 * 1024;     // 追加超过 上次完整写入的大小 + 该值 后整体重写
+
+    // 文件头中版本5新增或改变含义的字段
+    static constexpr int HEAD_STATE = 28;      // quint32 更新状态
+    static constexpr int HEAD_MEMBERS = 32;    // quint32 队员数（顺序表长度）
+    static constexpr int HEAD_CRC = 36;        // quint32 顺序表的 CRC32C（版本2~4：记录区与字符串表的 CRC32C）
+    static constexpr int HEAD_ORDER = 40;      // quint64 顺序表的位置（版本1~4：记录区的位置）
+    static constexpr int HEAD_DATA_END = 48;   // quint64 数据区末尾（版本1~4：字符串表的位置）
+    static constexpr int HEAD_COMPACTED = 56;  // quint64 上次完整写入时的数据区末尾（版本1~4：字符串表长度）
+    static constexpr quint32 STATE_COMPLETE = 0;
+    static constexpr quint32 STATE_UPDATING = 1;
+
+    // 记录内各字段的偏移
+    static constexpr int OFF_GROUP = 0;       // quint8 组别
+    static constexpr int OFF_FLAGS = 1;       // quint8 性别 / 是否在岗
+    static constexpr int OFF_GRADE = 4;       // qint32 年级
+    static constexpr int OFF_TIME = 8;        // quint32 执勤时间掩码低32位（位 (row-1)*5+(column-1)）
+    static constexpr int OFF_TIMES = 12;      // qint32 本轮执勤次数
+    static constexpr int OFF_ALL_TIMES = 16;  // qint32 总执勤次数
+    static constexpr int OFF_NJH_TIMES = 20;  // qint32 南鉴湖累计次数
+    static constexpr int OFF_DXY_TIMES = 24;  // qint32 东西院累计次数
+    static constexpr int OFF_TIME_HIGH = 28;  // 版本4：quint32 执勤时间掩码高32位
+    static constexpr int OFF_STRINGS = 32;    // 8 组 (quint32 偏移, quint32 长度)
+    static constexpr int OFF_EXTRA_LOCATIONS = 96; // 版本3：(quint32 偏移, quint32 个数) 其他执勤地点的累计次数
+    static constexpr int OFF_CRC = 104;       // 版本5：quint32 记录（此前的部分）及其引用的全部字符串的 CRC32C
+    static constexpr uchar FLAG_GENDER = 0x01;
+    static constexpr uchar FLAG_IS_WORK = 0x02;
+
+    // 打开的文件的结构（校验通过后整体替换）
+    struct Layout {
+        quint32 version = FORMAT_VERSION;
+        int locationCount = Person::DEFAULT_LOCATION_COUNT; // 执勤地点数
+        std::vector<quint64> groupStart;  // 各组第一条记录的序号
+        std::vector<quint64> groupCount;
+        const uchar* records = nullptr;   // 版本1~4：记录区
+        quint32 recordSize = RECORD_SIZE; // 版本1~4：记录长度（版本1~2 为 LEGACY_RECORD_SIZE）
+        const char* strings = nullptr;    // 记录中文本偏移的基准
+        const uchar* order = nullptr;     // 版本5：顺序表
+        quint64 dataEnd = 0;              // 版本5：数据区末尾
+        quint64 compactedEnd = 0;         // 版本5：上次完整写入时的数据区末尾
+    };
+
+    // 记录中引用的一段文本：（文件内偏移，长度）
+    struct TextRef {
+        quint32 offset = 0;
+        quint32 length = 0;
+    };
+
+    // 追加写入的数据：记录与字符串依次排列，base 为第一个字节在文件中的位置；同一次写入中相同的字符串只写一份
+    struct Appender {
+        quint64 base = 0;
+        QByteArray bytes;
+        std::unordered_map<std::string, quint32> texts;
+
+        quint64 end() const { return base + static_cast<quint64>(bytes.size()); }
+
+        TextRef text(std::string_view value) {
+            if (value.empty()) return TextRef();
+            auto it = texts.find(std::string(value));
+            if (it == texts.end()) {
+                it = texts.emplace(std::string(value), static_cast<quint32>(end())).first;
+                bytes.append(value.data(), static_cast<qsizetype>(value.size()));
+            }
+            return {it->second, static_cast<quint32>(value.size())};
+        }
+    };
+
+    enum InPlaceResult { InPlaceSaved, InPlaceTooLarge, InPlaceFailed };
+
+    // 打开并映射文件（可写时以读写方式打开，供增量保存使用）；verify 为 false 时不重新计算记录的校验值（刚由本类写出的文件）
+    bool openFile(const QString& filename, bool verify) {
+        close();
+        if (!QFile::exists(filename)) return false;
+        file.setFileName(filename);
+        writable = file.open(QIODevice::ReadWrite);
+        if (!writable && !file.open(QIODevice::ReadOnly)) {
+            qDebug() << "无法打开名单文件：" << filename;
+            return false;
+        }
+        const qint64 size = file.size();
+        if (size < HEADER_SIZE) {
+            qDebug() << "名单文件过短：" << filename;
+            close();
+            return false;
+        }
+        data = file.map(0, size);
+        if (!data) {
+            qDebug() << "无法映射名单文件：" << filename;
+            close();
+            return false;
+        }
+        Layout parsed;
+        if (!validate(data, static_cast<quint64>(size), verify, parsed)) {
+            qDebug() << "名单文件格式不正确：" << filename;
+            close();
+            return false;
+        }
+        layout = std::move(parsed);
+        return true;
+    }
+
+    // 写入失败或重写后无法重新打开时，直接使用内存中的文件内容（已挂接的名单仍能展开尚未展开的组）；下次保存时整体重写
+    void holdBytes(const QByteArray& bytes) {
+        close();
+        heldBytes = bytes;
+        data = reinterpret_cast<uchar*>(heldBytes.data());
+        Layout parsed;
+        validate(data, static_cast<quint64>(heldBytes.size()), false, parsed);
+        layout = std::move(parsed);
+    }
+
+    RecordView recordAt(quint64 k) const {
+        if (layout.order) {
+            return RecordView(data + recordOffset(k), layout.strings, true, true);
+        }
+        return RecordView(layout.records + k * layout.recordSize, layout.strings, layout.version >= 3, layout.version >= 4);
+    }
+
+    // 版本5：第 k 条记录在文件中的位置
+    quint64 recordOffset(quint64 k) const { return qFromLittleEndian<quint64>(layout.order + k * 8); }
+
+    // 队员的档案文本（Person 返回副本，RecordView 直接指向映射内存）
+    static std::array<std::string, StringFieldCount> memberTexts(const Person& person) {
+        return {person.getName(), person.getPhone_number(), person.getNative_place(), person.getNative(),
+                person.getDorm(), person.getSchool(), person.getClassname(), person.getBirthday()};
+    }
+    static std::array<std::string_view, StringFieldCount> memberTexts(const RecordView& view) {
+        std::array<std::string_view, StringFieldCount> texts;
+        for (int f = 0; f < StringFieldCount; ++f) texts[f] = view.text(f);
+        return texts;
+    }
+
+    // 其他执勤地点的累计次数：按 qint32 小端序连续存放
+    template <typename Member>
+    static std::string extraLocationBytes(const Member& member) {
+        const int extraLocations = member.getLocationCount() - Person::DEFAULT_LOCATION_COUNT;
+        std::string values(static_cast<size_t>(std::max(0, extraLocations)) * 4, '\0');
+        for (int k = 0; k < extraLocations; ++k) {
+            qToLittleEndian<qint32>(member.getLocationAllTimes(Person::DEFAULT_LOCATION_COUNT + k), &values[k * 4]);
+        }
+        return values;
+    }
+
+    // 记录的校验值：记录中校验值之前的部分，以及记录引用的全部文本
+    template <typename Texts>
+    static quint32 recordCrc(const uchar* record, const Texts& texts, std::string_view extra) {
+        quint32 crc = RecordFraming::crc32c(reinterpret_cast<const char*>(record), OFF_CRC);
+        for (const auto& text : texts) {
+            crc = RecordFraming::crc32c(text.data(), static_cast<qint64>(text.size()), crc);
+        }
+        return RecordFraming::crc32c(extra.data(), static_cast<qint64>(extra.size()), crc);
+    }
+
+    // 按队员内容填写一条版本5记录：组别取队员所在的组，refs 为各档案文本与其他地点次数（最后一项）在文件中的位置
+    template <typename Member, typename Texts>
+    static void fillRecord(uchar* record, int groupNumber, const Member& member, const TextRef* refs,
+                           const Texts& texts, const std::string& extra) {
+        std::memset(record, 0, RECORD_SIZE);
+        record[OFF_GROUP] = static_cast<uchar>(groupNumber);
+        record[OFF_FLAGS] = (member.getGender() ? FLAG_GENDER : 0) | (member.getIsWork() ? FLAG_IS_WORK : 0);
+        qToLittleEndian<qint32>(member.getGrade(), record + OFF_GRADE);
+        qToLittleEndian<quint32>(static_cast<quint32>(member.getTimeMask()), record + OFF_TIME);
+        qToLittleEndian<quint32>(static_cast<quint32>(member.getTimeMask() >> 32), record + OFF_TIME_HIGH);
+        qToLittleEndian<qint32>(member.getTimes(), record + OFF_TIMES);
+        qToLittleEndian<qint32>(member.getAll_times(), record + OFF_ALL_TIMES);
+        qToLittleEndian<qint32>(member.getNJHAllTimes(), record + OFF_NJH_TIMES);
+        qToLittleEndian<qint32>(member.getDXYAllTimes(), record + OFF_DXY_TIMES);
+        for (int f = 0; f < StringFieldCount; ++f) {
+            qToLittleEndian<quint32>(refs[f].offset, record + OFF_STRINGS + f * 8);
+            qToLittleEndian<quint32>(refs[f].length, record + OFF_STRINGS + f * 8 + 4);
+        }
+        qToLittleEndian<quint32>(refs[StringFieldCount].offset, record + OFF_EXTRA_LOCATIONS);
+        qToLittleEndian<quint32>(static_cast<quint32>(extra.size() / 4), record + OFF_EXTRA_LOCATIONS + 4);
+        qToLittleEndian<quint32>(recordCrc(record, texts, extra), record + OFF_CRC);
+    }
+
+    // 追加一名队员的字符串与记录，返回记录在文件中的位置
+    template <typename Member>
+    static quint64 appendMember(Appender& out, int groupNumber, const Member& member) {
+        const auto texts = memberTexts(member);
+        const std::string extra = extraLocationBytes(member);
+        TextRef refs[StringFieldCount + 1];
+        for (int f = 0; f < StringFieldCount; ++f) refs[f] = out.text(texts[f]);
+        refs[StringFieldCount] = out.text(extra);
+        uchar record[RECORD_SIZE];
+        fillRecord(record, groupNumber, member, refs, texts, extra);
+        const quint64 offset = out.end();
+        out.bytes.append(reinterpret_cast<const char*>(record), RECORD_SIZE);
+        return offset;
+    }
+
+    static QByteArray orderTable(const std::vector<quint64>& order) {
+        QByteArray bytes(static_cast<qsizetype>(order.size() * 8), '\0');
+        for (size_t k = 0; k < order.size(); ++k) {
+            qToLittleEndian<quint64>(order[k], bytes.data() + k * 8);
+        }
+        return bytes;
+    }
+
+    static void fillHeader(uchar* header, const Flag_group& flagGroup, const std::vector<quint64>& order,
+                           quint64 orderOffset, quint32 orderCrc, quint64 dataEnd, quint64 compactedEnd) {
+        std::memset(header, 0, HEADER_SIZE);
+        std::memcpy(header, MAGIC, 8);
+        qToLittleEndian<quint32>(FORMAT_VERSION, header + 8);
+        qToLittleEndian<quint32>(HEADER_SIZE, header + 12);
+        qToLittleEndian<quint32>(RECORD_SIZE, header + 16);
+        qToLittleEndian<quint32>(static_cast<quint32>(flagGroup.groupCount()), header + 20);
+        qToLittleEndian<quint32>(static_cast<quint32>(flagGroup.locationCount()), header + 24);
+        qToLittleEndian<quint32>(STATE_COMPLETE, header + HEAD_STATE);
+        qToLittleEndian<quint32>(static_cast<quint32>(order.size()), header + HEAD_MEMBERS);
+        qToLittleEndian<quint32>(orderCrc, header + HEAD_CRC);
+        qToLittleEndian<quint64>(orderOffset, header + HEAD_ORDER);
+        qToLittleEndian<quint64>(dataEnd, header + HEAD_DATA_END);
+        qToLittleEndian<quint64>(compactedEnd, header + HEAD_COMPACTED);
+    }
+
+    // 原地增量保存（见文件开头）。写入顺序：追加的数据与顺序表 -> 原地改写的记录 -> 落盘 -> 文件头 -> 落盘；
+    // 文件头写完之前更新状态一直是“正在更新”，中断时下次启动不使用该文件
+    InPlaceResult saveInPlace(const Flag_group& flagGroup) {
+        const bool attached = flagGroup.mappedRoster() == this;
+        Appender out;
+        out.base = layout.dataEnd;
+        std::vector<quint64> order;
+        std::vector<std::uint64_t> nextRevisions;
+        std::vector<std::pair<quint64, QByteArray>> rewrites; // 原地改写的记录：位置、内容
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            if (attached && flagGroup.isGroupMapped(i)) {
+                // 尚未展开的组没有任何修改，沿用全部记录
+                for (int k = 0; k < groupSize(i); ++k) {
+                    const quint64 ordinal = layout.groupStart[i - 1] + static_cast<quint64>(k);
+                    order.push_back(recordOffset(ordinal));
+                    nextRevisions.push_back(revisions[ordinal]);
+                }
+                continue;
+            }
+            std::unordered_map<std::string_view, quint64> byName; // 文件中同组的记录：姓名 -> 序号
+            for (int k = 0; k < groupSize(i); ++k) {
+                byName.emplace(record(i, k).nameView(), layout.groupStart[i - 1] + static_cast<quint64>(k));
+            }
+            for (const Person& person : flagGroup.getGroupMembers(i)) {
+                nextRevisions.push_back(person.getRevision());
+                const std::string name = person.getName();
+                auto it = byName.find(name);
+                if (it != byName.end()) {
+                    const quint64 ordinal = it->second;
+                    byName.erase(it);
+                    const quint64 offset = recordOffset(ordinal);
+                    if (revisions[ordinal] == person.getRevision()) {
+                        order.push_back(offset);
+                        continue;
+                    }
+                    const RecordView view = recordAt(ordinal);
+                    const auto texts = memberTexts(person);
+                    const std::string extra = extraLocationBytes(person);
+                    bool sameTexts = extra == extraLocationBytes(view);
+                    for (int f = 0; sameTexts && f < StringFieldCount; ++f) sameTexts = view.text(f) == texts[f];
+                    if (sameTexts) {
+                        // 档案文本未变（如执勤次数、空闲时间的修改）：沿用原有的文本，原地改写记录
+                        TextRef refs[StringFieldCount + 1];
+                        for (int f = 0; f < StringFieldCount; ++f) {
+                            refs[f].offset = qFromLittleEndian<quint32>(view.r + OFF_STRINGS + f * 8);
+                            refs[f].length = qFromLittleEndian<quint32>(view.r + OFF_STRINGS + f * 8 + 4);
+                        }
+                        refs[StringFieldCount].offset = qFromLittleEndian<quint32>(view.r + OFF_EXTRA_LOCATIONS);
+                        QByteArray bytes(RECORD_SIZE, '\0');
+                        fillRecord(reinterpret_cast<uchar*>(bytes.data()), i, person, refs, texts, extra);
+                        rewrites.emplace_back(offset, bytes);
+                        order.push_back(offset);
+                        continue;
+                    }
+                }
+                order.push_back(appendMember(out, i, person));
+            }
+        }
+
+        // 队员增删、顺序或组数变化时追加新的顺序表，否则沿用原顺序表
+        bool orderChanged = static_cast<int>(order.size()) != memberCount() || flagGroup.groupCount() != groups();
+        for (size_t k = 0; !orderChanged && k < order.size(); ++k) orderChanged = order[k] != recordOffset(k);
+        quint64 orderOffset = static_cast<quint64>(layout.order - data);
+        if (orderChanged) {
+            orderOffset = out.end();
+            out.bytes.append(orderTable(order));
+        }
+        const quint64 dataEnd = out.end();
+        if (dataEnd > MAX_FILE_SIZE || dataEnd > 2 * layout.compactedEnd + REWRITE_SLACK) return InPlaceTooLarge;
+
+        const bool unchanged = out.bytes.isEmpty() && rewrites.empty() && flagGroup.locationCount() == locations();
+        if (unchanged && !updating) return InPlaceSaved;
+        if (!markUpdating()) return InPlaceFailed;
+        if (!out.bytes.isEmpty() && (!file.seek(static_cast<qint64>(out.base)) || !DurableFile::write(file, out.bytes))) {
+            return InPlaceFailed;
+        }
+        for (const auto& rewrite : rewrites) {
+            if (!file.seek(static_cast<qint64>(rewrite.first)) || !DurableFile::write(file, rewrite.second)) {
+                return InPlaceFailed;
+            }
+        }
+        if (!DurableFile::syncFile(file)) return InPlaceFailed;
+        uchar header[HEADER_SIZE];
+        const QByteArray orderBytes = orderChanged ? orderTable(order) : QByteArray();
+        const quint32 orderCrc = orderChanged ? RecordFraming::crc32c(orderBytes)
+                                              : qFromLittleEndian<quint32>(data + HEAD_CRC);
+        fillHeader(header, flagGroup, order, orderOffset, orderCrc, dataEnd, layout.compactedEnd);
+        if (!file.seek(0)
+            || !DurableFile::write(file, QByteArray::fromRawData(reinterpret_cast<const char*>(header), HEADER_SIZE))
+            || !DurableFile::syncFile(file)) {
+            return InPlaceFailed;
+        }
+        updating = false;
+
+        // 重新映射到新的文件长度；新映射校验通过后才替换，之前的映射与结构在此之前保持有效
+        uchar* fresh = file.map(0, static_cast<qint64>(dataEnd));
+        Layout parsed;
+        if (!fresh || !validate(fresh, dataEnd, false, parsed)) {
+            if (fresh) file.unmap(fresh);
+            qDebug() << "无法重新映射名单文件：" << file.fileName();
+            return InPlaceFailed;
+        }
+        file.unmap(data);
+        data = fresh;
+        layout = std::move(parsed);
+        revisions = std::move(nextRevisions);
+        return InPlaceSaved;
+    }
+
+    // 整体重写（临时文件 + 重命名）：已挂接名单中尚未展开的组从当前映射读取；写完后重新映射新文件
+    bool rewrite(const Flag_group& flagGroup, const QString& filename) {
+        const bool attached = isOpen() && flagGroup.mappedRoster() == this;
+        Appender out;
+        out.base = HEADER_SIZE;
+        std::vector<quint64> order;
+        std::vector<std::uint64_t> nextRevisions;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            if (attached && flagGroup.isGroupMapped(i)) {
+                for (int k = 0; k < groupSize(i); ++k) {
+                    order.push_back(appendMember(out, i, record(i, k)));
+                    nextRevisions.push_back(recordRevision(i, k));
+                }
+                continue;
+            }
+            for (const Person& person : flagGroup.getGroupMembers(i)) {
+                order.push_back(appendMember(out, i, person));
+                nextRevisions.push_back(person.getRevision());
+            }
+        }
+        const quint64 orderOffset = out.end();
+        const QByteArray orderBytes = orderTable(order);
+        out.bytes.append(orderBytes);
+        if (out.end() > MAX_FILE_SIZE) {
+            qDebug() << "名单文件超过4GB，无法写入：" << filename;
+            return false;
+        }
+        QByteArray bytes(HEADER_SIZE, '\0');
+        fillHeader(reinterpret_cast<uchar*>(bytes.data()), flagGroup, order, orderOffset,
+                   RecordFraming::crc32c(orderBytes), out.end(), out.end());
+        bytes.append(out.bytes);
+
+        // 替换文件前先关闭映射（Windows 不能重命名覆盖已映射的文件）
+        close();
+        QFile tempFile;
+        bool ok = DurableFile::openTemp(tempFile, filename);
+        if (ok && !DurableFile::write(tempFile, bytes)) {
+            qDebug() << "写入名单临时文件时发生错误：" << tempFile.fileName();
+            tempFile.close();
+            tempFile.remove();
+            ok = false;
+        }
+        ok = ok && DurableFile::commit(tempFile, filename);
+        if (!ok || !openFile(filename, false)) {
+            holdBytes(bytes);
+        }
+        revisions = std::move(nextRevisions);
+        return ok;
+    }
+
+    // 校验文件头与所有记录的字符串引用，保证之后的原地读取不会越界；通过后结构写入 parsed
+    static bool validate(const uchar* base, quint64 size, bool verify, Layout& parsed) {
+        if (std::memcmp(base, MAGIC, 8) != 0) return false;
+        const quint32 version = qFromLittleEndian<quint32>(base + 8);
+        if (version < 1 || version > FORMAT_VERSION) return false;
+        if (qFromLittleEndian<quint32>(base + 12) != HEADER_SIZE) return false;
+        parsed.version = version;
+        return version >= 5 ? validateAppendable(base, size, verify, parsed) : validateLegacy(base, size, parsed);
+    }
+
+    // 版本5：按顺序表逐条检查记录的位置、组别顺序、字符串引用与校验值
+    static bool validateAppendable(const uchar* base, quint64 size, bool verify, Layout& parsed) {
+        if (qFromLittleEndian<quint32>(base + 16) != RECORD_SIZE) return false;
+        if (qFromLittleEndian<quint32>(base + HEAD_STATE) != STATE_COMPLETE) {
+            qDebug() << "名单文件上次更新未完成，内容可能落后于存储后端";
+            return false;
+        }
+        const quint32 count = qFromLittleEndian<quint32>(base + 20);
+        if (count < 1 || count > static_cast<quint32>(Flag_group::MAX_GROUP_COUNT)) return false;
+        const quint32 locationsInFile = qFromLittleEndian<quint32>(base + 24);
+        if (locationsInFile < static_cast<quint32>(Person::DEFAULT_LOCATION_COUNT)
+            || locationsInFile > static_cast<quint32>(Person::MAX_LOCATION_COUNT)) {
+            return false;
+        }
+        const quint64 members = qFromLittleEndian<quint32>(base + HEAD_MEMBERS);
+        const quint64 orderOffset = qFromLittleEndian<quint64>(base + HEAD_ORDER);
+        const quint64 dataEnd = qFromLittleEndian<quint64>(base + HEAD_DATA_END);
+        if (dataEnd < HEADER_SIZE || dataEnd > size || dataEnd > MAX_FILE_SIZE
+            || orderOffset < HEADER_SIZE || orderOffset > dataEnd || members > (dataEnd - orderOffset) / 8) {
+            return false;
+        }
+        const uchar* order = base + orderOffset;
+        if (RecordFraming::crc32c(reinterpret_cast<const char*>(order), static_cast<qint64>(members * 8))
+            != qFromLittleEndian<quint32>(base + HEAD_CRC)) {
+            qDebug() << "名单文件顺序表校验失败";
+            return false;
+        }
+        parsed.locationCount = static_cast<int>(locationsInFile);
+        parsed.groupCount.assign(count, 0);
+        parsed.groupStart.assign(count, 0);
+        parsed.strings = reinterpret_cast<const char*>(base);
+        parsed.order = order;
+        parsed.dataEnd = dataEnd;
+        parsed.compactedEnd = qFromLittleEndian<quint64>(base + HEAD_COMPACTED);
+        int previousGroup = 1;
+        for (quint64 k = 0; k < members; ++k) {
+            const quint64 offset = qFromLittleEndian<quint64>(order + k * 8);
+            if (offset < HEADER_SIZE || offset > dataEnd || dataEnd - offset < RECORD_SIZE) return false;
+            const uchar* r = base + offset;
+            const int group = r[OFF_GROUP];
+            if (group < previousGroup || group > static_cast<int>(count)) return false;
+            for (int f = 0; f < StringFieldCount; ++f) {
+                const quint64 textOffset = qFromLittleEndian<quint32>(r + OFF_STRINGS + f * 8);
+                const quint64 length = qFromLittleEndian<quint32>(r + OFF_STRINGS + f * 8 + 4);
+                if (textOffset + length > dataEnd) return false;
+            }
+            const quint64 extraOffset = qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS);
+            const quint64 extraCount = qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS + 4);
+            if (extraOffset + extraCount * 4 > dataEnd) return false;
+            if (verify) {
+                const RecordView view(r, parsed.strings, true, true);
+                if (recordCrc(r, memberTexts(view), extraLocationBytes(view)) != qFromLittleEndian<quint32>(r + OFF_CRC)) {
+                    qDebug() << "名单文件第" << k + 1 << "条记录校验失败";
+                    return false;
+                }
+            }
+            for (int i = previousGroup; i < group; ++i) parsed.groupStart[i] = k;
+            previousGroup = group;
+            parsed.groupCount[group - 1]++;
+        }
+        for (int i = previousGroup; i < static_cast<int>(count); ++i) parsed.groupStart[i] = members;
+        return true;
+    }
+
+    // 版本1~4：记录区与字符串表各自连续存放，整体校验 CRC32C（版本2起）
+    static bool validateLegacy(const uchar* base, quint64 size, Layout& parsed) {
+        const quint32 version = parsed.version;
+        parsed.recordSize = version >= 3 ? UNCHECKED_RECORD_SIZE : LEGACY_RECORD_SIZE;
+        if (qFromLittleEndian<quint32>(base + 16) != parsed.recordSize) return false;
+        quint64 total = 0;
+        if (version >= 3) {
+            // 记录总数由记录区长度得到，各组人数在下面逐条检查记录时统计
+            const quint32 count = qFromLittleEndian<quint32>(base + 20);
+            if (count < 1 || count > static_cast<quint32>(Flag_group::MAX_GROUP_COUNT)) return false;
+            parsed.groupCount.assign(count, 0);
+            parsed.groupStart.assign(count, 0);
+            if (version >= 4) {
+                const quint32 locationsInFile = qFromLittleEndian<quint32>(base + 24);
+                if (locationsInFile < static_cast<quint32>(Person::DEFAULT_LOCATION_COUNT)
+                    || locationsInFile > static_cast<quint32>(Person::MAX_LOCATION_COUNT)) {
+                    return false;
+                }
+                parsed.locationCount = static_cast<int>(locationsInFile);
+            }
+        } else {
+            parsed.groupCount.assign(Flag_group::DEFAULT_GROUP_COUNT, 0);
+            parsed.groupStart.assign(Flag_group::DEFAULT_GROUP_COUNT, 0);
+            for (int i = 0; i < Flag_group::DEFAULT_GROUP_COUNT; ++i) {
+                parsed.groupStart[i] = total;
+                parsed.groupCount[i] = qFromLittleEndian<quint32>(base + 20 + i * 4);
+                total += parsed.groupCount[i];
+            }
+        }
+        const quint64 recordsOffset = qFromLittleEndian<quint64>(base + 40);
+        const quint64 stringsOffset = qFromLittleEndian<quint64>(base + 48);
+        const quint64 stringsSize = qFromLittleEndian<quint64>(base + 56);
+        if (recordsOffset < HEADER_SIZE || recordsOffset > size
+            || stringsOffset > size || stringsSize > size - stringsOffset) {
+            return false;
+        }
+        if (version >= 3) {
+            if (stringsOffset < recordsOffset || (stringsOffset - recordsOffset) % parsed.recordSize != 0) return false;
+            total = (stringsOffset - recordsOffset) / parsed.recordSize;
+        }
+        if (total > (size - recordsOffset) / parsed.recordSize) return false;
+        // 版本2：记录区与字符串表紧接文件头依次存放，整体校验 CRC32C
+        if (version >= 2) {
+            if (stringsOffset < recordsOffset) return false;
+            const quint32 crc = RecordFraming::crc32c(reinterpret_cast<const char*>(base + recordsOffset),
+                                                      static_cast<qint64>(stringsOffset + stringsSize - recordsOffset));
+            if (crc != qFromLittleEndian<quint32>(base + 36)) {
+                qDebug() << "名单文件校验失败";
+                return false;
+            }
+        }
+        parsed.records = base + recordsOffset;
+        parsed.strings = reinterpret_cast<const char*>(base + stringsOffset);
+        int previousGroup = 1;
+        for (quint64 k = 0; k < total; ++k) {
+            const uchar* r = parsed.records + k * parsed.recordSize;
+            const int group = r[OFF_GROUP];
+            if (group < 1 || group > static_cast<int>(parsed.groupCount.size())) return false;
+            for (int f = 0; f < StringFieldCount; ++f) {
+                const quint64 offset = qFromLittleEndian<quint32>(r + OFF_STRINGS + f * 8);
+                const quint64 length = qFromLittleEndian<quint32>(r + OFF_STRINGS + f * 8 + 4);
+                if (offset + length > stringsSize) return false;
+            }
+            if (version >= 3) {
+                const quint64 offset = qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS);
+                const quint64 count = qFromLittleEndian<quint32>(r + OFF_EXTRA_LOCATIONS + 4);
+                if (offset + count * 4 > stringsSize) return false;
+                // 记录按组依次排列，统计各组人数
+                if (group < previousGroup) return false;
+                for (int i = previousGroup; i < group; ++i) parsed.groupStart[i] = k;
+                previousGroup = group;
+                parsed.groupCount[group - 1]++;
+            }
+        }
+        if (version >= 3) {
+            for (int i = previousGroup; i < static_cast<int>(parsed.groupCount.size()); ++i) parsed.groupStart[i] = total;
+        }
+        return true;
+    }
+
+    QFile file;
+    uchar* data = nullptr;              // 文件的映射（或 heldBytes 的内容）
+    QByteArray heldBytes;               // 无法映射时使用的内存中的文件内容（见 holdBytes）
+    bool writable = false;              // 文件以读写方式打开，可以原地增量保存
+    bool updating = false;              // 已将文件标记为正在更新（见 markUpdating）
+    Layout layout;
+    std::vector<std::uint64_t> revisions; // 各记录（按序号）内容对应的修订号
+};
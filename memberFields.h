@@ -0,0 +1,193 @@
+// memberFields.h头文件
+// 功能说明：队员各字段在导入 / 导出文件中的名称、校验与读写，供空闲时间导入（csvImport.h）与名单批量导入导出（rosterBulkIO.h）共用
+// 每个字段有两个名称：中文标题（CSV 表头）与英文键名（JSON），读取时两者均可识别。
+// 字段值在文件中统一以文本表示：性别为“男”/“女”，年级为 1~3（也可写“大一”~“大三”），是否值周为“是”/“否”（也可写 1/0），
+// 各项次数为非负整数，时间点为 0/1（1 表示可用；两个地点时为20个，每增加一个地点多10个）；validate 把这些写法统一为规范文本，assign 再写入 Person。
+
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include "Flag_group.h"
+#include "Person.h"
+
+class MemberFields
+{
+public:
+    // 字段编号；时间点为 TimeSlot + (row-1)*5 + (column-1)，与 Person::getTimeMask 的位序一致，
+    // 因此前 n 个地点的时间点正好是 TimeSlot 起的 n*10 个字段（见 fieldCount）
+    enum Field {
+        None = -1,
+        Name = 0, Group, Gender, Grade, Phone, NativePlace, Native, Dorm, School, Classname, Birthday,
+        IsWork, Times, AllTimes, NJHAllTimes, DXYAllTimes,
+        TimeSlot,
+        FieldCount = TimeSlot + Person::MAX_TIME_SLOTS
+    };
+
+    // 有 locationCount 个地点的名单所用的字段数
+    static int fieldCount(int locationCount) { return TimeSlot + locationCount * 2 * Person::DAY_COUNT; }
+
+    static int timeSlot(int row, int column) { return TimeSlot + (row - 1) * 5 + (column - 1); }
+    static bool isTimeSlot(int field) { return field >= TimeSlot && field < FieldCount; }
+    // 执勤次数类字段（界面上只允许管理员修改）
+    static bool isCount(int field) { return field >= Times && field <= DXYAllTimes; }
+
+    // CSV 表头
+    static QString title(int field) {
+        static const char* titles[TimeSlot] = {
+            "姓名", "组别", "性别", "年级", "电话", "籍贯", "民族", "宿舍", "学院", "班级", "生日",
+            "是否值周", "本轮次数", "总次数", "南鉴湖总次数", "东西院总次数"};
+        if (isTimeSlot(field)) {
+            static const char* days[5] = {"周一", "周二", "周三", "周四", "周五"};
+            const int slot = field - TimeSlot;
+            const int row = slot / 5 + 1;
+            return QString(days[slot % 5]) + (Person::rowCeremony(row) == 0 ? "升旗" : "降旗")
+                + Flag_group::locationTitle(Person::rowLocation(row));
+        }
+        return (field >= 0 && field < TimeSlot) ? QString(titles[field]) : QString();
+    }
+
+    // JSON 键名（时间点统一放在 "availability" 数组中，见 rosterBulkIO.h）
+    static QString key(int field) {
+        static const char* keys[TimeSlot] = {
+            "name", "group", "gender", "grade", "phone", "nativePlace", "native", "dorm", "school", "className",
+            "birthday", "isWork", "times", "allTimes", "njhAllTimes", "dxyAllTimes"};
+        return (field >= 0 && field < TimeSlot) ? QString(keys[field]) : QString();
+    }
+
+    // 由中文标题或英文键名查找字段，未识别时返回 None
+    static int fromName(const QString& name) {
+        static const QHash<QString, int> fields = []() {
+            QHash<QString, int> table;
+            for (int field = 0; field < FieldCount; ++field) {
+                table.insert(title(field), field);
+                if (!isTimeSlot(field)) table.insert(key(field), field);
+            }
+            return table;
+        }();
+        return fields.value(name.trimmed(), None);
+    }
+
+    // 校验一个字段值并转为规范文本；失败时 error 为原因
+    static bool validate(int field, const QString& text, QString& normalized, QString& error) {
+        const QString value = text.trimmed();
+        bool ok = false;
+        switch (field) {
+        case Name:
+            if (value.isEmpty()) {
+                error = "姓名为空";
+                return false;
+            }
+            break;
+        case Group: {
+            const int group = value.toInt(&ok);
+            if (!ok || group < 1 || group > Flag_group::MAX_GROUP_COUNT) { // 是否存在该组由导入时按名单的组数检查
+                error = "组别无效：" + value;
+                return false;
+            }
+            break;
+        }
+        case Gender:
+            if (value != "男" && value != "女") {
+                error = "性别应为“男”或“女”：" + value;
+                return false;
+            }
+            break;
+        case Grade: {
+            static const QStringList names = {"大一", "大二", "大三"};
+            int grade = names.indexOf(value) + 1;
+            if (grade == 0) grade = value.toInt(&ok);
+            if (grade < 1 || grade > names.size()) {
+                error = "年级无效：" + value;
+                return false;
+            }
+            normalized = QString::number(grade);
+            return true;
+        }
+        case IsWork:
+            if (value != "是" && value != "否" && value != "1" && value != "0") {
+                error = "是否值周应为“是”或“否”：" + value;
+                return false;
+            }
+            normalized = (value == "是" || value == "1") ? "是" : "否";
+            return true;
+        default:
+            if (isCount(field)) {
+                const int count = value.toInt(&ok);
+                if (!ok || count < 0) {
+                    error = title(field) + "应为非负整数：" + value;
+                    return false;
+                }
+                normalized = QString::number(count);
+                return true;
+            }
+            if (isTimeSlot(field)) {
+                const double slot = value.isEmpty() ? 0 : value.toDouble(&ok);
+                if (!value.isEmpty() && (!ok || (slot != 0 && slot != 1))) {
+                    error = title(field) + "的值无效（应为0或1）：" + value;
+                    return false;
+                }
+                normalized = slot == 1 ? "1" : "0";
+                return true;
+            }
+            break;
+        }
+        normalized = value;
+        return true;
+    }
+
+    // 把规范文本写入队员（姓名与组别是队员的标识，不在此修改）；set 函数只在值实际变化时标记修改
+    static void assign(int field, const QString& value, Person& person) {
+        const std::string text = value.toStdString();
+        switch (field) {
+        case Gender: person.setGender(value == "女"); break;
+        case Grade: person.setGrade(value.toInt()); break;
+        case Phone: person.setPhone_number(text); break;
+        case NativePlace: person.setNative_place(text); break;
+        case Native: person.setNative(text); break;
+        case Dorm: person.setDorm(text); break;
+        case School: person.setSchool(text); break;
+        case Classname: person.setClassname(text); break;
+        case Birthday: person.setBirthday(text); break;
+        case IsWork: person.setIsWork(value == "是"); break;
+        case Times: person.setTimes(value.toInt()); break;
+        case AllTimes: person.setAll_times(value.toInt()); break;
+        case NJHAllTimes: person.setNJHAllTimes(value.toInt()); break;
+        case DXYAllTimes: person.setDXYAllTimes(value.toInt()); break;
+        default:
+            if (isTimeSlot(field)) {
+                const int slot = field - TimeSlot;
+                person.setTime(slot / 5 + 1, slot % 5 + 1, value == "1");
+            }
+            break;
+        }
+    }
+
+    // 队员字段的规范文本（导出用）
+    static QString format(int field, const Person& person) {
+        switch (field) {
+        case Name: return QString::fromStdString(person.getName());
+        case Group: return QString::number(person.getGroup());
+        case Gender: return person.getGender() ? "女" : "男";
+        case Grade: return QString::number(person.getGrade());
+        case Phone: return QString::fromStdString(person.getPhone_number());
+        case NativePlace: return QString::fromStdString(person.getNative_place());
+        case Native: return QString::fromStdString(person.getNative());
+        case Dorm: return QString::fromStdString(person.getDorm());
+        case School: return QString::fromStdString(person.getSchool());
+        case Classname: return QString::fromStdString(person.getClassname());
+        case Birthday: return QString::fromStdString(person.getBirthday());
+        case IsWork: return person.getIsWork() ? "是" : "否";
+        case Times: return QString::number(person.getTimes());
+        case AllTimes: return QString::number(person.getAll_times());
+        case NJHAllTimes: return QString::number(person.getNJHAllTimes());
+        case DXYAllTimes: return QString::number(person.getDXYAllTimes());
+        default:
+            if (isTimeSlot(field)) {
+                const int slot = field - TimeSlot;
+                return person.getTime(slot / 5 + 1, slot % 5 + 1) ? "1" : "0";
+            }
+            return QString();
+        }
+    }
+};
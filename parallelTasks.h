@@ -0,0 +1,39 @@
+// parallelTasks.h头文件
+// 功能说明：在全局线程池上并行执行一组互不依赖的任务，供各个名单加载器按块并行解析时使用
+// 调用线程同样承担一个任务；全部任务结束后才返回，调用方按任务序号合并结果即可得到与顺序执行相同的顺序。
+
+#pragma once
+#include <QThreadPool>
+#include <QSemaphore>
+#include <QtGlobal>
+#include <functional>
+
+class ParallelTasks
+{
+public:
+    // 可同时运行的任务数（线程池线程数）
+    static int workerCount() {
+        return qMax(1, QThreadPool::globalInstance()->maxThreadCount());
+    }
+
+    // 依据数据量确定分块数：每块至少 minItemsPerTask 个单位，且不超过线程数
+    static int taskCountFor(qint64 items, qint64 minItemsPerTask) {
+        if (items <= 0) return 1;
+        const qint64 byMinimum = qMax<qint64>(1, items / qMax<qint64>(1, minItemsPerTask));
+        return static_cast<int>(qMin<qint64>(byMinimum, workerCount()));
+    }
+
+    // 执行任务 0 ~ taskCount-1：任务 1 起提交到全局线程池，任务 0 在当前线程执行
+    static void run(int taskCount, const std::function<void(int)>& task) {
+        if (taskCount <= 0) return;
+        QSemaphore done;
+        for (int i = 1; i < taskCount; ++i) {
+            QThreadPool::globalInstance()->start([&task, &done, i]() {
+                task(i);
+                done.release();
+            });
+        }
+        task(0);
+        done.acquire(taskCount - 1);
+    }
+};
@@ -0,0 +1,57 @@
+// pinyin.h头文件
+// 功能说明：汉字姓名的拼音首字母，用于按首字母筛选队员（如输入“zs”找到“张三”）
+// 不附带拼音字典：按中文排序规则（QCollator 的简体中文拼音排序，Windows 与带 ICU 的 Qt 均支持）
+// 把汉字与各声母第一个字比较，落在哪两个字之间即为哪个首字母。每个汉字只比较一次，结果缓存。
+// 多音字按排序规则的默认读音处理。字母与数字原样保留（转为小写），其余字符忽略。
+
+#pragma once
+#include <QChar>
+#include <QCollator>
+#include <QHash>
+#include <QLocale>
+#include <QString>
+#include <mutex>
+
+class Pinyin
+{
+public:
+    // 文字的拼音首字母（小写），如“张三”返回“zs”
+    static QString initials(const QString& text) {
+        QString result;
+        result.reserve(text.size());
+        for (const QChar ch : text) {
+            if (ch.unicode() >= 0x4E00 && ch.unicode() <= 0x9FFF) {
+                const QChar letter = initial(ch);
+                if (!letter.isNull()) result += letter;
+            } else if (ch.isLetterOrNumber() && ch.unicode() < 0x80) {
+                result += ch.toLower();
+            }
+        }
+        return result;
+    }
+
+private:
+    // 单个汉字的首字母，无法确定时返回空字符
+    static QChar initial(QChar ch) {
+        static std::mutex mutex;
+        static QHash<QChar, QChar> cache;
+        std::lock_guard<std::mutex> lock(mutex);
+        const auto it = cache.constFind(ch);
+        if (it != cache.constEnd()) return it.value();
+
+        // 各首字母按拼音排序的第一个字（没有以 i、u、v 开头的拼音）
+        static const QString boundaries = QString::fromUtf8("阿八嚓哒妸发旮哈讥咔垃痳拏噢妑七呥扨它穵夕丫帀");
+        static const char letters[] = "abcdefghjklmnopqrstwxyz";
+        static const QCollator collator(QLocale(QLocale::Chinese, QLocale::China));
+        QChar letter;
+        const QString text(ch);
+        for (int i = boundaries.size() - 1; i >= 0; --i) {
+            if (collator.compare(QString(boundaries.at(i)), text) <= 0) {
+                letter = QChar(letters[i]);
+                break;
+            }
+        }
+        cache.insert(ch, letter);
+        return letter;
+    }
+};
@@ -0,0 +1,165 @@
+// recordFraming.h头文件
+// 功能说明：各数据文件共用的记录分帧与 CRC32C 校验
+// 文件头：[魔数 "FGRF"][格式版本][记录数][文件头校验值]，用于确认格式版本与记录条数
+// 每条记录：[长度][长度取反][CRC32C][内容]
+//   - 长度与其取反值互相校验，长度字段损坏时能够发现（此后的记录无法定位，停止读取）
+//   - 内容的 CRC32C 不符时只跳过这一条记录并报告，继续读取后续记录
+// 校验只需计算 CRC，不必解码内容（见 verify）。
+// CRC32C：编译器启用 SSE4.2 时使用硬件指令，否则使用 slice-by-8 查表法（每次处理8字节）。
+
+#pragma once
+#include <QByteArray>
+#include <QDataStream>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+#include <cstring>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+
+class RecordFraming
+{
+public:
+    static constexpr quint32 MAX_RECORD_SIZE = 64 * 1024 * 1024; // 单条记录长度上限（超过视为长度字段损坏）
+
+    // 读取一条记录的结果
+    enum ReadResult {
+        RecordOk,       // 读取成功
+        RecordCorrupt,  // 内容校验失败，已跳过该记录，可以继续读取
+        StreamBroken    // 长度字段损坏或数据不完整，无法继续读取
+    };
+
+    // CRC32C（Castagnoli 多项式）
+    static quint32 crc32c(const char* data, qint64 length, quint32 crc = 0) {
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+        crc = ~crc;
+#if defined(__SSE4_2__)
+        for (; length >= 8; p += 8, length -= 8) {
+            quint64 word;
+            std::memcpy(&word, p, 8);
+            crc = static_cast<quint32>(_mm_crc32_u64(crc, word));
+        }
+        for (; length > 0; ++p, --length) {
+            crc = _mm_crc32_u8(crc, *p);
+        }
+#else
+        const Tables& t = tables();
+        for (; length >= 8; p += 8, length -= 8) {
+            const quint32 low = crc ^ (static_cast<quint32>(p[0]) | (static_cast<quint32>(p[1]) << 8)
+                                       | (static_cast<quint32>(p[2]) << 16) | (static_cast<quint32>(p[3]) << 24));
+            crc = t.table[7][low & 0xFF] ^ t.table[6][(low >> 8) & 0xFF]
+                ^ t.table[5][(low >> 16) & 0xFF] ^ t.table[4][low >> 24]
+                ^ t.table[3][p[4]] ^ t.table[2][p[5]] ^ t.table[1][p[6]] ^ t.table[0][p[7]];
+        }
+        for (; length > 0; ++p, --length) {
+            crc = t.table[0][(crc ^ *p) & 0xFF] ^ (crc >> 8);
+        }
+#endif
+        return ~crc;
+    }
+
+    static quint32 crc32c(const QByteArray& data) {
+        return crc32c(data.constData(), data.size());
+    }
+
+    // 文件头
+    static void writeHeader(QDataStream& out, quint32 formatVersion, quint32 recordCount) {
+        out << HEADER_MAGIC << formatVersion << recordCount << headerCheck(formatVersion, recordCount);
+    }
+
+    static bool readHeader(QDataStream& in, quint32& formatVersion, quint32& recordCount) {
+        quint32 magic, check;
+        in >> magic >> formatVersion >> recordCount >> check;
+        return in.status() == QDataStream::Ok && magic == HEADER_MAGIC && check == headerCheck(formatVersion, recordCount);
+    }
+
+    // 写入一条记录
+    static void writeRecord(QDataStream& out, const QByteArray& payload) {
+        const quint32 length = static_cast<quint32>(payload.size());
+        out << length << ~length << crc32c(payload);
+        out.writeRawData(payload.constData(), payload.size());
+    }
+
+    // 读取一条记录；返回 RecordCorrupt 时 payload 为空，流位置已越过该记录
+    static ReadResult readRecord(QDataStream& in, QByteArray& payload) {
+        quint32 length, lengthCheck, crc;
+        in >> length >> lengthCheck >> crc;
+        if (in.status() != QDataStream::Ok || lengthCheck != ~length || length > MAX_RECORD_SIZE) {
+            return StreamBroken;
+        }
+        payload.resize(static_cast<int>(length));
+        if (in.readRawData(payload.data(), static_cast<int>(length)) != static_cast<int>(length)) {
+            payload.clear();
+            return StreamBroken;
+        }
+        if (crc32c(payload) != crc) {
+            payload.clear();
+            return RecordCorrupt;
+        }
+        return RecordOk;
+    }
+
+    // 快速校验一段分帧数据（文件头 + 全部记录）：只计算 CRC，不解码内容。
+    // 返回校验通过的记录数；problems 中记录每一处损坏
+    static int verify(const QByteArray& data, QStringList* problems = nullptr) {
+        QDataStream in(data);
+        in.setVersion(QDataStream::Qt_5_15);
+        quint32 formatVersion, recordCount;
+        if (!readHeader(in, formatVersion, recordCount)) {
+            if (problems) problems->append("文件头损坏");
+            return 0;
+        }
+        int valid = 0;
+        QByteArray payload;
+        for (quint32 i = 0; i < recordCount; ++i) {
+            const ReadResult result = readRecord(in, payload);
+            if (result == RecordOk) {
+                ++valid;
+            } else if (result == RecordCorrupt) {
+                if (problems) problems->append(QString("第 %1 条记录校验失败").arg(i + 1));
+            } else {
+                if (problems) problems->append(QString("第 %1 条记录起数据不完整，共 %2 条无法读取").arg(i + 1).arg(recordCount - i));
+                break;
+            }
+        }
+        return valid;
+    }
+
+private:
+    static constexpr quint32 HEADER_MAGIC = 0x46475246; // "FGRF"
+
+    static quint32 headerCheck(quint32 formatVersion, quint32 recordCount) {
+        char fields[8];
+        for (int i = 0; i < 4; ++i) {
+            fields[i] = static_cast<char>(formatVersion >> (8 * i));
+            fields[4 + i] = static_cast<char>(recordCount >> (8 * i));
+        }
+        return crc32c(fields, 8);
+    }
+
+#if !defined(__SSE4_2__)
+    struct Tables {
+        quint32 table[8][256];
+        Tables() {
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0x82F63B78u ^ (c >> 1)) : (c >> 1);
+                }
+                table[0][i] = c;
+            }
+            for (quint32 i = 0; i < 256; ++i) {
+                for (int s = 1; s < 8; ++s) {
+                    table[s][i] = (table[s - 1][i] >> 8) ^ table[0][table[s - 1][i] & 0xFF];
+                }
+            }
+        }
+    };
+
+    static const Tables& tables() {
+        static const Tables instance;
+        return instance;
+    }
+#endif
+};
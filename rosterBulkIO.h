@@ -0,0 +1,436 @@
+// rosterBulkIO.h头文件
+// 功能说明：队员名单的批量导入与导出（CSV / JSON），一次导入或导出全队所有字段
+// 导入分两步：
+//   1. prepare（工作线程）：读取并校验文件，与名单快照逐人比对，得到「新增 / 更新 / 未变化」的修改计划，不修改名单；
+//   2. apply（界面线程）：把计划一次性写入名单（整个导入为一个撤销步骤），返回涉及的组别，界面每组只刷新一次。
+// 导出直接遍历名单逐人写出，通过 DurableFile 先写临时文件再替换目标文件，不在内存中拼出整个文件。
+// 文件格式：
+//   - CSV：第一行为表头（中文标题，见 memberFields.h），必须包含“姓名”与“组别”，其余列可任意取舍、任意顺序；
+//     空单元格保持原值。导出文件带 UTF-8 BOM，Excel 可直接打开。
+//   - JSON：{"version": 1, "members": [{"name": "张三", "group": 1, ..., "availability": [地点数×10个0/1]}]}，
+//     键名见 memberFields.h（也可使用中文标题）；缺少的键保持原值。availability 也可只写前几个地点（如两个地点时的20个）。
+// 导出只写名单已有地点的时间点；导入时名单中没有的地点的时间点被忽略。
+// 姓名与组别是队员的标识：文件中找不到的队员作为新队员加入，已在其他组的姓名视为错误（调整组别请在界面中操作）。
+// 执勤次数类字段与界面一致，只有管理员可以导入。
+
+#pragma once
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QPair>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include "Flag_group.h"
+#include "rosterSnapshot.h"
+#include "memberFields.h"
+#include "csvImport.h"
+#include "rosterUndoStack.h"
+#include "durableFile.h"
+#include "rosterIndex.h"
+
+class RosterBulkIO
+{
+public:
+    enum Format { Csv, Json };
+
+    static constexpr int JSON_VERSION = 1;
+
+    // 由文件扩展名判断格式（.json 为 JSON，其余按 CSV 处理）
+    static Format formatFor(const QString& path) {
+        return QFileInfo(path).suffix().compare("json", Qt::CaseInsensitive) == 0 ? Json : Csv;
+    }
+
+    struct Issue {
+        int line;         // CSV 为行号，JSON 为队员在数组中的序号（均从1开始）
+        QString message;
+    };
+
+    // 一名队员的修改：values 为 (字段, 规范文本)，只包含文件中给出的字段
+    struct Entry {
+        int line = 0;
+        int group = 0;
+        QString name;
+        bool isNew = false;
+        QVector<QPair<int, QString>> values;
+    };
+
+    // 修改计划：entries 只包含确有变化的队员
+    struct Plan {
+        bool ok = false;          // 文件能否读取（为 false 时 error 为原因）
+        QString error;
+        QVector<Entry> entries;
+        int added = 0;
+        int updated = 0;
+        int unchanged = 0;
+        QVector<Issue> issues;    // 被跳过的行及原因
+        QStringList ignoredColumns; // 因权限不足而忽略的字段
+        QStringList extraLocationColumns; // 名单中没有该地点而忽略的时间点
+    };
+
+    // 读取并校验文件，与名单快照比对（可在工作线程调用，不访问界面与名单本身）
+    // includeCounts：是否导入执勤次数类字段
+    static Plan prepare(const QString& path, const RosterSnapshot& snapshot, bool includeCounts) {
+        Plan plan;
+        Differ differ(snapshot, includeCounts, plan);
+        plan.ok = formatFor(path) == Json ? readJson(path, differ, plan) : readCsv(path, differ, plan);
+        if (!plan.ok) plan.entries.clear();
+        return plan;
+    }
+
+    // 把修改计划作为一个撤销步骤写入名单（界面线程，见 rosterUndoStack.h），返回涉及的组别（升序）
+    // 按组别 + 姓名重新查找队员，准备期间名单发生的其他修改不会被覆盖为旧快照
+    static QVector<int> apply(const Plan& plan, RosterUndoStack& undoStack) {
+        Flag_group& flagGroup = undoStack.roster();
+        QHash<QPair<int, QString>, int> index; // (组别, 姓名) -> 组内下标
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            const auto& members = flagGroup.getGroupMembers(i);
+            for (int k = 0; k < static_cast<int>(members.size()); ++k) {
+                index.insert(qMakePair(i, QString::fromStdString(members[k].getName())), k);
+            }
+        }
+        QSet<int> touched;
+        undoStack.begin("批量导入队员");
+        for (const Entry& entry : plan.entries) {
+            if (!flagGroup.isValidGroup(entry.group)) continue; // 准备期间组数被减少（计划中的组已不存在）
+            const QPair<int, QString> key(entry.group, entry.name);
+            auto it = index.constFind(key);
+            if (it == index.constEnd()) {
+                // 新队员加入组末尾；是否值周默认与同组其他队员一致
+                const auto& members = flagGroup.getGroupMembers(entry.group);
+                const int added = undoStack.append(entry.group,
+                    newPerson(entry.name, entry.group, members.empty() ? true : members.front().getIsWork()));
+                it = index.insert(key, added);
+            }
+            for (const auto& value : entry.values) {
+                undoStack.setField(entry.group, it.value(), value.first, value.second);
+            }
+            touched.insert(entry.group);
+        }
+        undoStack.commit();
+        QVector<int> groups(touched.begin(), touched.end());
+        std::sort(groups.begin(), groups.end());
+        return groups;
+    }
+
+    // 导出全队名单（全部字段）；selection 不为空时只导出位图中选中的队员（序号见 rosterIndex.h）
+    static bool exportRoster(const Flag_group& flagGroup, const QString& path, Format format,
+                             const RosterBitmap* selection = nullptr) {
+        QFile file;
+        if (!DurableFile::openTemp(file, path)) {
+            qDebug() << "无法创建导出文件：" << path;
+            return false;
+        }
+        const bool written = format == Json ? writeJson(flagGroup, file, selection) : writeCsv(flagGroup, file, selection);
+        if (!written) {
+            file.close();
+            qDebug() << "写入导出文件失败：" << path;
+            return false;
+        }
+        return DurableFile::commit(file, path);
+    }
+
+private:
+    static constexpr int FLUSH_SIZE = 64 * 1024; // 导出时累积到该大小再写入文件
+
+    // 校验一行数据并与快照比对，结果记入修改计划
+    class Differ
+    {
+    public:
+        Differ(const RosterSnapshot& snapshot, bool includeCounts, Plan& plan)
+            : m_includeCounts(includeCounts), m_groupCount(snapshot.groupCount()),
+              m_slotCount(snapshot.locationCount() * 2 * Person::DAY_COUNT), m_plan(plan) {
+            for (int i = 1; i <= m_groupCount; ++i) {
+                for (const auto& record : snapshot.getGroupRecords(i)) {
+                    m_index.insert(QString::fromStdString(record->getName()), record);
+                }
+            }
+        }
+
+        // 字段是否参与导入；因权限不足而忽略的字段记录一次
+        bool accepts(int field, const QString& name) {
+            if (field == MemberFields::None) return false;
+            if (MemberFields::isCount(field) && !m_includeCounts) {
+                if (!m_plan.ignoredColumns.contains(name)) m_plan.ignoredColumns.append(name);
+                return false;
+            }
+            if (MemberFields::isTimeSlot(field) && field - MemberFields::TimeSlot >= m_slotCount) {
+                if (!m_plan.extraLocationColumns.contains(name)) m_plan.extraLocationColumns.append(name);
+                return false;
+            }
+            return true;
+        }
+
+        // 名单已有地点的时间点数
+        int slotCount() const { return m_slotCount; }
+
+        // fields：(字段, 原始文本)，空文本表示保持原值
+        void addRow(int line, const QVector<QPair<int, QString>>& fields) {
+            Entry entry;
+            entry.line = line;
+            QString normalized, error;
+            for (const auto& field : fields) {
+                if (field.first == MemberFields::Name || field.first == MemberFields::Group) {
+                    if (!MemberFields::validate(field.first, field.second, normalized, error)) {
+                        fail(line, error);
+                        return;
+                    }
+                    if (field.first == MemberFields::Name) entry.name = normalized;
+                    else entry.group = normalized.toInt();
+                    continue;
+                }
+                if (field.second.trimmed().isEmpty()) continue;
+                if (!MemberFields::validate(field.first, field.second, normalized, error)) {
+                    fail(line, error);
+                    return;
+                }
+                entry.values.append(qMakePair(field.first, normalized));
+            }
+            if (entry.name.isEmpty()) {
+                fail(line, "姓名为空");
+                return;
+            }
+            if (entry.group == 0) {
+                fail(line, "组别为空");
+                return;
+            }
+            if (entry.group > m_groupCount) {
+                fail(line, QString("名单中没有第%1组").arg(entry.group));
+                return;
+            }
+            const auto seen = m_seen.constFind(entry.name);
+            if (seen != m_seen.constEnd()) {
+                fail(line, QString("姓名“%1”与第 %2 行重复").arg(entry.name).arg(seen.value()));
+                return;
+            }
+            m_seen.insert(entry.name, line);
+
+            const RosterSnapshot::Record record = m_index.value(entry.name);
+            if (record && record->getGroup() != entry.group) {
+                fail(line, QString("“%1”已在第%2组，如需调整组别请在界面中修改").arg(entry.name).arg(record->getGroup()));
+                return;
+            }
+            // 在快照记录的副本上试写：set 函数只在值实际变化时分配新修订号，修订号不变即无需修改
+            Person person = record ? *record : newPerson(entry.name, entry.group, true);
+            const std::uint64_t revision = person.getRevision();
+            assignAll(entry, person);
+            entry.isNew = !record;
+            if (entry.isNew) {
+                m_plan.added++;
+            } else if (person.getRevision() != revision) {
+                m_plan.updated++;
+            } else {
+                m_plan.unchanged++;
+                return;
+            }
+            m_plan.entries.append(entry);
+        }
+
+    private:
+        void fail(int line, const QString& message) {
+            m_plan.issues.append({line, message});
+        }
+
+        bool m_includeCounts;
+        int m_groupCount;                               // 名单的组数
+        int m_slotCount;                                // 名单已有地点的时间点数
+        Plan& m_plan;
+        QHash<QString, RosterSnapshot::Record> m_index; // 姓名 -> 快照记录
+        QHash<QString, int> m_seen;                     // 文件中已出现的姓名 -> 行号
+    };
+
+    static Person newPerson(const QString& name, int group, bool isWork) {
+        bool time[4][5] = {};
+        return Person(name.toStdString(), false, group, 1, "", "", "", "", "", "", "", isWork, time, 0, 0);
+    }
+
+    static void assignAll(const Entry& entry, Person& person) {
+        for (const auto& value : entry.values) {
+            MemberFields::assign(value.first, value.second, person);
+        }
+    }
+
+    static bool readCsv(const QString& path, Differ& differ, Plan& plan) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            plan.error = "无法打开文件";
+            return false;
+        }
+        CsvReader reader(&file);
+        QStringList record;
+        QVector<QPair<int, int>> columns; // (列下标, 字段)
+        if (reader.readRecord(record)) {
+            for (int k = 0; k < record.size(); ++k) {
+                const int field = MemberFields::fromName(record.at(k));
+                if (differ.accepts(field, record.at(k).trimmed())) columns.append(qMakePair(k, field));
+            }
+        }
+        bool hasName = false, hasGroup = false;
+        for (const auto& column : columns) {
+            hasName = hasName || column.second == MemberFields::Name;
+            hasGroup = hasGroup || column.second == MemberFields::Group;
+        }
+        if (!hasName || !hasGroup) {
+            plan.error = "表头中缺少“姓名”或“组别”列";
+            return false;
+        }
+        QVector<QPair<int, QString>> fields;
+        while (reader.readRecord(record)) {
+            if (record.join(QString()).trimmed().isEmpty()) continue; // 空行
+            fields.clear();
+            for (const auto& column : columns) {
+                fields.append(qMakePair(column.second, record.value(column.first)));
+            }
+            differ.addRow(reader.recordLine(), fields);
+        }
+        if (reader.hasError()) {
+            plan.error = QString("第 %1 行起引号未闭合").arg(reader.recordLine());
+            return false;
+        }
+        return true;
+    }
+
+    static bool readJson(const QString& path, Differ& differ, Plan& plan) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            plan.error = "无法打开文件";
+            return false;
+        }
+        QJsonParseError parseError;
+        const QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+        if (document.isNull()) {
+            plan.error = "JSON 格式错误：" + parseError.errorString();
+            return false;
+        }
+        // 也接受直接以队员数组作为根的文件
+        const QJsonArray members = document.isArray() ? document.array() : document.object().value("members").toArray();
+        if (document.isObject() && document.object().value("version").toInt(JSON_VERSION) > JSON_VERSION) {
+            plan.error = "文件版本过新，请升级程序后再导入";
+            return false;
+        }
+        QVector<QPair<int, QString>> fields;
+        for (int k = 0; k < members.size(); ++k) {
+            const int line = k + 1;
+            if (!members.at(k).isObject()) {
+                plan.issues.append({line, "不是队员对象"});
+                continue;
+            }
+            const QJsonObject member = members.at(k).toObject();
+            fields.clear();
+            bool valid = true;
+            for (auto it = member.constBegin(); it != member.constEnd() && valid; ++it) {
+                if (it.key() == QLatin1String("availability")) {
+                    const QJsonArray availability = it.value().toArray();
+                    // 按地点依次排列，每个地点10个，可以只写前几个地点
+                    const int slots = availability.size();
+                    const int perLocation = 2 * Person::DAY_COUNT;
+                    if (slots % perLocation != 0 || slots < Person::DEFAULT_LOCATION_COUNT * perLocation || slots > differ.slotCount()) {
+                        plan.issues.append({line, QString("availability 应为%1个0/1").arg(differ.slotCount())});
+                        valid = false;
+                    }
+                    for (int slot = 0; slot < availability.size() && valid; ++slot) {
+                        fields.append(qMakePair(MemberFields::TimeSlot + slot, jsonText(availability.at(slot))));
+                    }
+                    continue;
+                }
+                const int field = MemberFields::fromName(it.key());
+                if (differ.accepts(field, it.key())) fields.append(qMakePair(field, jsonText(it.value())));
+            }
+            if (valid) differ.addRow(line, fields);
+        }
+        return true;
+    }
+
+    // JSON 值的文本形式：数字按整数写出，布尔值为 1/0
+    static QString jsonText(const QJsonValue& value) {
+        if (value.isString()) return value.toString();
+        if (value.isBool()) return value.toBool() ? "1" : "0";
+        if (value.isDouble()) {
+            const double number = value.toDouble();
+            return number == static_cast<qint64>(number) ? QString::number(static_cast<qint64>(number)) : QString::number(number);
+        }
+        return QString();
+    }
+
+    static bool writeCsv(const Flag_group& flagGroup, QFile& file, const RosterBitmap* selection) {
+        QByteArray buffer("\xEF\xBB\xBF");
+        const int fieldCount = MemberFields::fieldCount(flagGroup.locationCount());
+        QStringList cells;
+        for (int field = 0; field < fieldCount; ++field) cells.append(MemberFields::title(field));
+        appendCsvRecord(buffer, cells);
+        int ordinal = 0;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            for (const Person& person : flagGroup.getGroupMembers(i)) {
+                if (selection && !selection->test(ordinal++)) continue;
+                cells.clear();
+                for (int field = 0; field < fieldCount; ++field) cells.append(MemberFields::format(field, person));
+                appendCsvRecord(buffer, cells);
+                if (buffer.size() >= FLUSH_SIZE) {
+                    if (!DurableFile::write(file, buffer)) return false;
+                    buffer.clear();
+                }
+            }
+        }
+        return DurableFile::write(file, buffer);
+    }
+
+    // 写出一条 CSV 记录：含逗号、引号或换行的字段用双引号包围，字段内的引号写为两个
+    static void appendCsvRecord(QByteArray& buffer, const QStringList& cells) {
+        for (int k = 0; k < cells.size(); ++k) {
+            if (k > 0) buffer.append(',');
+            QByteArray cell = cells.at(k).toUtf8();
+            if (cell.contains(',') || cell.contains('"') || cell.contains('\n') || cell.contains('\r')) {
+                cell.replace("\"", "\"\"");
+                buffer.append('"').append(cell).append('"');
+            } else {
+                buffer.append(cell);
+            }
+        }
+        buffer.append("\r\n");
+    }
+
+    // 每名队员写为一行紧凑的 JSON 对象，整体仍是一个合法的 JSON 文档
+    static bool writeJson(const Flag_group& flagGroup, QFile& file, const RosterBitmap* selection) {
+        const int fieldCount = MemberFields::fieldCount(flagGroup.locationCount());
+        QByteArray buffer = QByteArray("{\"version\":") + QByteArray::number(JSON_VERSION) + ",\"members\":[";
+        bool first = true;
+        int ordinal = 0;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            for (const Person& person : flagGroup.getGroupMembers(i)) {
+                if (selection && !selection->test(ordinal++)) continue;
+                QJsonObject member;
+                for (int field = 0; field < MemberFields::TimeSlot; ++field) {
+                    const QString text = MemberFields::format(field, person);
+                    if (field == MemberFields::IsWork) {
+                        member.insert(MemberFields::key(field), person.getIsWork());
+                    } else if (field == MemberFields::Group || field == MemberFields::Grade || MemberFields::isCount(field)) {
+                        member.insert(MemberFields::key(field), text.toInt());
+                    } else {
+                        member.insert(MemberFields::key(field), text);
+                    }
+                }
+                QJsonArray availability;
+                for (int field = MemberFields::TimeSlot; field < fieldCount; ++field) {
+                    availability.append(MemberFields::format(field, person).toInt());
+                }
+                member.insert("availability", availability);
+                buffer.append(first ? "\n" : ",\n").append(QJsonDocument(member).toJson(QJsonDocument::Compact));
+                first = false;
+                if (buffer.size() >= FLUSH_SIZE) {
+                    if (!DurableFile::write(file, buffer)) return false;
+                    buffer.clear();
+                }
+            }
+        }
+        buffer.append("\n]}\n");
+        return DurableFile::write(file, buffer);
+    }
+};
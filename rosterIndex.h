@@ -0,0 +1,435 @@
+// rosterIndex.h头文件
+// 功能说明：队员名单的位图索引与组合查询
+// 按「序号」为每名队员编号（按组号从小到大，组内按顺序），为组别、年级、性别、是否值周、各地点的每个时间点各建一张位图，
+// 学院与班级的每个不同取值也各建一张位图（按字符串池编号区分取值，见 stringPool.h）。位图按 64 位字整体做与 / 或 / 非运算，
+// 例如「大二且周四降旗东西院有空」只需把两张位图逐字相与，不必逐人比较。
+// 索引随名单增量维护：sync 按修订号找出上次同步后发生变化的队员，只更新这些队员在各位图中的位；
+// 组数或各组人数发生变化（增删队员）时序号整体移动，此时完整重建。
+// 尚未从名单文件展开的组直接读取文件中的记录（见 MappedRoster::visitMember），建立索引不会展开任何组。
+// 筛选文本（见 parse）由空格分隔的条件组成，条件之间为「且」，一个条件内用 | 分隔的写法为「或」，前缀 - 或 ! 表示「非」：
+//   一组 / 1组 / 第1组、大一~大三、男 / 女、值周 / 不值周、时间点（如“周四降旗东西院”，也可只写“周四”或“降旗东西院”）、
+//   学院或班级的完整名称；其余文字按姓名、姓名拼音首字母（见 pinyin.h）、学院或班级中包含该文字匹配（不区分大小写）。
+// 文字条件的结果缓存最近几条：输入时逐字追加，新条件包含之前的条件，符合的队员只会更少，只需在之前的结果中查找，
+// 不必重新扫描整个名单。名单有任何变化（sync 更新了队员）时缓存清空。
+
+#pragma once
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QtGlobal>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <utility>
+#include <vector>
+#include "Flag_group.h"
+#include "mappedRoster.h"
+#include "memberFields.h"
+#include "pinyin.h"
+#include "stringPool.h"
+
+// 定长位图：第 i 位表示序号为 i 的队员
+class RosterBitmap
+{
+public:
+    RosterBitmap() {}
+    explicit RosterBitmap(int size, bool value = false) { resize(size, value); }
+
+    int size() const { return m_size; }
+
+    void resize(int size, bool value = false) {
+        m_size = size;
+        m_words.assign((size + 63) / 64, value ? ~quint64(0) : 0);
+        trim();
+    }
+
+    bool test(int i) const { return i >= 0 && i < m_size && ((m_words[i >> 6] >> (i & 63)) & 1); }
+
+    void set(int i, bool value = true) {
+        if (i < 0 || i >= m_size) return;
+        if (value) m_words[i >> 6] |= quint64(1) << (i & 63);
+        else m_words[i >> 6] &= ~(quint64(1) << (i & 63));
+    }
+
+    RosterBitmap& operator&=(const RosterBitmap& other) {
+        for (size_t k = 0; k < m_words.size(); ++k) m_words[k] &= k < other.m_words.size() ? other.m_words[k] : 0;
+        return *this;
+    }
+
+    RosterBitmap& operator|=(const RosterBitmap& other) {
+        for (size_t k = 0; k < m_words.size() && k < other.m_words.size(); ++k) m_words[k] |= other.m_words[k];
+        trim();
+        return *this;
+    }
+
+    RosterBitmap operator~() const {
+        RosterBitmap result(*this);
+        for (quint64& word : result.m_words) word = ~word;
+        result.trim();
+        return result;
+    }
+
+    friend RosterBitmap operator&(RosterBitmap a, const RosterBitmap& b) { return a &= b; }
+    friend RosterBitmap operator|(RosterBitmap a, const RosterBitmap& b) { return a |= b; }
+
+    // 置位的数量
+    int count() const {
+        int total = 0;
+        for (quint64 word : m_words) total += popcount(word);
+        return total;
+    }
+
+    bool any() const {
+        for (quint64 word : m_words) {
+            if (word) return true;
+        }
+        return false;
+    }
+
+    // 按序号从小到大遍历置位的位
+    void forEach(const std::function<void(int)>& visit) const {
+        for (size_t k = 0; k < m_words.size(); ++k) {
+            quint64 word = m_words[k];
+            while (word) {
+                visit(static_cast<int>(k * 64) + lowestBit(word));
+                word &= word - 1;
+            }
+        }
+    }
+
+private:
+    // 清除超出长度的位，保证取反与计数结果正确
+    void trim() {
+        if (m_size % 64 != 0 && !m_words.empty()) m_words.back() &= (quint64(1) << (m_size % 64)) - 1;
+    }
+
+    static int popcount(quint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_popcountll(word);
+#else
+        int total = 0;
+        for (; word; word &= word - 1) ++total;
+        return total;
+#endif
+    }
+
+    static int lowestBit(quint64 word) {
+#if defined(__GNUC__) || defined(__clang__)
+        return __builtin_ctzll(word);
+#else
+        int bit = 0;
+        while (!(word & 1)) {
+            word >>= 1;
+            ++bit;
+        }
+        return bit;
+#endif
+    }
+
+    std::vector<quint64> m_words;
+    int m_size = 0;
+};
+
+class RosterIndex
+{
+public:
+    static constexpr int MAX_GRADE = 3;
+    static constexpr int TEXT_CACHE_SIZE = 8; // 缓存的文字条件数
+
+    explicit RosterIndex(const Flag_group& roster) : m_roster(roster) { sync(); }
+
+    // 与名单同步：只更新修订号发生变化的队员；各组人数变化时完整重建
+    void sync() {
+        std::vector<int> sizes(m_roster.groupCount());
+        for (int i = 1; i <= m_roster.groupCount(); ++i) {
+            sizes[i - 1] = m_roster.memberCount(i);
+        }
+        if (sizes != m_groupSize) {
+            rebuild(sizes);
+            return;
+        }
+        for (int ordinal = 0; ordinal < m_size; ++ordinal) {
+            if (revisionOf(ordinal) != m_entries[ordinal].revision) update(ordinal);
+        }
+    }
+
+    // 队员总数（序号范围为 0 ~ size-1）
+    int size() const { return m_size; }
+
+    // 序号对应的组别（1 ~ 组数）与组内位置
+    int groupOf(int ordinal) const {
+        const int count = static_cast<int>(m_groupStart.size());
+        int group = 1;
+        while (group < count && ordinal >= m_groupStart[group]) ++group;
+        return group;
+    }
+    int positionOf(int ordinal) const { return ordinal - m_groupStart[groupOf(ordinal) - 1]; }
+
+    // 序号对应的队员（展开其所在的组；只读取字段时用 visit）
+    const Person* person(int ordinal) const {
+        if (ordinal < 0 || ordinal >= m_size) return nullptr;
+        const int group = groupOf(ordinal);
+        return &m_roster.getGroupMembers(group)[ordinal - m_groupStart[group - 1]];
+    }
+
+    // 读取序号对应的队员而不展开其所在的组（见 MappedRoster::visitMember），返回 visit 的返回值
+    template <typename Visitor>
+    auto visit(int ordinal, Visitor&& visitor) const {
+        const int group = groupOf(ordinal);
+        return MappedRoster::visitMember(m_roster, group, ordinal - m_groupStart[group - 1], std::forward<Visitor>(visitor));
+    }
+
+    // 名单中队员的序号，不在名单中时返回 -1
+    int ordinalOf(const Person* member) const {
+        for (int i = 1; i <= static_cast<int>(m_groupStart.size()); ++i) {
+            if (m_roster.isGroupMapped(i)) continue; // 尚未展开的组中没有 Person
+            const auto& members = m_roster.getGroupMembers(i);
+            if (!members.empty() && member >= members.data() && member < members.data() + members.size()) {
+                return m_groupStart[i - 1] + static_cast<int>(member - members.data());
+            }
+        }
+        return -1;
+    }
+
+    // 各属性的位图
+    RosterBitmap all() const { return RosterBitmap(m_size, true); }
+    RosterBitmap none() const { return RosterBitmap(m_size); }
+    RosterBitmap group(int group) const {
+        return group >= 1 && group <= static_cast<int>(m_group.size()) ? m_group[group - 1] : none();
+    }
+    RosterBitmap grade(int grade) const { return grade >= 1 && grade <= MAX_GRADE ? m_grade[grade - 1] : none(); }
+    const RosterBitmap& female() const { return m_female; }
+    const RosterBitmap& working() const { return m_working; }
+    // 时间点：row 为 1 ~ Person::MAX_TIME_ROWS（行号见 Person::timeRow），column 为 1~5（周一~周五）
+    const RosterBitmap& available(int row, int column) const {
+        return m_available[MemberFields::timeSlot(qBound(1, row, Person::MAX_TIME_ROWS), qBound(1, column, 5)) - MemberFields::TimeSlot];
+    }
+    RosterBitmap school(const QString& school) const { return valueBits(m_schoolIds, m_school, school); }
+    RosterBitmap classname(const QString& classname) const { return valueBits(m_classIds, m_classname, classname); }
+
+    // 解析筛选文本并求值（格式见文件开头）；空文本选中全部队员
+    RosterBitmap parse(const QString& filter) const {
+        RosterBitmap result = all();
+        const QStringList terms = QString(filter).replace(QChar(0x3000), ' ').split(' ', Qt::SkipEmptyParts); // 也接受全角空格
+        for (QString term : terms) {
+            bool negate = false;
+            if (term.startsWith('-') || term.startsWith('!')) {
+                negate = true;
+                term = term.mid(1);
+            }
+            if (term.isEmpty()) continue;
+            RosterBitmap alternatives = none();
+            for (const QString& word : term.split('|', Qt::SkipEmptyParts)) {
+                alternatives |= match(word);
+            }
+            result &= negate ? ~alternatives : alternatives;
+        }
+        return result;
+    }
+
+private:
+    struct Entry {
+        std::uint64_t revision = 0;
+        int grade = 0;
+        bool female = false;
+        bool working = false;
+        std::uint64_t timeMask = 0;
+        int school = -1;
+        int classname = -1;
+    };
+
+    // 一条文字条件及其结果
+    struct TextMatch {
+        QString word;
+        RosterBitmap bits;
+        int count;
+    };
+
+    void rebuild(const std::vector<int>& sizes) {
+        const int count = static_cast<int>(sizes.size());
+        m_size = 0;
+        m_groupStart.assign(count, 0);
+        m_groupSize = sizes;
+        for (int i = 0; i < count; ++i) {
+            m_groupStart[i] = m_size;
+            m_size += sizes[i];
+        }
+        m_entries.assign(m_size, Entry());
+        m_searchKeys.assign(m_size, QString());
+        m_searchRevision.assign(m_size, ~std::uint64_t(0));
+        m_textMatches.clear();
+        m_group.assign(count, RosterBitmap());
+        for (int i = 0; i < count; ++i) {
+            m_group[i].resize(m_size);
+            for (int k = 0; k < sizes[i]; ++k) m_group[i].set(m_groupStart[i] + k);
+        }
+        for (RosterBitmap& bits : m_grade) bits.resize(m_size);
+        m_female.resize(m_size);
+        m_working.resize(m_size);
+        for (RosterBitmap& bits : m_available) bits.resize(m_size);
+        for (RosterBitmap& bits : m_school) bits.resize(m_size);
+        for (RosterBitmap& bits : m_classname) bits.resize(m_size);
+        for (int ordinal = 0; ordinal < m_size; ++ordinal) {
+            m_entries[ordinal].revision = ~std::uint64_t(0);
+            update(ordinal);
+        }
+    }
+
+    // 序号对应队员的修订号（不展开其所在的组）
+    std::uint64_t revisionOf(int ordinal) const {
+        const int group = groupOf(ordinal);
+        return m_roster.memberRevision(group, ordinal - m_groupStart[group - 1]);
+    }
+
+    void update(int ordinal) {
+        const std::uint64_t revision = revisionOf(ordinal);
+        visit(ordinal, [&](const auto& member) { update(ordinal, member, revision); });
+    }
+
+    // 按队员当前内容更新其在各位图中的位（只改动发生变化的属性）；Member 为 Person 或名单文件中的记录
+    template <typename Member>
+    void update(int ordinal, const Member& member, std::uint64_t revision) {
+        Entry& entry = m_entries[ordinal];
+        const bool fresh = entry.revision == ~std::uint64_t(0);
+        entry.revision = revision;
+        m_textMatches.clear();
+        const int grade = member.getGrade();
+        if (fresh || grade != entry.grade) {
+            if (entry.grade >= 1 && entry.grade <= MAX_GRADE) m_grade[entry.grade - 1].set(ordinal, false);
+            if (grade >= 1 && grade <= MAX_GRADE) m_grade[grade - 1].set(ordinal);
+            entry.grade = grade;
+        }
+        entry.female = member.getGender();
+        m_female.set(ordinal, entry.female);
+        entry.working = member.getIsWork();
+        m_working.set(ordinal, entry.working);
+        const std::uint64_t mask = member.getTimeMask();
+        if (fresh || mask != entry.timeMask) {
+            for (int slot = 0; slot < Person::MAX_TIME_SLOTS; ++slot) m_available[slot].set(ordinal, (mask >> slot) & 1);
+            entry.timeMask = mask;
+        }
+        entry.school = intern(m_schoolIds, m_school, entry.school, member.getSchoolId(), ordinal);
+        entry.classname = intern(m_classIds, m_classname, entry.classname, member.getClassnameId(), ordinal);
+    }
+
+    // 学院 / 班级：每个取值（字符串池编号）一张位图；返回该取值对应的位图下标
+    int intern(QHash<StringPool::Id, int>& ids, std::vector<RosterBitmap>& bits, int oldId, StringPool::Id value, int ordinal) {
+        int id = -1;
+        if (value != StringPool::EMPTY) {
+            auto it = ids.constFind(value);
+            if (it == ids.constEnd()) {
+                it = ids.insert(value, static_cast<int>(bits.size()));
+                bits.emplace_back(m_size);
+            }
+            id = it.value();
+        }
+        if (id == oldId) return id;
+        if (oldId >= 0) bits[oldId].set(ordinal, false);
+        if (id >= 0) bits[id].set(ordinal);
+        return id;
+    }
+
+    // 只查询字符串池，不把筛选文字加入池中
+    static int valueIndex(const QHash<StringPool::Id, int>& ids, const QString& value) {
+        const StringPool::Id id = StringPool::shared().find(value.toStdString());
+        return id == StringPool::EMPTY ? -1 : ids.value(id, -1);
+    }
+
+    RosterBitmap valueBits(const QHash<StringPool::Id, int>& ids, const std::vector<RosterBitmap>& bits, const QString& value) const {
+        const int index = valueIndex(ids, value);
+        return index < 0 ? none() : bits[index];
+    }
+
+    // 单个筛选词
+    RosterBitmap match(const QString& word) const {
+        static const QStringList grades = {"大一", "大二", "大三"};
+        static const QStringList days = {"周一", "周二", "周三", "周四", "周五"};
+        if (word.endsWith("组")) {
+            // 一组、1组、第1组
+            bool isNumber = false;
+            const int number = QString(word).remove(0, word.startsWith("第") ? 1 : 0).chopped(1).toInt(&isNumber);
+            if (isNumber) return group(number);
+            for (int i = 1; i <= static_cast<int>(m_group.size()); ++i) {
+                if (word == Flag_group::groupTitle(i)) return group(i);
+            }
+        }
+        if (grades.contains(word)) return grade(grades.indexOf(word) + 1);
+        if (word == "男") return ~m_female;
+        if (word == "女") return m_female;
+        if (word == "值周") return m_working;
+        if (word == "不值周") return ~m_working;
+        const int field = MemberFields::fromName(word);
+        if (MemberFields::isTimeSlot(field)) return m_available[field - MemberFields::TimeSlot];
+        if (days.contains(word)) {
+            // 当天任一时间点有空
+            RosterBitmap bits = none();
+            for (int row = 1; row <= m_roster.locationCount() * 2; ++row) bits |= available(row, days.indexOf(word) + 1);
+            return bits;
+        }
+        for (int row = 1; row <= m_roster.locationCount() * 2; ++row) {
+            // 一周中任一天的该时间点有空（如“降旗东西院”）
+            if (word != QString(Person::rowCeremony(row) == 0 ? "升旗" : "降旗") + Flag_group::locationTitle(Person::rowLocation(row))) continue;
+            RosterBitmap bits = none();
+            for (int column = 1; column <= 5; ++column) bits |= available(row, column);
+            return bits;
+        }
+        if (valueIndex(m_schoolIds, word) >= 0) return school(word);
+        if (valueIndex(m_classIds, word) >= 0) return classname(word);
+        return textMatch(word.toLower());
+    }
+
+    // 文字条件：姓名、拼音首字母、学院或班级中包含该文字
+    RosterBitmap textMatch(const QString& word) const {
+        // 缓存中有被本条件包含的条件时，只在其中人数最少的结果里查找
+        const TextMatch* narrowest = nullptr;
+        for (const TextMatch& cached : m_textMatches) {
+            if (cached.word == word) return cached.bits;
+            if (word.contains(cached.word) && (!narrowest || cached.count < narrowest->count)) narrowest = &cached;
+        }
+        RosterBitmap bits = none();
+        const auto test = [&](int ordinal) {
+            if (searchKey(ordinal).contains(word)) bits.set(ordinal);
+        };
+        if (narrowest) {
+            narrowest->bits.forEach(test);
+        } else {
+            for (int ordinal = 0; ordinal < m_size; ++ordinal) test(ordinal);
+        }
+        m_textMatches.push_front({word, bits, bits.count()});
+        if (static_cast<int>(m_textMatches.size()) > TEXT_CACHE_SIZE) m_textMatches.pop_back();
+        return bits;
+    }
+
+    // 队员的检索文字（小写）：姓名、拼音首字母、学院、班级，以换行分隔，队员修改后按需重新生成
+    const QString& searchKey(int ordinal) const {
+        const std::uint64_t revision = revisionOf(ordinal);
+        if (m_searchRevision[ordinal] != revision) {
+            m_searchKeys[ordinal] = visit(ordinal, [](const auto& member) {
+                const QString name = QString::fromStdString(member.getName());
+                return (name + '\n' + Pinyin::initials(name) + '\n' + QString::fromStdString(member.getSchool())
+                        + '\n' + QString::fromStdString(member.getClassname())).toLower();
+            });
+            m_searchRevision[ordinal] = revision;
+        }
+        return m_searchKeys[ordinal];
+    }
+
+    const Flag_group& m_roster;
+    int m_size = 0;
+    std::vector<int> m_groupStart;  // 各组第一名队员的序号
+    std::vector<int> m_groupSize;   // 上次同步时各组人数（组数或人数变化时重建）
+    std::vector<Entry> m_entries;
+    std::vector<RosterBitmap> m_group;
+    RosterBitmap m_grade[MAX_GRADE];
+    RosterBitmap m_female;
+    RosterBitmap m_working;
+    RosterBitmap m_available[Person::MAX_TIME_SLOTS];
+    QHash<StringPool::Id, int> m_schoolIds; // 字符串池编号 -> m_school 下标
+    std::vector<RosterBitmap> m_school;
+    QHash<StringPool::Id, int> m_classIds;  // 字符串池编号 -> m_classname 下标
+    std::vector<RosterBitmap> m_classname;
+    mutable std::vector<QString> m_searchKeys;            // 各队员的检索文字（见 searchKey）
+    mutable std::vector<std::uint64_t> m_searchRevision;  // 生成检索文字时队员的修订号
+    mutable std::deque<TextMatch> m_textMatches;          // 最近的文字条件及其结果，最近使用的在前
+};
@@ -0,0 +1,181 @@
+// rosterListModel.h头文件
+// 功能说明：队员管理工具栏中一个组的组员标签列表模型
+// 模型只保存列表中每一行对应的组内位置与显示的姓名，不复制队员本身。
+// 名单修改后调用 refresh 传入新的可见队员位置（已按组内位置升序），模型与当前内容比较后只发出
+// 实际变化的行的 rowsRemoved / rowsInserted / dataChanged 信号，列表保留滚动位置与选中状态，
+// 刷新的界面开销只与变化的行数有关。
+// 比较按姓名进行（同组内姓名不重复）：增删队员、调整组别、撤销与筛选都不改变其余队员的先后顺序，
+// 因此删去消失的姓名后，剩余行一定是新列表的子序列，缺少的部分按连续区间插入。
+// 行数不变且每行位置相同时（改名）只通知姓名变化的行。
+// 姓名通过 MappedRoster::visitMember 读取，尚未从名单文件展开的组不会因显示列表而展开。
+// 列表分页加载：模型一开始只向列表提供前 PAGE_SIZE 行，滚动到末尾时列表通过 canFetchMore / fetchMore 取下一页，
+// 队员很多时打开页面不必为每名队员创建显示项；尚未提供给列表的行照常参与比较，但不发出任何信号。
+
+#pragma once
+#include <QAbstractListModel>
+#include <QDebug>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include "Flag_group.h"
+#include "mappedRoster.h"
+
+class RosterListModel : public QAbstractListModel
+{
+    Q_OBJECT
+public:
+    static constexpr int PositionRole = Qt::UserRole; // 行对应的组内位置
+    static constexpr int PAGE_SIZE = 200;             // 每次向列表提供的行数
+
+    RosterListModel(Flag_group& roster, int group, QObject* parent = nullptr)
+        : QAbstractListModel(parent), m_roster(roster), m_group(group) {}
+
+    int group() const { return m_group; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override {
+        return parent.isValid() ? 0 : m_visible;
+    }
+
+    // 列表中的全部队员数（含尚未提供给列表的行）
+    int memberCount() const { return m_rows.size(); }
+
+    bool canFetchMore(const QModelIndex& parent) const override {
+        return !parent.isValid() && m_visible < m_rows.size();
+    }
+
+    // 向列表提供下一页
+    void fetchMore(const QModelIndex& parent) override {
+        if (parent.isValid()) return;
+        const int count = qMin(PAGE_SIZE, m_rows.size() - m_visible);
+        if (count <= 0) return;
+        beginInsertRows(QModelIndex(), m_visible, m_visible + count - 1);
+        m_visible += count;
+        endInsertRows();
+    }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid() || index.row() >= m_visible) return QVariant();
+        const Row& row = m_rows.at(index.row());
+        if (role == Qt::DisplayRole || role == Qt::ToolTipRole) return row.name;
+        if (role == PositionRole) return row.position;
+        return QVariant();
+    }
+
+    // 列表行号对应的组内位置，无效时返回 -1
+    int positionAt(int row) const { return row >= 0 && row < m_visible ? m_rows.at(row).position : -1; }
+
+    // 按新的可见队员位置更新列表，只通知发生变化的行
+    void refresh(const QVector<int>& positions) {
+        const int count = m_roster.memberCount(m_group);
+        QVector<Row> next;
+        next.reserve(positions.size());
+        for (int position : positions) {
+            if (position >= 0 && position < count) {
+                next.append({position, MappedRoster::visitMember(m_roster, m_group, position, [](const auto& member) {
+                                 return QString::fromStdString(member.getName());
+                             })});
+            }
+        }
+
+        // 第一次填充：只提供第一页
+        if (m_rows.isEmpty()) {
+            beginResetModel();
+            m_rows = next;
+            m_visible = qMin(PAGE_SIZE, m_rows.size());
+            endResetModel();
+            return;
+        }
+
+        // 行数与位置都不变：只可能是改名，逐行比较姓名
+        if (samePositions(next)) {
+            for (int row = 0; row < next.size(); ++row) {
+                if (m_rows[row].name != next[row].name) {
+                    m_rows[row].name = next[row].name;
+                    if (row >= m_visible) continue;
+                    const QModelIndex changed = index(row);
+                    emit dataChanged(changed, changed, {Qt::DisplayRole, Qt::ToolTipRole});
+                }
+            }
+            return;
+        }
+
+        // 删除新列表中已不存在的行（从后往前按连续区间删除，行号不受前面删除的影响）
+        QSet<QString> names;
+        names.reserve(next.size());
+        for (const Row& row : next) names.insert(row.name);
+        for (int last = m_rows.size() - 1; last >= 0; --last) {
+            if (names.contains(m_rows[last].name)) continue;
+            int first = last;
+            while (first > 0 && !names.contains(m_rows[first - 1].name)) --first;
+            removeRange(first, last);
+            last = first;
+        }
+
+        // 剩余行是新列表的子序列：更新位置，并把缺少的连续区间插入到对应行之前
+        int row = 0;
+        for (int k = 0; k < next.size();) {
+            if (row < m_rows.size() && m_rows[row].name == next[k].name) {
+                m_rows[row++].position = next[k++].position;
+                continue;
+            }
+            int end = k + 1;
+            while (end < next.size() && !(row < m_rows.size() && m_rows[row].name == next[end].name)) ++end;
+            insertRange(row, next, k, end);
+            row += end - k;
+            k = end;
+        }
+
+        // 组内出现重名等无法逐行对应的情况，整体重置
+        if (row != m_rows.size()) {
+            qDebug() << "[RosterListModel::refresh] 第" << m_group << "组的列表无法逐行对应，整体重置";
+            beginResetModel();
+            m_rows = next;
+            m_visible = qMin(qMax(m_visible, PAGE_SIZE), m_rows.size());
+            endResetModel();
+        }
+    }
+
+private:
+    struct Row {
+        int position;  // 组内位置
+        QString name;  // 显示的姓名
+    };
+
+    // 删除 [first, last] 行，只通知已提供给列表的部分
+    void removeRange(int first, int last) {
+        const int visibleLast = qMin(last, m_visible - 1);
+        if (first > visibleLast) {
+            m_rows.remove(first, last - first + 1);
+            return;
+        }
+        beginRemoveRows(QModelIndex(), first, visibleLast);
+        m_rows.remove(first, last - first + 1);
+        m_visible -= visibleLast - first + 1;
+        endRemoveRows();
+    }
+
+    // 把 source[begin, end) 插入到第 row 行之前；插入位置在已提供的行之内（或全部行都已提供）时一并提供给列表，
+    // 否则这些行等列表取下一页时再提供
+    void insertRange(int row, const QVector<Row>& source, int begin, int end) {
+        const bool visible = row < m_visible || m_visible == m_rows.size();
+        if (visible) beginInsertRows(QModelIndex(), row, row + (end - begin) - 1);
+        for (int j = begin; j < end; ++j) m_rows.insert(row + (j - begin), source[j]);
+        if (visible) {
+            m_visible += end - begin;
+            endInsertRows();
+        }
+    }
+
+    bool samePositions(const QVector<Row>& next) const {
+        if (next.size() != m_rows.size()) return false;
+        for (int row = 0; row < next.size(); ++row) {
+            if (next[row].position != m_rows[row].position) return false;
+        }
+        return true;
+    }
+
+    Flag_group& m_roster;
+    int m_group;            // 组号（1 ~ 组数）
+    QVector<Row> m_rows;    // 列表中的队员，按组内位置升序
+    int m_visible = 0;      // 已提供给列表的行数（m_rows 的前缀）
+};
@@ -0,0 +1,309 @@
+// rosterSnapshot.h头文件
+// 功能说明：排班历史使用的写时复制（copy-on-write）队员快照
+// 快照中每名队员以 shared_ptr<const Person> 保存，多个历史快照之间共享未被修改的队员记录（连同其全部字符串信息），
+// 只有内容发生变化的队员才会复制一份新记录。因此历史记录占用的内存只与每次排班之间实际变化的队员数量成正比。
+// 每组的记录按 CHUNK_SIZE 条分块保存，块本身也在快照之间共享：生成快照时复制上一份快照的块列表（每块一个指针），
+// 按名单的修改登记（见 Flag_group::changesSince）只替换发生变化的队员所在的块，耗时与变化的队员数成正比。
+// 登记不可用时（第一份快照、名单被整体替换、队员被直接增删等）退回逐人比对修订号。
+
+#pragma once
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+#include "Flag_group.h"
+
+class RosterSnapshot
+{
+public:
+    using Record = std::shared_ptr<const Person>; // 只读共享的队员记录
+    static constexpr int CHUNK_SIZE = 64;          // 每块的记录数
+
+    // 一个组的全部记录：除最后一块外每块都是满的，块在快照之间共享，修改前先复制
+    class GroupRecords
+    {
+    public:
+        class const_iterator
+        {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = Record;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const Record*;
+            using reference = const Record&;
+            const_iterator(const GroupRecords* records, size_t index) : m_records(records), m_index(index) {}
+            reference operator*() const { return (*m_records)[m_index]; }
+            pointer operator->() const { return &(*m_records)[m_index]; }
+            const_iterator& operator++() { ++m_index; return *this; }
+            bool operator==(const const_iterator& other) const { return m_index == other.m_index; }
+            bool operator!=(const const_iterator& other) const { return m_index != other.m_index; }
+        private:
+            const GroupRecords* m_records;
+            size_t m_index;
+        };
+
+        size_t size() const { return m_count; }
+        bool empty() const { return m_count == 0; }
+        const Record& operator[](size_t k) const { return (*m_chunks[k / CHUNK_SIZE])[k % CHUNK_SIZE]; }
+        const_iterator begin() const { return const_iterator(this, 0); }
+        const_iterator end() const { return const_iterator(this, m_count); }
+
+    private:
+        friend class RosterSnapshot;
+        using Chunk = std::vector<Record>;
+
+        void append(Record record) {
+            if (m_count % CHUNK_SIZE == 0) {
+                m_chunks.push_back(std::make_shared<Chunk>());
+                m_chunks.back()->reserve(CHUNK_SIZE);
+            }
+            writableChunk(m_chunks.size() - 1).push_back(std::move(record));
+            ++m_count;
+        }
+
+        void set(size_t k, Record record) { writableChunk(k / CHUNK_SIZE)[k % CHUNK_SIZE] = std::move(record); }
+
+        // 在第 k 条之前插入一条记录（可为空，稍后由 set 填入）：第 k 条所在块及之后的块重新分块
+        void insert(size_t k, Record record) {
+            std::vector<Record> tail = takeTail(k);
+            tail.insert(tail.begin() + (k % CHUNK_SIZE), std::move(record));
+            for (Record& item : tail) append(std::move(item));
+        }
+
+        // 删除第 k 条记录
+        void erase(size_t k) {
+            std::vector<Record> tail = takeTail(k);
+            tail.erase(tail.begin() + (k % CHUNK_SIZE));
+            for (Record& item : tail) append(std::move(item));
+        }
+
+        // 取出第 k 条所在块及之后的全部记录
+        std::vector<Record> takeTail(size_t k) {
+            const size_t first = k / CHUNK_SIZE;
+            std::vector<Record> tail;
+            tail.reserve(m_count - first * CHUNK_SIZE + 1);
+            for (size_t c = first; c < m_chunks.size(); ++c) {
+                tail.insert(tail.end(), m_chunks[c]->begin(), m_chunks[c]->end());
+            }
+            m_chunks.resize(first);
+            m_count = first * CHUNK_SIZE;
+            return tail;
+        }
+
+        // 与其他快照共享的块先复制一份
+        Chunk& writableChunk(size_t c) {
+            if (m_chunks[c].use_count() > 1) m_chunks[c] = std::make_shared<Chunk>(*m_chunks[c]);
+            return *m_chunks[c];
+        }
+
+        std::vector<std::shared_ptr<Chunk>> m_chunks;
+        size_t m_count = 0;
+    };
+
+    RosterSnapshot() : group(Flag_group::DEFAULT_GROUP_COUNT) {}
+
+    // 从当前队员容器生成快照
+    // previous：上一份快照（可为空）。previous 取自同一名单且之后的修改登记完整时，只处理登记中的队员；
+    // 否则逐人比对修订号，修订号一致的队员直接共享上一份快照中的记录，不复制任何字符串。
+    static RosterSnapshot capture(const Flag_group& live, const RosterSnapshot* previous = nullptr) {
+        const Flag_group::Change* begin = nullptr;
+        const Flag_group::Change* end = nullptr;
+        if (previous && previous->groupCount() == live.groupCount() && live.changesSince(previous->m_mark, &begin, &end)) {
+            RosterSnapshot snapshot = *previous;
+            if (snapshot.applyChanges(live, begin, end)) {
+                snapshot.m_locationCount = live.locationCount();
+                snapshot.m_mark = live.changeMark();
+                return snapshot;
+            }
+        }
+        RosterSnapshot snapshot = compareAll(live, previous);
+        snapshot.m_locationCount = live.locationCount();
+        // 登记不完整（队员被直接增删等）：逐人比对之后从当前名单重新开始登记
+        if (live.changeTrackingLost()) live.restartChangeTracking();
+        snapshot.m_mark = live.changeMark();
+        return snapshot;
+    }
+
+    // 从文件读取的队员容器生成快照
+    // 读取得到的 Person 修订号都是新分配的，因此与上一份快照逐字段比较内容，内容一致的队员同样共享记录
+    static RosterSnapshot fromLoaded(const Flag_group& loaded, const RosterSnapshot* previous = nullptr) {
+        RosterSnapshot snapshot;
+        snapshot.setGroupCount(loaded.groupCount());
+        snapshot.setLocationCount(loaded.locationCount());
+        for (int i = 1; i <= loaded.groupCount(); ++i) {
+            const auto& members = loaded.getGroupMembers(i);
+            GroupRecords& records = snapshot.group[i - 1];
+            const GroupRecords& previousRecords = previous ? previous->getGroupRecords(i) : records;
+            for (size_t k = 0; k < members.size(); ++k) {
+                if (previous && k < previousRecords.size() && previousRecords[k]->sameContentAs(members[k])) {
+                    records.append(previousRecords[k]);
+                } else {
+                    records.append(std::make_shared<const Person>(members[k]));
+                }
+            }
+        }
+        return snapshot;
+    }
+
+    // 展开为完整的队员容器（用于回退到历史记录）
+    Flag_group toFlagGroup() const {
+        Flag_group result;
+        result.setGroupCount(groupCount());
+        result.setLocationCount(m_locationCount);
+        for (int i = 1; i <= groupCount(); ++i) {
+            auto& members = result.getGroupMembers(i);
+            members.reserve(group[i - 1].size());
+            for (const auto& record : group[i - 1]) {
+                members.push_back(*record);
+            }
+        }
+        return result;
+    }
+
+    // 组数（与生成快照时的名单一致）
+    int groupCount() const { return static_cast<int>(group.size()); }
+    // 设置组数（从历史文件重建快照时使用），多出的组为空
+    void setGroupCount(int count) { group.resize(std::max(1, count)); }
+
+    // 执勤地点数（与生成快照时的名单一致）
+    int locationCount() const { return m_locationCount; }
+    void setLocationCount(int count) {
+        m_locationCount = std::max(Person::DEFAULT_LOCATION_COUNT, std::min(count, Person::MAX_LOCATION_COUNT));
+    }
+
+    // 获取指定组的全部队员记录（只读）
+    const GroupRecords& getGroupRecords(int groupNumber) const {
+        if (groupNumber >= 1 && groupNumber <= groupCount()) {
+            return group[groupNumber - 1];
+        }
+        static const GroupRecords emptyGroup;
+        return emptyGroup;
+    }
+
+    // 向指定组末尾追加一条记录（从历史文件重建快照时使用）
+    void appendRecord(int groupNumber, Record record) {
+        if (groupNumber >= 1 && groupNumber <= groupCount() && record) {
+            group[groupNumber - 1].append(std::move(record));
+        }
+    }
+
+    // 快照中的总队员数
+    int memberCount() const {
+        int count = 0;
+        for (const auto& records : group) {
+            count += static_cast<int>(records.size());
+        }
+        return count;
+    }
+
+    // 统计与另一份快照共享的记录数量（调试与内存统计用）
+    int sharedRecordCount(const RosterSnapshot& other) const {
+        int shared = 0;
+        for (int i = 0; i < std::min(groupCount(), other.groupCount()); ++i) {
+            const size_t n = std::min(group[i].size(), other.group[i].size());
+            for (size_t k = 0; k < n; ++k) {
+                if (group[i][k] == other.group[i][k]) {
+                    ++shared;
+                }
+            }
+        }
+        return shared;
+    }
+
+private:
+    // 逐人比对：常规情况下队员顺序不变，按位置比对修订号即可命中；只有位置错开时才建立修订号索引
+    static RosterSnapshot compareAll(const Flag_group& live, const RosterSnapshot* previous) {
+        RosterSnapshot snapshot;
+        snapshot.setGroupCount(live.groupCount());
+        std::unordered_map<std::uint64_t, Record> revisionIndex; // 修订号 -> 上一份快照中的记录，按需建立
+        bool indexBuilt = false;
+        for (int i = 1; i <= live.groupCount(); ++i) {
+            const auto& members = live.getGroupMembers(i);
+            GroupRecords& records = snapshot.group[i - 1];
+            for (size_t k = 0; k < members.size(); ++k) {
+                const Person& person = members[k];
+                Record shared;
+                if (previous) {
+                    const GroupRecords& previousRecords = previous->getGroupRecords(i);
+                    // 快速路径：同一位置的记录修订号一致
+                    if (k < previousRecords.size() && previousRecords[k]->getRevision() == person.getRevision()) {
+                        shared = previousRecords[k];
+                    } else {
+                        // 慢速路径：队员增删导致位置错开，按修订号查找
+                        if (!indexBuilt) {
+                            for (const auto& previousGroup : previous->group) {
+                                for (const auto& record : previousGroup) {
+                                    revisionIndex.emplace(record->getRevision(), record);
+                                }
+                            }
+                            indexBuilt = true;
+                        }
+                        auto it = revisionIndex.find(person.getRevision());
+                        if (it != revisionIndex.end()) {
+                            shared = it->second;
+                        }
+                    }
+                }
+                // 未命中共享记录：只复制这一名发生变化的队员
+                records.append(shared ? shared : std::make_shared<const Person>(person));
+            }
+        }
+        return snapshot;
+    }
+
+    // 在上一份快照的副本上按顺序执行修改登记：插入与删除调整记录位置，登记过的位置最后按当前名单重新复制。
+    // 登记与名单不一致时返回 false，由调用方逐人比对
+    bool applyChanges(const Flag_group& live, const Flag_group::Change* begin, const Flag_group::Change* end) {
+        std::vector<std::vector<int>> touched(group.size()); // 各组需要重新复制的位置（执行完全部登记后的位置）
+        for (const Flag_group::Change* change = begin; change != end; ++change) {
+            if (change->group < 1 || change->group > groupCount()) return false;
+            GroupRecords& records = group[change->group - 1];
+            std::vector<int>& positions = touched[change->group - 1];
+            const int index = change->index;
+            switch (change->kind) {
+            case Flag_group::Change::Modified:
+                if (index < 0 || index >= static_cast<int>(records.size())) return false;
+                positions.push_back(index);
+                break;
+            case Flag_group::Change::Inserted:
+                if (index < 0 || index > static_cast<int>(records.size())) return false;
+                records.insert(static_cast<size_t>(index), nullptr); // 占位，最后复制
+                for (int& position : positions) {
+                    if (position >= index) ++position;
+                }
+                positions.push_back(index);
+                break;
+            case Flag_group::Change::Removed:
+                if (index < 0 || index >= static_cast<int>(records.size())) return false;
+                records.erase(static_cast<size_t>(index));
+                positions.erase(std::remove(positions.begin(), positions.end(), index), positions.end());
+                for (int& position : positions) {
+                    if (position > index) --position;
+                }
+                break;
+            }
+        }
+        for (int i = 1; i <= groupCount(); ++i) {
+            GroupRecords& records = group[i - 1];
+            if (records.size() != static_cast<size_t>(live.memberCount(i))) return false;
+            std::vector<int>& positions = touched[i - 1];
+            if (positions.empty()) continue; // 没有登记的组不必访问（尚未展开的组保持不展开，见 Flag_group::attachMappedRoster）
+            const auto& members = live.getGroupMembers(i);
+            std::sort(positions.begin(), positions.end());
+            positions.erase(std::unique(positions.begin(), positions.end()), positions.end());
+            for (int position : positions) {
+                const Person& person = members[position];
+                // 赋值等未改变修订号的登记：内容与原记录相同，仍共享原记录
+                if (!records[position] || records[position]->getRevision() != person.getRevision()) {
+                    records.set(static_cast<size_t>(position), std::make_shared<const Person>(person));
+                }
+            }
+        }
+        return true;
+    }
+
+    std::vector<GroupRecords> group; // 按组存放队员的共享记录，group[i] 为第 i+1 组
+    int m_locationCount = Person::DEFAULT_LOCATION_COUNT; // 执勤地点数
+    Flag_group::ChangeMark m_mark;   // 生成快照时名单的登记位置（从文件重建的快照为空，不与任何名单对应）
+};
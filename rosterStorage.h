@@ -0,0 +1,146 @@
+// rosterStorage.h头文件
+// 功能说明：名单与排表历史的存储后端接口，以及基于现有文件格式的实现
+// 接口统一了名单读写、按条件查询与历史记录存取，现有的加密文件（data.dat + schedule_history.dat）与
+// 可选的 SQLite 数据库（见 sqliteRosterStorage.h）都实现该接口，可用 rosterStorageBenchmark.h 对比两者的耗时。
+// 主界面通过该接口读写名单（见 SystemWindow 构造函数与 saveDataToFile）：数据目录中存在 data.sqlite 时使用 SQLite，否则使用加密文件。
+
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QDir>
+#include "Flag_group.h"
+#include "encryptedFileManager.h"
+#include "scheduleHistory.h"
+
+class RosterStorageBackend
+{
+public:
+    virtual ~RosterStorageBackend() {}
+
+    virtual QString backendName() const = 0; // 后端名称（用于对比报告）
+    virtual bool open() = 0;                 // 打开存储（文件不存在时创建）
+
+    // 名单
+    virtual bool hasRoster() = 0;                                // 存储中是否已保存过名单
+    virtual bool loadRoster(Flag_group& flagGroup) = 0;          // 读取完整名单
+    virtual bool saveRoster(Flag_group& flagGroup) = 0;          // 保存名单（后端支持时只写出修改过的队员），成功后清空修改记录
+    virtual bool importRoster(const Flag_group& flagGroup) = 0;  // 批量导入：整体替换已保存的名单
+    virtual QStringList memberNames(int groupNumber) = 0;        // 指定组的队员姓名（界面列表按需加载详细信息）
+
+    // 按条件查询（结果按组别、组内顺序排列）
+    virtual QVector<Person> findByName(const QString& name) = 0;
+    virtual QVector<Person> membersOfGroup(int groupNumber) = 0;
+    virtual QVector<Person> membersOfGrade(int grade) = 0;
+    virtual QVector<Person> membersAvailableAt(int row, int column) = 0; // 对应 Person::getTime(row, column)
+
+    // 排表历史
+    virtual bool appendHistory(const ScheduleHistoryItem& item) = 0;       // 追加一条记录并写入存储
+    virtual int historyCount() = 0;
+    virtual bool loadHistory(int index, ScheduleHistoryItem& item) = 0;   // 读取一条记录的完整内容
+};
+
+// 现有文件格式：名单为加密文件（增量更新日志），历史为排表历史文件；任何查询都需要读入完整名单
+class FileRosterStorage : public RosterStorageBackend
+{
+public:
+    // dataDirectory：数据目录（与程序使用的 ./data 结构一致）
+    explicit FileRosterStorage(const QString& dataDirectory)
+        : m_rosterPath(QDir(dataDirectory).filePath("data.dat")),
+          m_historyPath(QDir(dataDirectory).filePath("schedule_history.dat")) {}
+
+    QString backendName() const override { return "加密文件"; }
+
+    // 历史文件在第一次存取历史时才读入（主界面只通过本后端读写名单，历史由 ScheduleHistoryManager 直接管理）
+    bool open() override {
+        return QDir().mkpath(QFileInfo(m_rosterPath).absolutePath());
+    }
+
+    bool hasRoster() override {
+        return QFile::exists(m_rosterPath);
+    }
+
+    bool loadRoster(Flag_group& flagGroup) override {
+        return EncryptedFileManager::loadFromFile(flagGroup, m_rosterPath);
+    }
+
+    bool saveRoster(Flag_group& flagGroup) override {
+        return EncryptedFileManager::saveIncremental(flagGroup, m_rosterPath);
+    }
+
+    bool importRoster(const Flag_group& flagGroup) override {
+        return EncryptedFileManager::saveToFile(flagGroup, m_rosterPath);
+    }
+
+    QStringList memberNames(int groupNumber) override {
+        QStringList names;
+        for (const Person& person : membersOfGroup(groupNumber)) {
+            names.append(QString::fromStdString(person.getName()));
+        }
+        return names;
+    }
+
+    QVector<Person> findByName(const QString& name) override {
+        const std::string key = name.toStdString();
+        return filter([&key](const Person& person) { return person.getName() == key; });
+    }
+
+    QVector<Person> membersOfGroup(int groupNumber) override {
+        return filter([groupNumber](const Person& person) { return person.getGroup() == groupNumber; });
+    }
+
+    QVector<Person> membersOfGrade(int grade) override {
+        return filter([grade](const Person& person) { return person.getGrade() == grade; });
+    }
+
+    QVector<Person> membersAvailableAt(int row, int column) override {
+        return filter([row, column](const Person& person) { return person.getTime(row, column); });
+    }
+
+    bool appendHistory(const ScheduleHistoryItem& item) override {
+        if (!ensureHistory()) return false;
+        m_history.addHistoryItem(item);
+        return m_history.saveToFile(); // 历史文件整体重写
+    }
+
+    int historyCount() override {
+        return ensureHistory() ? m_history.getHistoryCount() : 0;
+    }
+
+    bool loadHistory(int index, ScheduleHistoryItem& item) override {
+        if (!ensureHistory()) return false;
+        const ScheduleHistoryItem* found = m_history.getHistory(index);
+        if (!found) return false;
+        item = *found;
+        return true;
+    }
+
+private:
+    // 第一次存取历史时读入历史文件
+    bool ensureHistory() {
+        if (m_historyLoaded) return true;
+        m_history.setHistoryFilePath(m_historyPath);
+        if (QFile::exists(m_historyPath) && !m_history.loadFromFile(m_historyPath)) return false;
+        m_historyLoaded = true;
+        return true;
+    }
+
+    // 读入完整名单后逐人筛选
+    template <typename Predicate>
+    QVector<Person> filter(Predicate predicate) {
+        QVector<Person> result;
+        Flag_group flagGroup;
+        if (!loadRoster(flagGroup)) return result;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            for (const Person& person : flagGroup.getGroupMembers(i)) {
+                if (predicate(person)) result.append(person);
+            }
+        }
+        return result;
+    }
+
+    QString m_rosterPath;
+    QString m_historyPath;
+    ScheduleHistoryManager m_history;
+    bool m_historyLoaded = false;
+};
@@ -0,0 +1,105 @@
+// rosterStorageBenchmark.h头文件
+// 功能说明：对比各存储后端的耗时（开发自检用）
+// 在临时目录中生成指定人数的名单，对每个后端依次执行：批量导入、读取完整名单、修改一人后保存、
+// 按姓名 / 年级 / 空闲时间查询、追加排表历史与读取一条历史，输出每一步的耗时。
+// 以 --benchmark-storage [人数] 参数启动程序即可运行（见 main.cpp）。
+
+#pragma once
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QElapsedTimer>
+#include <QDebug>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "rosterStorage.h"
+#include "sqliteRosterStorage.h"
+
+class RosterStorageBenchmark
+{
+public:
+    // memberCount：名单总人数；historyEntries：追加的历史记录条数
+    static QStringList run(int memberCount, int historyEntries = 20) {
+        QStringList report;
+        QTemporaryDir dir;
+        if (!dir.isValid()) {
+            report.append("无法创建临时目录");
+            return report;
+        }
+        const Flag_group roster = sampleRoster(memberCount);
+
+        std::vector<std::unique_ptr<RosterStorageBackend>> backends;
+        backends.emplace_back(new FileRosterStorage(dir.filePath("file")));
+#ifdef FLAG_GROUP_HAS_SQLITE
+        backends.emplace_back(new SqliteRosterStorage(dir.filePath("roster.sqlite")));
+#else
+        report.append("未安装 QtSql 模块，跳过 SQLite 后端");
+#endif
+        for (auto& backend : backends) {
+            runBackend(*backend, roster, historyEntries, report);
+        }
+        for (const QString& line : report) qDebug() << line;
+        return report;
+    }
+
+private:
+    static void runBackend(RosterStorageBackend& backend, const Flag_group& roster, int historyEntries, QStringList& report) {
+        const QString name = backend.backendName();
+        if (!backend.open()) {
+            report.append(name + "：无法打开");
+            return;
+        }
+        auto measure = [&](const QString& step, const std::function<bool()>& action) {
+            QElapsedTimer timer;
+            timer.start();
+            const bool ok = action();
+            report.append(QString("%1 %2：%3 毫秒%4").arg(name, step).arg(timer.nsecsElapsed() / 1e6, 0, 'f', 2)
+                          .arg(ok ? "" : "（失败）"));
+        };
+
+        Flag_group loaded;
+        measure("批量导入", [&]() { return backend.importRoster(roster); });
+        measure("读取名单", [&]() { return backend.loadRoster(loaded); });
+        measure("修改一人后保存", [&]() {
+            auto& members = loaded.getGroupMembers(1);
+            if (members.empty()) return false;
+            members.front().setTimes(members.front().getTimes() + 1);
+            return backend.saveRoster(loaded);
+        });
+        measure("按姓名查询", [&]() { return !backend.findByName("队员1").isEmpty(); });
+        measure("按年级查询", [&]() { return !backend.membersOfGrade(2).isEmpty(); });
+        measure("按空闲时间查询", [&]() { return !backend.membersAvailableAt(1, 1).isEmpty(); });
+        measure("列出第一组姓名", [&]() { return !backend.memberNames(1).isEmpty(); });
+
+        ScheduleHistoryItem item;
+        item.timestamp = QDateTime::currentDateTime();
+        item.mode = "总次数";
+        item.flagGroupSnapshot = RosterSnapshot::capture(roster);
+        item.totalMembers = item.flagGroupSnapshot.memberCount();
+        measure(QString("追加 %1 条历史").arg(historyEntries), [&]() {
+            for (int k = 0; k < historyEntries; ++k) {
+                if (!backend.appendHistory(item)) return false;
+            }
+            return true;
+        });
+        measure("读取最后一条历史", [&]() {
+            ScheduleHistoryItem last;
+            return backend.historyCount() > 0 && backend.loadHistory(backend.historyCount() - 1, last);
+        });
+    }
+
+    // 生成测试名单：平均分到四个组，年级与空闲时间按序号变化
+    static Flag_group sampleRoster(int memberCount) {
+        Flag_group roster;
+        for (int k = 0; k < memberCount; ++k) {
+            bool time[4][5] = {};
+            const int group = k % 4 + 1;
+            Person person("队员" + std::to_string(k + 1), k % 2 == 0, group, k % 4 + 1, "13800000000", "湖北武汉", "汉族",
+                          "东院1舍", "计算机学院", "计科2401", "2005-01-01", true, time, 0, k % 10);
+            person.setTimeMask(static_cast<std::uint32_t>(k * 2654435761u) & 0xFFFFFu);
+            roster.getGroupMembers(group).push_back(std::move(person));
+        }
+        return roster;
+    }
+};
@@ -0,0 +1,269 @@
+// rosterUndoStack.h头文件
+// 功能说明：队员名单的修改事务与撤销 / 重做
+// 界面对名单的每项修改（增删队员、改名、调整组别、修改信息与空闲时间、导入）都通过本类执行，
+// 执行时同时记录可逆的操作：增删队员记录组别、组内位置与队员本身，字段修改只记录该字段修改前后的文本（见 memberFields.h），
+// 空闲时间整体修改只记录前后两个时间掩码。撤销 / 重做按记录逐条反向 / 正向执行，开销只与本次修改的规模有关，
+// 不需要像恢复排班历史那样复制整个名单。
+// begin / commit 把多项修改合并为一个撤销步骤（可嵌套，以最外层为准），rollback 撤回尚未提交的全部修改。
+// 所有修改都经由队员的 set 函数或 Flag_group 的增删函数完成，因此增量保存与界面刷新都只涉及实际变化的队员。
+// 操作按组内位置定位队员：绕过本类增删队员或整体替换名单（读取文件、恢复历史）后必须调用 clear。
+
+#pragma once
+#include <QString>
+#include <QVector>
+#include <QDebug>
+#include <algorithm>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <vector>
+#include "Flag_group.h"
+#include "memberFields.h"
+
+class RosterUndoStack
+{
+public:
+    static constexpr int MAX_STEPS = 100; // 最多保留的撤销步数
+
+    // 一次撤销 / 重做的结果：label 为步骤名称，groups 为涉及的组别（升序），界面只需刷新这些组
+    struct Change {
+        QString label;
+        QVector<int> groups;
+    };
+
+    explicit RosterUndoStack(Flag_group& roster) : m_roster(roster) {}
+
+    Flag_group& roster() { return m_roster; }
+
+    // 事务：begin 与 commit 之间的修改合并为一个撤销步骤
+    void begin(const QString& label) {
+        if (m_depth++ == 0) {
+            m_open = Step();
+            m_open.label = label;
+        }
+    }
+
+    void commit() {
+        if (m_depth == 0) return;
+        if (--m_depth == 0) push(std::move(m_open));
+    }
+
+    // 撤回当前事务中已执行的全部修改（整个事务，包括外层）
+    void rollback() {
+        if (m_depth == 0) return;
+        m_depth = 0;
+        for (auto it = m_open.ops.rbegin(); it != m_open.ops.rend(); ++it) revert(*it);
+        m_open = Step();
+    }
+
+    bool inTransaction() const { return m_depth > 0; }
+
+    // 在组末尾添加队员，返回其组内位置
+    int append(int group, const Person& person) {
+        const int index = static_cast<int>(m_roster.getGroupMembers(group).size());
+        Op op(Op::Insert, group, index);
+        op.person = std::make_shared<const Person>(person);
+        execute(std::move(op), "添加队员");
+        return index;
+    }
+
+    // 删除指定位置的队员
+    void remove(int group, int index) {
+        if (!valid(group, index)) return;
+        Op op(Op::Remove, group, index);
+        op.person = std::make_shared<const Person>(m_roster.getGroupMembers(group)[index]);
+        execute(std::move(op), "删除队员");
+    }
+
+    // 修改姓名；姓名未变时不记录
+    bool rename(int group, int index, const std::string& name) {
+        if (!valid(group, index)) return false;
+        const QString before = QString::fromStdString(m_roster.getGroupMembers(group)[index].getName());
+        const QString after = QString::fromStdString(name);
+        if (before == after) return false;
+        Op op(Op::Rename, group, index);
+        op.field = MemberFields::Name;
+        op.before = before;
+        op.after = after;
+        execute(std::move(op), "修改姓名");
+        return true;
+    }
+
+    // 修改一个字段（value 为 MemberFields::validate 得到的规范文本）；值未变时不记录
+    bool setField(int group, int index, int field, const QString& value) {
+        if (!valid(group, index)) return false;
+        if (field == MemberFields::Name) return rename(group, index, value.toStdString());
+        if (field == MemberFields::Group || field == MemberFields::None) {
+            qDebug() << "[RosterUndoStack::setField] 错误：不能直接修改的字段" << field; // 组别请使用 move
+            return false;
+        }
+        const QString before = MemberFields::format(field, m_roster.getGroupMembers(group)[index]);
+        if (before == value) return false;
+        Op op(Op::SetField, group, index);
+        op.field = field;
+        op.before = before;
+        op.after = value;
+        execute(std::move(op), MemberFields::isTimeSlot(field) ? "修改空闲时间" : "修改" + MemberFields::title(field));
+        return true;
+    }
+
+    // 整体设置全部时间点（位序同 Person::getTimeMask）；未变时不记录
+    bool setTimeMask(int group, int index, std::uint64_t mask) {
+        if (!valid(group, index)) return false;
+        const std::uint64_t before = m_roster.getGroupMembers(group)[index].getTimeMask();
+        if (before == mask) return false;
+        Op op(Op::SetTimeMask, group, index);
+        op.maskBefore = before;
+        op.maskAfter = mask;
+        execute(std::move(op), "修改空闲时间");
+        return true;
+    }
+
+    // 把队员移到另一组末尾并设置是否值周，返回在新组中的位置
+    int move(int fromGroup, int index, int toGroup, bool isWork) {
+        if (!valid(fromGroup, index) || !m_roster.isValidGroup(toGroup)) return -1;
+        Person person = m_roster.getGroupMembers(fromGroup)[index];
+        person.setGroup(toGroup);
+        person.setIsWork(isWork);
+        begin("调整组别");
+        remove(fromGroup, index);
+        const int newIndex = append(toGroup, person);
+        commit();
+        return newIndex;
+    }
+
+    bool canUndo() const { return !m_undo.empty() && m_depth == 0; }
+    bool canRedo() const { return !m_redo.empty() && m_depth == 0; }
+    QString undoLabel() const { return m_undo.empty() ? QString() : m_undo.back().label; }
+    QString redoLabel() const { return m_redo.empty() ? QString() : m_redo.back().label; }
+
+    Change undo() {
+        Change change;
+        if (!canUndo()) return change;
+        Step step = std::move(m_undo.back());
+        m_undo.pop_back();
+        for (auto it = step.ops.rbegin(); it != step.ops.rend(); ++it) revert(*it);
+        change = describe(step);
+        m_redo.push_back(std::move(step));
+        return change;
+    }
+
+    Change redo() {
+        Change change;
+        if (!canRedo()) return change;
+        Step step = std::move(m_redo.back());
+        m_redo.pop_back();
+        for (const Op& op : step.ops) apply(op);
+        change = describe(step);
+        m_undo.push_back(std::move(step));
+        return change;
+    }
+
+    // 清空撤销记录（名单被整体替换或绕过本类增删队员后调用）
+    void clear() {
+        m_undo.clear();
+        m_redo.clear();
+        m_open = Step();
+        m_depth = 0;
+    }
+
+private:
+    struct Op {
+        enum Kind { Insert, Remove, Rename, SetField, SetTimeMask };
+        Op(Kind kind, int group, int index) : kind(kind), group(group), index(index) {}
+        Kind kind;
+        int group;
+        int index;                             // 组内位置
+        int field = MemberFields::None;
+        QString before;                        // 字段修改前后的规范文本
+        QString after;
+        std::uint64_t maskBefore = 0;
+        std::uint64_t maskAfter = 0;
+        std::shared_ptr<const Person> person;  // 增删的队员（撤销删除、重做添加时使用）
+    };
+
+    struct Step {
+        QString label;
+        std::vector<Op> ops;
+    };
+
+    bool valid(int group, int index) const {
+        if (!m_roster.isValidGroup(group)) return false;
+        return index >= 0 && index < static_cast<int>(m_roster.getGroupMembers(group).size());
+    }
+
+    // 执行并记录一项操作；不在事务中时单独成为一个撤销步骤
+    void execute(Op op, const QString& label) {
+        apply(op);
+        if (m_depth > 0) {
+            m_open.ops.push_back(std::move(op));
+            return;
+        }
+        Step step;
+        step.label = label;
+        step.ops.push_back(std::move(op));
+        push(std::move(step));
+    }
+
+    static bool mergeable(const Op& op) {
+        return op.kind == Op::Rename
+            || (op.kind == Op::SetField && !MemberFields::isTimeSlot(op.field) && op.field != MemberFields::IsWork);
+    }
+
+    void push(Step step) {
+        if (step.ops.empty()) return;
+        // 对同一队员同一文本字段的连续修改（如连续调整次数）合并为一步
+        if (step.ops.size() == 1 && !m_undo.empty() && m_redo.empty() && mergeable(step.ops.front())) {
+            Op& last = m_undo.back().ops.front();
+            const Op& op = step.ops.front();
+            if (m_undo.back().ops.size() == 1 && last.kind == op.kind && last.group == op.group
+                && last.index == op.index && last.field == op.field) {
+                last.after = op.after;
+                return;
+            }
+        }
+        m_undo.push_back(std::move(step));
+        m_redo.clear();
+        while (static_cast<int>(m_undo.size()) > MAX_STEPS) m_undo.pop_front();
+    }
+
+    // 正向执行
+    void apply(const Op& op) {
+        auto& members = m_roster.getGroupMembers(op.group);
+        switch (op.kind) {
+        case Op::Insert: m_roster.insertPersonAt(op.group, op.index, *op.person); break;
+        case Op::Remove: m_roster.takePersonAt(op.group, op.index); break;
+        case Op::Rename: m_roster.renamePersonAt(op.group, op.index, op.after.toStdString()); break;
+        case Op::SetField: MemberFields::assign(op.field, op.after, members[op.index]); break;
+        case Op::SetTimeMask: members[op.index].setTimeMask(op.maskAfter); break;
+        }
+    }
+
+    // 反向执行
+    void revert(const Op& op) {
+        auto& members = m_roster.getGroupMembers(op.group);
+        switch (op.kind) {
+        case Op::Insert: m_roster.takePersonAt(op.group, op.index); break;
+        case Op::Remove: m_roster.insertPersonAt(op.group, op.index, *op.person); break;
+        case Op::Rename: m_roster.renamePersonAt(op.group, op.index, op.before.toStdString()); break;
+        case Op::SetField: MemberFields::assign(op.field, op.before, members[op.index]); break;
+        case Op::SetTimeMask: members[op.index].setTimeMask(op.maskBefore); break;
+        }
+    }
+
+    static Change describe(const Step& step) {
+        Change change;
+        change.label = step.label;
+        for (const Op& op : step.ops) {
+            if (!change.groups.contains(op.group)) change.groups.append(op.group);
+        }
+        std::sort(change.groups.begin(), change.groups.end());
+        return change;
+    }
+
+    Flag_group& m_roster;
+    std::deque<Step> m_undo;
+    std::deque<Step> m_redo;
+    Step m_open;        // 当前事务中已执行的操作
+    int m_depth = 0;    // 事务嵌套层数
+};
@@ -1,7 +1,15 @@
 // scheduleHistory.h头文件
 // 功能说明：管理排班历史记录，保存每次制表时的状态，支持回退到任意历史记录
-// 持久化：历史仅内存，写入 ./data/schedule_history.dat 仅在退出且用户未选「不保存」时进行；
-// 若用户选「不保存」，本次会话的增删改全部丢弃，文件保持启动时状态。
+// 持久化：./data/schedule_history.dat 保存历史记录，之后的增删记录追加写入日志文件（见下文）；
+// 若用户选「不保存」，本次会话的增删改全部丢弃，下次启动时的历史与本次启动时一致。
+// 文件版本：1~3 每条记录保存完整名单；4 每10条记录保存一次完整名单，其余记录只保存相对上一条记录的变化；
+// 5 在文件头部增加索引（摘要字段 + 完整内容的偏移与长度），启动时只读取索引，完整内容按需解码。
+// 6 在文件头部记录已合并的日志代数。7 在索引中记录每条完整内容的 CRC32C，索引末尾附文件头校验值，损坏的记录跳过并报告。
+// 8 名单中记录组数（组数可变，见 Flag_group.h），队员记录附带南鉴湖、东西院之外其他执勤地点的累计次数。
+// 读取兼容版本1~8，写入始终使用版本8。
+// 追加日志（openJournal）：新增与删除历史记录时立即向 schedule_history.<代数>.journal 追加一条带校验的记录，
+// 启动时回放日志；「不保存」通过会话放弃记录实现。当前日志过大时（启动时，或会话中追加记录后）在后台压缩进历史文件，
+// 会话中途压缩过时，「不保存」改为用会话开始时的历史重写历史文件。
 
 #pragma once
 #include <QString>
@@ -12,9 +20,20 @@
 #include <QFileInfo>
 #include <QDir>
 #include <QDebug>
+#include <QHash>
+#include <QPair>
+#include <QVector>
+#include <QObject>
+#include <QMetaObject>
+#include <QThreadPool>
 #include <vector>
+#include <algorithm>
 #include "Flag_group.h"
 #include "dataFunction.h"
+#include "rosterSnapshot.h"
+#include "historyJournal.h"
+#include "durableFile.h"
+#include "recordFraming.h"
 
 // 排班表位置信息（保存Person的标识信息而非指针）
 struct SchedulePosition {
@@ -32,7 +51,7 @@ struct SchedulePosition {
     // 根据标识信息查找Person（在flagGroup中）
     // 使用姓名+组别查找（确保在指定组内唯一）
     Person* findPerson(Flag_group& flagGroup) const {
-        if (personGroup >= 1 && personGroup <= 4 && !personName.isEmpty()) {
+        if (flagGroup.isValidGroup(personGroup) && !personName.isEmpty()) {
             Person temp;
             temp.setName(personName.toStdString());
             return flagGroup.findPersonInGroup(temp, personGroup);
@@ -45,51 +64,385 @@ struct SchedulePosition {
 struct ScheduleHistoryItem {
     QDateTime timestamp;              // 制表时间
     QString mode;                    // 排班模式（常规模式、监督模式等）
-    Flag_group flagGroupSnapshot;    // 队员信息快照
+    RosterSnapshot flagGroupSnapshot; // 队员信息快照（写时复制，与相邻记录共享未修改的队员）
     std::vector<std::vector<std::vector<SchedulePosition>>> scheduleTable; // 排班表快照（保存标识信息）
     QString scheduleText;            // 排班结果文本
     int totalMembers;                // 总队员数
     int totalScheduleCount;          // 总排班次数
     
-    ScheduleHistoryItem() : totalMembers(0), totalScheduleCount(0) {}
+    // 延迟加载状态：从版本5文件读取时只读入索引中的摘要字段（时间、模式、队员数、排班次数），
+    // 名单、排班表与排班结果文本在第一次通过 getHistory 访问时才从文件中解码
+    bool detailLoaded;               // 名单、排班表与排班结果文本是否已在内存中
+    bool payloadKeyframe;            // 文件中该记录的名单是否为关键帧
+    qint64 payloadOffset;            // 完整记录在文件中的偏移
+    qint64 payloadLength;            // 完整记录在文件中的长度
+    quint64 entryId;                 // 内存中的记录编号（后台压缩完成后据此更新文件位置）
+    quint32 payloadCrc;              // 完整记录的 CRC32C（版本7及以上的文件）
+    bool payloadHasCrc;              // 文件中是否保存了 payloadCrc
+    qint32 payloadVersion;           // 完整记录所在文件的版本（决定名单的编码方式）
+    
+    ScheduleHistoryItem() : totalMembers(0), totalScheduleCount(0),
+        detailLoaded(true), payloadKeyframe(true), payloadOffset(0), payloadLength(0), entryId(0),
+        payloadCrc(0), payloadHasCrc(false), payloadVersion(0) {}
 };
 
 class ScheduleHistoryManager
 {
 private:
-    QList<ScheduleHistoryItem> historyList;  // 历史记录列表
+    mutable QList<ScheduleHistoryItem> historyList;  // 历史记录列表（未加载的记录在首次访问时解码，因此为 mutable）
     int maxHistoryCount;  // 最大保存历史记录数量（防止占用过多内存）
     QString m_historyFilePath;  // 历史记录文件路径，用于持久化
+    QString m_payloadFilePath;  // 尚未加载的记录所在的文件（最近一次加载的版本5及以上文件）
+    quint64 m_nextEntryId = 1;  // 下一条记录的内存编号
+    
+    // 追加日志（见 openJournal）
+    qint64 m_generation = 0;         // 历史文件已包含的日志代数：启动时只回放代数不小于该值的日志
+    qint64 m_journalGeneration = 0;  // 当前写入的日志代数
+    bool m_journalOpen = false;      // 是否已启用追加日志
+    qint64 m_sessionId = 0;          // 本次会话编号（会话开始前为0）
+    qint64 m_sessionGeneration = 0;  // 本次会话开始时的日志代数
+    qint64 m_journalBytes = 0;       // 当前代日志已写入的字节数
+    QObject* m_compactionContext = nullptr; // 压缩完成通知投递到的对象
+    bool m_compacting = false;       // 是否有压缩正在进行
+    bool m_sessionCompacted = false; // 本次会话的记录是否已有一部分压缩进历史文件
+    QList<ScheduleHistoryItem> m_sessionBaseline; // 会话开始时的历史记录（会话中途压缩后「不保存」据此重写历史文件）
+    QThreadPool m_compactionPool;    // 后台压缩线程（析构时等待压缩结束）
+    
+    // 当前代日志超过该大小时，在后台将日志压缩进历史文件（启动时检查一次，会话中每次追加记录后检查）
+    static constexpr qint64 JOURNAL_COMPACT_BYTES = 1024 * 1024;
+    
+    // 当前写入的文件版本；早于 GROUPS_VERSION 的名单固定为四组，早于 LOCATIONS_VERSION 的名单固定为两个执勤地点
+    static constexpr qint32 FILE_VERSION = 9;
+    static constexpr qint32 GROUPS_VERSION = 8;
+    static constexpr qint32 LOCATIONS_VERSION = 9;
     
-    static bool writeFlagGroupToStream(QDataStream& out, const Flag_group& g) {
-        for (int i = 1; i <= 4; ++i) {
-            const auto& members = g.getGroupMembers(i);
-            out << static_cast<qint32>(members.size());
-            for (const auto& p : members) {
-                out << QString::fromStdString(p.getName()) << p.getGender()
-                    << static_cast<qint32>(p.getGroup()) << static_cast<qint32>(p.getGrade())
-                    << QString::fromStdString(p.getPhone_number())
-                    << QString::fromStdString(p.getNative_place())
-                    << QString::fromStdString(p.getNative())
-                    << QString::fromStdString(p.getDorm())
-                    << QString::fromStdString(p.getSchool())
-                    << QString::fromStdString(p.getClassname())
-                    << QString::fromStdString(p.getBirthday())
-                    << p.getIsWork();
-                for (int r = 1; r <= 4; ++r)
-                    for (int c = 1; c <= 5; ++c)
-                        out << p.getTime(r, c);
-                out << static_cast<qint32>(p.getTimes())
-                    << static_cast<qint32>(p.getAll_times())
-                    << static_cast<qint32>(p.getNJHAllTimes())
-                    << static_cast<qint32>(p.getDXYAllTimes());
+    // ========== 版本4：基准快照 + 增量记录 ==========
+    // 每 KEYFRAME_INTERVAL 条历史记录保存一次完整名单（关键帧），其余记录只保存相对上一条记录的变化：
+    // 未变化的队员以"复制区间"引用上一条记录，发生变化的队员只写入变化的字段，新增队员写入完整记录，
+    // 上一条记录中未被引用的队员即为被删除的队员。读取任意一条记录最多只需从最近的关键帧向后应用若干增量。
+    static constexpr int KEYFRAME_INTERVAL = 10;
+
+    enum EntryKind : quint8 { EntryKeyframe = 0, EntryDelta = 1 };
+    enum DeltaOp : quint8 { OpCopyRun = 0, OpPatch = 1, OpNew = 2 };
+    enum PatchField : quint32 {
+        FieldName = 1u << 0, FieldGender = 1u << 1, FieldGroup = 1u << 2, FieldGrade = 1u << 3,
+        FieldPhone = 1u << 4, FieldNativePlace = 1u << 5, FieldNative = 1u << 6, FieldDorm = 1u << 7,
+        FieldSchool = 1u << 8, FieldClassname = 1u << 9, FieldBirthday = 1u << 10, FieldIsWork = 1u << 11,
+        FieldTime = 1u << 12, FieldTimes = 1u << 13, FieldAllTimes = 1u << 14,
+        FieldNJHAllTimes = 1u << 15, FieldDXYAllTimes = 1u << 16, FieldLocationTimes = 1u << 17,
+        FieldTimeHigh = 1u << 18 // 版本9：执勤时间掩码的高32位（FieldTime 为低32位）
+    };
+
+    // 南鉴湖、东西院之外其他执勤地点的累计次数（版本8）
+    static void writeExtraLocations(QDataStream& out, const Person& p) {
+        const int extra = p.getLocationCount() - Person::DEFAULT_LOCATION_COUNT;
+        out << static_cast<quint8>(extra);
+        for (int k = 0; k < extra; ++k) {
+            out << static_cast<qint32>(p.getLocationAllTimes(Person::DEFAULT_LOCATION_COUNT + k));
+        }
+    }
+
+    static void readExtraLocations(QDataStream& in, Person& p) {
+        quint8 extra;
+        in >> extra;
+        for (int k = 0; k < extra && in.status() == QDataStream::Ok; ++k) {
+            qint32 value;
+            in >> value;
+            p.setLocationAllTimes(Person::DEFAULT_LOCATION_COUNT + k, value);
+        }
+    }
+
+    static bool sameExtraLocations(const Person& a, const Person& b) {
+        const int count = std::max(a.getLocationCount(), b.getLocationCount());
+        for (int k = Person::DEFAULT_LOCATION_COUNT; k < count; ++k) {
+            if (a.getLocationAllTimes(k) != b.getLocationAllTimes(k)) return false;
+        }
+        return true;
+    }
+
+    // 写入单个队员的完整记录（执勤时间掩码先写低32位，版本9在记录末尾写高32位）
+    static void writePersonRecord(QDataStream& out, const Person& p) {
+        out << QString::fromStdString(p.getName()) << p.getGender()
+            << static_cast<qint32>(p.getGroup()) << static_cast<qint32>(p.getGrade())
+            << QString::fromStdString(p.getPhone_number())
+            << QString::fromStdString(p.getNative_place())
+            << QString::fromStdString(p.getNative())
+            << QString::fromStdString(p.getDorm())
+            << QString::fromStdString(p.getSchool())
+            << QString::fromStdString(p.getClassname())
+            << QString::fromStdString(p.getBirthday())
+            << p.getIsWork()
+            << static_cast<quint32>(p.getTimeMask())
+            << static_cast<qint32>(p.getTimes())
+            << static_cast<qint32>(p.getAll_times())
+            << static_cast<qint32>(p.getNJHAllTimes())
+            << static_cast<qint32>(p.getDXYAllTimes());
+        writeExtraLocations(out, p);
+        out << static_cast<quint32>(p.getTimeMask() >> 32);
+    }
+
+    static Person readPersonRecord(QDataStream& in, qint32 version) {
+        QString name; bool gender; qint32 group, grade;
+        QString phone, native_place, native, dorm, school, classname, birthday;
+        bool isWork; quint32 timeMask;
+        qint32 times, all_times, njh, dxy;
+        in >> name >> gender >> group >> grade
+           >> phone >> native_place >> native >> dorm >> school >> classname >> birthday
+           >> isWork >> timeMask >> times >> all_times >> njh >> dxy;
+        bool time[4][5] = {};
+        Person person(name.toStdString(), gender, group, grade,
+            phone.toStdString(), native_place.toStdString(), native.toStdString(),
+            dorm.toStdString(), school.toStdString(), classname.toStdString(),
+            birthday.toStdString(), isWork, time, times, all_times, njh, dxy);
+        if (version >= GROUPS_VERSION) readExtraLocations(in, person);
+        quint32 timeHigh = 0;
+        if (version >= LOCATIONS_VERSION) in >> timeHigh;
+        person.setTimeMask(timeMask | (static_cast<std::uint64_t>(timeHigh) << 32));
+        return person;
+    }
+
+    // 版本8的名单以组数开头，版本9在组数之后写入执勤地点数；更早的版本固定为四组、两个地点
+    static bool readGroupCount(QDataStream& in, RosterSnapshot& g, qint32 version) {
+        qint32 count = Flag_group::DEFAULT_GROUP_COUNT;
+        qint32 locations = Person::DEFAULT_LOCATION_COUNT;
+        if (version >= GROUPS_VERSION) in >> count;
+        if (version >= LOCATIONS_VERSION) in >> locations;
+        if (in.status() != QDataStream::Ok || count < 1 || count > Flag_group::MAX_GROUP_COUNT
+            || locations < Person::DEFAULT_LOCATION_COUNT || locations > Person::MAX_LOCATION_COUNT) {
+            in.setStatus(QDataStream::ReadCorruptData);
+            return false;
+        }
+        g.setGroupCount(count);
+        g.setLocationCount(locations);
+        return true;
+    }
+
+    static void writeGroupCount(QDataStream& out, const RosterSnapshot& g) {
+        out << static_cast<qint32>(g.groupCount()) << static_cast<qint32>(g.locationCount());
+    }
+
+    // 关键帧：写入组数、地点数与完整名单
+    static bool writeKeyframe(QDataStream& out, const RosterSnapshot& g) {
+        writeGroupCount(out, g);
+        for (int i = 1; i <= g.groupCount(); ++i) {
+            const auto& records = g.getGroupRecords(i);
+            out << static_cast<qint32>(records.size());
+            for (const auto& record : records) {
+                writePersonRecord(out, *record);
             }
         }
         return (out.status() == QDataStream::Ok);
     }
-    
+
+    static bool readKeyframe(QDataStream& in, RosterSnapshot& g, qint32 version) {
+        if (!readGroupCount(in, g, version)) return false;
+        for (int grp = 1; grp <= g.groupCount() && in.status() == QDataStream::Ok; ++grp) {
+            qint32 n;
+            in >> n;
+            for (int i = 0; i < n && in.status() == QDataStream::Ok; ++i) {
+                g.appendRecord(grp, std::make_shared<const Person>(readPersonRecord(in, version)));
+            }
+        }
+        return (in.status() == QDataStream::Ok);
+    }
+
+    // 计算两条队员记录之间变化的字段（档案字段比较字符串池编号）
+    static quint32 diffFields(const Person& a, const Person& b) {
+        quint32 mask = 0;
+        if (a.getName() != b.getName()) mask |= FieldName;
+        if (a.getGender() != b.getGender()) mask |= FieldGender;
+        if (a.getGroup() != b.getGroup()) mask |= FieldGroup;
+        if (a.getGrade() != b.getGrade()) mask |= FieldGrade;
+        if (a.getPhone_number() != b.getPhone_number()) mask |= FieldPhone;
+        if (a.getNative_placeId() != b.getNative_placeId()) mask |= FieldNativePlace;
+        if (a.getNativeId() != b.getNativeId()) mask |= FieldNative;
+        if (a.getDormId() != b.getDormId()) mask |= FieldDorm;
+        if (a.getSchoolId() != b.getSchoolId()) mask |= FieldSchool;
+        if (a.getClassnameId() != b.getClassnameId()) mask |= FieldClassname;
+        if (a.getBirthday() != b.getBirthday()) mask |= FieldBirthday;
+        if (a.getIsWork() != b.getIsWork()) mask |= FieldIsWork;
+        if (static_cast<quint32>(a.getTimeMask()) != static_cast<quint32>(b.getTimeMask())) mask |= FieldTime;
+        if ((a.getTimeMask() >> 32) != (b.getTimeMask() >> 32)) mask |= FieldTimeHigh;
+        if (a.getTimes() != b.getTimes()) mask |= FieldTimes;
+        if (a.getAll_times() != b.getAll_times()) mask |= FieldAllTimes;
+        if (a.getNJHAllTimes() != b.getNJHAllTimes()) mask |= FieldNJHAllTimes;
+        if (a.getDXYAllTimes() != b.getDXYAllTimes()) mask |= FieldDXYAllTimes;
+        if (!sameExtraLocations(a, b)) mask |= FieldLocationTimes;
+        return mask;
+    }
+
+    // 只写入变化的字段；执勤时间写入与旧掩码的异或值，即发生变化的时间位
+    static void writePatch(QDataStream& out, const Person& base, const Person& p, quint32 mask) {
+        out << mask;
+        if (mask & FieldName) out << QString::fromStdString(p.getName());
+        if (mask & FieldGender) out << p.getGender();
+        if (mask & FieldGroup) out << static_cast<qint32>(p.getGroup());
+        if (mask & FieldGrade) out << static_cast<qint32>(p.getGrade());
+        if (mask & FieldPhone) out << QString::fromStdString(p.getPhone_number());
+        if (mask & FieldNativePlace) out << QString::fromStdString(p.getNative_place());
+        if (mask & FieldNative) out << QString::fromStdString(p.getNative());
+        if (mask & FieldDorm) out << QString::fromStdString(p.getDorm());
+        if (mask & FieldSchool) out << QString::fromStdString(p.getSchool());
+        if (mask & FieldClassname) out << QString::fromStdString(p.getClassname());
+        if (mask & FieldBirthday) out << QString::fromStdString(p.getBirthday());
+        if (mask & FieldIsWork) out << p.getIsWork();
+        if (mask & FieldTime) out << static_cast<quint32>(base.getTimeMask() ^ p.getTimeMask());
+        if (mask & FieldTimeHigh) out << static_cast<quint32>((base.getTimeMask() ^ p.getTimeMask()) >> 32);
+        if (mask & FieldTimes) out << static_cast<qint32>(p.getTimes());
+        if (mask & FieldAllTimes) out << static_cast<qint32>(p.getAll_times());
+        if (mask & FieldNJHAllTimes) out << static_cast<qint32>(p.getNJHAllTimes());
+        if (mask & FieldDXYAllTimes) out << static_cast<qint32>(p.getDXYAllTimes());
+        if (mask & FieldLocationTimes) writeExtraLocations(out, p);
+    }
+
+    static Person readPatch(QDataStream& in, const Person& base) {
+        Person p = base;
+        quint32 mask;
+        in >> mask;
+        QString text; bool flag; qint32 number; quint32 bits;
+        if (mask & FieldName) { in >> text; p.setName(text.toStdString()); }
+        if (mask & FieldGender) { in >> flag; p.setGender(flag); }
+        if (mask & FieldGroup) { in >> number; p.setGroup(number); }
+        if (mask & FieldGrade) { in >> number; p.setGrade(number); }
+        if (mask & FieldPhone) { in >> text; p.setPhone_number(text.toStdString()); }
+        if (mask & FieldNativePlace) { in >> text; p.setNative_place(text.toStdString()); }
+        if (mask & FieldNative) { in >> text; p.setNative(text.toStdString()); }
+        if (mask & FieldDorm) { in >> text; p.setDorm(text.toStdString()); }
+        if (mask & FieldSchool) { in >> text; p.setSchool(text.toStdString()); }
+        if (mask & FieldClassname) { in >> text; p.setClassname(text.toStdString()); }
+        if (mask & FieldBirthday) { in >> text; p.setBirthday(text.toStdString()); }
+        if (mask & FieldIsWork) { in >> flag; p.setIsWork(flag); }
+        if (mask & FieldTime) { in >> bits; p.setTimeMask(p.getTimeMask() ^ bits); }
+        if (mask & FieldTimeHigh) { in >> bits; p.setTimeMask(p.getTimeMask() ^ (static_cast<std::uint64_t>(bits) << 32)); }
+        if (mask & FieldTimes) { in >> number; p.setTimes(number); }
+        if (mask & FieldAllTimes) { in >> number; p.setAll_times(number); }
+        if (mask & FieldNJHAllTimes) { in >> number; p.setNJHAllTimes(number); }
+        if (mask & FieldDXYAllTimes) { in >> number; p.setDXYAllTimes(number); }
+        if (mask & FieldLocationTimes) {
+            Person counts;
+            readExtraLocations(in, counts);
+            for (int k = Person::DEFAULT_LOCATION_COUNT; k < std::max(p.getLocationCount(), counts.getLocationCount()); ++k) {
+                p.setLocationAllTimes(k, counts.getLocationAllTimes(k));
+            }
+        }
+        return p;
+    }
+
+    // 增量记录：写入组数后逐组写入操作序列，重建时按顺序执行即可得到与原名单完全一致的顺序
+    static bool writeDelta(QDataStream& out, const RosterSnapshot& g, const RosterSnapshot& previous) {
+        // 上一条记录中 姓名 -> (组别, 下标)，用于定位发生了位置变化或组别变化的队员
+        QHash<QString, QPair<int, int>> previousIndex;
+        for (int grp = 1; grp <= previous.groupCount(); ++grp) {
+            const auto& records = previous.getGroupRecords(grp);
+            for (int k = 0; k < static_cast<int>(records.size()); ++k) {
+                previousIndex.insert(QString::number(grp) + '|' + QString::fromStdString(records[k]->getName()), qMakePair(grp, k));
+            }
+        }
+        writeGroupCount(out, g);
+        for (int grp = 1; grp <= g.groupCount(); ++grp) {
+            const auto& records = g.getGroupRecords(grp);
+            const auto& previousRecords = previous.getGroupRecords(grp);
+            // 先在内存中生成操作序列，再写入操作数量与操作内容
+            QByteArray ops;
+            QDataStream opOut(&ops, QIODevice::WriteOnly);
+            opOut.setVersion(out.version());
+            qint32 opCount = 0;
+            int k = 0;
+            const int n = static_cast<int>(records.size());
+            while (k < n) {
+                // 与上一条记录同位置且为同一份共享记录：合并为复制区间
+                if (k < static_cast<int>(previousRecords.size()) && records[k] == previousRecords[k]) {
+                    int run = 1;
+                    while (k + run < n && k + run < static_cast<int>(previousRecords.size())
+                           && records[k + run] == previousRecords[k + run]) {
+                        ++run;
+                    }
+                    opOut << static_cast<quint8>(OpCopyRun) << static_cast<qint8>(grp)
+                          << static_cast<qint32>(k) << static_cast<qint32>(run);
+                    ++opCount;
+                    k += run;
+                    continue;
+                }
+                const Person& p = *records[k];
+                // 按姓名定位上一条记录中的同一队员：先查本组，再查其他组（组别发生变化的队员）
+                QPair<int, int> source(0, -1);
+                auto it = previousIndex.find(QString::number(grp) + '|' + QString::fromStdString(p.getName()));
+                if (it != previousIndex.end()) {
+                    source = it.value();
+                } else {
+                    for (int other = 1; other <= previous.groupCount() && source.second < 0; ++other) {
+                        auto otherIt = previousIndex.find(QString::number(other) + '|' + QString::fromStdString(p.getName()));
+                        if (otherIt != previousIndex.end()) source = otherIt.value();
+                    }
+                }
+                if (source.second >= 0) {
+                    const Person& base = *previous.getGroupRecords(source.first)[source.second];
+                    const quint32 mask = diffFields(base, p);
+                    if (mask == 0) {
+                        opOut << static_cast<quint8>(OpCopyRun) << static_cast<qint8>(source.first)
+                              << static_cast<qint32>(source.second) << static_cast<qint32>(1);
+                    } else {
+                        opOut << static_cast<quint8>(OpPatch) << static_cast<qint8>(source.first)
+                              << static_cast<qint32>(source.second);
+                        writePatch(opOut, base, p, mask);
+                    }
+                } else {
+                    // 新增队员：写入完整记录
+                    opOut << static_cast<quint8>(OpNew);
+                    writePersonRecord(opOut, p);
+                }
+                ++opCount;
+                ++k;
+            }
+            out << opCount;
+            out.writeRawData(ops.constData(), ops.size());
+        }
+        return (out.status() == QDataStream::Ok);
+    }
+
+    static bool readDelta(QDataStream& in, RosterSnapshot& g, const RosterSnapshot& previous, qint32 version) {
+        if (!readGroupCount(in, g, version)) return false;
+        for (int grp = 1; grp <= g.groupCount() && in.status() == QDataStream::Ok; ++grp) {
+            qint32 opCount;
+            in >> opCount;
+            for (int i = 0; i < opCount && in.status() == QDataStream::Ok; ++i) {
+                quint8 op;
+                in >> op;
+                if (op == OpCopyRun || op == OpPatch) {
+                    qint8 sourceGroup; qint32 sourceIndex;
+                    in >> sourceGroup >> sourceIndex;
+                    const auto& sourceRecords = previous.getGroupRecords(sourceGroup);
+                    if (op == OpCopyRun) {
+                        qint32 run;
+                        in >> run;
+                        if (sourceIndex < 0 || run < 0 || sourceIndex + run > static_cast<qint32>(sourceRecords.size())) {
+                            in.setStatus(QDataStream::ReadCorruptData);
+                            break;
+                        }
+                        // 未变化的队员直接共享上一条记录中的同一份数据
+                        for (qint32 r = 0; r < run; ++r) {
+                            g.appendRecord(grp, sourceRecords[sourceIndex + r]);
+                        }
+                    } else {
+                        if (sourceIndex < 0 || sourceIndex >= static_cast<qint32>(sourceRecords.size())) {
+                            in.setStatus(QDataStream::ReadCorruptData);
+                            break;
+                        }
+                        g.appendRecord(grp, std::make_shared<const Person>(readPatch(in, *sourceRecords[sourceIndex])));
+                    }
+                } else if (op == OpNew) {
+                    g.appendRecord(grp, std::make_shared<const Person>(readPersonRecord(in, version)));
+                } else {
+                    in.setStatus(QDataStream::ReadCorruptData);
+                }
+            }
+        }
+        return (in.status() == QDataStream::Ok);
+    }
+
+    // 版本1~3：每条记录保存完整名单（仅用于兼容读取旧文件，固定为四组）
     static bool readFlagGroupFromStream(QDataStream& in, Flag_group& g, qint32 version) {
-        for (int grp = 1; grp <= 4; ++grp) {
+        for (int grp = 1; grp <= Flag_group::DEFAULT_GROUP_COUNT; ++grp) {
             qint32 n;
             in >> n;
             for (int i = 0; i < n; ++i) {
@@ -121,13 +474,495 @@ private:
         return (in.status() == QDataStream::Ok);
     }
     
+    // 排班表与排班结果文本（各版本共用，版本1~2 的旧字段只读取不使用）
+    static void writeScheduleBody(QDataStream& out, const ScheduleHistoryItem& item) {
+        qint32 d0 = static_cast<qint32>(item.scheduleTable.size());
+        qint32 d1 = d0 ? static_cast<qint32>(item.scheduleTable[0].size()) : 0;
+        qint32 d2 = (d0 && d1) ? static_cast<qint32>(item.scheduleTable[0][0].size()) : 0;
+        out << d0 << d1 << d2;
+        for (const auto& row : item.scheduleTable)
+            for (const auto& col : row)
+                for (const auto& pos : col)
+                    out << pos.personName << static_cast<qint32>(pos.personGroup);
+        out << item.scheduleText;
+    }
+    
+    static bool readScheduleBody(QDataStream& in, ScheduleHistoryItem& item, qint32 version) {
+        qint32 d0, d1, d2;
+        in >> d0 >> d1 >> d2;
+        if (in.status() != QDataStream::Ok || d0 < 0 || d1 < 0 || d2 < 0) return false;
+        item.scheduleTable.resize(d0);
+        for (int i = 0; i < d0; ++i) {
+            item.scheduleTable[i].resize(d1);
+            for (int j = 0; j < d1; ++j) {
+                item.scheduleTable[i][j].resize(d2);
+                for (int t = 0; t < d2; ++t) {
+                    if (version >= 2 && version < 3) {
+                        // 兼容旧版本：读取但忽略ID、性别、班级信息
+                        qint32 id;
+                        bool gender;
+                        QString className;
+                        in >> id;
+                        in >> item.scheduleTable[i][j][t].personName >> gender >> className;
+                        // 无法从旧数据恢复组别，设为0（后续查找时会失败，但不会崩溃）
+                        item.scheduleTable[i][j][t].personGroup = 0;
+                    } else if (version >= 3) {
+                        // 新版本：读取姓名和组别
+                        qint32 group;
+                        in >> item.scheduleTable[i][j][t].personName >> group;
+                        item.scheduleTable[i][j][t].personGroup = group;
+                    } else {
+                        // 版本1：只有姓名、性别、班级
+                        bool gender;
+                        QString className;
+                        in >> item.scheduleTable[i][j][t].personName >> gender >> className;
+                        item.scheduleTable[i][j][t].personGroup = 0;
+                    }
+                }
+            }
+        }
+        in >> item.scheduleText;
+        return (in.status() == QDataStream::Ok);
+    }
+    
+    // 版本5及以上：解码一条记录的完整内容（名单 + 排班表 + 排班结果文本）
+    // 增量记录依赖上一条记录的名单，调用方需保证 index-1 已加载
+    static bool decodeEntry(QList<ScheduleHistoryItem>& list, QFile& f, int index) {
+        ScheduleHistoryItem& item = list[index];
+        if (!f.seek(item.payloadOffset)) return false;
+        const QByteArray payload = f.read(item.payloadLength);
+        if (payload.size() != item.payloadLength) return false;
+        if (item.payloadHasCrc && RecordFraming::crc32c(payload) != item.payloadCrc) {
+            qDebug() << "历史记录校验失败（文件损坏）：" << index;
+            return false;
+        }
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_5_15);
+        RosterSnapshot snapshot;
+        bool ok;
+        if (item.payloadKeyframe) {
+            ok = readKeyframe(in, snapshot, item.payloadVersion);
+        } else {
+            ok = index > 0 && readDelta(in, snapshot, list.at(index - 1).flagGroupSnapshot, item.payloadVersion);
+        }
+        ScheduleHistoryItem decoded;
+        if (!ok || !readScheduleBody(in, decoded, 5)) return false;
+        item.flagGroupSnapshot = snapshot;
+        item.scheduleTable = std::move(decoded.scheduleTable);
+        item.scheduleText = decoded.scheduleText;
+        item.detailLoaded = true;
+        return true;
+    }
+    
+    // 确保指定记录已加载：从最近的关键帧（或已加载的记录）开始依次解码到该记录，最多解码 KEYFRAME_INTERVAL 条
+    static bool ensureLoaded(QList<ScheduleHistoryItem>& list, const QString& payloadPath, int index) {
+        if (index < 0 || index >= list.size()) return false;
+        if (list.at(index).detailLoaded) return true;
+        int start = index;
+        while (start > 0 && !list.at(start).payloadKeyframe && !list.at(start - 1).detailLoaded) {
+            --start;
+        }
+        QFile f(payloadPath);
+        if (!f.open(QIODevice::ReadOnly)) {
+            qDebug() << "无法打开历史文件：" << payloadPath;
+            return false;
+        }
+        for (int k = start; k <= index; ++k) {
+            if (list.at(k).detailLoaded) continue;
+            if (!decodeEntry(list, f, k)) {
+                qDebug() << "历史记录解码失败：" << k;
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    bool ensureLoaded(int index) const {
+        return ensureLoaded(historyList, m_payloadFilePath, index);
+    }
+    
+    // 解码全部记录；无法解码（校验失败或损坏）的记录连同依赖它的增量记录一起跳过并报告，返回跳过的条数
+    static int loadAllSkippingCorrupt(QList<ScheduleHistoryItem>& list, const QString& payloadPath) {
+        int skipped = 0;
+        for (int k = 0; k < list.size();) {
+            if (ensureLoaded(list, payloadPath, k)) {
+                ++k;
+                continue;
+            }
+            // 之后直到下一个关键帧的增量记录都以该记录为基准，同样无法恢复
+            int end = k + 1;
+            while (end < list.size() && !list.at(end).detailLoaded && !list.at(end).payloadKeyframe) ++end;
+            qDebug() << "历史记录损坏，已跳过第" << k + 1 << "至第" << end << "条";
+            skipped += end - k;
+            list.erase(list.begin() + k, list.begin() + end);
+        }
+        return skipped;
+    }
+    
+    // 带索引的历史文件（版本6及以上）中一条记录的位置
+    struct PayloadBound {
+        quint64 entryId;
+        bool keyframe;
+        qint64 offset;
+        qint64 length;
+        quint32 crc;
+        qint32 version;
+    };
+    
+    // 读取版本5及以上文件头部的索引（调用方已读过魔数、版本号与记录数）
+    // 版本7的索引末尾带有文件头 CRC32C，索引损坏时读取失败
+    static bool readIndex(QFile& f, QDataStream& in, qint32 version, qint32 count,
+                          QList<ScheduleHistoryItem>& list, qint64& generation) {
+        if (version >= 6) in >> generation;
+        // 版本5：索引 = 每条记录的摘要字段 + 完整内容的位置
+        const qint64 fileSize = f.size();
+        for (int k = 0; k < count && in.status() == QDataStream::Ok; ++k) {
+            ScheduleHistoryItem item;
+            quint8 kind;
+            qint32 totalMembers, totalScheduleCount;
+            in >> item.timestamp >> item.mode >> totalMembers >> totalScheduleCount
+               >> kind >> item.payloadOffset >> item.payloadLength;
+            if (version >= 7) {
+                in >> item.payloadCrc;
+                item.payloadHasCrc = true;
+            }
+            if (item.payloadOffset < 0 || item.payloadLength < 0
+                || item.payloadOffset + item.payloadLength > fileSize
+                || (kind != EntryKeyframe && (kind != EntryDelta || k == 0))) {
+                in.setStatus(QDataStream::ReadCorruptData);
+                break;
+            }
+            item.totalMembers = totalMembers;
+            item.totalScheduleCount = totalScheduleCount;
+            item.payloadKeyframe = (kind == EntryKeyframe);
+            item.payloadVersion = version;
+            item.detailLoaded = false;
+            list.append(item);
+        }
+        if (in.status() != QDataStream::Ok) return false;
+        if (version >= 7) {
+            const qint64 headerSize = f.pos();
+            quint32 headerCrc;
+            in >> headerCrc;
+            if (!f.seek(0)) return false;
+            const QByteArray header = f.read(headerSize);
+            if (in.status() != QDataStream::Ok || header.size() != headerSize
+                || RecordFraming::crc32c(header.constData(), header.size()) != headerCrc) {
+                qDebug() << "历史文件索引校验失败：" << f.fileName();
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // 将全部记录（必须均已加载）写成带索引的历史文件；bounds 非空时返回每条记录在文件中的位置
+    static bool writeIndexedFile(const QList<ScheduleHistoryItem>& list, qint64 generation,
+                                 const QString& path, QVector<PayloadBound>* bounds) {
+        // 先在内存中生成每条记录的完整内容，以便在文件头部写入索引
+        QList<QByteArray> payloads;
+        QList<quint32> crcs;
+        for (int k = 0; k < list.size(); ++k) {
+            const auto& item = list.at(k);
+            QByteArray payload;
+            QDataStream body(&payload, QIODevice::WriteOnly);
+            body.setVersion(QDataStream::Qt_5_15);
+            const bool keyframe = (k % KEYFRAME_INTERVAL == 0);
+            bool written = keyframe ? writeKeyframe(body, item.flagGroupSnapshot)
+                                    : writeDelta(body, item.flagGroupSnapshot, list.at(k - 1).flagGroupSnapshot);
+            writeScheduleBody(body, item);
+            if (!written || body.status() != QDataStream::Ok) return false;
+            payloads.append(payload);
+            crcs.append(RecordFraming::crc32c(payload));
+        }
+        // 索引大小与偏移取值无关，先以0占位计算索引长度，再写入真实偏移
+        QByteArray header;
+        for (int pass = 0; pass < 2; ++pass) {
+            const qint64 base = header.size();
+            header.clear();
+            QDataStream out(&header, QIODevice::WriteOnly);
+            out.setVersion(QDataStream::Qt_5_15);
+            // 版本3：移除队员唯一ID，使用姓名+组别作为唯一标识
+            // 版本4：名单改为关键帧 + 增量记录保存
+            // 版本5：文件头部增加索引，完整内容按需读取
+            // 版本6：文件头部记录已合并的日志代数
+            // 版本7：索引中保存每条记录的 CRC32C，索引末尾保存整个文件头的 CRC32C
+            // 版本8：名单中保存组数与全部执勤地点的累计次数
+            // 版本9：名单中保存执勤地点数，执勤时间掩码扩展为64位
+            out << QString("SCHEDULE_HISTORY_V1") << FILE_VERSION
+                << static_cast<qint32>(list.size()) << generation;
+            qint64 offset = base;
+            for (int k = 0; k < list.size(); ++k) {
+                const auto& item = list.at(k);
+                const bool keyframe = (k % KEYFRAME_INTERVAL == 0);
+                out << item.timestamp << item.mode
+                    << static_cast<qint32>(item.totalMembers) << static_cast<qint32>(item.totalScheduleCount)
+                    << static_cast<quint8>(keyframe ? EntryKeyframe : EntryDelta)
+                    << (pass == 0 ? qint64(0) : offset) << static_cast<qint64>(payloads.at(k).size())
+                    << crcs.at(k);
+                if (pass == 1 && bounds) {
+                    bounds->append(PayloadBound{item.entryId, keyframe, offset, payloads.at(k).size(), crcs.at(k), FILE_VERSION});
+                }
+                offset += payloads.at(k).size();
+            }
+            out << RecordFraming::crc32c(header.constData(), header.size());
+        }
+        if (DurableFile::interrupted(DurableFile::StepOpen)) return false;
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            qDebug() << "无法创建历史文件：" << path;
+            return false;
+        }
+        bool ok = DurableFile::write(f, header);
+        for (const QByteArray& payload : payloads) {
+            if (!ok) break;
+            ok = DurableFile::write(f, payload);
+        }
+        // 内容落盘后才由调用方重命名为正式文件
+        ok = ok && DurableFile::syncFile(f);
+        f.close();
+        if (!ok) QFile::remove(path);
+        return ok;
+    }
+    
+    // 删除或淘汰某条记录前，先解码其后一条尚未加载的记录，避免后者的增量失去基准
+    void detachSuccessor(int index) const {
+        if (index + 1 < historyList.size() && !historyList.at(index + 1).detailLoaded) {
+            ensureLoaded(index + 1);
+        }
+    }
+    
+    // 追加记录并淘汰超出数量上限的最旧记录（日志回放时按同样规则执行，因此淘汰不单独写日志）
+    void appendItem(ScheduleHistoryItem& item) {
+        item.entryId = m_nextEntryId++;
+        historyList.append(item);
+        while (historyList.size() > maxHistoryCount) {
+            detachSuccessor(0);
+            historyList.removeFirst();
+        }
+    }
+    
+    // ========== 追加日志 ==========
+    // 日志文件与历史文件位于同一目录，按代数命名：schedule_history.<代数>.journal
+    QString journalPathFor(qint64 generation) const {
+        QFileInfo info(m_historyFilePath);
+        return info.absolutePath() + "/" + info.completeBaseName() + "." + QString::number(generation) + ".journal";
+    }
+    
+    // 列出现有日志文件的代数（升序）
+    QList<qint64> listJournalGenerations() const {
+        QFileInfo info(m_historyFilePath);
+        const QString prefix = info.completeBaseName() + ".";
+        QList<qint64> generations;
+        const QStringList names = QDir(info.absolutePath()).entryList(QStringList() << prefix + "*.journal", QDir::Files);
+        for (const QString& name : names) {
+            bool ok = false;
+            const qint64 generation = name.mid(prefix.size(), name.size() - prefix.size() - 8).toLongLong(&ok);
+            if (ok) generations.append(generation);
+        }
+        std::sort(generations.begin(), generations.end());
+        return generations;
+    }
+    
+    // 新增记录的日志内容：摘要字段 + 名单（相对上一条记录的增量，没有上一条记录时为关键帧）+ 排班表
+    QByteArray encodeAddRecord(const ScheduleHistoryItem& item) const {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_15);
+        out << item.timestamp << item.mode
+            << static_cast<qint32>(item.totalMembers) << static_cast<qint32>(item.totalScheduleCount);
+        if (historyList.isEmpty()) {
+            out << static_cast<quint8>(EntryKeyframe);
+            writeKeyframe(out, item.flagGroupSnapshot);
+        } else {
+            out << static_cast<quint8>(EntryDelta);
+            writeDelta(out, item.flagGroupSnapshot, historyList.last().flagGroupSnapshot);
+        }
+        writeScheduleBody(out, item);
+        return payload;
+    }
+    
+    // version：日志记录类型为 RecordAdd 时为版本8之前的名单格式，RecordAddGroups 为版本8，RecordAddLocations 为当前格式
+    bool replayAddRecord(const QByteArray& payload, qint32 version) {
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_5_15);
+        ScheduleHistoryItem item;
+        qint32 totalMembers, totalScheduleCount;
+        quint8 kind;
+        in >> item.timestamp >> item.mode >> totalMembers >> totalScheduleCount >> kind;
+        item.totalMembers = totalMembers;
+        item.totalScheduleCount = totalScheduleCount;
+        bool ok = false;
+        if (kind == EntryKeyframe) {
+            ok = readKeyframe(in, item.flagGroupSnapshot, version);
+        } else if (kind == EntryDelta && !historyList.isEmpty() && ensureLoaded(historyList.size() - 1)) {
+            ok = readDelta(in, item.flagGroupSnapshot, historyList.last().flagGroupSnapshot, version);
+        }
+        if (!ok || !readScheduleBody(in, item, 5)) return false;
+        appendItem(item);
+        return true;
+    }
+    
+    bool replayRemoveRecord(const QByteArray& payload) {
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_5_15);
+        qint32 index;
+        QDateTime timestamp;
+        in >> index >> timestamp;
+        // 墓碑同时记录下标与制表时间，两者一致才删除，防止日志与历史文件不匹配时误删
+        if (in.status() != QDataStream::Ok || index < 0 || index >= historyList.size()
+            || historyList.at(index).timestamp != timestamp) {
+            return false;
+        }
+        detachSuccessor(index);
+        historyList.removeAt(index);
+        return true;
+    }
+    
+    // 回放一个日志文件。记录按会话分段，以「会话放弃」结尾的会话整段丢弃（对应退出时选择「不保存」）；
+    // 未正常结束的会话（程序崩溃）照常回放
+    bool replayJournal(const QString& path) {
+        QList<HistoryJournal::Record> records;
+        if (!HistoryJournal::readRecords(path, records)) return false;
+        int k = 0;
+        while (k < records.size()) {
+            // 确定当前会话的范围 [k, end)
+            int end = k + 1;
+            while (end < records.size() && records.at(end).type != HistoryJournal::RecordSessionBegin) ++end;
+            bool aborted = false;
+            for (int r = k; r < end; ++r) {
+                if (records.at(r).type == HistoryJournal::RecordSessionAbort) aborted = true;
+            }
+            if (!aborted) {
+                for (int r = k; r < end; ++r) {
+                    const auto& record = records.at(r);
+                    bool ok = true;
+                    if (record.type == HistoryJournal::RecordAdd) {
+                        ok = replayAddRecord(record.payload, GROUPS_VERSION - 1);
+                    } else if (record.type == HistoryJournal::RecordAddGroups) {
+                        ok = replayAddRecord(record.payload, GROUPS_VERSION);
+                    } else if (record.type == HistoryJournal::RecordAddLocations) {
+                        ok = replayAddRecord(record.payload, FILE_VERSION);
+                    } else if (record.type == HistoryJournal::RecordRemove) {
+                        ok = replayRemoveRecord(record.payload);
+                    }
+                    if (!ok) {
+                        qDebug() << "历史日志回放失败，忽略其后的记录：" << path << r;
+                        return false;
+                    }
+                }
+            }
+            k = end;
+        }
+        return true;
+    }
+    
+    // 向当前代日志追加一条记录并累计写入量
+    bool appendJournal(quint8 type, const QByteArray& payload) {
+        m_journalBytes += HistoryJournal::recordSize(payload);
+        return HistoryJournal::appendRecord(journalPathFor(m_journalGeneration), type, payload);
+    }
+    
+    QByteArray sessionPayload() const {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out << m_sessionId;
+        return payload;
+    }
+    
+    // 会话中追加记录并修改列表之后调用：当前代日志超过上限且没有压缩在进行时开始压缩
+    void compactIfNeeded() {
+        if (m_journalOpen && !m_compacting && m_compactionContext && m_journalBytes > JOURNAL_COMPACT_BYTES) {
+            startCompaction(m_compactionContext);
+        }
+    }
+    
+    // 后台压缩：轮换到新一代日志后，在线程池中把当前全部记录写成新的历史文件；
+    // 完成后回到 context 所在线程替换历史文件、更新未加载记录的文件位置并删除旧日志。
+    // 会话中途压缩时，新一代日志以同一会话编号的会话开始记录开头，并在后台一并解码会话开始时的历史（旧文件即将被替换）
+    void startCompaction(QObject* context) {
+        const qint64 newGeneration = m_journalGeneration + 1;
+        m_journalGeneration = newGeneration;
+        m_journalBytes = 0;
+        m_compacting = true;
+        const bool inSession = (m_sessionId != 0);
+        if (inSession) appendJournal(HistoryJournal::RecordSessionBegin, sessionPayload());
+        const QList<ScheduleHistoryItem> snapshot = historyList;
+        const QList<ScheduleHistoryItem> baseline = inSession ? m_sessionBaseline : QList<ScheduleHistoryItem>();
+        const QString payloadPath = m_payloadFilePath;
+        const QString target = m_historyFilePath + ".compact";
+        m_compactionPool.start([this, context, snapshot, baseline, inSession, payloadPath, target, newGeneration]() {
+            QList<ScheduleHistoryItem> list = snapshot;
+            QList<ScheduleHistoryItem> loadedBaseline = baseline;
+            QVector<PayloadBound> bounds;
+            loadAllSkippingCorrupt(list, payloadPath); // 损坏的记录不再写入新文件
+            loadAllSkippingCorrupt(loadedBaseline, payloadPath);
+            const bool ok = writeIndexedFile(list, newGeneration, target, &bounds);
+            QMetaObject::invokeMethod(context, [this, ok, target, newGeneration, bounds, inSession, loadedBaseline]() {
+                if (inSession) m_sessionBaseline = loadedBaseline;
+                finishCompaction(ok, target, newGeneration, bounds, inSession);
+            }, Qt::QueuedConnection);
+        });
+    }
+    
+    // 未加载的记录改为从新文件读取；新文件中没有的未加载记录已损坏，一并移除
+    static void remapPayloads(QList<ScheduleHistoryItem>& list, const QHash<quint64, PayloadBound>& boundById) {
+        for (int k = list.size() - 1; k >= 0; --k) {
+            ScheduleHistoryItem& item = list[k];
+            if (item.detailLoaded) continue;
+            const auto it = boundById.constFind(item.entryId);
+            if (it != boundById.constEnd()) {
+                item.payloadOffset = it->offset;
+                item.payloadLength = it->length;
+                item.payloadKeyframe = it->keyframe;
+                item.payloadCrc = it->crc;
+                item.payloadHasCrc = true;
+                item.payloadVersion = it->version;
+            } else {
+                list.removeAt(k);
+            }
+        }
+    }
+    
+    // inSession：压缩的内容是否包含本次会话的记录
+    void finishCompaction(bool ok, const QString& target, qint64 newGeneration, const QVector<PayloadBound>& bounds,
+                          bool inSession) {
+        m_compacting = false;
+        if (!ok) {
+            // 压缩失败不影响数据：旧历史文件与各代日志仍然完整，下次启动会全部回放
+            qDebug() << "历史日志压缩失败";
+            QFile::remove(target);
+            return;
+        }
+        // 原子替换历史文件（不先删除旧文件），失败时旧文件与各代日志仍然完整
+        if (!DurableFile::replace(target, m_historyFilePath)) {
+            qDebug() << "无法重命名压缩后的历史文件为：" << m_historyFilePath;
+            QFile::remove(target);
+            return;
+        }
+        // 尚未加载的记录改为从新文件读取（启动时压缩的内容与会话开始时的历史相同，后者一并更新）
+        QHash<quint64, PayloadBound> boundById;
+        for (const auto& bound : bounds) boundById.insert(bound.entryId, bound);
+        remapPayloads(historyList, boundById);
+        remapPayloads(m_sessionBaseline, boundById);
+        m_payloadFilePath = m_historyFilePath;
+        m_generation = newGeneration;
+        if (inSession) m_sessionCompacted = true;
+        for (qint64 generation : listJournalGenerations()) {
+            if (generation < newGeneration) QFile::remove(journalPathFor(generation));
+        }
+        qDebug() << "历史日志已压缩，当前日志代数：" << newGeneration;
+    }
+    
 public:
-    ScheduleHistoryManager(int maxCount = 50) : maxHistoryCount(maxCount) {}
+    ScheduleHistoryManager(int maxCount = 50) : maxHistoryCount(maxCount) {
+        m_compactionPool.setMaxThreadCount(1);
+    }
     
     void setHistoryFilePath(const QString& path) { m_historyFilePath = path; }
     QString historyFilePath() const { return m_historyFilePath; }
     
     /// 从文件加载历史记录。成功则覆盖当前列表并保存路径；失败则保留原列表。
+    /// 版本5及以上只读取文件头部的索引，各条记录的完整内容在首次访问时再解码。
     bool loadFromFile(const QString& path) {
         QFile f(path);
         if (!f.exists() || !f.open(QIODevice::ReadOnly)) {
@@ -145,96 +980,67 @@ public:
             return false;
         }
         QList<ScheduleHistoryItem> tmp;
+        if (version >= 5) {
+            qint64 generation = 0;
+            const bool ok = readIndex(f, in, version, count, tmp, generation);
+            f.close();
+            if (!ok) return false;
+            for (auto& item : tmp) item.entryId = m_nextEntryId++;
+            historyList = tmp;
+            m_historyFilePath = path;
+            m_payloadFilePath = path;
+            m_generation = generation;
+            return true;
+        }
         for (int k = 0; k < count && in.status() == QDataStream::Ok; ++k) {
             ScheduleHistoryItem item;
             in >> item.timestamp >> item.mode;
-            if (!readFlagGroupFromStream(in, item.flagGroupSnapshot, version)) break;
-            qint32 d0, d1, d2;
-            in >> d0 >> d1 >> d2;
-            item.scheduleTable.resize(d0);
-            for (int i = 0; i < d0; ++i) {
-                item.scheduleTable[i].resize(d1);
-                for (int j = 0; j < d1; ++j) {
-                    item.scheduleTable[i][j].resize(d2);
-                    for (int t = 0; t < d2; ++t) {
-                        if (version >= 2 && version < 3) {
-                            // 兼容旧版本：读取但忽略ID、性别、班级信息
-                            qint32 id;
-                            bool gender;
-                            QString className;
-                            in >> id;
-                            in >> item.scheduleTable[i][j][t].personName >> gender >> className;
-                            // 无法从旧数据恢复组别，设为0（后续查找时会失败，但不会崩溃）
-                            item.scheduleTable[i][j][t].personGroup = 0;
-                        } else if (version >= 3) {
-                            // 新版本：读取姓名和组别
-                            qint32 group;
-                            in >> item.scheduleTable[i][j][t].personName >> group;
-                            item.scheduleTable[i][j][t].personGroup = group;
-                        } else {
-                            // 版本1：只有姓名、性别、班级
-                            bool gender;
-                            QString className;
-                            in >> item.scheduleTable[i][j][t].personName >> gender >> className;
-                            item.scheduleTable[i][j][t].personGroup = 0;
-                        }
-                    }
+            if (version >= 4) {
+                // 版本4：关键帧直接读取完整名单；增量记录在上一条记录的快照上重建，未变化的队员直接共享
+                quint8 kind;
+                in >> kind;
+                bool ok = false;
+                if (kind == EntryKeyframe) {
+                    ok = readKeyframe(in, item.flagGroupSnapshot, version);
+                } else if (kind == EntryDelta && !tmp.isEmpty()) {
+                    ok = readDelta(in, item.flagGroupSnapshot, tmp.last().flagGroupSnapshot, version);
                 }
+                if (!ok) {
+                    if (in.status() == QDataStream::Ok) in.setStatus(QDataStream::ReadCorruptData);
+                    break;
+                }
+            } else {
+                Flag_group loaded;
+                if (!readFlagGroupFromStream(in, loaded, version)) break;
+                // 旧格式每条记录都保存完整名单，读取后与上一条记录比较内容，内容相同的队员共享同一份记录
+                item.flagGroupSnapshot = RosterSnapshot::fromLoaded(loaded, tmp.isEmpty() ? nullptr : &tmp.last().flagGroupSnapshot);
             }
-            in >> item.scheduleText >> item.totalMembers >> item.totalScheduleCount;
+            if (!readScheduleBody(in, item, version)) break;
+            in >> item.totalMembers >> item.totalScheduleCount;
+            item.entryId = m_nextEntryId++;
             if (in.status() == QDataStream::Ok) tmp.append(item);
         }
         f.close();
         if (in.status() != QDataStream::Ok) return false;
         historyList = tmp;
         m_historyFilePath = path;
+        m_payloadFilePath.clear();
+        m_generation = 0;
         return true;
     }
     
-    /// 将当前历史记录写入已设置路径的文件。使用临时文件+重命名保证写入原子性。
+    /// 将当前历史记录一次性写入已设置路径的文件。使用临时文件+重命名保证写入原子性。
+    /// 启用追加日志后历史随时写入日志，退出时无需调用。
     bool saveToFile() const {
         if (m_historyFilePath.isEmpty()) return false;
-        QString tmpPath = m_historyFilePath + ".tmp";
-        QFile tmp(tmpPath);
-        if (QFile::exists(tmpPath)) QFile::remove(tmpPath);
-        if (!tmp.open(QIODevice::WriteOnly)) {
-            qDebug() << "无法创建历史临时文件：" << tmpPath;
-            return false;
-        }
-        QDataStream out(&tmp);
-        out.setVersion(QDataStream::Qt_5_15);
-        // 版本3：移除队员唯一ID，使用姓名+组别作为唯一标识
-        out << QString("SCHEDULE_HISTORY_V1") << static_cast<qint32>(3)
-            << static_cast<qint32>(historyList.size());
-        for (const auto& item : historyList) {
-            out << item.timestamp << item.mode;
-            if (!writeFlagGroupToStream(out, item.flagGroupSnapshot)) {
-                tmp.close();
-                QFile::remove(tmpPath);
-                return false;
-            }
-            qint32 d0 = static_cast<qint32>(item.scheduleTable.size());
-            qint32 d1 = d0 ? static_cast<qint32>(item.scheduleTable[0].size()) : 0;
-            qint32 d2 = (d0 && d1) ? static_cast<qint32>(item.scheduleTable[0][0].size()) : 0;
-            out << d0 << d1 << d2;
-            for (const auto& row : item.scheduleTable)
-                for (const auto& col : row)
-                    for (const auto& pos : col)
-                        out << pos.personName << static_cast<qint32>(pos.personGroup);
-            out << item.scheduleText << static_cast<qint32>(item.totalMembers)
-                << static_cast<qint32>(item.totalScheduleCount);
-        }
-        tmp.close();
-        if (out.status() != QDataStream::Ok) {
-            QFile::remove(tmpPath);
-            return false;
-        }
-        if (QFile::exists(m_historyFilePath) && !QFile::remove(m_historyFilePath)) {
-            qDebug() << "无法覆盖历史文件：" << m_historyFilePath;
-            QFile::remove(tmpPath);
+        // 写入前解码所有尚未加载的记录（旧文件即将被覆盖），损坏的记录跳过并报告
+        loadAllSkippingCorrupt(historyList, m_payloadFilePath);
+        // 写入并落盘临时文件后原子替换历史文件（见 durableFile.h）
+        const QString tmpPath = DurableFile::tempPathFor(m_historyFilePath);
+        if (!writeIndexedFile(historyList, m_generation, tmpPath, nullptr)) {
             return false;
         }
-        if (!tmp.rename(m_historyFilePath)) {
+        if (!DurableFile::replace(tmpPath, m_historyFilePath)) {
             qDebug() << "无法重命名历史临时文件为：" << m_historyFilePath;
             QFile::remove(tmpPath);
             return false;
@@ -242,6 +1048,65 @@ public:
         return true;
     }
     
+    /// 启用追加日志：回放历史文件之后的各代日志（恢复上次崩溃前的记录），并开始新的会话。
+    /// 此后每次新增或删除历史记录都立即追加一条日志；当前代日志过大时（启动时或会话中）在后台压缩进历史文件，
+    /// 压缩完成的通知投递到 context 所在线程执行。需在 loadFromFile 之后调用。
+    bool openJournal(QObject* context) {
+        if (m_historyFilePath.isEmpty()) return false;
+        m_compactionContext = context;
+        qint64 journalBytes = 0;
+        m_journalGeneration = m_generation;
+        for (qint64 generation : listJournalGenerations()) {
+            const QString path = journalPathFor(generation);
+            if (generation < m_generation) {
+                // 已合并进历史文件的旧日志（上次压缩后未来得及删除）
+                QFile::remove(path);
+                continue;
+            }
+            replayJournal(path);
+            journalBytes += QFileInfo(path).size();
+            m_journalGeneration = generation;
+        }
+        m_journalOpen = true;
+        m_journalBytes = journalBytes;
+        if (journalBytes > JOURNAL_COMPACT_BYTES && context) {
+            startCompaction(context);
+        }
+        // 会话开始记录写在压缩轮换之后，启动时的压缩不包含本次会话的记录
+        m_sessionId = QDateTime::currentMSecsSinceEpoch();
+        m_sessionGeneration = m_journalGeneration;
+        m_sessionBaseline = historyList;
+        return appendJournal(HistoryJournal::RecordSessionBegin, sessionPayload());
+    }
+    
+    bool isJournalOpen() const { return m_journalOpen; }
+    
+    /// 放弃本次会话对历史记录的全部修改（退出时用户选择「不保存」）：
+    /// 向会话涉及的每一代日志追加会话放弃记录，下次启动回放时整段跳过；
+    /// 会话中途的压缩已把本次会话的记录写进历史文件时，改为用会话开始时的历史重写历史文件，并使全部日志失效
+    void discardSession() {
+        if (!m_journalOpen) return;
+        // 等待进行中的压缩结束；尚未替换历史文件的压缩结果直接丢弃
+        m_compactionPool.waitForDone();
+        QFile::remove(m_historyFilePath + ".compact");
+        if (m_sessionCompacted) {
+            const qint64 generation = m_journalGeneration + 1;
+            const QString tmpPath = DurableFile::tempPathFor(m_historyFilePath);
+            if (!writeIndexedFile(m_sessionBaseline, generation, tmpPath, nullptr)
+                || !DurableFile::replace(tmpPath, m_historyFilePath)) {
+                qDebug() << "无法恢复会话开始时的排表历史：" << m_historyFilePath;
+                QFile::remove(tmpPath);
+                return;
+            }
+            for (qint64 journal : listJournalGenerations()) QFile::remove(journalPathFor(journal));
+            return;
+        }
+        const QByteArray payload = sessionPayload();
+        for (qint64 generation = m_sessionGeneration; generation <= m_journalGeneration; ++generation) {
+            HistoryJournal::appendRecord(journalPathFor(generation), HistoryJournal::RecordSessionAbort, payload);
+        }
+    }
+    
     // 添加新的历史记录
     void addHistory(const Flag_group& flagGroup, 
                    const SchedulingManager& manager,
@@ -252,19 +1117,21 @@ public:
         item.mode = mode;
         item.scheduleText = scheduleText;
         
-        // 深拷贝队员信息
-        item.flagGroupSnapshot = flagGroup;
+        // 生成队员信息快照：只复制自上一条记录以来发生变化的队员，其余队员与上一条记录共享
+        if (!historyList.isEmpty()) ensureLoaded(historyList.size() - 1);
+        item.flagGroupSnapshot = RosterSnapshot::capture(flagGroup, historyList.isEmpty() ? nullptr : &historyList.last().flagGroupSnapshot);
         
-        // 保存排班表（将Person指针转换为标识信息）
-        const auto& scheduleTable = manager.getScheduleTable();
-        item.scheduleTable.resize(scheduleTable.size());
-        for (size_t slot = 0; slot < scheduleTable.size(); ++slot) {
-            item.scheduleTable[slot].resize(scheduleTable[slot].size());
-            for (size_t location = 0; location < scheduleTable[slot].size(); ++location) {
-                item.scheduleTable[slot][location].resize(scheduleTable[slot][location].size());
-                for (size_t position = 0; position < scheduleTable[slot][location].size(); ++position) {
-                    const Person* person = scheduleTable[slot][location][position];
-                    item.scheduleTable[slot][location][position] = SchedulePosition(person);
+        // 保存排班表（将Person指针转换为标识信息），直接逐个岗位读取排班管理器的岗位数组；尚未排表时为空
+        if (manager.hasSchedule()) {
+            item.scheduleTable.resize(SchedulingManager::TOTAL_SLOTS);
+            for (int slot = 0; slot < SchedulingManager::TOTAL_SLOTS; ++slot) {
+                item.scheduleTable[slot].resize(manager.getLocationCount());
+                for (int location = 0; location < manager.getLocationCount(); ++location) {
+                    auto& positions = item.scheduleTable[slot][location];
+                    positions.resize(SchedulingManager::PEOPLE_PER_LOCATION);
+                    for (int position = 0; position < SchedulingManager::PEOPLE_PER_LOCATION; ++position) {
+                        positions[position] = SchedulePosition(manager.getSeat(slot, location, position));
+                    }
                 }
             }
         }
@@ -272,7 +1139,7 @@ public:
         // 统计信息
         int totalMembers = 0;
         int totalScheduleCount = 0;
-        for (int i = 1; i <= 4; ++i) {
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
             const auto& members = flagGroup.getGroupMembers(i);
             totalMembers += members.size();
             for (const auto& member : members) {
@@ -282,24 +1149,67 @@ public:
         item.totalMembers = totalMembers;
         item.totalScheduleCount = totalScheduleCount;
         
-        // 添加到列表
-        historyList.append(item);
+        addHistoryItem(item);
+    }
+    
+    // 添加一条已生成的历史记录（名单快照、排班表与统计信息均已填好）
+    void addHistoryItem(ScheduleHistoryItem item) {
+        // 启用日志时立即追加一条记录，写入量只与本条记录有关
+        if (m_journalOpen) {
+            appendJournal(HistoryJournal::RecordAddLocations, encodeAddRecord(item));
+        }
         
-        // 如果超过最大数量，删除最旧的记录
-        while (historyList.size() > maxHistoryCount) {
-            historyList.removeFirst();
+        // 添加到列表；如果超过最大数量，删除最旧的记录
+        appendItem(item);
+        // 压缩在列表修改之后开始，快照包含本条记录
+        compactIfNeeded();
+        // 未启用日志时不在此处写盘；历史仅内存，退出时若用户选择「保存」才写入文件
+    }
+    
+    // 将一条记录的名单（关键帧）、排班表与排班结果文本编码为独立的数据块，不依赖其他记录；
+    // 供其他存储后端逐条保存历史（摘要字段由调用方另行保存）。
+    // 数据块以负数形式的格式版本开头；版本8之前的数据块直接以一组的人数（非负）开头，据此区分
+    static QByteArray encodeStandaloneEntry(const ScheduleHistoryItem& item) {
+        QByteArray payload;
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_5_15);
+        out << -FILE_VERSION;
+        writeKeyframe(out, item.flagGroupSnapshot);
+        writeScheduleBody(out, item);
+        return (out.status() == QDataStream::Ok) ? payload : QByteArray();
+    }
+    
+    // 解码 encodeStandaloneEntry 生成的数据块，填入 item 的名单、排班表与排班结果文本
+    static bool decodeStandaloneEntry(const QByteArray& payload, ScheduleHistoryItem& item) {
+        QDataStream in(payload);
+        in.setVersion(QDataStream::Qt_5_15);
+        qint32 marker = 0;
+        in >> marker;
+        qint32 version = -marker;
+        if (marker >= 0) {
+            // 旧数据块：开头读到的是一组的人数
+            version = GROUPS_VERSION - 1;
+            in.device()->seek(0);
+            in.resetStatus();
         }
-        // 不在此处写盘；历史仅内存，退出时若用户选择「保存」才写入文件
+        RosterSnapshot snapshot;
+        if (!readKeyframe(in, snapshot, version) || !readScheduleBody(in, item, 5)) return false;
+        item.flagGroupSnapshot = snapshot;
+        item.detailLoaded = true;
+        return true;
     }
     
     // 获取历史记录列表
+    // 注意：列表中的记录可能尚未加载，只保证摘要字段（时间、模式、队员数、排班次数）可用；
+    // 需要名单、排班表或排班结果文本时请使用 getHistory
     const QList<ScheduleHistoryItem>& getHistoryList() const {
         return historyList;
     }
     
     // 获取指定索引的历史记录
+    // 尚未加载的记录在此时从文件中解码，解码失败返回 nullptr
     const ScheduleHistoryItem* getHistory(int index) const {
-        if (index >= 0 && index < historyList.size()) {
+        if (index >= 0 && index < historyList.size() && ensureLoaded(index)) {
             return &historyList.at(index);
         }
         return nullptr;
@@ -310,15 +1220,62 @@ public:
         return historyList.size();
     }
     
+    /// 快速校验历史文件（版本7及以上）：只核对索引与每条记录的 CRC32C，不解码内容。
+    /// 返回校验通过的记录数（无法识别的文件返回 -1），problems 中记录每一处损坏。
+    static int verifyFile(const QString& path, QStringList* problems = nullptr) {
+        QFile f(path);
+        if (!f.open(QIODevice::ReadOnly)) return -1;
+        QDataStream in(&f);
+        in.setVersion(QDataStream::Qt_5_15);
+        QString magic;
+        qint32 version, count;
+        in >> magic >> version >> count;
+        if (magic != "SCHEDULE_HISTORY_V1" || in.status() != QDataStream::Ok || version < 7) return -1;
+        QList<ScheduleHistoryItem> index;
+        qint64 generation = 0;
+        if (!readIndex(f, in, version, count, index, generation)) {
+            if (problems) problems->append("历史文件索引损坏");
+            return -1;
+        }
+        int valid = 0;
+        for (int k = 0; k < index.size(); ++k) {
+            const ScheduleHistoryItem& item = index.at(k);
+            if (f.seek(item.payloadOffset)) {
+                const QByteArray payload = f.read(item.payloadLength);
+                if (payload.size() == item.payloadLength && RecordFraming::crc32c(payload) == item.payloadCrc) {
+                    ++valid;
+                    continue;
+                }
+            }
+            if (problems) problems->append(QString("第 %1 条历史记录校验失败").arg(k + 1));
+        }
+        return valid;
+    }
+    
     // 清空所有历史记录
+    // 启用日志时逐条写入删除记录，保证回放结果一致
     void clearHistory() {
+        if (m_journalOpen) {
+            for (int i = historyList.size() - 1; i >= 0; --i) {
+                removeHistory(i);
+            }
+        }
         historyList.clear();
     }
     
     // 删除指定索引的历史记录
     bool removeHistory(int index) {
         if (index >= 0 && index < historyList.size()) {
+            if (m_journalOpen) {
+                QByteArray payload;
+                QDataStream out(&payload, QIODevice::WriteOnly);
+                out.setVersion(QDataStream::Qt_5_15);
+                out << static_cast<qint32>(index) << historyList.at(index).timestamp;
+                appendJournal(HistoryJournal::RecordRemove, payload);
+            }
+            detachSuccessor(index);
             historyList.removeAt(index);
+            compactIfNeeded();
             return true;
         }
         return false;
@@ -0,0 +1,211 @@
+// scheduleTableModel.h头文件
+// 功能说明：值周管理界面排班表的表格模型
+// 行列与界面表格一致：先为各地点的升旗行，再为各地点的降旗行（两个地点时即南鉴湖升旗、东西院升旗、南鉴湖降旗、东西院降旗），
+// 列 0~4 为周一~周五（见 dataFunction.h 开头的表格结构）。行数随排班管理器的地点数变化（见 setLocationCount），
+// 模型持有 行数 × 5 个单元格，每次排表或恢复历史时直接从排班管理器的岗位数组读取（SchedulingManager::getSeat），
+// 只对内容发生变化的单元格发出 dataChanged，不再为每个单元格新建表格项。
+// 单元格的显示尺寸在内容变化时计算一次并缓存，表格按内容调整列宽、行高时直接使用缓存值。
+// 单元格可以手动修改（导出前临时调整），修改只影响显示与导出，不改动排班结果。
+// 除姓名外，单元格还提供：
+//   ShortageRole：该地点缺少的人数（已有人执勤但不足三人时以红色底标出，无人执勤时以灰色底标出）；
+//   LoadRole：格内队员本周执勤次数的最大值，超过本周人均次数 1 次以上时以橙色底标出，便于检查排班是否均衡。
+
+#pragma once
+#include <QAbstractTableModel>
+#include <QBrush>
+#include <QColor>
+#include <QFont>
+#include <QFontMetrics>
+#include <QGuiApplication>
+#include <QSize>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <algorithm>
+#include <vector>
+#include "dataFunction.h"
+
+class ScheduleTableModel : public QAbstractTableModel
+{
+    Q_OBJECT
+public:
+    static constexpr int COLUMNS = SchedulingManager::TOTAL_SLOTS / 2;     // 周一~周五
+
+    enum Role {
+        ShortageRole = Qt::UserRole, // 缺少的人数
+        LoadRole                     // 格内队员本周执勤次数的最大值
+    };
+
+    explicit ScheduleTableModel(QObject* parent = nullptr)
+        : QAbstractTableModel(parent), m_cells(rows() * COLUMNS) {
+        m_rowHeaderFont.setPointSize(15);
+        m_columnHeaderFont.setPointSize(20);
+    }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override { return parent.isValid() ? 0 : rows(); }
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override { return parent.isValid() ? 0 : COLUMNS; }
+
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override {
+        if (!index.isValid()) return QVariant();
+        const Cell& cell = m_cells.at(index.row() * COLUMNS + index.column());
+        switch (role) {
+        case Qt::DisplayRole:
+        case Qt::EditRole: return cell.text;
+        case Qt::ToolTipRole: return cell.toolTip;
+        case Qt::SizeHintRole: return cell.sizeHint.isValid() ? QVariant(cell.sizeHint) : QVariant();
+        case Qt::TextAlignmentRole: return int(Qt::AlignCenter);
+        case ShortageRole: return cell.shortage;
+        case LoadRole: return cell.load;
+        case Qt::BackgroundRole:
+            if (!m_scheduled) return QVariant();
+            if (cell.shortage == SchedulingManager::PEOPLE_PER_LOCATION) return QBrush(QColor("#E0E0E0"));
+            if (cell.shortage > 0) return QBrush(QColor("#F8C8C8"));
+            if (cell.load > m_averageLoad + 1) return QBrush(QColor("#FCE0B0"));
+            return QVariant();
+        default: return QVariant();
+        }
+    }
+
+    // 与原先的表格一样，导出前可以直接在单元格中手动修改姓名
+    Qt::ItemFlags flags(const QModelIndex& index) const override {
+        return index.isValid() ? QAbstractTableModel::flags(index) | Qt::ItemIsEditable : Qt::NoItemFlags;
+    }
+
+    bool setData(const QModelIndex& index, const QVariant& value, int role = Qt::EditRole) override {
+        if (!index.isValid() || role != Qt::EditRole) return false;
+        Cell next = m_cells.at(index.row() * COLUMNS + index.column());
+        next.text = value.toString().trimmed();
+        store(index.row(), index.column(), next, false);
+        return true;
+    }
+
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override {
+        static const char* const columnTitles[COLUMNS] = {"周一", "周二", "周三", "周四", "周五"};
+        const bool horizontal = orientation == Qt::Horizontal;
+        if (section < 0 || section >= (horizontal ? COLUMNS : rows())) return QVariant();
+        if (role == Qt::DisplayRole) {
+            if (horizontal) return QString(columnTitles[section]);
+            return Flag_group::locationTitle(section % m_locationCount) + (section < m_locationCount ? "升旗" : "降旗");
+        }
+        if (role == Qt::FontRole) return horizontal ? m_columnHeaderFont : m_rowHeaderFont;
+        return QVariant();
+    }
+
+    // 单元格显示的姓名（空格分隔），导出表格时使用
+    QString cellText(int row, int column) const {
+        return row >= 0 && row < rows() && column >= 0 && column < COLUMNS ? m_cells.at(row * COLUMNS + column).text : QString();
+    }
+
+    // 设置地点数（行数为地点数的两倍），变化时重置全部单元格；返回是否发生变化
+    bool setLocationCount(int count) {
+        if (count == m_locationCount || count < 1) return false;
+        beginResetModel();
+        m_locationCount = count;
+        m_cells = QVector<Cell>(rows() * COLUMNS);
+        endResetModel();
+        return true;
+    }
+
+    // 从排班管理器读取排班表，只通知内容变化的单元格；返回是否有单元格的显示尺寸发生变化（需要调整列宽、行高）
+    bool setSchedule(const SchedulingManager& manager) {
+        // 地点数与当前行数不同（添加地点或恢复历史记录）时先按新的行数重建表格
+        bool resized = setLocationCount(manager.getLocationCount());
+        // 本周人均执勤次数（按已排入表格的队员计）
+        int total = 0;
+        m_counted.clear();
+        for (int slot = 0; slot < SchedulingManager::TOTAL_SLOTS; ++slot) {
+            for (int location = 0; location < m_locationCount; ++location) {
+                for (int position = 0; position < SchedulingManager::PEOPLE_PER_LOCATION; ++position) {
+                    const Person* person = manager.getSeat(slot, location, position);
+                    if (person && std::find(m_counted.begin(), m_counted.end(), person) == m_counted.end()) {
+                        m_counted.push_back(person);
+                        total += person->getTimes();
+                    }
+                }
+            }
+        }
+        const double averageLoad = m_counted.empty() ? 0 : double(total) / m_counted.size();
+        const bool recolor = !m_scheduled || averageLoad != m_averageLoad;
+        m_averageLoad = averageLoad;
+        m_scheduled = true;
+
+        for (int slot = 0; slot < SchedulingManager::TOTAL_SLOTS; ++slot) {
+            const int column = slot / 2;    // 0~4，分别对应周一至周五
+            const int halfDay = slot % 2;   // 0~1，分别对应升旗与降旗
+            for (int location = 0; location < m_locationCount; ++location) {
+                const int row = halfDay * m_locationCount + location;
+                Cell next;
+                QStringList names;
+                QStringList details;
+                for (int position = 0; position < SchedulingManager::PEOPLE_PER_LOCATION; ++position) {
+                    const Person* person = manager.getSeat(slot, location, position);
+                    if (!person) continue;
+                    const QString name = QString::fromStdString(person->getName());
+                    names << name;
+                    details << QString("%1（本周 %2 次）").arg(name).arg(person->getTimes());
+                    next.load = qMax(next.load, person->getTimes());
+                }
+                next.text = names.join(' ');
+                next.shortage = SchedulingManager::PEOPLE_PER_LOCATION - names.size();
+                next.toolTip = details.join('\n');
+                if (details.isEmpty()) {
+                    next.toolTip = "无人执勤";
+                } else if (next.shortage > 0) {
+                    next.toolTip += QString("\n缺少 %1 人").arg(next.shortage);
+                }
+                resized |= store(row, column, next, recolor);
+            }
+        }
+        return resized;
+    }
+
+    // 清空排班表
+    void clear() {
+        m_scheduled = false;
+        for (int row = 0; row < rows(); ++row) {
+            for (int column = 0; column < COLUMNS; ++column) {
+                store(row, column, Cell(), true);
+            }
+        }
+    }
+
+private:
+    struct Cell {
+        QString text;
+        QString toolTip;
+        QSize sizeHint;     // 缓存的显示尺寸
+        int shortage = 0;
+        int load = 0;
+    };
+
+    // 保存单元格内容，内容变化时通知界面；返回显示尺寸是否变化
+    bool store(int row, int column, Cell next, bool recolor) {
+        Cell& cell = m_cells[row * COLUMNS + column];
+        const bool textChanged = cell.text != next.text;
+        next.sizeHint = textChanged ? sizeHintFor(next.text) : cell.sizeHint;
+        const bool changed = textChanged || cell.toolTip != next.toolTip
+            || cell.shortage != next.shortage || cell.load != next.load;
+        const bool resized = next.sizeHint != cell.sizeHint;
+        if (changed) cell = std::move(next);
+        if (changed || recolor) {
+            const QModelIndex index = this->index(row, column);
+            emit dataChanged(index, index);
+        }
+        return resized;
+    }
+
+    int rows() const { return m_locationCount * 2; }
+
+    static QSize sizeHintFor(const QString& text) {
+        const QFontMetrics metrics(QGuiApplication::font());
+        return QSize(metrics.horizontalAdvance(text) + 16, metrics.height() + 12);
+    }
+
+    int m_locationCount = Person::DEFAULT_LOCATION_COUNT; // 地点数（升旗、降旗各占 m_locationCount 行）
+    QVector<Cell> m_cells;          // 按行优先存放的 行数 * COLUMNS 个单元格
+    std::vector<const Person*> m_counted; // 计算人均次数时已计入的队员（重复使用，避免每次排表重新分配）
+    bool m_scheduled = false;       // 是否已有排班结果（尚未排表时不着色）
+    double m_averageLoad = 0;       // 本周人均执勤次数
+    QFont m_rowHeaderFont;
+    QFont m_columnHeaderFont;
+};
@@ -0,0 +1,434 @@
+// sqliteRosterStorage.h头文件
+// 功能说明：可选的 SQLite 存储后端（使用 Qt 自带的 QSQLITE 驱动，只访问本地数据库文件）
+// 表结构：
+//   members      队员信息与执勤次数，主键为 (组别, 姓名)，另按姓名、年级、组内顺序建索引；组内顺序 position 为 0 ~ 人数-1，
+//                增量保存插入或删除队员时同一事务内移动其后队员的 position；
+//                availability 列保存空闲时间掩码（位 (row-1)*5+(column-1)，前两个地点为低20位），用于整表读取
+//   availability 每名队员每个空闲时间段一行，按时间段建索引，用于按空闲时间查询
+//   location_times 南鉴湖、东西院之外其他执勤地点的累计次数，每名队员每个地点一行（没有其他地点时为空）
+//   roster_settings 名单级别的设置：组数 group_count（没有该项时为四组）、执勤地点数 location_count（没有该项时为两个地点）
+//   history      排表历史，摘要字段单独成列（按时间建索引），名单与排班表作为独立数据块存放，按需读取
+// 批量导入、增量保存与追加历史都在单个事务内完成。
+// 需要 QtSql 模块（项目文件中加入 QT += sql）；未安装该模块时本文件不提供任何内容。
+
+#pragma once
+#if __has_include(<QSqlDatabase>)
+#define FLAG_GROUP_HAS_SQLITE 1
+#include <QSqlDatabase>
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QVariant>
+#include <QVariantList>
+#include <QAtomicInteger>
+#include <QDebug>
+#include "rosterStorage.h"
+
+class SqliteRosterStorage : public RosterStorageBackend
+{
+public:
+    explicit SqliteRosterStorage(const QString& databasePath)
+        : m_path(databasePath),
+          m_connectionName(QString("roster_storage_%1").arg(nextConnectionId())) {}
+
+    ~SqliteRosterStorage() override {
+        {
+            QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+            if (db.isOpen()) db.close();
+        }
+        QSqlDatabase::removeDatabase(m_connectionName);
+    }
+
+    QString backendName() const override { return "SQLite"; }
+
+    bool open() override {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+        db.setDatabaseName(m_path);
+        if (!db.open()) {
+            qDebug() << "无法打开数据库：" << m_path << db.lastError().text();
+            return false;
+        }
+        QSqlQuery query(db);
+        const char* statements[] = {
+            "PRAGMA journal_mode = WAL",
+            "PRAGMA synchronous = NORMAL",
+            "PRAGMA foreign_keys = ON",
+            "CREATE TABLE IF NOT EXISTS members ("
+            " grp INTEGER NOT NULL, name TEXT NOT NULL, position INTEGER NOT NULL,"
+            " gender INTEGER NOT NULL, grade INTEGER NOT NULL, phone_number TEXT, native_place TEXT, native TEXT,"
+            " dorm TEXT, school TEXT, classname TEXT, birthday TEXT, is_work INTEGER NOT NULL,"
+            " availability INTEGER NOT NULL, times INTEGER NOT NULL, all_times INTEGER NOT NULL,"
+            " njh_all_times INTEGER NOT NULL, dxy_all_times INTEGER NOT NULL,"
+            " PRIMARY KEY (grp, name))",
+            "CREATE INDEX IF NOT EXISTS members_by_name ON members(name)",
+            "CREATE INDEX IF NOT EXISTS members_by_grade ON members(grade)",
+            "CREATE INDEX IF NOT EXISTS members_by_position ON members(grp, position)",
+            "CREATE TABLE IF NOT EXISTS availability ("
+            " grp INTEGER NOT NULL, name TEXT NOT NULL, slot INTEGER NOT NULL,"
+            " PRIMARY KEY (grp, name, slot),"
+            " FOREIGN KEY (grp, name) REFERENCES members(grp, name) ON DELETE CASCADE) WITHOUT ROWID",
+            "CREATE INDEX IF NOT EXISTS availability_by_slot ON availability(slot)",
+            "CREATE TABLE IF NOT EXISTS location_times ("
+            " grp INTEGER NOT NULL, name TEXT NOT NULL, location INTEGER NOT NULL, all_times INTEGER NOT NULL,"
+            " PRIMARY KEY (grp, name, location),"
+            " FOREIGN KEY (grp, name) REFERENCES members(grp, name) ON DELETE CASCADE) WITHOUT ROWID",
+            "CREATE TABLE IF NOT EXISTS roster_settings (key TEXT PRIMARY KEY, value INTEGER NOT NULL) WITHOUT ROWID",
+            "CREATE TABLE IF NOT EXISTS history ("
+            " id INTEGER PRIMARY KEY AUTOINCREMENT, created TEXT NOT NULL, mode TEXT NOT NULL,"
+            " total_members INTEGER NOT NULL, total_schedule_count INTEGER NOT NULL, payload BLOB NOT NULL)",
+            "CREATE INDEX IF NOT EXISTS history_by_time ON history(created)"
+        };
+        for (const char* statement : statements) {
+            if (!query.exec(statement)) {
+                qDebug() << "初始化数据库失败：" << statement << query.lastError().text();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool hasRoster() override {
+        QSqlQuery query(database());
+        return query.exec("SELECT EXISTS (SELECT 1 FROM roster_settings) OR EXISTS (SELECT 1 FROM members)")
+            && query.next() && query.value(0).toBool();
+    }
+
+    bool loadRoster(Flag_group& flagGroup) override {
+        QSqlQuery query(database());
+        if (!query.exec(QString("SELECT %1 FROM members ORDER BY grp, position").arg(MEMBER_COLUMNS))) {
+            qDebug() << "读取名单失败：" << query.lastError().text();
+            return false;
+        }
+        Flag_group loaded;
+        QSqlQuery setting(database());
+        if (setting.exec("SELECT value FROM roster_settings WHERE key = 'group_count'") && setting.next()) {
+            loaded.setGroupCount(setting.value(0).toInt());
+        }
+        if (setting.exec("SELECT value FROM roster_settings WHERE key = 'location_count'") && setting.next()) {
+            loaded.setLocationCount(setting.value(0).toInt());
+        }
+        bool contiguous = true; // 各组的 position 是否恰为 0 ~ 人数-1（增量保存按此插入队员）
+        while (query.next()) {
+            Person person = personFromRow(query);
+            const int group = person.getGroup();
+            if (group < 1 || group > Flag_group::MAX_GROUP_COUNT) continue;
+            if (group > loaded.groupCount()) loaded.setGroupCount(group);
+            auto& members = loaded.getGroupMembers(group);
+            if (query.value(2).toInt() != static_cast<int>(members.size())) contiguous = false;
+            members.push_back(std::move(person));
+        }
+        // 其他执勤地点的累计次数
+        QSqlQuery locations(database());
+        if (locations.exec("SELECT grp, name, location, all_times FROM location_times")) {
+            while (locations.next()) {
+                Person key;
+                key.setName(locations.value(1).toString().toStdString());
+                Person* person = loaded.findPersonInGroup(key, locations.value(0).toInt());
+                if (person) person->setLocationAllTimes(locations.value(2).toInt(), locations.value(3).toInt());
+            }
+        }
+        flagGroup = std::move(loaded);
+        // 旧版本增量保存留下的顺序有空缺时保持「需要完整保存」，下次保存重新编号
+        if (contiguous) flagGroup.markSaved();
+        return true;
+    }
+
+    // 只写出修改过的队员：删除记录与修改后的队员在同一事务内提交
+    bool saveRoster(Flag_group& flagGroup) override {
+        if (flagGroup.requiresFullSave()) {
+            if (!importRoster(flagGroup)) return false;
+            flagGroup.markSaved();
+            return true;
+        }
+        QSqlDatabase db = database();
+        if (!db.transaction()) return false;
+        // 组内顺序 position 保持为 0 ~ 人数-1：取出队员时其后的队员前移一位，插入时其后的队员后移一位
+        QSqlQuery locate(db), remove(db), shiftDown(db), shiftUp(db);
+        locate.prepare("SELECT position FROM members WHERE grp = ? AND name = ?");
+        remove.prepare("DELETE FROM members WHERE grp = ? AND name = ?");
+        shiftDown.prepare("UPDATE members SET position = position - 1 WHERE grp = ? AND position > ?");
+        shiftUp.prepare("UPDATE members SET position = position + 1 WHERE grp = ? AND position >= ?");
+        auto takeOut = [&](int group, const QString& name) {
+            locate.addBindValue(group);
+            locate.addBindValue(name);
+            if (!locate.exec()) return false;
+            const bool found = locate.next();
+            const int position = found ? locate.value(0).toInt() : 0;
+            locate.finish();
+            if (!found) return true;
+            remove.addBindValue(group);
+            remove.addBindValue(name);
+            shiftDown.addBindValue(group);
+            shiftDown.addBindValue(position);
+            return remove.exec() && shiftDown.exec();
+        };
+        bool ok = true;
+        for (const auto& key : flagGroup.getRemovedKeys()) {
+            if (!ok) break;
+            ok = takeOut(key.first, QString::fromStdString(key.second));
+        }
+        // 修改或新增的队员先全部取出，再按组内位置从小到大插入：未修改的队员先后顺序不变，插入后与名单顺序一致
+        vector<std::pair<const Person*, int>> changed;
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
+            if (flagGroup.isGroupMapped(i)) continue; // 尚未从名单文件展开的组没有修改
+            const auto& members = flagGroup.getGroupMembers(i);
+            for (size_t k = 0; k < members.size(); ++k) {
+                if (flagGroup.isDirty(members[k])) changed.emplace_back(&members[k], static_cast<int>(k));
+            }
+        }
+        for (const auto& entry : changed) {
+            if (!ok) break;
+            ok = takeOut(entry.first->getGroup(), QString::fromStdString(entry.first->getName()));
+        }
+        for (const auto& entry : changed) {
+            if (!ok) break;
+            shiftUp.addBindValue(entry.first->getGroup());
+            shiftUp.addBindValue(entry.second);
+            ok = shiftUp.exec() && upsertMember(db, *entry.first, entry.second);
+        }
+        if (!ok || !db.commit()) {
+            qDebug() << "增量保存名单失败：" << db.lastError().text();
+            db.rollback();
+            return false;
+        }
+        flagGroup.markSaved();
+        return true;
+    }
+
+    // 批量导入：清空后按列批量插入，整个过程一个事务
+    bool importRoster(const Flag_group& flagGroup) override {
+        QSqlDatabase db = database();
+        if (!db.transaction()) return false;
+        QSqlQuery query(db);
+        bool ok = query.exec("DELETE FROM members");
+
+        QVariantList columns[MEMBER_COLUMN_COUNT];
+        QVariantList slotGroups, slotNames, slotIndexes;
+        QVariantList locationColumns[LOCATION_COLUMN_COUNT];
+        for (int i = 1; i <= flagGroup.groupCount() && ok; ++i) {
+            const auto& members = flagGroup.getGroupMembers(i);
+            for (size_t k = 0; k < members.size(); ++k) {
+                appendMemberValues(columns, members[k], static_cast<int>(k));
+                appendSlots(slotGroups, slotNames, slotIndexes, members[k]);
+                appendLocations(locationColumns, members[k]);
+            }
+        }
+        if (ok) {
+            query.prepare("INSERT OR REPLACE INTO roster_settings (key, value) VALUES ('group_count', ?)");
+            query.addBindValue(flagGroup.groupCount());
+            ok = query.exec();
+        }
+        if (ok) {
+            query.prepare("INSERT OR REPLACE INTO roster_settings (key, value) VALUES ('location_count', ?)");
+            query.addBindValue(flagGroup.locationCount());
+            ok = query.exec();
+        }
+        if (ok) {
+            query.prepare(QString("INSERT INTO members (%1) VALUES (%2)").arg(MEMBER_COLUMNS, placeholders(MEMBER_COLUMN_COUNT)));
+            for (auto& column : columns) query.addBindValue(column);
+            ok = query.execBatch();
+        }
+        if (ok) {
+            query.prepare("INSERT INTO availability (grp, name, slot) VALUES (?, ?, ?)");
+            query.addBindValue(slotGroups);
+            query.addBindValue(slotNames);
+            query.addBindValue(slotIndexes);
+            ok = query.execBatch();
+        }
+        if (ok && !locationColumns[0].isEmpty()) {
+            query.prepare("INSERT INTO location_times (grp, name, location, all_times) VALUES (?, ?, ?, ?)");
+            for (auto& column : locationColumns) query.addBindValue(column);
+            ok = query.execBatch();
+        }
+        if (!ok || !db.commit()) {
+            qDebug() << "导入名单失败：" << query.lastError().text();
+            db.rollback();
+            return false;
+        }
+        return true;
+    }
+
+    QStringList memberNames(int groupNumber) override {
+        QStringList names;
+        QSqlQuery query(database());
+        query.prepare("SELECT name FROM members WHERE grp = ? ORDER BY position");
+        query.addBindValue(groupNumber);
+        if (query.exec()) {
+            while (query.next()) names.append(query.value(0).toString());
+        }
+        return names;
+    }
+
+    QVector<Person> findByName(const QString& name) override {
+        return selectMembers("name = ?", name);
+    }
+
+    QVector<Person> membersOfGroup(int groupNumber) override {
+        return selectMembers("grp = ?", groupNumber);
+    }
+
+    QVector<Person> membersOfGrade(int grade) override {
+        return selectMembers("grade = ?", grade);
+    }
+
+    QVector<Person> membersAvailableAt(int row, int column) override {
+        return selectMembers("(grp, name) IN (SELECT grp, name FROM availability WHERE slot = ?)", (row - 1) * 5 + (column - 1));
+    }
+
+    bool appendHistory(const ScheduleHistoryItem& item) override {
+        const QByteArray payload = ScheduleHistoryManager::encodeStandaloneEntry(item);
+        if (payload.isEmpty()) return false;
+        QSqlQuery query(database());
+        query.prepare("INSERT INTO history (created, mode, total_members, total_schedule_count, payload) VALUES (?, ?, ?, ?, ?)");
+        query.addBindValue(item.timestamp.toString(Qt::ISODateWithMs));
+        query.addBindValue(item.mode);
+        query.addBindValue(item.totalMembers);
+        query.addBindValue(item.totalScheduleCount);
+        query.addBindValue(payload);
+        if (!query.exec()) {
+            qDebug() << "写入排表历史失败：" << query.lastError().text();
+            return false;
+        }
+        return true;
+    }
+
+    int historyCount() override {
+        QSqlQuery query(database());
+        if (query.exec("SELECT COUNT(*) FROM history") && query.next()) return query.value(0).toInt();
+        return 0;
+    }
+
+    bool loadHistory(int index, ScheduleHistoryItem& item) override {
+        QSqlQuery query(database());
+        query.prepare("SELECT created, mode, total_members, total_schedule_count, payload FROM history"
+                      " ORDER BY id LIMIT 1 OFFSET ?");
+        query.addBindValue(index);
+        if (!query.exec() || !query.next()) return false;
+        item.timestamp = QDateTime::fromString(query.value(0).toString(), Qt::ISODateWithMs);
+        item.mode = query.value(1).toString();
+        item.totalMembers = query.value(2).toInt();
+        item.totalScheduleCount = query.value(3).toInt();
+        return ScheduleHistoryManager::decodeStandaloneEntry(query.value(4).toByteArray(), item);
+    }
+
+private:
+    static constexpr int MEMBER_COLUMN_COUNT = 18;
+    static constexpr int LOCATION_COLUMN_COUNT = 4; // location_times：grp, name, location, all_times
+    static constexpr const char* MEMBER_COLUMNS =
+        "grp, name, position, gender, grade, phone_number, native_place, native, dorm, school, classname, birthday,"
+        " is_work, availability, times, all_times, njh_all_times, dxy_all_times";
+
+    static int nextConnectionId() {
+        static QAtomicInteger<int> counter(0);
+        return counter.fetchAndAddRelaxed(1);
+    }
+
+    static QString placeholders(int count) {
+        QStringList marks;
+        for (int i = 0; i < count; ++i) marks.append("?");
+        return marks.join(", ");
+    }
+
+    QSqlDatabase database() const {
+        return QSqlDatabase::database(m_connectionName);
+    }
+
+    static QVariant text(const std::string& value) {
+        return QString::fromStdString(value);
+    }
+
+    static void appendMemberValues(QVariantList (&columns)[MEMBER_COLUMN_COUNT], const Person& person, int position) {
+        const QVariant values[MEMBER_COLUMN_COUNT] = {
+            person.getGroup(), text(person.getName()), position, person.getGender() ? 1 : 0, person.getGrade(),
+            text(person.getPhone_number()), text(person.getNative_place()), text(person.getNative()),
+            text(person.getDorm()), text(person.getSchool()), text(person.getClassname()), text(person.getBirthday()),
+            person.getIsWork() ? 1 : 0, static_cast<qint64>(person.getTimeMask()), person.getTimes(),
+            person.getAll_times(), person.getNJHAllTimes(), person.getDXYAllTimes()
+        };
+        for (int i = 0; i < MEMBER_COLUMN_COUNT; ++i) columns[i].append(values[i]);
+    }
+
+    static void appendSlots(QVariantList& groups, QVariantList& names, QVariantList& indexes, const Person& person) {
+        const quint64 mask = person.getTimeMask();
+        for (int bit = 0; bit < Person::MAX_TIME_SLOTS; ++bit) {
+            if (mask & (quint64(1) << bit)) {
+                groups.append(person.getGroup());
+                names.append(QString::fromStdString(person.getName()));
+                indexes.append(bit);
+            }
+        }
+    }
+
+    // 南鉴湖、东西院之外各地点的累计次数，每个地点一行
+    static void appendLocations(QVariantList (&columns)[LOCATION_COLUMN_COUNT], const Person& person) {
+        for (int location = Person::DEFAULT_LOCATION_COUNT; location < person.getLocationCount(); ++location) {
+            columns[0].append(person.getGroup());
+            columns[1].append(QString::fromStdString(person.getName()));
+            columns[2].append(location);
+            columns[3].append(person.getLocationAllTimes(location));
+        }
+    }
+
+    // 插入或替换一名队员及其空闲时间与其他地点的执勤次数（调用方负责事务）
+    static bool upsertMember(QSqlDatabase& db, const Person& person, int position) {
+        QVariantList columns[MEMBER_COLUMN_COUNT];
+        appendMemberValues(columns, person, position);
+        QSqlQuery query(db);
+        query.prepare(QString("INSERT OR REPLACE INTO members (%1) VALUES (%2)").arg(MEMBER_COLUMNS, placeholders(MEMBER_COLUMN_COUNT)));
+        for (const auto& column : columns) query.addBindValue(column.first());
+        if (!query.exec()) return false;
+        query.prepare("DELETE FROM availability WHERE grp = ? AND name = ?");
+        query.addBindValue(person.getGroup());
+        query.addBindValue(QString::fromStdString(person.getName()));
+        if (!query.exec()) return false;
+        QVariantList groups, names, indexes;
+        appendSlots(groups, names, indexes, person);
+        if (!groups.isEmpty()) {
+            query.prepare("INSERT INTO availability (grp, name, slot) VALUES (?, ?, ?)");
+            query.addBindValue(groups);
+            query.addBindValue(names);
+            query.addBindValue(indexes);
+            if (!query.execBatch()) return false;
+        }
+        query.prepare("DELETE FROM location_times WHERE grp = ? AND name = ?");
+        query.addBindValue(person.getGroup());
+        query.addBindValue(QString::fromStdString(person.getName()));
+        if (!query.exec()) return false;
+        QVariantList locationColumns[LOCATION_COLUMN_COUNT];
+        appendLocations(locationColumns, person);
+        if (locationColumns[0].isEmpty()) return true;
+        query.prepare("INSERT INTO location_times (grp, name, location, all_times) VALUES (?, ?, ?, ?)");
+        for (auto& column : locationColumns) query.addBindValue(column);
+        return query.execBatch();
+    }
+
+    static Person personFromRow(const QSqlQuery& query) {
+        bool time[4][5] = {};
+        Person person(query.value(1).toString().toStdString(), query.value(3).toInt() != 0, query.value(0).toInt(),
+                      query.value(4).toInt(), query.value(5).toString().toStdString(),
+                      query.value(6).toString().toStdString(), query.value(7).toString().toStdString(),
+                      query.value(8).toString().toStdString(), query.value(9).toString().toStdString(),
+                      query.value(10).toString().toStdString(), query.value(11).toString().toStdString(),
+                      query.value(12).toInt() != 0, time, query.value(14).toInt(), query.value(15).toInt(),
+                      query.value(16).toInt(), query.value(17).toInt());
+        person.setTimeMask(static_cast<quint64>(query.value(13).toLongLong()));
+        return person;
+    }
+
+    QVector<Person> selectMembers(const char* condition, const QVariant& value) {
+        QVector<Person> result;
+        QSqlQuery query(database());
+        query.prepare(QString("SELECT %1 FROM members WHERE %2 ORDER BY grp, position").arg(MEMBER_COLUMNS, condition));
+        query.addBindValue(value);
+        if (!query.exec()) {
+            qDebug() << "查询名单失败：" << query.lastError().text();
+            return result;
+        }
+        while (query.next()) result.append(personFromRow(query));
+        return result;
+    }
+
+    QString m_path;
+    QString m_connectionName;
+};
+
+#endif // __has_include(<QSqlDatabase>)
@@ -0,0 +1,75 @@
+// stringPool.h头文件
+// 功能说明：队员档案字段的字符串池（驻留）
+// 学院、班级、民族、籍贯、寝室等字段在全队中大量重复。Person 只保存这些字段在池中的编号，相同的文字在整个程序中只存一份，
+// 实时名单、撤销记录与每条排班历史快照中的队员都引用同一份字符串；比较或按学院 / 班级分组时只需比较编号。
+// 编号在程序运行期间不变，0 固定表示空串；池只增不减（取值种类很少，不需要回收）。
+// 池在读取文件的后台线程与界面线程之间共享，查询与插入均加锁。
+// 文件中不直接保存池编号（编号随运行而不同），而是在文件内写一张字符串表，队员记录引用表中的序号（见 encryptedFileManager.h）。
+
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+class StringPool
+{
+public:
+    using Id = std::uint32_t;
+    static constexpr Id EMPTY = 0; // 空串的编号
+
+    // 全局共享的池
+    static StringPool& shared() {
+        static StringPool pool;
+        return pool;
+    }
+
+    // 返回文字对应的编号，池中没有时加入
+    Id intern(std::string_view text) {
+        if (text.empty()) return EMPTY;
+        {
+            std::shared_lock<std::shared_mutex> lock(m_mutex);
+            const auto it = m_ids.find(text);
+            if (it != m_ids.end()) return it->second;
+        }
+        std::unique_lock<std::shared_mutex> lock(m_mutex);
+        const auto it = m_ids.find(text); // 加写锁前可能已被其他线程加入
+        if (it != m_ids.end()) return it->second;
+        const Id id = static_cast<Id>(m_strings.size());
+        m_strings.emplace_back(text);
+        m_ids.emplace(std::string_view(m_strings.back()), id); // deque 追加元素不移动已有字符串，键可以直接引用池中的文字
+        return id;
+    }
+
+    // 只查询不加入：池中没有该文字时返回 EMPTY（因此没有队员使用该取值）
+    Id find(std::string_view text) const {
+        if (text.empty()) return EMPTY;
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        const auto it = m_ids.find(text);
+        return it == m_ids.end() ? EMPTY : it->second;
+    }
+
+    // 编号对应的文字；返回的引用在程序运行期间一直有效
+    const std::string& text(Id id) const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return id < m_strings.size() ? m_strings[id] : m_strings.front();
+    }
+
+    // 池中不同取值的数量（含空串）
+    std::size_t size() const {
+        std::shared_lock<std::shared_mutex> lock(m_mutex);
+        return m_strings.size();
+    }
+
+private:
+    StringPool() { m_strings.emplace_back(); }
+    StringPool(const StringPool&) = delete;
+    StringPool& operator=(const StringPool&) = delete;
+
+    mutable std::shared_mutex m_mutex;
+    std::deque<std::string> m_strings;                // 编号 -> 文字
+    std::unordered_map<std::string_view, Id> m_ids;  // 文字 -> 编号
+};
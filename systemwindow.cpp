@@ -4,12 +4,8 @@
 
 #include "ui_systemwindow.h"
 #include <QMessageBox>
-#include <QStringListModel>
 #include <QCloseEvent>
 #include <QFileDialog>
-#include <QAxObject>
-#include <QProgressDialog>
-#include <QTextStream>
 #include <QApplication>
 #include <QFileInfo>
 #include <QDir>
@@ -24,10 +20,24 @@
 #include <QTextEdit>
 #include <QLabel>
 #include <QEvent>
+#include <QStatusBar>
+#include <QThreadPool>
+#include <QListView>
+#include <QRadioButton>
+#include <QGroupBox>
+#include <QHBoxLayout>
+#include <QSignalBlocker>
+#include <QPointer>
 #include "systemwindow.h"
 #include "fileFunction.h"
 #include "dataFunction.h"
 #include "encryptedFileManager.h"
+#include "mappedRoster.h"
+#include "xlsxWriter.h"
+#include "xlsxReader.h"
+#include "csvImport.h"
+#include "availabilityMatrixDialog.h"
+#include "sqliteRosterStorage.h"
 
 QString finalText_excel; // 全局变量，用于导出表格时输出统计的表格信息
 
@@ -54,29 +64,85 @@ SystemWindow::SystemWindow(QWidget *parent)
         dir.mkpath("."); // 创建目录
     }
     
-    // 尝试读取加密文件
+    // 若存在二进制名单文件（./data/data.roster，需用户自行启用），优先通过内存映射读取。
+    // 文件在整个会话中保持映射：各组在第一次需要修改时才展开为 Person，列表、筛选与排班候选直接读取文件中的记录
     bool loaded = false;
-    QFile encryptedFile(encryptedFilename);
-    if (encryptedFile.exists()) {
-        loaded = EncryptedFileManager::loadFromFile(flagGroup, encryptedFilename);
+    QString rosterFilename = filename;
+    rosterFilename.replace(".txt", ".roster");
+    if (QFile::exists(rosterFilename)) {
+        mappedRoster = std::make_shared<MappedRoster>();
+        if (mappedRoster->open(rosterFilename)) {
+            flagGroup.attachMappedRoster(mappedRoster);
+            loaded = true;
+            qDebug() << "成功从二进制名单文件读取数据：" << rosterFilename;
+        } else {
+            qDebug() << "二进制名单文件读取失败，尝试读取加密文件：" << rosterFilename;
+        }
+    }
+    
+    // 名单存储后端：数据目录中存在 data.sqlite（可为空文件，需用户自行启用）且程序带有 QtSql 模块时使用 SQLite 数据库，
+    // 否则使用加密文件 data.dat；数据库无法打开时退回加密文件
+    QString databaseFilename = filename;
+    databaseFilename.replace(".txt", ".sqlite");
+#ifdef FLAG_GROUP_HAS_SQLITE
+    if (QFile::exists(databaseFilename)) {
+        storage.reset(new SqliteRosterStorage(databaseFilename));
+        if (!storage->open()) {
+            qDebug() << "数据库无法打开，改用加密文件：" << databaseFilename;
+            storage.reset();
+        }
+    }
+#else
+    if (QFile::exists(databaseFilename)) {
+        qDebug() << "程序未带有 QtSql 模块，忽略数据库文件，使用加密文件：" << databaseFilename;
+    }
+#endif
+    if (!storage) {
+        storage.reset(new FileRosterStorage(dir.absolutePath()));
+        storage->open();
+    }
+    // 名单取自二进制名单文件而存储后端中还没有名单：下次保存时完整写入存储后端
+    if (flagGroup.mappedRoster() && !storage->hasRoster()) {
+        flagGroup.markFullSaveRequired();
+    }
+    
+    // 从存储后端读取名单
+    if (!loaded && storage->hasRoster()) {
+        loaded = storage->loadRoster(flagGroup);
         if (loaded) {
-            qDebug() << "成功从加密文件读取数据：" << encryptedFilename;
+            qDebug() << "成功从" << storage->backendName() << "读取数据";
         } else {
-            qDebug() << "加密文件读取失败，尝试读取旧格式：" << encryptedFilename;
+            qDebug() << storage->backendName() << "读取失败，尝试读取旧格式：" << filename;
         }
-    } else {
-        qDebug() << "加密文件不存在，尝试读取旧格式：" << encryptedFilename;
+    } else if (!loaded && QFile::exists(encryptedFilename)) {
+        // 刚启用数据库：把加密文件中的名单一次导入数据库，加密文件保留不动
+        loaded = EncryptedFileManager::loadFromFile(flagGroup, encryptedFilename);
+        if (loaded && storage->importRoster(flagGroup)) {
+            flagGroup.markSaved();
+            qDebug() << "已将加密文件中的名单导入" << storage->backendName() << "：" << encryptedFilename;
+        } else if (loaded) {
+            flagGroup.markFullSaveRequired(); // 导入失败：下次保存时完整写入数据库，下次启动也会重新导入
+            qDebug() << "名单导入" << storage->backendName() << "失败：" << encryptedFilename;
+        }
+    } else if (!loaded) {
+        qDebug() << storage->backendName() << "中没有名单，尝试读取旧格式：" << filename;
     }
     
     // 如果加密文件不存在或读取失败，尝试读取旧格式文件（向后兼容）
     if (!loaded) {
         QFile oldFile(filename);
         if (oldFile.exists()) {
-            FlagGroupFileManager::loadFromFile(flagGroup, filename);
-            qDebug() << "从旧格式文件读取数据：" << filename;
-            // 如果旧文件存在，自动转换为新格式
-            EncryptedFileManager::saveToFile(flagGroup, encryptedFilename);
-            qDebug() << "已将旧格式转换为加密格式：" << encryptedFilename;
+            QStringList legacyErrors;
+            int legacyCount = FlagGroupFileManager::loadFromFileFast(flagGroup, filename, &legacyErrors);
+            qDebug() << "从旧格式文件读取数据：" << filename << "队员数：" << legacyCount;
+            for (const QString& error : legacyErrors) {
+                qDebug() << "旧格式数据错误：" << error;
+            }
+            // 如果旧文件存在，自动转换为新格式（写入当前的存储后端）
+            if (storage->importRoster(flagGroup)) {
+                flagGroup.markSaved();
+                qDebug() << "已将旧格式转换并写入" << storage->backendName();
+            }
         } else {
             qDebug() << "数据文件不存在，使用空数据：" << filename;
         }
@@ -88,12 +154,34 @@ SystemWindow::SystemWindow(QWidget *parent)
     if (historyManager.loadFromFile(historyPath)) {
         qDebug() << "已加载排表历史记录：" << historyPath;
     }
+    // 回放上次退出（或崩溃）前追加的历史日志，此后每次制表、删除历史都立即写入日志
+    if (!historyManager.openJournal(this)) {
+        qDebug() << "无法启用排表历史日志，退出时将一次性保存历史：" << historyPath;
+    }
 
     // 刚启动时，内存中的数据与文件一致（或为空初始状态），认为没有未保存修改
     dataSaved = true;
     hasUnsavedChanges = false;
     discardWithoutSave = false;
 
+    // 后台自动保存：修改后写入恢复文件，状态显示在状态栏
+    QString autosaveFilename = encryptedFilename + ".autosave";
+    autosave.start(&flagGroup, autosaveFilename, this, [this](const QString& message) {
+        statusBar()->showMessage(message, 5000);
+    });
+    // 上次退出前存在未保存的修改（程序崩溃或保存失败）：从恢复文件找回，并视为尚未保存
+    if (AutosaveService::hasRecovery(autosaveFilename)) {
+        Flag_group recovered;
+        if (EncryptedFileManager::loadFromFile(recovered, autosaveFilename)) {
+            flagGroup = std::move(recovered);
+            markDataChanged();
+            statusBar()->showMessage("已从自动保存恢复上次未保存的修改", 10000);
+            qDebug() << "已从自动保存恢复数据：" << autosaveFilename;
+        } else {
+            qDebug() << "自动保存的恢复文件无法读取，已忽略：" << autosaveFilename;
+        }
+    }
+
     // 执勤管理界面
     // 连接按钮和复选框的信号与槽
     connect(ui->tabulateButton, &QPushButton::clicked, this, &SystemWindow::onTabulateButtonClicked); // 排表按钮点击事件
@@ -101,28 +189,32 @@ SystemWindow::SystemWindow(QWidget *parent)
     connect(ui->alterButton, &QPushButton::clicked, this, &SystemWindow::onRestoreScheduleButtonClicked); // 恢复排班按钮点击事件
     connect(ui->deriveButton, &QPushButton::clicked, this, &SystemWindow::onExportButtonClicked); // 导出表格按钮点击事件
     connect(ui->importTimeFromTask_pushButton, &QPushButton::clicked, this, &SystemWindow::onImportTimeFromTaskButtonClicked); // 导入空闲时间按钮点击事件
+    connect(ui->checkDataFiles_pushButton, &QPushButton::clicked, this, &SystemWindow::onCheckDataFilesButtonClicked); // 检查数据文件按钮点击事件
+    // 排班表由模型提供数据，模型只通知内容变化的单元格
+    scheduleModel = new ScheduleTableModel(this);
+    scheduleModel->setLocationCount(flagGroup.locationCount()); // 尚未排班时按名单的地点数显示空表
+    ui->worksheet->setModel(scheduleModel);
     // 导出表格在初始时取消交互
     ui->deriveButton->setEnabled(false);
     // 历史记录按钮始终可用
-    // 进度对话框指针
-    exportProgress = nullptr;
     // 以常规模式为默认排表规则
     ui->normal_mode_radioButton->setChecked(true);
     // 因自定义模式未实现，取消其交互
     ui->custom_mode_radioButton->setEnabled(false);
 
     // 队员管理界面
-    // 更新四个组的队员标签界面
-    for (int groupIndex = 1; groupIndex <= 4; ++groupIndex) {
-        updateListView(groupIndex);
-    }
-    // 设置全组执勤按钮的选中状态，默认为被选中
-    ui->group1_iswork_radioButton->setChecked(true);
-    ui->group2_iswork_radioButton->setChecked(true);
-    ui->group3_iswork_radioButton->setChecked(true);
-    ui->group4_iswork_radioButton->setChecked(true);
+    // 按名单的组数生成各组页面（全组执勤按钮默认被选中）并更新队员标签界面
+    syncGroupPages();
+    connect(ui->addGroup_pushButton, &QPushButton::clicked, this, &SystemWindow::onAddGroupButtonClicked); // 添加组别按钮点击事件
+    connect(ui->addLocation_pushButton, &QPushButton::clicked, this, &SystemWindow::onAddLocationButtonClicked); // 添加地点按钮点击事件
     // 将 FlagGroup 中所有队员的 iswork 信息全部调成 true，对应全组执勤按钮的默认选定状态
-    for (int groupIndex = 1; groupIndex <= 4; ++groupIndex) {
+    // （先读取判断，整组已经值周时不修改，尚未展开的组也就不必展开）
+    for (int groupIndex = 1; groupIndex <= flagGroup.groupCount(); ++groupIndex) {
+        bool allWorking = true;
+        for (int k = 0; k < flagGroup.memberCount(groupIndex) && allWorking; ++k) {
+            allWorking = MappedRoster::visitMember(flagGroup, groupIndex, k, [](const auto& member) { return member.getIsWork(); });
+        }
+        if (allWorking) continue;
         auto& members = flagGroup.getGroupMembers(groupIndex); // 返回对应组的队员列表
         for (auto& member : members) {
             member.setIsWork(true); // 修改iswork信息
@@ -146,30 +238,10 @@ SystemWindow::SystemWindow(QWidget *parent)
             connect(button, &QAbstractButton::clicked, this, &SystemWindow::onAllSelectButtonClicked);
         }
     }
-    // 连接一组的信号与槽
-    connect(ui->group1_add_pushButton, &QPushButton::clicked, this, [this]() { onGroupAddButtonClicked(1); });
-    connect(ui->group1_delete_pushButton, &QPushButton::clicked, this, [this]() { onGroupDeleteButtonClicked(1); });
-    connect(ui->group1_iswork_radioButton, &QRadioButton::clicked, this, [this]() { onGroupIsWorkRadioButtonClicked(1); });
-    connect(ui->group1_info_listView, &QListView::clicked, this, [this](const QModelIndex &index) { onListViewItemClicked(index, 1); });
-    // 连接二组的信号与槽
-    connect(ui->group2_add_pushButton, &QPushButton::clicked, this, [this]() { onGroupAddButtonClicked(2); });
-    connect(ui->group2_delete_pushButton, &QPushButton::clicked, this, [this]() { onGroupDeleteButtonClicked(2); });
-    connect(ui->group2_iswork_radioButton, &QRadioButton::clicked, this, [this]() { onGroupIsWorkRadioButtonClicked(2); });
-    connect(ui->group2_info_listView, &QListView::clicked, this, [this](const QModelIndex &index) { onListViewItemClicked(index, 2); });
-    // 连接三组的信号与槽
-    connect(ui->group3_add_pushButton, &QPushButton::clicked, this, [this]() { onGroupAddButtonClicked(3); });
-    connect(ui->group3_delete_pushButton, &QPushButton::clicked, this, [this]() { onGroupDeleteButtonClicked(3); });
-    connect(ui->group3_iswork_radioButton, &QRadioButton::clicked, this, [this]() { onGroupIsWorkRadioButtonClicked(3); });
-    connect(ui->group3_info_listView, &QListView::clicked, this, [this](const QModelIndex &index) { onListViewItemClicked(index, 3); });
-    // 连接四组的信号与槽
-    connect(ui->group4_add_pushButton, &QPushButton::clicked, this, [this]() { onGroupAddButtonClicked(4); });
-    connect(ui->group4_delete_pushButton, &QPushButton::clicked, this, [this]() { onGroupDeleteButtonClicked(4); });
-    connect(ui->group4_iswork_radioButton, &QRadioButton::clicked, this, [this]() { onGroupIsWorkRadioButtonClicked(4); });
-    connect(ui->group4_info_listView, &QListView::clicked, this, [this](const QModelIndex &index) { onListViewItemClicked(index, 4); });
-
     // 基础信息栏内容
     // 连接 group_combobox 的 currentIndexChanged 信号，组别修改事件
     connect(ui->group_combobox, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &SystemWindow::onGroupComboBoxChanged);
+    connect(ui->memberFilter_lineEdit, &QLineEdit::textChanged, this, &SystemWindow::onMemberFilterChanged); // 队员筛选框
     // 连接队员信息输入框的 editingFinished 信号到编辑结束槽函数，但不包括 group_combobox
     connect(ui->name_lineEdit, &QLineEdit::editingFinished, this, &SystemWindow::onInfoLineEditChanged);
     connect(ui->phone_lineEdit, &QLineEdit::editingFinished, this, &SystemWindow::onInfoLineEditChanged);
@@ -210,6 +282,9 @@ SystemWindow::SystemWindow(QWidget *parent)
     connect(ui->importTime_pushButton, &QPushButton::clicked, this, &SystemWindow::onImportTimeButtonClicked);
     connect(ui->setAllAvailable_pushButton, &QPushButton::clicked, this, &SystemWindow::onSetAllAvailableButtonClicked);
     connect(ui->setAllUnavailable_pushButton, &QPushButton::clicked, this, &SystemWindow::onSetAllUnavailableButtonClicked);
+    connect(ui->importRoster_pushButton, &QPushButton::clicked, this, &SystemWindow::onImportRosterButtonClicked);
+    connect(ui->exportRoster_pushButton, &QPushButton::clicked, this, &SystemWindow::onExportRosterButtonClicked);
+    connect(ui->availabilityMatrix_pushButton, &QPushButton::clicked, this, &SystemWindow::onAvailabilityMatrixButtonClicked);
     
     // 连接应用程序退出信号，确保在任何情况下都能保存数据
     connect(qApp, &QApplication::aboutToQuit, this, &SystemWindow::onApplicationAboutToQuit);
@@ -232,7 +307,6 @@ SystemWindow::SystemWindow(QWidget *parent)
 }
 SystemWindow::~SystemWindow()
 {
-    delete exportProgress;
     delete ui;
 }
 //关闭窗口事件
@@ -300,6 +374,12 @@ void SystemWindow::keyPressEvent(QKeyEvent *event)
         event->accept();
         return;
     }
+    // 撤销 / 重做名单修改（输入框获得焦点时由输入框自身处理）
+    if (event->matches(QKeySequence::Undo) || event->matches(QKeySequence::Redo)) {
+        undoRosterChange(event->matches(QKeySequence::Redo));
+        event->accept();
+        return;
+    }
     
     // 其他按键事件交给父类处理
     QMainWindow::keyPressEvent(event);
@@ -318,17 +398,36 @@ bool SystemWindow::saveDataToFile()
         dir.mkpath(".");
     }
     
-    // 保存文件（使用加密格式）
-    bool saved = EncryptedFileManager::saveToFile(flagGroup, encryptedFilename);
+    // 已启用二进制名单文件时，先在文件头标记“更新中”：若之后的保存中断，下次启动不再读取这份落后的文件，改从存储后端读取
+    QString rosterFilename = filename;
+    rosterFilename.replace(".txt", ".roster");
+    const bool rosterEnabled = QFile::exists(rosterFilename);
+    if (rosterEnabled) {
+        if (!mappedRoster) mappedRoster = std::make_shared<MappedRoster>();
+        if (!mappedRoster->markUpdating()) {
+            qDebug() << "二进制名单文件无法标记为更新中，保存时将完整重写：" << rosterFilename;
+        }
+    }
+
+    // 保存到存储后端：只写出上次保存后修改过的队员，必要时自动完整重写
+    // （加密文件为追加更新日志，数据库为单个事务内的增量更新）
+    bool saved = storage->saveRoster(flagGroup);
+    
+    // 同步更新二进制名单文件，保证下次启动读取到的是最新数据：修改过的队员原地改写或追加到文件末尾，
+    // 无法原地更新时完整重写
+    if (saved && rosterEnabled) {
+        saved = mappedRoster->save(flagGroup, rosterFilename);
+    }
     
     if (saved) {
+        autosave.discardRecovery(); // 数据文件已是最新，恢复文件不再需要
         dataSaved = true;
         hasUnsavedChanges = false;   // 所有修改已写入文件
         discardWithoutSave = false;  // 当前状态是“已保存”，不再视为放弃保存
-        qDebug() << "数据已保存：" << encryptedFilename;
+        qDebug() << "数据已保存：" << storage->backendName();
         return true;
     } else {
-        qDebug() << "数据保存失败：" << encryptedFilename;
+        qDebug() << "数据保存失败：" << storage->backendName();
         return false;
     }
 }
@@ -337,10 +436,12 @@ bool SystemWindow::saveDataToFile()
 void SystemWindow::onApplicationAboutToQuit()
 {
     if (discardWithoutSave) {
-        // 用户已选择「不保存」：不写队员数据，不写排表历史；本次会话的修改全部丢弃
+        // 用户已选择「不保存」：不写队员数据；排表历史日志中本次会话的记录标记为放弃，下次启动时不再回放
+        historyManager.discardSession();
+        autosave.discardRecovery();
         return;
     }
-    // 未选择「不保存」：视情况保存队员数据，并始终保存排表历史
+    // 未选择「不保存」：视情况保存队员数据，并保存排表历史
     if (hasUnsavedChanges) {
         qDebug() << "检测到程序即将退出，尝试自动保存数据...";
         if (saveDataToFile()) {
@@ -349,7 +450,8 @@ void SystemWindow::onApplicationAboutToQuit()
             qDebug() << "自动保存失败，数据可能丢失";
         }
     }
-    if (historyManager.saveToFile()) {
+    // 启用日志时历史记录已随时写入，无需整体重写
+    if (!historyManager.isJournalOpen() && historyManager.saveToFile()) {
         qDebug() << "排表历史已保存";
     }
 }
@@ -360,6 +462,7 @@ void SystemWindow::markDataChanged()
     hasUnsavedChanges = true;
     dataSaved = false;
     discardWithoutSave = false;
+    autosave.notifyChanged(); // 防抖后在后台写入恢复文件
 }
 
 //值周管理界面函数实现
@@ -413,7 +516,7 @@ void SystemWindow::onTabulateButtonClicked() {
         manager->setScheduleMode(SchedulingManager::ScheduleMode::Normal);
     }
     // 检查可用成员数量，不足则直接返回
-    if (manager->getAvailableMembers().size() < 12) {
+    if (manager->availableMemberCount() < 12) {
         QMessageBox::warning(nullptr,"排表错误警告","现在国旗班12个队员都凑不出来了吗:(");
     } else {
         manager->schedule();
@@ -423,28 +526,14 @@ void SystemWindow::onTabulateButtonClicked() {
 }
 void SystemWindow::updateTableWidget(const SchedulingManager& manager) {
     //制表操作，点击制表按钮后的辅助函数
-    const auto& scheduleTable = manager.getScheduleTable();
-    // 从周一上午开始，依次处理表格每个时间槽（周一上午、周一下午、周二上午、周二下午…… 周五下午）
-    for (int slot = 0; slot < 10; ++slot) {
-        int day = slot / 2; // 0~4，分别对应周一至周五
-        int halfDay = slot % 2; // 时段，0~1，分别对应升旗与降旗
-        for (int location = 0; location < 2; ++location) {
-            // 对于每个时间槽，依次处理两个地点。
-            int row = halfDay * 2 + location;// 表格对应的行数，0~3，对应表格单元项的第一到第四行（即不包括表头）
-            QString cellText;
-            for (int position = 0; position < 3; ++position) {
-                // 对于每个地点，检查并添加 3 个人员位置的人员姓名。
-                if (scheduleTable[slot][location][position]) {
-                    cellText += QString::fromStdString(scheduleTable[slot][location][position]->getName()) + " ";
-                }
-            }
-            ui->worksheet->setItem(row, day, new QTableWidgetItem(cellText.trimmed()));
-        }
+    // 排班结果交给排班表模型（见 scheduleTableModel.h），只刷新内容变化的单元格；单元格尺寸不变时列宽、行高与窗口都无需调整
+    if (!scheduleModel->setSchedule(manager)) {
+        return;
     }
 
     // 处理完表格后的表格和窗口大小调整功能
 
-    // 表格大小处理
+    // 表格大小处理（使用模型缓存的单元格尺寸）
     // 调整表格列宽以适应内容
     ui->worksheet->resizeColumnsToContents();
     // 调整表格行高以适应内容
@@ -454,19 +543,11 @@ void SystemWindow::updateTableWidget(const SchedulingManager& manager) {
     //
     // 窗口宽度计算
     // 计算表格所需的总宽度
-    int totalTableWidth = 0;
-    QHeaderView* horizontalHeader = ui->worksheet->horizontalHeader();
-    for (int col = 0; col < ui->worksheet->columnCount(); ++col) {
-        totalTableWidth += horizontalHeader->sectionSize(col);
-    }
+    int totalTableWidth = ui->worksheet->horizontalHeader()->length();
     // 加上垂直表头的宽度
     totalTableWidth += ui->worksheet->verticalHeader()->width();
     // 计算表格所需的总高度
-    int totalTableHeight = 0;
-    QHeaderView* verticalHeader = ui->worksheet->verticalHeader();
-    for (int row = 0; row < ui->worksheet->rowCount(); ++row) {
-        totalTableHeight += verticalHeader->sectionSize(row);
-    }
+    int totalTableHeight = ui->worksheet->verticalHeader()->length();
     //
     // 窗口高度计算
     // 加上水平表头的高度
@@ -514,14 +595,13 @@ void SystemWindow::handleSchedulingWarning(const QString& warningMessage)
 void SystemWindow::updateTextEdit(const SchedulingManager& manager) {
     // 制表结果文本域更新
     QString resultText;
-    const auto& availableMembers = manager.getAvailableMembers();
-    for (const auto& member : availableMembers) {
-        resultText += QString::fromStdString(member->getName()) +
-                      " 本周工作次数: " + QString::number(member->getTimes()) +
-                      " 总工作次数: " + QString::number(member->getAll_times()) +
-                      " （南鉴湖累计: " + QString::number(member->getNJHAllTimes()) +
-                      "，东西院累计: " + QString::number(member->getDXYAllTimes()) + "）\n";
-    }
+    manager.forEachAvailableMember([&resultText](const auto& member) {
+        resultText += QString::fromStdString(member.getName()) +
+                      " 本周工作次数: " + QString::number(member.getTimes()) +
+                      " 总工作次数: " + QString::number(member.getAll_times()) +
+                      " （南鉴湖累计: " + QString::number(member.getNJHAllTimes()) +
+                      "，东西院累计: " + QString::number(member.getDXYAllTimes()) + "）\n";
+    });
     // 拼接警告信息和排班结果文本
     QString finalText = warningMessages + resultText;
     finalText_excel = finalText;
@@ -546,8 +626,9 @@ void SystemWindow::restoreFromHistory(int historyIndex) {
         return;
     }
     
-    // 恢复队员信息
-    flagGroup = item->flagGroupSnapshot;
+    // 恢复队员信息（由共享快照展开为完整的队员容器）
+    flagGroup = item->flagGroupSnapshot.toFlagGroup();
+    undoStack.clear(); // 名单被整体替换，已有的撤销记录不再对应
     
     // 恢复排班表（需要重新创建SchedulingManager并设置排班表）
     // 先删除旧的manager，确保下次排班时能重新创建
@@ -559,21 +640,16 @@ void SystemWindow::restoreFromHistory(int historyIndex) {
     // 创建临时manager用于恢复排班表显示
     SchedulingManager* tempManager = new SchedulingManager(flagGroup);
     
-    // 根据历史记录中的排班表信息恢复排班状态
-    std::vector<std::vector<std::vector<Person*>>> scheduleTable;
-    scheduleTable.resize(item->scheduleTable.size());
+    // 根据历史记录中的排班表信息恢复排班状态（逐个岗位写入，超出固定规模的岗位忽略）
     for (size_t slot = 0; slot < item->scheduleTable.size(); ++slot) {
-        scheduleTable[slot].resize(item->scheduleTable[slot].size());
         for (size_t location = 0; location < item->scheduleTable[slot].size(); ++location) {
-            scheduleTable[slot][location].resize(item->scheduleTable[slot][location].size());
             for (size_t position = 0; position < item->scheduleTable[slot][location].size(); ++position) {
                 const SchedulePosition& pos = item->scheduleTable[slot][location][position];
-                Person* person = pos.findPerson(flagGroup);
-                scheduleTable[slot][location][position] = person;
+                tempManager->setSeat(static_cast<int>(slot), static_cast<int>(location), static_cast<int>(position),
+                                     pos.findPerson(flagGroup));
             }
         }
     }
-    tempManager->setScheduleTable(scheduleTable);
     
     // 使用临时manager更新UI
     updateTableWidget(*tempManager);
@@ -588,10 +664,8 @@ void SystemWindow::restoreFromHistory(int historyIndex) {
     ui->tabulateButton->setEnabled(false);
     ui->deriveButton->setEnabled(true);
     
-    // 刷新队员列表显示
-    for (int i = 1; i <= 4; ++i) {
-        updateListView(i);
-    }
+    // 刷新队员列表显示（历史记录中的组数可能与当前不同）
+    syncGroupPages();
     
     // 标记数据已更改
     markDataChanged();
@@ -604,10 +678,6 @@ void SystemWindow::onRestoreScheduleButtonClicked() {
     ui->deriveButton->setEnabled(false);
     QMessageBox::information(this, "恢复排班", "已恢复排班功能，可以重新进行排班操作。");
 }
-// 导出表格颜色转换辅助函数
-int rgbToBgr(const QColor& color) {
-    return (color.blue() << 16) | (color.green() << 8) | color.red();
-}
 void SystemWindow::onExportButtonClicked()
 {
     // 导出表格按钮点击事件
@@ -638,289 +708,91 @@ void SystemWindow::onExportButtonClicked()
         }
     }
 
-    // 确保进度对话框被正确初始化和重置
-    if (exportProgress == nullptr) {
-        exportProgress = new QProgressDialog(this);
-        exportProgress->setWindowModality(Qt::ApplicationModal);
-        exportProgress->setWindowFlags(exportProgress->windowFlags() | Qt::WindowStaysOnTopHint);
-        exportProgress->setCancelButton(nullptr);
-        exportProgress->setMinimumDuration(0); // 允许快速显示
-    } else {
-        // 重置对话框状态
-        exportProgress->reset();
-        exportProgress->setWindowModality(Qt::ApplicationModal);
-        exportProgress->setWindowFlags(exportProgress->windowFlags() | Qt::WindowStaysOnTopHint);
-        exportProgress->setCancelButton(nullptr);
-        exportProgress->setMinimumDuration(0);
-    }
-
-    // 显示初始提示信息
-    exportProgress->setWindowTitle("导出进度");
-    exportProgress->setLabelText("正在导出表格，请稍候...");
-    exportProgress->setRange(0, 0); // 不确定进度模式
-    exportProgress->show();
-
-    // 强制更新UI，确保初始提示显示，增加事件处理次数
-    for (int i = 0; i < 5; ++i) {
-        QApplication::processEvents(QEventLoop::AllEvents);
-    }
-
-    QAxObject *excel = new QAxObject("Excel.Application");
-    if (excel) {
-        // 设置 Excel 应用程序不可见
-        excel->dynamicCall("SetVisible(bool)", false);
-        // 获取 Excel 应用程序的工作簿集合
-        QAxObject *workbooks = excel->querySubObject("Workbooks");
-        // 分段处理：每完成一个主要步骤就处理一次事件
-        processStep("创建工作簿", exportProgress); // 自定义函数，见下方
-        // 创建一个新的工作簿
-        QAxObject *workbook = workbooks->querySubObject("Add");
-        if (workbook) {
-            // ========== 第一个工作表：统计信息 ==========
-            // 获取新工作簿的第一个工作表
-            QAxObject *statsSheet = workbook->querySubObject("Worksheets(int)", 1);
-            statsSheet->dynamicCall("SetName(const QString&)", "统计信息");
-            // 将 finalText 内容逐行写入工作表
-            QStringList lines = finalText_excel.split('\n');
-            for (int i = 0; i < lines.size(); ++i) {
-                QAxObject *cell = statsSheet->querySubObject("Cells(int,int)", i + 1, 1);
-                cell->dynamicCall("SetValue(const QVariant&)", lines[i]);
-                // 获取字体对象并设置颜色为蓝色
-                QAxObject *font = cell->querySubObject("Font");
-                if (font) {
-                    // RGB 值转换为 BGR（Excel 使用 BGR 格式）
-                    int blueColor = rgbToBgr(QColor(Qt::blue));
-                    font->dynamicCall("SetColor(int)", blueColor);
-                    delete font; // 释放对象，避免内存泄漏
-                }
-                // 处理事件，让进度对话框有机会更新
-                if (i % 5 == 0) { // 每5行处理一次事件，增加频率
-                    for (int j = 0; j < 2; ++j) {
-                        QApplication::processEvents(QEventLoop::AllEvents);
-                    }
-                    if (exportProgress->wasCanceled()) {
-                        break;
-                    }
-                }
-            }
-            // 调整列宽以适应内容
-            QAxObject *usedRange = statsSheet->querySubObject("UsedRange");
-            usedRange->querySubObject("Columns")->dynamicCall("AutoFit()");
-
-            processStep("写入统计信息", exportProgress);
-
-
-            // ========== 第二个工作表：排班表 ==========
-            QAxObject *worksheets = workbook->querySubObject("Worksheets");
-            worksheets->dynamicCall("Add()"); // 添加新工作表
-            QAxObject *worksheetExcel = workbook->querySubObject("Worksheets(int)", 1);
-            worksheetExcel->dynamicCall("SetName(const QString&)", "排班表");
-
-            processStep("创建排班表", exportProgress);
-
-            // 1. 所有拥有文字的区域（A1~G5矩阵区域）都应该居中对齐
-            QAxObject *allRange = worksheetExcel->querySubObject("Range(const QString&)", "A1:G5");
-            allRange->setProperty("HorizontalAlignment", -4108); // 直接设置属性
-            // 2. 第一行列标题C1~G1区域，文本内容不变，字体格式改为16号黑体，背景填充色改为#FFC000
-            QAxObject *headerRange = worksheetExcel->querySubObject("Range(const QString&)", "C1:G1");
-            QAxObject *headerFont = headerRange->querySubObject("Font");
-            headerFont->dynamicCall("SetName(const QString&)", "黑体");
-            headerFont->dynamicCall("SetSize(int)", 16);
-            QAxObject *headerInterior = headerRange->querySubObject("Interior");
-            QColor Color("#FFC000");
-            int BgrColor = rgbToBgr(Color);
-            headerInterior->dynamicCall("SetColor(int)", BgrColor);
-            // 复制列标题到 Excel
-            for (int col = 0; col < ui->worksheet->columnCount(); ++col) {
-                QString headerText = ui->worksheet->horizontalHeaderItem(col)->text();
-                QAxObject *cell = worksheetExcel->querySubObject("Cells(int,int)", 1, col + 3); // 从第一行第三列开始写列标题
-                cell->dynamicCall("SetValue(const QVariant&)", headerText);
-            }
-            processStep("设置表头格式", exportProgress);
-            // 3. 第一列A2和A3区域合并，并输入“升旗”文本，字体格式改为16号黑体，背景填充色改为#FFFF00
-            // 两者使用的颜色单位不同，不能直接转换需要rgb to bgr的操作
-            QAxObject *riseFlagRange = worksheetExcel->querySubObject("Range(const QString&)", "A2:A3");
-            riseFlagRange->dynamicCall("Merge()");
-            QAxObject *riseFlagCell = worksheetExcel->querySubObject("Cells(int,int)", 2, 1);
-            riseFlagCell->dynamicCall("SetValue(const QVariant&)", "升旗");
-            QAxObject *riseFlagFont = riseFlagRange->querySubObject("Font");
-            riseFlagFont->dynamicCall("SetName(const QString&)", "黑体");
-            riseFlagFont->dynamicCall("SetSize(int)", 16);
-            QAxObject *riseFlagInterior = riseFlagRange->querySubObject("Interior");
-            Color = QColor("#FFF000");
-            BgrColor = rgbToBgr(Color);
-            riseFlagInterior->dynamicCall("SetColor(int)", BgrColor);
-            processStep("设置升旗区域", exportProgress);
-            // 4. 第一列A4和A5区域合并，并输入“降旗”文本，字体格式改为16号黑体，背景填充色改为#FFFF00
-            QAxObject *lowerFlagRange = worksheetExcel->querySubObject("Range(const QString&)", "A4:A5");
-            lowerFlagRange->dynamicCall("Merge()");
-            QAxObject *lowerFlagCell = worksheetExcel->querySubObject("Cells(int,int)", 4, 1);
-            lowerFlagCell->dynamicCall("SetValue(const QVariant&)", "降旗");
-            QAxObject *lowerFlagFont = lowerFlagRange->querySubObject("Font");
-            lowerFlagFont->dynamicCall("SetName(const QString&)", "黑体");
-            lowerFlagFont->dynamicCall("SetSize(int)", 16);
-            QAxObject *lowerFlagInterior = lowerFlagRange->querySubObject("Interior");
-            Color = QColor("#FFF000");
-            BgrColor = rgbToBgr(Color);
-            lowerFlagInterior->dynamicCall("SetColor(int)", BgrColor);
-            processStep("设置降旗区域", exportProgress);
-            // 5. 第二列B2~B5区域行标题，文本内容不变，字体格式改为12号等线，背景填充色改为#FFFF00
-            QAxObject *rowHeaderRange = worksheetExcel->querySubObject("Range(const QString&)", "B2:B5");
-            QAxObject *rowHeaderFont = rowHeaderRange->querySubObject("Font");
-            rowHeaderFont->dynamicCall("SetName(const QString&)", "等线");
-            rowHeaderFont->dynamicCall("SetSize(int)", 12);
-            QAxObject *rowHeaderInterior = rowHeaderRange->querySubObject("Interior");
-            Color = QColor("#FFF000");
-            BgrColor = rgbToBgr(Color);
-            rowHeaderInterior->dynamicCall("SetColor(int)", BgrColor);
-            processStep("设置行标题", exportProgress);
-            // 复制行标题到 Excel
-            for (int row = 0; row < ui->worksheet->rowCount(); ++row) {
-                QString rowHeaderText = ui->worksheet->verticalHeaderItem(row)->text();
-                QAxObject *cell = worksheetExcel->querySubObject("Cells(int,int)", row + 2, 2); // 从第二行第二列写行标题
-                cell->dynamicCall("SetValue(const QVariant&)", rowHeaderText);
-            }
-            // 复制表格数据到 Excel，从第二行第三列开始
-            for (int row = 0; row < ui->worksheet->rowCount(); ++row) {
-                for (int col = 0; col < ui->worksheet->columnCount(); ++col) {
-                    QTableWidgetItem *item = ui->worksheet->item(row, col);
-                    if (item) {
-                        QAxObject *cell = worksheetExcel->querySubObject("Cells(int,int)", row + 2, col + 3);
-                        cell->dynamicCall("SetValue(const QVariant&)", item->text());
-                    }
-                }
-                // 每行处理一次事件，让进度条更流畅
-                if (row % 1 == 0) {
-                    QApplication::processEvents(QEventLoop::AllEvents);
-                }
-            }
-            processStep("复制表格数据", exportProgress);
-            // // 6. A1~G5矩阵区域设置粗外侧框线
-            QAxObject *allBorders = allRange->querySubObject("Borders");
-            if (allBorders) {
-                // 设置边框样式为连续线条
-                allBorders->dynamicCall("LineStyle", 1); // xlContinuous
-                // 设置边框粗细为粗线
-                allBorders->dynamicCall("Weight", 2);    // xlThick
-                delete allBorders;
-            }
-            //C1~G1区域、B2~B5区域、A2和A3的合并区域、A4和A5的合并区域分别设置为所有框线
-            QAxObject *headerBorders = headerRange->querySubObject("Borders");
-            headerBorders->dynamicCall("LineStyle", 1); // xlContinuous
-            QAxObject *rowHeaderBorders = rowHeaderRange->querySubObject("Borders");
-            rowHeaderBorders->dynamicCall("LineStyle", 1); // xlContinuous
-            QAxObject *riseFlagBorders = riseFlagRange->querySubObject("Borders");
-            riseFlagBorders->dynamicCall("LineStyle", 1); // xlContinuous
-            QAxObject *lowerFlagBorders = lowerFlagRange->querySubObject("Borders");
-            lowerFlagBorders->dynamicCall("LineStyle", 1); // xlContinuous
-            processStep("设置表格边框", exportProgress);
-            // 7. A列宽110像素，B列宽175像素，C~G列宽350像素，1~5行高全部设置为65像素
-            // 两者计量单位不同，需要计算后转换
-            QAxObject *columnA = worksheetExcel->querySubObject("Columns(const QString&)", "A");
-            columnA->dynamicCall("ColumnWidth", 8);
-            QAxObject *columnB = worksheetExcel->querySubObject("Columns(const QString&)", "B");
-            columnB->dynamicCall("ColumnWidth", 14);
-            QAxObject *columnsCToG = worksheetExcel->querySubObject("Range(const QString&)", "C:G");
-            columnsCToG->dynamicCall("ColumnWidth", 28);
-            QAxObject *rows1To5 = worksheetExcel->querySubObject("Range(const QString&)", "1:5");
-            rows1To5->dynamicCall("RowHeight", 32.5);
-            processStep("设置表格格式", exportProgress);
-            // 保存并关闭 Excel 文件
-            // 如果目标文件已存在，先尝试删除（避免SaveAs时的覆盖提示卡死）
-            QFile targetFile(filePath);
-            if (targetFile.exists()) {
-                // 尝试删除旧文件，如果失败说明文件被占用
-                if (!targetFile.remove()) {
-                    qDebug() << "警告：无法删除旧文件，可能被占用：" << filePath;
-                    // 继续尝试SaveAs，Excel可能会提示覆盖
-                }
-            }
-            
-            // 将工作簿保存到用户指定的路径
-            // 使用DisplayAlerts=false来避免覆盖提示对话框导致卡死
-            excel->dynamicCall("SetDisplayAlerts(bool)", false);
-            QVariant saveResult = workbook->dynamicCall("SaveAs(const QString&)", QDir::toNativeSeparators(filePath));
-            excel->dynamicCall("SetDisplayAlerts(bool)", true);
-            
-            // 检查保存是否成功
-            bool saveSuccess = false;
-            if (saveResult.isNull() || !saveResult.toBool()) {
-                qDebug() << "Excel保存可能失败：" << filePath;
-            } else {
-                // 验证文件是否真的存在
-                QFileInfo savedFile(filePath);
-                if (savedFile.exists() && savedFile.size() > 0) {
-                    saveSuccess = true;
-                }
-            }
-            
-            // 关闭工作簿
-            workbook->dynamicCall("Close()");
-            processStep("保存工作簿", exportProgress);
-            
-            // 退出 Excel 应用程序
-            excel->dynamicCall("Quit()");
-            // 释放 Excel 应用程序对象的内存
-            delete excel;
-            
-            // 导出完成后恢复控件状态并提示
-            if (exportProgress) {
-                exportProgress->hide();
-            }
-            
-            // 只有在成功保存后才显示成功消息并恢复排班按钮
-            if (saveSuccess) {
-                QMessageBox::information(this, "导出完成", "表格已成功导出至：\n" + filePath, QMessageBox::Ok);
-                // 恢复排班按钮的交互功能，关闭导出按钮
-                ui->tabulateButton->setEnabled(true);
-                ui->deriveButton->setEnabled(false);
-            } else {
-                QMessageBox::warning(this, "导出失败", 
-                    "表格导出可能失败，请检查文件路径和权限。\n\n"
-                    "文件路径：" + filePath + "\n\n"
-                    "建议解决方案：\n"
-                    "1. 可以通过\"查看历史记录功能\"回退到之前的记录，然后重新导出\n"
-                    "2. 或者关闭程序后重新打开，重新进行排班和导出操作",
-                    QMessageBox::Ok);
-            }
-        } else {
-            // workbook创建失败
-            excel->dynamicCall("Quit()");
-            delete excel;
-            if (exportProgress) {
-                exportProgress->hide();
-            }
-            QMessageBox::warning(this, "导出失败", 
-                "无法创建工作簿，导出失败。\n\n"
-                "建议解决方案：\n"
-                "1. 可以通过\"查看历史记录功能\"回退到之前的记录，然后重新导出\n"
-                "2. 或者关闭程序后重新打开，重新进行排班和导出操作",
-                QMessageBox::Ok);
+    // 直接生成 .xlsx 文件（见 xlsxWriter.h），不再通过 COM 驱动 Excel，无需安装 Excel
+    XlsxWriter writer;
+    // 1. 所有拥有文字的区域（A1~G5矩阵区域）都应该居中对齐，并设置所有框线
+    XlsxWriter::Style plain;
+    plain.border = true;
+    plain.center = true;
+    const int plainStyle = writer.addStyle(plain);
+    // 2. 第一行列标题C1~G1区域，字体格式为16号黑体，背景填充色为#FFC000
+    XlsxWriter::Style header = plain;
+    header.fontName = "黑体";
+    header.fontSize = 16;
+    header.fill = QColor("#FFC000");
+    const int headerStyle = writer.addStyle(header);
+    // 3. 第一列“升旗”“降旗”合并区域，字体格式为16号黑体，背景填充色为#FFF000
+    XlsxWriter::Style flag = header;
+    flag.fill = QColor("#FFF000");
+    const int flagStyle = writer.addStyle(flag);
+    // 4. 第二列B2~B5区域行标题，字体格式为12号等线，背景填充色为#FFF000
+    XlsxWriter::Style rowHeader = plain;
+    rowHeader.fontName = "等线";
+    rowHeader.fontSize = 12;
+    rowHeader.fill = QColor("#FFF000");
+    const int rowHeaderStyle = writer.addStyle(rowHeader);
+    // 统计信息：蓝色字体
+    XlsxWriter::Style stats;
+    stats.fontColor = QColor(Qt::blue);
+    const int statsStyle = writer.addStyle(stats);
+
+    // ========== 第一个工作表：排班表 ==========
+    writer.beginSheet("排班表");
+    // 5. A列宽8，B列宽14，C~G列宽28（字符），1~5行高全部设置为32.5磅
+    writer.setColumnWidth(1, 1, 8);
+    writer.setColumnWidth(2, 2, 14);
+    writer.setColumnWidth(3, 7, 28);
+    const double rowHeight = 32.5;
+    // 第一行：A1、B1 空白，C1~G1 为列标题
+    QVector<XlsxWriter::Cell> cells;
+    cells.append({1, QString(), plainStyle});
+    cells.append({2, QString(), plainStyle});
+    for (int col = 0; col < ScheduleTableModel::COLUMNS; ++col) {
+        cells.append({col + 3, scheduleModel->headerData(col, Qt::Horizontal).toString(), headerStyle});
+    }
+    writer.writeRow(1, cells, rowHeight);
+    // 第二行起每个地点升旗、降旗各一行：A 列为“升旗”/“降旗”合并单元格，B 列为行标题，C~G 列为排班数据
+    const int ceremonyRows = scheduleModel->rowCount() / 2; // 升旗（降旗）的行数，即地点数
+    for (int row = 0; row < scheduleModel->rowCount(); ++row) {
+        cells.clear();
+        cells.append({1, row == 0 ? QString("升旗") : (row == ceremonyRows ? QString("降旗") : QString()), flagStyle});
+        cells.append({2, scheduleModel->headerData(row, Qt::Vertical).toString(), rowHeaderStyle});
+        for (int col = 0; col < ScheduleTableModel::COLUMNS; ++col) {
+            cells.append({col + 3, scheduleModel->cellText(row, col), plainStyle});
         }
+        writer.writeRow(row + 2, cells, rowHeight);
+    }
+    writer.mergeCells(QString("A2:A%1").arg(1 + ceremonyRows));
+    writer.mergeCells(QString("A%1:A%2").arg(2 + ceremonyRows).arg(1 + 2 * ceremonyRows));
+
+    // ========== 第二个工作表：统计信息 ==========
+    writer.beginSheet("统计信息");
+    // 将 finalText 内容逐行写入工作表，列宽按最长的一行设置（代替 Excel 的自动调整列宽）
+    const QStringList lines = finalText_excel.split('\n');
+    double statsWidth = 8;
+    for (const QString& line : lines) {
+        statsWidth = qMax(statsWidth, XlsxWriter::textWidth(line));
+    }
+    writer.setColumnWidth(1, 1, statsWidth);
+    for (int i = 0; i < lines.size(); ++i) {
+        writer.writeRow(i + 1, {{1, lines[i], statsStyle}});
+    }
+
+    // 保存：先写入临时文件，完成后替换目标文件
+    if (writer.save(filePath)) {
+        QMessageBox::information(this, "导出完成", "表格已成功导出至：\n" + filePath, QMessageBox::Ok);
+        // 恢复排班按钮的交互功能，关闭导出按钮
+        ui->tabulateButton->setEnabled(true);
+        ui->deriveButton->setEnabled(false);
     } else {
-        // Excel启动失败
-        if (exportProgress) {
-            exportProgress->hide();
-        }
         QMessageBox::warning(this, "导出失败", 
-            "无法启动Excel应用程序，请确保已安装Microsoft Excel。\n\n"
+            "表格导出失败，请检查文件路径和权限，并确认文件没有被其他程序（如Excel）打开。\n\n"
+            "文件路径：" + filePath + "\n\n"
             "建议解决方案：\n"
-            "1. 安装或修复Microsoft Excel\n"
-            "2. 如果Excel已安装但仍无法启动，可以通过\"查看历史记录\"功能回退到之前的记录，然后重新导出\n"
-            "3. 或者关闭程序后重新打开，重新进行排班和导出操作",
+            "1. 可以通过\"查看历史记录功能\"回退到之前的记录，然后重新导出\n"
+            "2. 或者关闭程序后重新打开，重新进行排班和导出操作",
             QMessageBox::Ok);
     }
-
-}
-// 自定义进度更新函数 - 优化版，增加更多事件处理
-void SystemWindow::processStep(const QString& stepName, QProgressDialog* progress) {
-    if (progress && progress->isVisible()) {
-        progress->setLabelText("正在导出表格 - " + stepName + "...");
-        // 多次调用 processEvents，让进度条动画更流畅
-        for (int i = 0; i < 3; ++i) {
-            QApplication::processEvents(QEventLoop::AllEvents);
-        }
-    }
 }
 
 
@@ -929,19 +801,13 @@ void SystemWindow::onGroupAddButtonClicked(int groupIndex)
 {
     //添加队员按钮点击事件
     // 检查组号是否有效
-    if (groupIndex < 1 || groupIndex > 4) {
+    if (!flagGroup.isValidGroup(groupIndex) || groupIndex > groupPages.size()) {
         QMessageBox::warning(this, "错误", "无效的组别");
         return;
     }
     
-    bool isChecked = false;
-    //判断是哪个组发出的信号，修改新队员的是否值周状态
-    switch (groupIndex) {
-    case 1: isChecked = ui->group1_iswork_radioButton->isChecked(); break;
-    case 2: isChecked = ui->group2_iswork_radioButton->isChecked(); break;
-    case 3: isChecked = ui->group3_iswork_radioButton->isChecked(); break;
-    case 4: isChecked = ui->group4_iswork_radioButton->isChecked(); break;
-    } 
+    //按发出信号的组修改新队员的是否值周状态
+    bool isChecked = groupPages[groupIndex - 1].isWork->isChecked();
     
     bool time[4][5];
     //初始化所有执勤时间，默认为全部不可以执勤
@@ -972,8 +838,8 @@ void SystemWindow::onGroupAddButtonClicked(int groupIndex)
     //初始化新队员的基础信息
     Person person(defaultName, false, groupIndex, 1, "", "", "", "", "", "", "", isChecked, time, 0, 0);
     
-    //向flagGroup中添加新队员
-    flagGroup.addPersonToGroup(person, groupIndex);
+    //向flagGroup中添加新队员（可撤销）
+    undoStack.append(groupIndex, person);
     
     //更新对应组的ListView组员标签信息
     updateListView(groupIndex);
@@ -987,14 +853,8 @@ void SystemWindow::onGroupDeleteButtonClicked(int groupIndex)
     qDebug() << "\n========== [SystemWindow::onGroupDeleteButtonClicked] 删除队员操作开始 ==========";
     qDebug() << "触发删除的组别:" << groupIndex;
     
-    QListView* listView = nullptr;
     //判断是哪个组发出的信号，以及信号情况
-    switch (groupIndex) {
-    case 1: listView = ui->group1_info_listView; break;
-    case 2: listView = ui->group2_info_listView; break;
-    case 3: listView = ui->group3_info_listView; break;
-    case 4: listView = ui->group4_info_listView; break;
-    }
+    QListView* listView = groupIndex >= 1 && groupIndex <= groupPages.size() ? groupPages[groupIndex - 1].listView : nullptr;
     //如果出现非法组号，退出
     if (!listView) {
         qDebug() << "错误：listView为空";
@@ -1021,8 +881,8 @@ void SystemWindow::onGroupDeleteButtonClicked(int groupIndex)
     if (reply == QMessageBox::Yes) {
         qDebug() << "用户确认删除";
         
-        int row = selectedIndexes.first().row();
-        qDebug() << "选中的行索引:" << row;
+        int row = memberIndexForRow(groupIndex, selectedIndexes.first().row()); // 列表可能经过筛选，行号需换算为组内位置
+        qDebug() << "选中的队员位置:" << row;
         
         const auto& members = flagGroup.getGroupMembers(groupIndex);
         qDebug() << "组" << groupIndex << "当前队员数量:" << members.size();
@@ -1042,7 +902,7 @@ void SystemWindow::onGroupDeleteButtonClicked(int groupIndex)
         
         // 打印删除前所有组的队员情况
         qDebug() << "\n--- 删除前各组队员情况 ---";
-        for (int i = 1; i <= 4; ++i) {
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
             const auto& grp = flagGroup.getGroupMembers(i);
             qDebug() << "组" << i << "队员数量:" << grp.size();
             for (size_t j = 0; j < grp.size(); ++j) {
@@ -1065,13 +925,13 @@ void SystemWindow::onGroupDeleteButtonClicked(int groupIndex)
         qDebug() << "创建待删除队员副本，姓名:" << QString::fromStdString(personToRemove.getName());
         qDebug() << "副本的组别属性:" << personToRemove.getGroup();
         
-        // 调用 Flag_group 的删除成员方法（在指定组内通过姓名删除）
-        qDebug() << "\n调用 flagGroup.removePersonFromGroup()...";
-        flagGroup.removePersonFromGroup(personToRemove, groupIndex);
+        // 按组内位置删除（可撤销，撤销时队员回到原位置）
+        qDebug() << "\n调用 undoStack.remove()...";
+        undoStack.remove(groupIndex, row);
         
         // 打印删除后所有组的队员情况
         qDebug() << "\n--- 删除后各组队员情况 ---";
-        for (int i = 1; i <= 4; ++i) {
+        for (int i = 1; i <= flagGroup.groupCount(); ++i) {
             const auto& grp = flagGroup.getGroupMembers(i);
             qDebug() << "组" << i << "队员数量:" << grp.size();
             for (size_t j = 0; j < grp.size(); ++j) {
@@ -1129,20 +989,16 @@ void SystemWindow::clearMemberInfoDisplay()
 void SystemWindow::onGroupIsWorkRadioButtonClicked(int groupIndex)
 {
     //是否值周确认按钮点击事件
-    bool isChecked = false;
     //判断是哪个组发出的信号，以及信号情况
-    switch (groupIndex) {
-    case 1: isChecked = ui->group1_iswork_radioButton->isChecked(); break;
-    case 2: isChecked = ui->group2_iswork_radioButton->isChecked(); break;
-    case 3: isChecked = ui->group3_iswork_radioButton->isChecked(); break;
-    case 4: isChecked = ui->group4_iswork_radioButton->isChecked(); break;
-    }
-    //获取对应组别所有队员
-    const auto& members = flagGroup.getGroupMembers(groupIndex);
-    //设置对应组别所有队员isWork属性，选中设为1，取消选中设为0
-    for (auto& member : const_cast<std::vector<Person>&>(members)) {
-        member.setIsWork(isChecked);
-    }
+    if (groupIndex < 1 || groupIndex > groupPages.size()) return;
+    bool isChecked = groupPages[groupIndex - 1].isWork->isChecked();
+    //设置对应组别所有队员isWork属性，选中设为1，取消选中设为0；整组修改为一个撤销步骤
+    const int memberCount = flagGroup.memberCount(groupIndex);
+    undoStack.begin(QString("设置%1是否值周").arg(Flag_group::groupTitle(groupIndex)));
+    for (int k = 0; k < memberCount; ++k) {
+        undoStack.setField(groupIndex, k, MemberFields::IsWork, isChecked ? "是" : "否");
+    }
+    undoStack.commit();
     // 该组的是否值周状态已更改
     markDataChanged();
 }
@@ -1163,11 +1019,115 @@ Person* SystemWindow::getSelectedPerson(int groupIndex, const QModelIndex &index
 {
     //捕捉被选中的标签是哪个队员
     const auto& members = flagGroup.getGroupMembers(groupIndex);
-    if (index.isValid() && static_cast<std::vector<Person>::size_type>(index.row()) < members.size()){
-        return const_cast<Person*>(&members[index.row()]);
+    const int position = index.isValid() ? memberIndexForRow(groupIndex, index.row()) : -1;
+    if (position >= 0 && static_cast<std::vector<Person>::size_type>(position) < members.size()){
+        return const_cast<Person*>(&members[position]);
     }
     return nullptr;
 }
+int SystemWindow::memberIndexForRow(int groupIndex, int row) const
+{
+    // 列表行号换算为组内位置（列表只显示符合筛选条件的队员）
+    if (groupIndex < 1 || groupIndex > groupPages.size()) return -1;
+    return groupPages[groupIndex - 1].model->positionAt(row);
+}
+void SystemWindow::onAddGroupButtonClicked()
+{
+    //添加组别按钮点击事件：在末尾增加一个空组
+    const int count = flagGroup.groupCount();
+    if (count >= Flag_group::MAX_GROUP_COUNT) {
+        QMessageBox::warning(this, "错误", QString("组别最多为 %1 个").arg(Flag_group::MAX_GROUP_COUNT));
+        return;
+    }
+    if (!flagGroup.setGroupCount(count + 1)) {
+        return;
+    }
+    syncGroupPages();
+    ui->teammates_toolBox->setCurrentIndex(count); // 切换到新组的页面
+    // 组数已更改
+    markDataChanged();
+}
+void SystemWindow::onAddLocationButtonClicked()
+{
+    //添加地点按钮点击事件：在末尾增加一个执勤地点，之后的排班、空闲时间与导入导出都包含该地点
+    const int count = flagGroup.locationCount();
+    if (count >= Person::MAX_LOCATION_COUNT) {
+        QMessageBox::warning(this, "错误", QString("执勤地点最多为 %1 个").arg(Person::MAX_LOCATION_COUNT));
+        return;
+    }
+    if (QMessageBox::question(this, "添加地点", QString("添加执勤地点“%1”？新地点的空闲时间请在“批量编辑空闲时间”中填写，添加后不能删除。")
+                              .arg(Flag_group::locationTitle(count))) != QMessageBox::Yes) {
+        return;
+    }
+    if (!flagGroup.setLocationCount(count + 1)) {
+        return;
+    }
+    // 已显示的排班结果（可以导出）仍是原来的地点数，重新排表后才会包含新地点；尚未排班时空表按新的地点数显示
+    if (!ui->deriveButton->isEnabled()) {
+        scheduleModel->setLocationCount(flagGroup.locationCount());
+    }
+    // 地点数已更改
+    markDataChanged();
+}
+void SystemWindow::syncGroupPages()
+{
+    // 按名单的组数增删工具栏页面：添加组别后增加，恢复历史记录、读取文件后可能增加或减少
+    const int count = flagGroup.groupCount();
+    while (groupPages.size() > count) {
+        GroupPage page = groupPages.takeLast();
+        ui->teammates_toolBox->removeItem(ui->teammates_toolBox->indexOf(page.page));
+        page.page->deleteLater();
+    }
+    while (groupPages.size() < count) {
+        groupPages.append(createGroupPage(groupPages.size() + 1));
+    }
+    // 组别下拉框的选项与页面一一对应，增删选项时不触发组别修改事件
+    {
+        const QSignalBlocker blocker(ui->group_combobox);
+        while (ui->group_combobox->count() > count) {
+            ui->group_combobox->removeItem(ui->group_combobox->count() - 1);
+        }
+        while (ui->group_combobox->count() < count) {
+            ui->group_combobox->addItem(Flag_group::groupTitle(ui->group_combobox->count() + 1));
+        }
+    }
+    updateAllListViews();
+}
+SystemWindow::GroupPage SystemWindow::createGroupPage(int groupIndex)
+{
+    // 页面内容：添加 / 删除组员按钮、全组是否值周按钮（默认被选中）、组员标签列表
+    const QString title = Flag_group::groupTitle(groupIndex);
+    GroupPage page;
+    page.page = new QWidget(ui->teammates_toolBox);
+    QVBoxLayout* layout = new QVBoxLayout(page.page);
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    QPushButton* addButton = new QPushButton("添加组员", page.page);
+    QPushButton* deleteButton = new QPushButton("删除组员", page.page);
+    buttonLayout->addWidget(addButton);
+    buttonLayout->addWidget(deleteButton);
+    layout->addLayout(buttonLayout);
+    page.isWork = new QRadioButton(title + "是否值周", page.page);
+    page.isWork->setChecked(true);
+    layout->addWidget(page.isWork);
+    QGroupBox* info = new QGroupBox("组员信息", page.page);
+    QVBoxLayout* infoLayout = new QVBoxLayout(info);
+    page.listView = new QListView(info);
+    page.model = new RosterListModel(flagGroup, groupIndex, page.listView);
+    page.listView->setModel(page.model);
+    page.listView->setEditTriggers(QAbstractItemView::NoEditTriggers); // 禁用所有编辑触发，但保留点击功能
+    page.listView->setSelectionMode(QAbstractItemView::SingleSelection);
+    page.listView->setUniformItemSizes(true); // 各行等高，大组滚动时不必逐行计算高度
+    infoLayout->addWidget(page.listView);
+    layout->addWidget(info);
+    ui->teammates_toolBox->addItem(page.page, title);
+
+    // 连接该组的信号与槽
+    connect(addButton, &QPushButton::clicked, this, [this, groupIndex]() { onGroupAddButtonClicked(groupIndex); });
+    connect(deleteButton, &QPushButton::clicked, this, [this, groupIndex]() { onGroupDeleteButtonClicked(groupIndex); });
+    connect(page.isWork, &QRadioButton::clicked, this, [this, groupIndex]() { onGroupIsWorkRadioButtonClicked(groupIndex); });
+    connect(page.listView, &QListView::clicked, this, [this, groupIndex](const QModelIndex &index) { onListViewItemClicked(index, groupIndex); });
+    return page;
+}
 void SystemWindow::onInfoLineEditChanged()
 {
     // 信息修改后更新 Flag_group 中队员的信息,不包括点击队员标签时显示队员信息时造成的修改
@@ -1198,7 +1158,7 @@ void SystemWindow::onGroupComboBoxChanged(int newGroupIndex)
         return;
     }
     
-    int oldGroupIndex = currentSelectedPerson->getGroup();//值为1~4
+    int oldGroupIndex = currentSelectedPerson->getGroup();//值为1~组数
     
     // 规避并未修改组别引发多余操作
     if((oldGroupIndex - 1) == newGroupIndex) {
@@ -1208,7 +1168,7 @@ void SystemWindow::onGroupComboBoxChanged(int newGroupIndex)
     newGroupIndex += 1; // combobox 索引从 0 开始，组索引从 1 开始
     
     // 检查新组号是否有效
-    if (newGroupIndex < 1 || newGroupIndex > 4) {
+    if (!flagGroup.isValidGroup(newGroupIndex) || newGroupIndex > groupPages.size()) {
         QMessageBox::warning(this, "错误", "无效的组别");
         // 恢复原来的组别显示
         ui->group_combobox->setCurrentIndex(oldGroupIndex - 1);
@@ -1229,35 +1189,18 @@ void SystemWindow::onGroupComboBoxChanged(int newGroupIndex)
         }
     }
     
-    // 创建当前队员的副本，避免指针失效
-    Person personCopy = *currentSelectedPerson;
-    
-    // 更新队员的组别信息
-    personCopy.setGroup(newGroupIndex);
-    
-    bool isChecked = false;
-    switch (newGroupIndex) {
-    case 1: isChecked = ui->group1_iswork_radioButton->isChecked(); break;
-    case 2: isChecked = ui->group2_iswork_radioButton->isChecked(); break;
-    case 3: isChecked = ui->group3_iswork_radioButton->isChecked(); break;
-    case 4: isChecked = ui->group4_iswork_radioButton->isChecked(); break;
-    }
-    personCopy.setIsWork(isChecked);
-    
-    // 先从旧组中删除队员（通过姓名在指定组内删除）
-    flagGroup.removePersonFromGroup(*currentSelectedPerson, oldGroupIndex);
+    bool isChecked = groupPages[newGroupIndex - 1].isWork->isChecked();
     
-    // 将队员添加到新组中（使用更新后的队员信息）
-    flagGroup.addPersonToGroup(personCopy, newGroupIndex);
+    // 从旧组移到新组末尾并设置是否值周（一个撤销步骤，撤销时回到旧组原位置）
+    const int newIndex = undoStack.move(oldGroupIndex, selectedPersonIndex(), newGroupIndex, isChecked);
     
     // 更新两个组的ListView显示
     updateListView(oldGroupIndex);
     updateListView(newGroupIndex);
     
-    // 在新组中查找刚添加的队员，更新当前选中的队员指针
-    Person* person = flagGroup.findPersonInGroup(personCopy, newGroupIndex);
-    if (person) {
-        currentSelectedPerson = person;
+    // 组容器已变化，按新位置更新当前选中的队员指针
+    if (newIndex >= 0) {
+        currentSelectedPerson = &flagGroup.getGroupMembers(newGroupIndex)[newIndex];
     } else {
         // 如果找不到，清空当前选中
         currentSelectedPerson = nullptr;
@@ -1271,40 +1214,49 @@ void SystemWindow::onGroupComboBoxChanged(int newGroupIndex)
 void SystemWindow::updateListView(int groupIndex)
 {
     // 更新队员标签界面
-    qDebug() << "[SystemWindow::updateListView] 更新组" << groupIndex << "的ListView";
+    if (groupIndex < 1 || groupIndex > groupPages.size()) {
+        qDebug() << "[SystemWindow::updateListView] 错误：无效的组别" << groupIndex;
+        return;
+    }
     
-    QListView* listView = nullptr;
-    switch (groupIndex) {
-    case 1: listView = ui->group1_info_listView; break;
-    case 2: listView = ui->group2_info_listView; break;
-    case 3: listView = ui->group3_info_listView; break;
-    case 4: listView = ui->group4_info_listView; break;
+    // 只列出符合筛选框条件的队员（见 rosterIndex.h）
+    rosterIndex.sync();
+    refreshListView(groupIndex, rosterIndex.parse(ui->memberFilter_lineEdit->text()));
+}
+void SystemWindow::updateAllListViews()
+{
+    // 索引只同步一次、筛选条件只解析一次，各组取与本组位图的交集
+    rosterIndex.sync();
+    const RosterBitmap filtered = rosterIndex.parse(ui->memberFilter_lineEdit->text());
+    for (int i = 1; i <= groupPages.size(); ++i) {
+        refreshListView(i, filtered);
     }
-    if (!listView) {
-        qDebug() << "  错误：listView为空";
+}
+void SystemWindow::refreshListView(int groupIndex, const RosterBitmap& filtered)
+{
+    // 模型按新的组内位置只更新变化的行（见 rosterListModel.h）
+    const RosterBitmap matched = filtered & rosterIndex.group(groupIndex);
+    QVector<int> positions;
+    positions.reserve(matched.count());
+    matched.forEach([&](int ordinal) {
+        positions.append(rosterIndex.positionOf(ordinal));
+    });
+    groupPages[groupIndex - 1].model->refresh(positions);
+}
+void SystemWindow::onMemberFilterChanged()
+{
+    // 筛选条件修改后重新列出各组队员，并在状态栏显示符合条件的人数
+    updateAllListViews();
+    const QString filter = ui->memberFilter_lineEdit->text().trimmed();
+    if (filter.isEmpty()) {
+        statusBar()->clearMessage();
         return;
     }
-    
-    const auto& members = flagGroup.getGroupMembers(groupIndex);
-    qDebug() << "  组" << groupIndex << "当前队员数量:" << members.size();
-    
-    QStringList memberNames;
-    for (const auto& member : members) {
-        QString name = QString::fromStdString(member.getName());
-        memberNames << name;
-        qDebug() << "    - " << name << "(组别属性:" << member.getGroup() << ")";
+    int matched = 0;
+    for (const GroupPage& page : groupPages) {
+        matched += page.model->memberCount(); // 含尚未加载到列表的队员
     }
-    
-    // 使用 QStringListModel 替代 QStandardItemModel
-    QStringListModel *model = new QStringListModel();//创建一个 QStringListModel 对象 model，它是 QAbstractItemModel 的子类，专门用于处理字符串列表数据
-    model->setStringList(memberNames);//调用 model 的 setStringList 方法，将 memberNames 列表中的数据设置到模型中。
-    listView->setModel(model);//调用 listView 的 setModel 方法，将 model 设置为 listView 的数据模型。这样，listView 就会显示 model 中的数据，即指定组别的队员姓名。
-    // 关键设置：禁用所有编辑触发，但保留点击功能
-    listView->setEditTriggers(QAbstractItemView::NoEditTriggers);
-    // 可选：设置选择模式，允许点击选择
-    listView->setSelectionMode(QAbstractItemView::SingleSelection);
-    
-    qDebug() << "  ListView更新完成";
+    statusBar()->showMessage(QString("筛选“%1”：共 %2 名队员").arg(filter).arg(matched));
 }
 void SystemWindow::showMemberInfo(const Person &person)
 {
@@ -1342,19 +1294,6 @@ void SystemWindow::updatePersonInfo(const Person &person)
     int all_times = ui->total_times_spinBox->value();
     int njh_all_times = ui->njh_total_times_spinBox->value();
     int dxy_all_times = ui->dxy_total_times_spinBox->value();
-    // 创建新的 Person 对象
-    bool time[4][5];
-    //time 数组保持不变
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 5; ++j) {
-            time[i][j] = person.getTime(i + 1, j + 1);
-        }
-    }
-    Person newPerson(name.toStdString(), gender, person.getGroup(), grade, phone.toStdString(),
-                     nativePlace.toStdString(), native.toStdString(), dorm.toStdString(),
-                     school.toStdString(), classname.toStdString(), birthday.toStdString(), person.getIsWork(),
-                     time, person.getTimes(), all_times, njh_all_times, dxy_all_times);
-    
     // 如果修改了姓名，需要检查同组内是否有重名
     if (name.toStdString() != person.getName()) {
         const auto& members = flagGroup.getGroupMembers(person.getGroup());
@@ -1374,17 +1313,31 @@ void SystemWindow::updatePersonInfo(const Person &person)
         }
     }
     
-    // 更新 flagGroup 中对应队员的信息
-    flagGroup.modifyPersonInGroup(person, newPerson, person.getGroup());
-    // 更新对应组的 ListView 显示
-    updateListView(person.getGroup());
-    
-    // 更新当前选中的队员指针（因为姓名可能已改变，需要重新查找）
-    Person* updatedPerson = flagGroup.findPersonInGroup(newPerson, person.getGroup());
-    if (updatedPerson) {
-        currentSelectedPerson = updatedPerson;
+    // 逐字段写入（可撤销，本次编辑为一个撤销步骤）：只有实际变化的字段会被记录并标记修改
+    const int groupIndex = person.getGroup();
+    const int index = selectedPersonIndex();
+    if (index < 0) {
+        return;
+    }
+    undoStack.begin("修改队员信息");
+    const bool renamed = undoStack.rename(groupIndex, index, name.toStdString());
+    undoStack.setField(groupIndex, index, MemberFields::Gender, gender ? "女" : "男");
+    undoStack.setField(groupIndex, index, MemberFields::Grade, QString::number(grade));
+    undoStack.setField(groupIndex, index, MemberFields::Phone, phone);
+    undoStack.setField(groupIndex, index, MemberFields::NativePlace, nativePlace);
+    undoStack.setField(groupIndex, index, MemberFields::Native, native);
+    undoStack.setField(groupIndex, index, MemberFields::Dorm, dorm);
+    undoStack.setField(groupIndex, index, MemberFields::School, school);
+    undoStack.setField(groupIndex, index, MemberFields::Classname, classname);
+    undoStack.setField(groupIndex, index, MemberFields::Birthday, birthday);
+    undoStack.setField(groupIndex, index, MemberFields::AllTimes, QString::number(all_times));
+    undoStack.setField(groupIndex, index, MemberFields::NJHAllTimes, QString::number(njh_all_times));
+    undoStack.setField(groupIndex, index, MemberFields::DXYAllTimes, QString::number(dxy_all_times));
+    undoStack.commit();
+    // 队员标签只显示姓名，改名时才需要刷新对应组的 ListView
+    if (renamed) {
+        updateListView(groupIndex);
     }
-
 }
 void SystemWindow::updateAttendanceButtons(const Person &person)
 {
@@ -1469,7 +1422,7 @@ void SystemWindow::onAttendanceButtonClicked(QAbstractButton *button)
     if (it != buttonToTimeMap.end()) {
         int row = it.value().first;
         int column = it.value().second;
-        currentSelectedPerson->setTime(row, column, button->isChecked());
+        undoStack.setField(groupIndex, selectedPersonIndex(), MemberFields::timeSlot(row, column), button->isChecked() ? "1" : "0");
         // 出勤时间更改
         markDataChanged();
     }
@@ -1512,16 +1465,21 @@ void SystemWindow::onAllSelectButtonClicked()
         {ui->friday_down_NJH_pushButton, {3, 5}},
         {ui->friday_down_DXY_pushButton, {4, 5}}
     };
+    // 同一天的时间点一起修改，为一个撤销步骤
+    const int groupIndex = currentSelectedPerson->getGroup();
+    const int index = selectedPersonIndex();
+    undoStack.begin("全选");
     for (QAbstractButton* button : childButtons) {
         if (button != senderButton) {
             auto it = buttonToTimeMap.find(button);
             if (it != buttonToTimeMap.end()) {
                 int row = it.value().first;
                 int column = it.value().second;
-                currentSelectedPerson->setTime(row, column, true);
+                undoStack.setField(groupIndex, index, MemberFields::timeSlot(row, column), "1");
             }
         }
     }
+    undoStack.commit();
     // 全选更改出勤时间
     markDataChanged();
 }
@@ -1534,280 +1492,263 @@ void SystemWindow::onImportTimeButtonClicked()
         return;
     }
 
-    int successCount = 0;
-    int failCount = 0;
-
-    // 根据文件扩展名判断文件类型
+    // 根据文件扩展名判断文件类型；两种文件都交给同一个导入引擎（见 csvImport.h）校验后一次性写入名单
     QString suffix = QFileInfo(filePath).suffix().toLower();
+    // 导入可能新增队员，组容器扩容后原指针失效，先记下当前选中的队员
+    const Person selected = currentSelectedPerson ? *currentSelectedPerson : Person();
+    const int selectedGroup = currentSelectedPerson ? currentSelectedPerson->getGroup() : 0;
+    AvailabilityImport::Report report;
     
     if (suffix == "csv") {
-        // 处理CSV文件
-        QFile file(filePath);
-        if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
-            QMessageBox::warning(this, "错误", "无法打开文件：" + filePath);
-            return;
-        }
-
-        QTextStream in(&file);
-#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
-        in.setCodec("UTF-8");
-#endif
-
-        // 跳过表头
-        if (!in.atEnd()) {
-            in.readLine();
-        }
-
-        // 读取数据
-        while (!in.atEnd()) {
-            QString line = in.readLine();
-            if (line.isEmpty()) continue;
-
-            QStringList parts = line.split(",");
-            if (parts.size() < 22) { // 姓名+组别+20个时间点
-                failCount++;
-                continue;
-            }
-
-            QString name = parts[0];
-            int group = parts[1].toInt();
-            if (group < 1 || group > 4) {
-                failCount++;
-                continue;
-            }
-
-            // 查找对应的队员
-            bool found = false;
-            auto& members = flagGroup.getGroupMembers(group);
-            for (auto& member : members) {
-                if (QString::fromStdString(member.getName()) == name) {
-                    // 读取时间安排
-                    bool time[4][5];
-                    for (int row = 0; row < 4; ++row) {
-                        for (int col = 0; col < 5; ++col) {
-                            int index = 2 + row * 5 + col;
-                            if (index < parts.size()) {
-                                time[row][col] = (parts[index].toInt() == 1);
-                            } else {
-                                time[row][col] = false;
-                            }
-                        }
-                    }
-                    member.setTime(time);
-                    found = true;
-                    successCount++;
-                    break;
-                }
-            }
-            if (!found) {
-                failCount++;
-            }
-        }
-
-        file.close();
-    } else if (suffix == "xlsx" || suffix == "xls") {
-        // 检查文件是否被占用
-        QFile testFile(filePath);
-        if (!testFile.open(QIODevice::ReadOnly)) {
-            QMessageBox::warning(this, "文件被占用", 
-                QString("文件 \"%1\" 可能正在被其他程序使用（如Excel）。\n\n请先关闭该文件，然后重试。").arg(QFileInfo(filePath).fileName()));
+        if (!AvailabilityImport::importCsv(filePath, undoStack, report, isAdminMode)) {
+            QMessageBox::warning(this, "错误", "无法读取文件：" + filePath + "\n\n请确认文件未被占用，且字段中的引号成对出现。");
             return;
         }
-        testFile.close();
-        
-        // 处理Excel文件 - 显示进度提示
-        QProgressDialog *importProgress = new QProgressDialog(this);
-        importProgress->setWindowModality(Qt::ApplicationModal);
-        importProgress->setWindowFlags(importProgress->windowFlags() | Qt::WindowStaysOnTopHint);
-        importProgress->setCancelButton(nullptr);
-        importProgress->setMinimumDuration(0);
-        importProgress->setWindowTitle("导入进度");
-        importProgress->setLabelText("正在导入Excel文件，请稍候...");
-        importProgress->setRange(0, 0); // 不确定进度模式
-        importProgress->show();
-        QApplication::processEvents();
-
-        QAxObject *excel = new QAxObject("Excel.Application");
-        if (!excel || excel->isNull()) {
-            delete importProgress;
-            QMessageBox::warning(this, "错误", "无法启动Excel应用程序。请确保已安装Microsoft Excel。");
-            if (excel) delete excel;
+    } else if (suffix == "xlsx") {
+        // 直接解析 .xlsx 文件（见 xlsxReader.h），不再通过 COM 逐个单元格读取，无需安装 Excel
+        XlsxReader reader;
+        if (!reader.open(filePath)) {
+            QMessageBox::warning(this, "错误", "无法读取Excel文件：" + filePath + "\n\n" + reader.errorString());
             return;
         }
-        
-        // 设置Excel不显示警告对话框，避免卡死
-        excel->dynamicCall("SetDisplayAlerts(bool)", false);
-
-        importProgress->setLabelText("正在连接Excel...");
-        QApplication::processEvents();
-
-        // 设置 Excel 应用程序不可见
-        excel->dynamicCall("SetVisible(bool)", false);
-        // 获取 Excel 应用程序的工作簿集合
-        importProgress->setLabelText("正在打开Excel文件...");
-        QApplication::processEvents();
-        
-        QAxObject *workbooks = excel->querySubObject("Workbooks");
-        if (!workbooks || workbooks->isNull()) {
-            delete importProgress;
-            excel->dynamicCall("Quit()");
-            delete excel;
-            QMessageBox::warning(this, "错误", "无法访问Excel工作簿集合。");
-            return;
-        }
-
-        // 打开Excel文件（ReadOnly模式，避免文件被占用）
-        QVariant openResult = workbooks->dynamicCall("Open(const QString&, bool)", QDir::toNativeSeparators(filePath), true);
-        QAxObject *workbook = excel->querySubObject("ActiveWorkbook");
-        if (!workbook || workbook->isNull()) {
-            delete importProgress;
-            excel->dynamicCall("SetDisplayAlerts(bool)", true);
-            excel->dynamicCall("Quit()");
-            delete excel;
-            QMessageBox::warning(this, "错误", "无法打开Excel文件：" + filePath + "\n\n文件可能被其他程序占用，请先关闭该文件。");
+        // 第一行是表头，之后每行为一名队员
+        AvailabilityImport import(isAdminMode);
+        bool headerRead = false;
+        const bool read = reader.readRows([&](int row, const QStringList& values) {
+            if (!headerRead) {
+                import.setHeader(values, report);
+                headerRead = true;
+            } else {
+                import.addRow(row, values, report);
+            }
+            return true;
+        });
+        if (!read) {
+            QMessageBox::warning(this, "错误", "读取工作表时发生错误：" + reader.errorString());
             return;
         }
+        import.apply(undoStack, report);
+    } else if (suffix == "xls") {
+        QMessageBox::warning(this, "错误", "不支持旧版 .xls 文件，请在Excel中另存为 .xlsx 或 .csv 后再导入。");
+        return;
+    } else {
+        QMessageBox::warning(this, "错误", "不支持的文件格式：" + suffix);
+        return;
+    }
 
-        importProgress->setLabelText("正在读取工作表数据...");
-        QApplication::processEvents();
-
-        // 获取第一个工作表
-        QAxObject *worksheet = workbook->querySubObject("Worksheets(int)", 1);
-        if (!worksheet || worksheet->isNull()) {
-            delete importProgress;
-            workbook->dynamicCall("Close(bool)", false);
-            excel->dynamicCall("Quit()");
-            delete excel;
-            QMessageBox::warning(this, "错误", "无法访问工作表。");
-            return;
-        }
+    // 更新当前显示的队员信息
+    if (currentSelectedPerson) {
+        currentSelectedPerson = flagGroup.findPersonInGroup(selected, selectedGroup);
+        if (currentSelectedPerson) updateAttendanceButtons(*currentSelectedPerson);
+    }
 
-        // 获取已使用的范围
-        QAxObject *usedRange = worksheet->querySubObject("UsedRange");
-        if (!usedRange || usedRange->isNull()) {
-            delete importProgress;
-            delete worksheet;
-            workbook->dynamicCall("Close(bool)", false);
-            excel->dynamicCall("Quit()");
-            delete excel;
-            QMessageBox::warning(this, "错误", "工作表为空或无法读取。");
-            return;
-        }
+    // 更新所有组的ListView
+    updateAllListViews();
 
-        // 获取行数和列数
-        QAxObject *rows = usedRange->querySubObject("Rows");
-        QAxObject *columns = usedRange->querySubObject("Columns");
-        int rowCount = rows ? rows->property("Count").toInt() : 0;
+    const int successCount = report.updated + report.added;
+    QString message = QString("导入完成！\n成功：%1 条").arg(successCount);
+    if (report.added > 0) message += QString("（其中新增队员 %1 名）").arg(report.added);
+    message += QString("\n失败：%1 条").arg(report.errors.size());
+    // 逐行列出失败原因（过多时只列出前20条）
+    for (int k = 0; k < report.errors.size() && k < 20; ++k) {
+        message += QString("\n第 %1 行：%2").arg(report.errors.at(k).line).arg(report.errors.at(k).message);
+    }
+    if (report.errors.size() > 20) message += QString("\n……其余 %1 条略").arg(report.errors.size() - 20);
+    if (!report.ignoredColumns.isEmpty()) {
+        message += "\n\n以下列需要管理员权限，已忽略：" + report.ignoredColumns.join("、");
+    }
+    QMessageBox::information(this, "导入结果", message);
+    // 全部修改已一次性写入名单，只需通知一次
+    if (successCount > 0) {
+        markDataChanged();
+    }
+}
 
-        // 设置进度条范围（如果有数据行）
-        if (rowCount > 1) {
-            importProgress->setRange(0, rowCount - 1); // 减去表头行
-            importProgress->setValue(0);
-        }
+// 批量导入队员：文件在工作线程中读取、校验并与名单快照比对，确认后一次性写入名单
+void SystemWindow::onImportRosterButtonClicked()
+{
+    QString filePath = QFileDialog::getOpenFileName(this, "批量导入队员", "",
+        "支持的文件 (*.csv *.json);;CSV 文件 (*.csv);;JSON 文件 (*.json)");
+    if (filePath.isEmpty()) {
+        return;
+    }
 
-        // 从第二行开始读取数据（第一行是表头）
-        for (int row = 2; row <= rowCount; ++row) {
-            // 更新进度提示
-            int progress = row - 2; // 当前处理的行数（从0开始）
-            importProgress->setValue(progress);
-            importProgress->setLabelText(QString("正在导入第 %1/%2 条数据...").arg(progress + 1).arg(rowCount - 1));
-            QApplication::processEvents();
-
-            // 读取姓名（第1列，索引为1）
-            QAxObject *nameCell = worksheet->querySubObject("Cells(int,int)", row, 1);
-            QString name = nameCell ? nameCell->property("Value").toString() : "";
-            if (nameCell) delete nameCell;
-
-            // 读取组别（第2列，索引为2）
-            QAxObject *groupCell = worksheet->querySubObject("Cells(int,int)", row, 2);
-            int group = groupCell ? groupCell->property("Value").toInt() : 0;
-            if (groupCell) delete groupCell;
-
-            if (name.isEmpty() || group < 1 || group > 4) {
-                failCount++;
-                continue;
+    // 快照在界面线程生成（写时复制，不复制字符串），工作线程只读快照，不访问名单本身
+    const RosterSnapshot snapshot = RosterSnapshot::capture(flagGroup);
+    const bool includeCounts = isAdminMode;
+    ui->importRoster_pushButton->setEnabled(false);
+    statusBar()->showMessage("正在读取队员名单文件……");
+    // 工作线程不持有窗口指针：结果排队回到界面线程后再检查窗口是否仍然存在（读取期间窗口可能已被关闭）
+    const QPointer<SystemWindow> window(this);
+    QThreadPool::globalInstance()->start([window, filePath, snapshot, includeCounts]() {
+        const RosterBulkIO::Plan plan = RosterBulkIO::prepare(filePath, snapshot, includeCounts);
+        QMetaObject::invokeMethod(qApp, [window, plan]() {
+            if (window) {
+                window->finishRosterImport(plan);
             }
+        }, Qt::QueuedConnection);
+    });
+}
 
-            // 读取时间安排（第3列到第22列，共20个时间点）
-            bool time[4][5];
-            bool hasValidData = false;
-            for (int col = 3; col <= 22; ++col) {
-                QAxObject *timeCell = worksheet->querySubObject("Cells(int,int)", row, col);
-                QVariant cellValue = timeCell ? timeCell->property("Value") : QVariant(0);
-                int timeValue = cellValue.toInt();
-                if (timeCell) delete timeCell;
-
-                int timeIndex = col - 3; // 0-19
-                int rowIndex = timeIndex / 5; // 0-3
-                int colIndex = timeIndex % 5; // 0-4
-                time[rowIndex][colIndex] = (timeValue == 1);
-                if (timeValue == 0 || timeValue == 1) {
-                    hasValidData = true;
-                }
-            }
+void SystemWindow::finishRosterImport(const RosterBulkIO::Plan& plan)
+{
+    ui->importRoster_pushButton->setEnabled(true);
+    statusBar()->clearMessage();
+    if (!plan.ok) {
+        QMessageBox::warning(this, "错误", "无法导入队员名单：" + plan.error);
+        return;
+    }
 
-            if (!hasValidData) {
-                failCount++;
-                continue;
-            }
+    QString message = QString("新增队员：%1 名\n更新队员：%2 名\n无变化：%3 名\n错误：%4 条")
+        .arg(plan.added).arg(plan.updated).arg(plan.unchanged).arg(plan.issues.size());
+    // 逐行列出错误（过多时只列出前20条），有错误的行不会导入
+    for (int k = 0; k < plan.issues.size() && k < 20; ++k) {
+        message += QString("\n第 %1 条：%2").arg(plan.issues.at(k).line).arg(plan.issues.at(k).message);
+    }
+    if (plan.issues.size() > 20) message += QString("\n……其余 %1 条略").arg(plan.issues.size() - 20);
+    if (!plan.ignoredColumns.isEmpty()) {
+        message += "\n\n以下字段需要管理员权限，已忽略：" + plan.ignoredColumns.join("、");
+    }
+    if (!plan.extraLocationColumns.isEmpty()) {
+        message += "\n\n名单中没有以下时间点的地点，已忽略：" + plan.extraLocationColumns.join("、");
+    }
+    if (plan.entries.isEmpty()) {
+        QMessageBox::information(this, "导入结果", "没有需要修改的队员。\n\n" + message);
+        return;
+    }
+    if (QMessageBox::question(this, "确认导入", message + "\n\n是否写入名单？",
+            QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes) != QMessageBox::Yes) {
+        return;
+    }
 
-            // 查找对应的队员
-            bool found = false;
-            auto& members = flagGroup.getGroupMembers(group);
-            for (auto& member : members) {
-                if (QString::fromStdString(member.getName()) == name) {
-                    member.setTime(time);
-                    found = true;
-                    successCount++;
-                    break;
-                }
-            }
-            if (!found) {
-                failCount++;
-            }
+    // 新增队员会使组容器扩容、原指针失效，先记下当前选中的队员
+    const Person selected = currentSelectedPerson ? *currentSelectedPerson : Person();
+    const int selectedGroup = currentSelectedPerson ? currentSelectedPerson->getGroup() : 0;
+    const QVector<int> groups = RosterBulkIO::apply(plan, undoStack);
+    if (currentSelectedPerson) {
+        currentSelectedPerson = flagGroup.findPersonInGroup(selected, selectedGroup);
+        if (currentSelectedPerson) {
+            isShowingInfo = true; // 刷新显示不触发修改事件
+            showMemberInfo(*currentSelectedPerson);
+            updateAttendanceButtons(*currentSelectedPerson);
+            isShowingInfo = false;
         }
+    }
+    // 每个涉及的组只刷新一次，整个导入只通知一次修改
+    for (int group : groups) {
+        updateListView(group);
+    }
+    markDataChanged();
+}
 
-        importProgress->setLabelText("正在完成导入...");
-        QApplication::processEvents();
-
-        // 清理资源
-        importProgress->setLabelText("正在关闭Excel文件...");
-        QApplication::processEvents();
-        
-        if (rows) delete rows;
-        if (columns) delete columns;
-        delete usedRange;
-        delete worksheet;
-        workbook->dynamicCall("Close(bool)", false); // 不保存更改
-        delete workbook;
-        excel->dynamicCall("SetDisplayAlerts(bool)", true); // 恢复警告显示
-        excel->dynamicCall("Quit()");
-        delete excel;
-        
-        // 关闭进度对话框
-        importProgress->close();
-        delete importProgress;
-    } else {
-        QMessageBox::warning(this, "错误", "不支持的文件格式：" + suffix);
+// 导出队员名单：按文件扩展名选择 CSV 或 JSON，直接由名单逐人写出
+void SystemWindow::onExportRosterButtonClicked()
+{
+    QString filePath = QFileDialog::getSaveFileName(this, "导出队员名单", "队员名单.csv",
+        "CSV 文件 (*.csv);;JSON 文件 (*.json)");
+    if (filePath.isEmpty()) {
         return;
     }
+    // 筛选框有内容时询问是否只导出筛选出的队员
+    const QString filter = ui->memberFilter_lineEdit->text().trimmed();
+    RosterBitmap selection;
+    bool filtered = false;
+    if (!filter.isEmpty()) {
+        rosterIndex.sync();
+        selection = rosterIndex.parse(filter);
+        QMessageBox::StandardButton reply = QMessageBox::question(this, "导出队员名单",
+            QString("当前筛选“%1”共 %2 名队员，是否只导出筛选结果？\n\n选择“否”导出全部队员。").arg(filter).arg(selection.count()),
+            QMessageBox::Yes | QMessageBox::No | QMessageBox::Cancel);
+        if (reply == QMessageBox::Cancel) {
+            return;
+        }
+        filtered = reply == QMessageBox::Yes;
+    }
+    if (RosterBulkIO::exportRoster(flagGroup, filePath, RosterBulkIO::formatFor(filePath), filtered ? &selection : nullptr)) {
+        QMessageBox::information(this, "导出成功", "队员名单已导出到：" + filePath);
+    } else {
+        QMessageBox::warning(this, "错误", "无法写入文件：" + filePath + "\n\n请确认文件未被其他程序占用。");
+    }
+}
 
-    // 更新当前显示的队员信息
+void SystemWindow::onAvailabilityMatrixButtonClicked()
+{
+    // 批量编辑空闲时间：列出筛选框选中的队员（筛选框为空时为全部队员），确定后作为一个撤销步骤写入名单
+    rosterIndex.sync();
+    QVector<QPair<int, int>> members;
+    rosterIndex.parse(ui->memberFilter_lineEdit->text()).forEach([&](int ordinal) {
+        members.append(qMakePair(rosterIndex.groupOf(ordinal), rosterIndex.positionOf(ordinal)));
+    });
+    if (members.isEmpty()) {
+        QMessageBox::information(this, "提示", "没有可以编辑的队员");
+        return;
+    }
+    AvailabilityMatrixDialog dialog(flagGroup, members, this);
+    if (dialog.exec() != QDialog::Accepted) {
+        return;
+    }
+    const int changed = dialog.apply(undoStack);
+    if (changed == 0) {
+        return;
+    }
+    // 刷新当前选中队员的执勤按钮（修改空闲时间不改变名单结构，指针仍然有效）
     if (currentSelectedPerson) {
+        isShowingInfo = true;
         updateAttendanceButtons(*currentSelectedPerson);
+        isShowingInfo = false;
+    }
+    // 空闲时间可能影响筛选结果
+    if (!ui->memberFilter_lineEdit->text().trimmed().isEmpty()) {
+        onMemberFilterChanged();
     }
+    statusBar()->showMessage(QString("已修改 %1 名队员的空闲时间").arg(changed), 3000);
+    markDataChanged();
+}
 
-    // 更新所有组的ListView
-    for (int i = 1; i <= 4; ++i) {
-        updateListView(i);
+// 当前选中队员在其组内的位置
+int SystemWindow::selectedPersonIndex() const
+{
+    if (!currentSelectedPerson) {
+        return -1;
+    }
+    const auto& members = flagGroup.getGroupMembers(currentSelectedPerson->getGroup());
+    const std::ptrdiff_t index = currentSelectedPerson - members.data();
+    if (index < 0 || index >= static_cast<std::ptrdiff_t>(members.size())) {
+        return -1;
     }
+    return static_cast<int>(index);
+}
 
-    QString message = QString("导入完成！\n成功：%1 条\n失败：%2 条").arg(successCount).arg(failCount);
-    QMessageBox::information(this, "导入结果", message);
-    // 若有成功导入的数据，则认为数据已更改
-    if (successCount > 0) {
-        markDataChanged();
+// 撤销 / 重做上一步名单修改（Ctrl+Z / Ctrl+Y）
+void SystemWindow::undoRosterChange(bool redo)
+{
+    if (redo ? !undoStack.canRedo() : !undoStack.canUndo()) {
+        statusBar()->showMessage(redo ? "没有可以重做的修改" : "没有可以撤销的修改", 3000);
+        return;
     }
+    // 撤销可能增删队员、使组容器中的指针失效，先记下当前选中的队员
+    const Person selected = currentSelectedPerson ? *currentSelectedPerson : Person();
+    const int selectedGroup = currentSelectedPerson ? currentSelectedPerson->getGroup() : 0;
+    currentSelectedPerson = nullptr;
+
+    const RosterUndoStack::Change change = redo ? undoStack.redo() : undoStack.undo();
+    // 只刷新涉及的组
+    for (int group : change.groups) {
+        updateListView(group);
+    }
+    if (selectedGroup > 0) {
+        currentSelectedPerson = flagGroup.findPersonInGroup(selected, selectedGroup);
+    }
+    if (currentSelectedPerson) {
+        isShowingInfo = true;
+        showMemberInfo(*currentSelectedPerson);
+        updateAttendanceButtons(*currentSelectedPerson);
+        isShowingInfo = false;
+    } else if (selectedGroup > 0) {
+        clearMemberInfoDisplay(); // 选中的队员已被撤销（或改名）
+    }
+    statusBar()->showMessage((redo ? "已重做：" : "已撤销：") + change.label, 3000);
+    markDataChanged();
 }
 
 // 全部可用
@@ -1818,14 +1759,8 @@ void SystemWindow::onSetAllAvailableButtonClicked()
         return;
     }
 
-    // 设置所有时间为可用
-    bool time[4][5];
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 5; ++j) {
-            time[i][j] = true;
-        }
-    }
-    currentSelectedPerson->setTime(time);
+    // 设置所有时间为可用（名单全部地点的时间点置位）
+    undoStack.setTimeMask(currentSelectedPerson->getGroup(), selectedPersonIndex(), Person::locationsMask(flagGroup.locationCount()));
 
     // 更新UI显示
     updateAttendanceButtons(*currentSelectedPerson);
@@ -1843,13 +1778,7 @@ void SystemWindow::onSetAllUnavailableButtonClicked()
     }
 
     // 设置所有时间为不可用
-    bool time[4][5];
-    for (int i = 0; i < 4; ++i) {
-        for (int j = 0; j < 5; ++j) {
-            time[i][j] = false;
-        }
-    }
-    currentSelectedPerson->setTime(time);
+    undoStack.setTimeMask(currentSelectedPerson->getGroup(), selectedPersonIndex(), 0);
 
     // 更新UI显示
     updateAttendanceButtons(*currentSelectedPerson);
@@ -1865,6 +1794,58 @@ void SystemWindow::onImportTimeFromTaskButtonClicked()
     onImportTimeButtonClicked();
 }
 
+// 检查数据文件：只核对文件头与每条记录的 CRC32C（见 recordFraming.h），不解码队员信息与历史内容，不修改任何文件
+void SystemWindow::onCheckDataFilesButtonClicked()
+{
+    const QString dataDir = QFileInfo(filename).absolutePath();
+    struct DataFile {
+        QString title;
+        QString path;
+        bool history;
+    };
+    const QVector<DataFile> files = {
+        {"队员数据", dataDir + "/data.dat", false},
+        {"排表历史", dataDir + "/schedule_history.dat", true}
+    };
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QStringList lines;
+    bool damaged = false;
+    for (const DataFile& file : files) {
+        const QString name = QFileInfo(file.path).fileName();
+        if (!QFile::exists(file.path)) {
+            lines << QString("%1（%2）：文件不存在").arg(file.title, name);
+            continue;
+        }
+        QStringList problems;
+        const int records = file.history ? ScheduleHistoryManager::verifyFile(file.path, &problems)
+                                         : EncryptedFileManager::verifyFile(file.path, &problems);
+        if (records < 0) {
+            damaged = damaged || !problems.isEmpty();
+            lines << QString("%1（%2）：%3").arg(file.title, name,
+                problems.isEmpty() ? "文件格式较旧，无法快速校验（读取时仍会逐条检查）" : "无法校验，文件可能已损坏");
+        } else {
+            lines << QString("%1（%2）：%3 条记录校验通过").arg(file.title, name).arg(records);
+        }
+        for (const QString& problem : problems) {
+            damaged = true;
+            lines << "    " + problem;
+            qDebug() << "数据文件校验：" << file.path << problem;
+        }
+    }
+    QApplication::restoreOverrideCursor();
+    if (!dynamic_cast<FileRosterStorage*>(storage.get())) {
+        lines << QString("当前名单保存在%1中，data.dat 为启用数据库之前的名单").arg(storage->backendName());
+    }
+
+    if (damaged) {
+        QMessageBox::warning(this, "检查数据文件", lines.join('\n')
+            + "\n\n损坏的记录在读取时会被跳过。建议先复制 data 文件夹备份，再保存一次数据以重写文件。");
+    } else {
+        QMessageBox::information(this, "检查数据文件", lines.join('\n'));
+    }
+}
+
 // 管理员权限相关函数实现
 void SystemWindow::onAdminLoginClicked()
 {
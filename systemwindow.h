@@ -8,9 +8,19 @@
 #include "dataFunction.h"
 #include "qabstractbutton.h"
 #include <QFutureWatcher>
-#include <QProgressDialog>
 #include "scheduleHistory.h"
 #include "historyDialog.h"
+#include "autosaveService.h"
+#include "rosterBulkIO.h"
+#include "rosterUndoStack.h"
+#include "rosterListModel.h"
+#include "scheduleTableModel.h"
+#include "rosterStorage.h"
+#include "mappedRoster.h"
+#include <memory>
+
+class QListView;
+class QRadioButton;
 
 
 QT_BEGIN_NAMESPACE
@@ -36,17 +46,21 @@ private slots:
     void onRestoreScheduleButtonClicked(); // 恢复排班按钮点击事件
     void onExportButtonClicked(); // 导出表格按钮点击事件
     void onImportTimeFromTaskButtonClicked(); // 导入空闲时间按钮点击事件（表格管理界面）
+    void onCheckDataFilesButtonClicked(); // 检查数据文件按钮点击事件
 
     // 制表警告
     void handleSchedulingWarning(const QString& warningMessage); // 排表过程中发送警告信息的对应处理函数
 
     // 队员管理界面槽函数
     // 组员管理工具栏
+    void onAddGroupButtonClicked(); // 添加组别按钮点击事件
+    void onAddLocationButtonClicked(); // 添加地点按钮点击事件
     void onGroupAddButtonClicked(int groupIndex); // 添加组员按钮点击事件
     void onGroupDeleteButtonClicked(int groupIndex); // 删除组员按钮点击事件
     void clearMemberInfoDisplay(); // 清空信息显示区
     void onGroupIsWorkRadioButtonClicked(int groupIndex); // 全组是否执勤按钮点击事件
     void onListViewItemClicked(const QModelIndex &index, int groupIndex); // 队员标签点击事件
+    void onMemberFilterChanged(); // 队员筛选框文字修改事件
     // 队员基础信息栏
     void onInfoLineEditChanged(); // 队员基础信息文本框修改事件
     void onGroupComboBoxChanged(int newGroupIndex); // 队员组别信息修改事件
@@ -57,6 +71,9 @@ private slots:
     void onImportTimeButtonClicked(); // 导入空闲时间按钮点击事件
     void onSetAllAvailableButtonClicked(); // 全部可用按钮点击事件
     void onSetAllUnavailableButtonClicked(); // 全部不可用按钮点击事件
+    void onImportRosterButtonClicked(); // 批量导入队员按钮点击事件
+    void onExportRosterButtonClicked(); // 导出队员名单按钮点击事件
+    void onAvailabilityMatrixButtonClicked(); // 批量编辑空闲时间按钮点击事件
     
     // 管理员权限相关槽函数
     void onAdminLoginClicked(); // 管理员登录按钮点击事件
@@ -68,6 +85,7 @@ private slots:
 private:
     Ui::SystemWindow *ui; // ui界面指针
     SchedulingManager *manager; // 国旗班制表管理器指针
+    ScheduleTableModel *scheduleModel = nullptr; // 排班表的表格模型
     Flag_group flagGroup; // 国旗班成员容器变量
     Person* currentSelectedPerson = nullptr; // 保存当前用户选中的队员标签指针
     bool isShowingInfo = false; // 新增标志位，用于区分展示信息造成的文本框信息修改和用户主动填写造成的信息修改
@@ -85,9 +103,20 @@ private:
     int instructionTabClickCount = 0; // 使用说明标签页点击计数
     QTimer* clickTimer = nullptr; // 点击计时器
 
-    QProgressDialog* exportProgress = nullptr; // 进度对话框
-
+    std::unique_ptr<RosterStorageBackend> storage; // 名单存储后端（加密文件或 SQLite 数据库，启动时选择）
+    std::shared_ptr<MappedRoster> mappedRoster; // 已启用的二进制名单文件，整个会话保持映射（名单中尚未修改的组直接读取文件）
     ScheduleHistoryManager historyManager; // 历史记录管理器
+    AutosaveService autosave; // 后台自动保存（崩溃恢复）
+    RosterUndoStack undoStack{flagGroup}; // 名单修改的撤销 / 重做记录，界面对名单的修改都经由它执行
+    RosterIndex rosterIndex{flagGroup}; // 名单位图索引，用于队员筛选框与按筛选结果导出
+    // 队员管理工具栏中一个组别的页面，按名单的组数动态生成
+    struct GroupPage {
+        QWidget* page = nullptr;
+        QRadioButton* isWork = nullptr; // 全组是否值周
+        QListView* listView = nullptr;  // 组员标签
+        RosterListModel* model = nullptr; // 组员标签的模型，记录每一行对应的组内位置（筛选后列表只显示部分队员）
+    };
+    QVector<GroupPage> groupPages; // 下标为组号 - 1
     QString finalText_excel; // 全局变量，用于导出表格时输出统计的表格信息
     
     // 历史记录相关函数
@@ -97,16 +126,23 @@ private:
     // 值周管理操作函数
     void updateTableWidget(const SchedulingManager& manager); // 制表操作，点击制表按钮后的辅助函数
     void updateTextEdit(const SchedulingManager& manager); // 制表结果在文本域中更新，点击制表按钮后的辅助函数
-    void processStep(const QString& stepName, QProgressDialog* progress); // 进度对话框辅助显示函数
     // 队员管理操作函数
+    void syncGroupPages(); // 按名单的组数增删工具栏页面与组别下拉框选项，并刷新各组队员标签
+    GroupPage createGroupPage(int groupIndex); // 生成一个组别的页面并连接信号与槽
     void updateListView(int groupIndex); // 更新队员标签界面
+    void updateAllListViews(); // 更新所有组的队员标签界面（筛选条件只解析一次）
+    void refreshListView(int groupIndex, const RosterBitmap& filtered); // 用已解析的筛选结果更新一个组的队员标签界面
     Person* getSelectedPerson(int groupIndex, const QModelIndex &index); // 捕捉被选中的标签是哪个队员，队员标签点击后的辅助函数
+    int memberIndexForRow(int groupIndex, int row) const; // 列表行号对应的组内位置，无效时返回 -1
     void showMemberInfo(const Person &person); // 根据选中的队员向UI中展示队员基础信息
     void updatePersonInfo(const Person &person); // 从UI中获取更新后的信息，修改flag_group中队员信息，仅更新基础信息部分，执勤安排不调整（根据程序实际设计，队员组别信息修改不在该函数进行）。
     void updateAttendanceButtons(const Person &person); // 根据队员的time数组调整按钮显示的状态
     bool saveDataToFile(); // 保存数据到文件
     void onApplicationAboutToQuit(); // 应用程序即将退出时的处理
     void markDataChanged(); // 标记数据已被修改
+    void finishRosterImport(const RosterBulkIO::Plan& plan); // 批量导入文件校验完成后确认并写入名单（界面线程）
+    int selectedPersonIndex() const; // 当前选中队员在其组内的位置，无选中时返回 -1
+    void undoRosterChange(bool redo); // 撤销（redo 为 true 时重做）上一步名单修改，只刷新涉及的组
     
     // 管理员权限相关函数
     void setAdminMode(bool isAdmin); // 设置管理员模式
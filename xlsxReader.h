@@ -0,0 +1,222 @@
+// xlsxReader.h头文件
+// 功能说明：不依赖 Excel 直接读取 .xlsx 文件中的单元格文本
+// 打开时解压并解析工作簿（工作表名称与位置）与共享字符串表；readRows 用 QXmlStreamReader 顺序解析工作表 XML，
+// 每读完一行就交给回调处理，不在内存中保存整张表。只读取单元格的值（数字按文件中保存的原文返回），不读取格式与公式。
+// 不支持旧版 .xls（二进制格式），需在 Excel 中另存为 .xlsx 或 .csv。
+
+#pragma once
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QXmlStreamReader>
+#include <QDebug>
+#include <functional>
+#include "zipArchive.h"
+
+class XlsxReader
+{
+public:
+    // 行回调：row 为行号（从1开始），values[k] 为第 k+1 列的文本（中间的空单元格为空字符串）；返回 false 停止读取
+    using RowHandler = std::function<bool(int row, const QStringList& values)>;
+
+    bool open(const QString& path) {
+        m_sheets.clear();
+        m_sharedStrings.clear();
+        if (!m_zip.open(path)) {
+            m_error = "文件不是有效的 .xlsx 文件";
+            return false;
+        }
+        if (!readWorkbook()) {
+            if (m_error.isEmpty()) m_error = "无法读取工作簿";
+            return false;
+        }
+        if (!m_sharedStringsPath.isEmpty() && m_zip.contains(m_sharedStringsPath) && !readSharedStrings()) {
+            m_error = "无法读取共享字符串表";
+            return false;
+        }
+        return true;
+    }
+
+    QString errorString() const { return m_error; }
+
+    QStringList sheetNames() const {
+        QStringList names;
+        for (const Sheet& sheet : m_sheets) names.append(sheet.name);
+        return names;
+    }
+
+    // 按行顺序读取第 sheetIndex 个工作表（从0开始），空白行不会回调
+    bool readRows(const RowHandler& handler, int sheetIndex = 0) {
+        if (sheetIndex < 0 || sheetIndex >= m_sheets.size()) {
+            m_error = "工作表不存在";
+            return false;
+        }
+        QByteArray xml;
+        if (!m_zip.read(m_sheets.at(sheetIndex).path, xml)) {
+            m_error = "无法解压工作表：" + m_sheets.at(sheetIndex).name;
+            return false;
+        }
+        QXmlStreamReader reader(xml);
+        QStringList values;
+        int rowNumber = 0;
+        int column = 0;          // 当前单元格的列号（从0开始）
+        QString cellType;
+        QString cellText;
+        bool inCell = false;
+        while (!reader.atEnd()) {
+            reader.readNext();
+            if (reader.isStartElement()) {
+                const auto name = reader.name();
+                if (name == QLatin1String("row")) {
+                    const auto r = reader.attributes().value("r");
+                    rowNumber = r.isEmpty() ? rowNumber + 1 : r.toInt();
+                    values.clear();
+                    column = 0;
+                } else if (name == QLatin1String("c")) {
+                    const QString reference = reader.attributes().value("r").toString();
+                    if (!reference.isEmpty()) column = columnIndex(reference);
+                    cellType = reader.attributes().value("t").toString();
+                    cellText.clear();
+                    inCell = true;
+                } else if (inCell && name == QLatin1String("v")) {
+                    cellText = reader.readElementText();
+                } else if (inCell && name == QLatin1String("is")) {
+                    cellText = readStringItem(reader);
+                }
+            } else if (reader.isEndElement()) {
+                const auto name = reader.name();
+                if (name == QLatin1String("c") && inCell) {
+                    inCell = false;
+                    if (cellType == QLatin1String("s") && !cellText.isEmpty()) {
+                        const int index = cellText.toInt();
+                        cellText = (index >= 0 && index < m_sharedStrings.size()) ? m_sharedStrings.at(index) : QString();
+                    }
+                    if (!cellText.isEmpty() && column >= 0 && column < MAX_COLUMNS) {
+                        while (values.size() < column) values.append(QString());
+                        if (values.size() == column) values.append(cellText);
+                        else values[column] = cellText;
+                    }
+                    ++column;
+                } else if (name == QLatin1String("row")) {
+                    if (!values.isEmpty() && !handler(rowNumber, values)) return true;
+                } else if (name == QLatin1String("sheetData")) {
+                    break; // 之后是合并单元格等格式信息，无需解析
+                }
+            }
+        }
+        if (reader.hasError()) {
+            m_error = "工作表内容损坏：" + reader.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    // 单元格名称中的列号（从0开始），如 "C12" -> 2
+    static int columnIndex(const QString& reference) {
+        int column = 0;
+        for (const QChar ch : reference) {
+            if (ch < QLatin1Char('A') || ch > QLatin1Char('Z')) break;
+            column = column * 26 + (ch.unicode() - 'A' + 1);
+        }
+        return column - 1;
+    }
+
+private:
+    static constexpr int MAX_COLUMNS = 16384; // Excel 的列数上限（XFD）
+
+    struct Sheet {
+        QString name;
+        QString path; // 压缩包内的路径
+    };
+
+    // 工作簿：xl/workbook.xml 给出工作表名称与关系编号，xl/_rels/workbook.xml.rels 给出各部件的路径
+    bool readWorkbook() {
+        QByteArray relationshipsXml;
+        QHash<QString, QString> targets; // 关系编号 -> 路径
+        m_sharedStringsPath = "xl/sharedStrings.xml";
+        if (m_zip.read("xl/_rels/workbook.xml.rels", relationshipsXml)) {
+            QXmlStreamReader reader(relationshipsXml);
+            while (!reader.atEnd()) {
+                reader.readNext();
+                if (!reader.isStartElement() || reader.name() != QLatin1String("Relationship")) continue;
+                const QXmlStreamAttributes attributes = reader.attributes();
+                const QString target = partPath(attributes.value("Target").toString());
+                targets.insert(attributes.value("Id").toString(), target);
+                if (attributes.value("Type").endsWith(QLatin1String("/sharedStrings"))) m_sharedStringsPath = target;
+            }
+        }
+        QByteArray workbookXml;
+        if (!m_zip.read("xl/workbook.xml", workbookXml)) return false;
+        QXmlStreamReader reader(workbookXml);
+        while (!reader.atEnd()) {
+            reader.readNext();
+            if (!reader.isStartElement() || reader.name() != QLatin1String("sheet")) continue;
+            Sheet sheet;
+            sheet.name = reader.attributes().value("name").toString();
+            // r:id 属性：按命名空间前缀之外的本地名称查找
+            for (const QXmlStreamAttribute& attribute : reader.attributes()) {
+                if (attribute.name() == QLatin1String("id")) {
+                    sheet.path = targets.value(attribute.value().toString());
+                }
+            }
+            // 缺少关系文件时按默认命名推断
+            if (sheet.path.isEmpty()) sheet.path = QString("xl/worksheets/sheet%1.xml").arg(m_sheets.size() + 1);
+            m_sheets.append(sheet);
+        }
+        if (reader.hasError() || m_sheets.isEmpty()) {
+            m_error = "工作簿中没有工作表";
+            return false;
+        }
+        return true;
+    }
+
+    // 关系文件中的路径相对于 xl/ 目录，以 '/' 开头时为压缩包内的绝对路径
+    static QString partPath(const QString& target) {
+        if (target.startsWith('/')) return target.mid(1);
+        return "xl/" + target;
+    }
+
+    bool readSharedStrings() {
+        QByteArray xml;
+        if (!m_zip.read(m_sharedStringsPath, xml)) return false;
+        QXmlStreamReader reader(xml);
+        while (!reader.atEnd()) {
+            reader.readNext();
+            if (reader.isStartElement() && reader.name() == QLatin1String("si")) {
+                m_sharedStrings.append(readStringItem(reader));
+            }
+        }
+        return !reader.hasError();
+    }
+
+    // 读取一个字符串项（<si> 或 <is>）：拼接其中所有 <t> 的文本（富文本分为多段），跳过注音 <rPh>
+    static QString readStringItem(QXmlStreamReader& reader) {
+        QString text;
+        int depth = 1;
+        int phoneticDepth = 0;
+        while (depth > 0 && !reader.atEnd()) {
+            reader.readNext();
+            if (reader.isStartElement()) {
+                ++depth;
+                if (reader.name() == QLatin1String("rPh")) {
+                    ++phoneticDepth;
+                } else if (reader.name() == QLatin1String("t") && phoneticDepth == 0) {
+                    text += reader.readElementText();
+                    --depth;
+                }
+            } else if (reader.isEndElement()) {
+                --depth;
+                if (reader.name() == QLatin1String("rPh")) --phoneticDepth;
+            }
+        }
+        return text;
+    }
+
+    ZipReader m_zip;
+    QVector<Sheet> m_sheets;
+    QStringList m_sharedStrings;
+    QString m_sharedStringsPath;
+    QString m_error;
+};
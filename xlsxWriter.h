@@ -0,0 +1,430 @@
+// xlsxWriter.h头文件
+// 功能说明：不依赖 Excel 直接生成 .xlsx 文件（Office Open XML 表格）
+// 按行依次写入各工作表，工作表 XML 随写随生成，保存时与工作簿、样式等部件一起压缩进 ZIP 容器（见 zipArchive.h）。
+// 支持的格式：字体（名称、字号、颜色）、纯色填充、细框线、水平居中、列宽、行高与合并单元格，满足导出排班表所需。
+// 单元格文本以内联字符串（inlineStr）保存，无需共享字符串表。
+// 用法：addStyle 登记样式 → beginSheet → setColumnWidth → 按行号递增调用 writeRow → mergeCells → 下一个工作表…… → save
+
+#pragma once
+#include <QByteArray>
+#include <QColor>
+#include <QFile>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QScopedPointer>
+#include <QXmlStreamWriter>
+#include <QDebug>
+#include "durableFile.h"
+#include "zipArchive.h"
+
+class XlsxWriter
+{
+public:
+    // 单元格样式；未设置的项使用工作簿默认值（等线 11 号，无填充，无框线）
+    struct Style {
+        QString fontName;
+        double fontSize = 0;
+        QColor fontColor;     // 无效颜色表示默认黑色
+        QColor fill;          // 无效颜色表示无填充
+        bool border = false;  // 四周细框线
+        bool center = false;  // 水平居中
+    };
+
+    struct Cell {
+        int column;           // 列号，从1开始
+        QString text;         // 为空时只写出样式
+        int style;            // addStyle 的返回值，0 为默认样式
+    };
+
+    XlsxWriter() {
+        m_styles.append(Style());
+    }
+
+    // 登记样式，返回在 writeRow 中使用的样式编号
+    int addStyle(const Style& style) {
+        m_styles.append(style);
+        return m_styles.size() - 1;
+    }
+
+    // 开始一个新工作表（工作表按创建顺序排列）
+    void beginSheet(const QString& name) {
+        endSheet();
+        m_sheets.append(Sheet());
+        m_sheets.last().name = name;
+        m_xml.reset(new QXmlStreamWriter(&m_sheets.last().xml));
+        m_xml->writeStartDocument("1.0", true);
+        m_xml->writeStartElement("worksheet");
+        m_xml->writeDefaultNamespace(NS_MAIN);
+        m_xml->writeNamespace(NS_RELATIONSHIPS, "r");
+        m_rowsStarted = false;
+        m_lastRow = 0;
+        m_merges.clear();
+    }
+
+    // 设置第 first ~ last 列的列宽（以字符为单位，与 Excel 的 ColumnWidth 相同），须在写入第一行之前调用
+    void setColumnWidth(int first, int last, double width) {
+        if (!m_xml || m_rowsStarted) return;
+        m_columns.append(ColumnWidth{first, last, width});
+    }
+
+    // 写入一行；row 从1开始且必须递增，height 为行高（磅），0 表示默认行高
+    bool writeRow(int row, const QVector<Cell>& cells, double height = 0) {
+        if (!m_xml || row <= m_lastRow) return false;
+        startRows();
+        m_lastRow = row;
+        m_xml->writeStartElement("row");
+        m_xml->writeAttribute("r", QString::number(row));
+        if (height > 0) {
+            m_xml->writeAttribute("ht", QString::number(height));
+            m_xml->writeAttribute("customHeight", "1");
+        }
+        for (const Cell& cell : cells) {
+            m_xml->writeStartElement("c");
+            m_xml->writeAttribute("r", cellName(row, cell.column));
+            if (cell.style > 0 && cell.style < m_styles.size()) {
+                m_xml->writeAttribute("s", QString::number(cell.style));
+            }
+            if (!cell.text.isEmpty()) {
+                m_xml->writeAttribute("t", "inlineStr");
+                m_xml->writeStartElement("is");
+                m_xml->writeStartElement("t");
+                m_xml->writeAttribute("xml:space", "preserve");
+                m_xml->writeCharacters(xmlSafe(cell.text));
+                m_xml->writeEndElement();
+                m_xml->writeEndElement();
+            }
+            m_xml->writeEndElement();
+        }
+        m_xml->writeEndElement();
+        return true;
+    }
+
+    // 合并单元格，range 形如 "A2:A3"
+    void mergeCells(const QString& range) {
+        if (m_xml) m_merges.append(range);
+    }
+
+    // 结束当前工作表并保存整个工作簿（先写入临时文件，完成后替换目标文件）
+    bool save(const QString& path) {
+        endSheet();
+        if (m_sheets.isEmpty()) return false;
+        QFile tempFile;
+        if (!DurableFile::openTemp(tempFile, path)) return false;
+        ZipWriter zip(&tempFile);
+        bool ok = zip.addFile("[Content_Types].xml", contentTypes())
+               && zip.addFile("_rels/.rels", rootRelationships())
+               && zip.addFile("xl/workbook.xml", workbook())
+               && zip.addFile("xl/_rels/workbook.xml.rels", workbookRelationships())
+               && zip.addFile("xl/styles.xml", stylesheet());
+        for (int i = 0; i < m_sheets.size() && ok; ++i) {
+            ok = zip.addFile(QString("xl/worksheets/sheet%1.xml").arg(i + 1), m_sheets.at(i).xml);
+        }
+        ok = ok && zip.finish();
+        if (!ok) {
+            qDebug() << "写入表格文件时发生错误：" << path;
+            tempFile.close();
+            tempFile.remove();
+            return false;
+        }
+        return DurableFile::commit(tempFile, path);
+    }
+
+    // 单元格名称，如 (1, 3) -> "C1"
+    static QString cellName(int row, int column) {
+        QString letters;
+        for (int c = column; c > 0; c = (c - 1) / 26) {
+            letters.prepend(QChar('A' + (c - 1) % 26));
+        }
+        return letters + QString::number(row);
+    }
+
+    // 估算文本所需列宽（字符单位），用于代替 Excel 的自动调整列宽：全角字符按两个字符计
+    static double textWidth(const QString& text) {
+        double width = 0;
+        for (const QChar ch : text) {
+            width += ch.unicode() >= 0x2E80 ? 2.0 : 1.0;
+        }
+        return width + 1.0;
+    }
+
+private:
+    static constexpr const char* NS_MAIN = "http://schemas.openxmlformats.org/spreadsheetml/2006/main";
+    static constexpr const char* NS_RELATIONSHIPS = "http://schemas.openxmlformats.org/officeDocument/2006/relationships";
+    static constexpr const char* DEFAULT_FONT = "等线";
+    static constexpr double DEFAULT_FONT_SIZE = 11;
+
+    struct Sheet {
+        QString name;
+        QByteArray xml;
+    };
+
+    struct ColumnWidth {
+        int first;
+        int last;
+        double width;
+    };
+
+    // 列宽须写在 sheetData 之前，因此在写入第一行时输出
+    void startRows() {
+        if (m_rowsStarted) return;
+        m_rowsStarted = true;
+        if (!m_columns.isEmpty()) {
+            m_xml->writeStartElement("cols");
+            for (const ColumnWidth& column : m_columns) {
+                m_xml->writeEmptyElement("col");
+                m_xml->writeAttribute("min", QString::number(column.first));
+                m_xml->writeAttribute("max", QString::number(column.last));
+                m_xml->writeAttribute("width", QString::number(column.width));
+                m_xml->writeAttribute("customWidth", "1");
+            }
+            m_xml->writeEndElement();
+            m_columns.clear();
+        }
+        m_xml->writeStartElement("sheetData");
+    }
+
+    void endSheet() {
+        if (!m_xml) return;
+        startRows();
+        m_xml->writeEndElement(); // sheetData
+        if (!m_merges.isEmpty()) {
+            m_xml->writeStartElement("mergeCells");
+            m_xml->writeAttribute("count", QString::number(m_merges.size()));
+            for (const QString& range : m_merges) {
+                m_xml->writeEmptyElement("mergeCell");
+                m_xml->writeAttribute("ref", range);
+            }
+            m_xml->writeEndElement();
+        }
+        m_xml->writeEndElement(); // worksheet
+        m_xml->writeEndDocument();
+        m_xml.reset();
+        m_merges.clear();
+    }
+
+    // XML 1.0 不允许的控制字符替换为空格
+    static QString xmlSafe(const QString& text) {
+        QString result = text;
+        for (QChar& ch : result) {
+            const ushort u = ch.unicode();
+            if (u < 0x20 && u != '\t' && u != '\n' && u != '\r') ch = QChar(' ');
+        }
+        return result;
+    }
+
+    static QString argb(const QColor& color) {
+        return QString("FF%1").arg(color.rgb() & 0xFFFFFF, 6, 16, QChar('0')).toUpper();
+    }
+
+    QByteArray contentTypes() const {
+        QByteArray xml;
+        QXmlStreamWriter w(&xml);
+        w.writeStartDocument("1.0", true);
+        w.writeStartElement("Types");
+        w.writeDefaultNamespace("http://schemas.openxmlformats.org/package/2006/content-types");
+        w.writeEmptyElement("Default");
+        w.writeAttribute("Extension", "rels");
+        w.writeAttribute("ContentType", "application/vnd.openxmlformats-package.relationships+xml");
+        w.writeEmptyElement("Default");
+        w.writeAttribute("Extension", "xml");
+        w.writeAttribute("ContentType", "application/xml");
+        w.writeEmptyElement("Override");
+        w.writeAttribute("PartName", "/xl/workbook.xml");
+        w.writeAttribute("ContentType", "application/vnd.openxmlformats-officedocument.spreadsheetml.sheet.main+xml");
+        w.writeEmptyElement("Override");
+        w.writeAttribute("PartName", "/xl/styles.xml");
+        w.writeAttribute("ContentType", "application/vnd.openxmlformats-officedocument.spreadsheetml.styles+xml");
+        for (int i = 0; i < m_sheets.size(); ++i) {
+            w.writeEmptyElement("Override");
+            w.writeAttribute("PartName", QString("/xl/worksheets/sheet%1.xml").arg(i + 1));
+            w.writeAttribute("ContentType", "application/vnd.openxmlformats-officedocument.spreadsheetml.worksheet+xml");
+        }
+        w.writeEndElement();
+        w.writeEndDocument();
+        return xml;
+    }
+
+    static QByteArray rootRelationships() {
+        QByteArray xml;
+        QXmlStreamWriter w(&xml);
+        w.writeStartDocument("1.0", true);
+        w.writeStartElement("Relationships");
+        w.writeDefaultNamespace("http://schemas.openxmlformats.org/package/2006/relationships");
+        w.writeEmptyElement("Relationship");
+        w.writeAttribute("Id", "rId1");
+        w.writeAttribute("Type", "http://schemas.openxmlformats.org/officeDocument/2006/relationships/officeDocument");
+        w.writeAttribute("Target", "xl/workbook.xml");
+        w.writeEndElement();
+        w.writeEndDocument();
+        return xml;
+    }
+
+    QByteArray workbook() const {
+        QByteArray xml;
+        QXmlStreamWriter w(&xml);
+        w.writeStartDocument("1.0", true);
+        w.writeStartElement("workbook");
+        w.writeDefaultNamespace(NS_MAIN);
+        w.writeNamespace(NS_RELATIONSHIPS, "r");
+        w.writeStartElement("sheets");
+        for (int i = 0; i < m_sheets.size(); ++i) {
+            w.writeEmptyElement("sheet");
+            w.writeAttribute("name", m_sheets.at(i).name);
+            w.writeAttribute("sheetId", QString::number(i + 1));
+            w.writeAttribute(NS_RELATIONSHIPS, "id", QString("rId%1").arg(i + 1));
+        }
+        w.writeEndElement();
+        w.writeEndElement();
+        w.writeEndDocument();
+        return xml;
+    }
+
+    QByteArray workbookRelationships() const {
+        QByteArray xml;
+        QXmlStreamWriter w(&xml);
+        w.writeStartDocument("1.0", true);
+        w.writeStartElement("Relationships");
+        w.writeDefaultNamespace("http://schemas.openxmlformats.org/package/2006/relationships");
+        for (int i = 0; i < m_sheets.size(); ++i) {
+            w.writeEmptyElement("Relationship");
+            w.writeAttribute("Id", QString("rId%1").arg(i + 1));
+            w.writeAttribute("Type", "http://schemas.openxmlformats.org/officeDocument/2006/relationships/worksheet");
+            w.writeAttribute("Target", QString("worksheets/sheet%1.xml").arg(i + 1));
+        }
+        w.writeEmptyElement("Relationship");
+        w.writeAttribute("Id", QString("rId%1").arg(m_sheets.size() + 1));
+        w.writeAttribute("Type", "http://schemas.openxmlformats.org/officeDocument/2006/relationships/styles");
+        w.writeAttribute("Target", "styles.xml");
+        w.writeEndElement();
+        w.writeEndDocument();
+        return xml;
+    }
+
+    // 样式表：每个登记的样式对应一个 cellXfs 项，字体与填充各自单独成表（第0项为默认值，填充第1项为规范要求的 gray125）
+    QByteArray stylesheet() const {
+        QByteArray xml;
+        QXmlStreamWriter w(&xml);
+        w.writeStartDocument("1.0", true);
+        w.writeStartElement("styleSheet");
+        w.writeDefaultNamespace(NS_MAIN);
+
+        w.writeStartElement("fonts");
+        w.writeAttribute("count", QString::number(m_styles.size()));
+        for (const Style& style : m_styles) {
+            w.writeStartElement("font");
+            w.writeEmptyElement("sz");
+            w.writeAttribute("val", QString::number(style.fontSize > 0 ? style.fontSize : DEFAULT_FONT_SIZE));
+            if (style.fontColor.isValid()) {
+                w.writeEmptyElement("color");
+                w.writeAttribute("rgb", argb(style.fontColor));
+            }
+            w.writeEmptyElement("name");
+            w.writeAttribute("val", style.fontName.isEmpty() ? QString(DEFAULT_FONT) : style.fontName);
+            w.writeEmptyElement("charset");
+            w.writeAttribute("val", "134"); // GB2312
+            w.writeEndElement();
+        }
+        w.writeEndElement();
+
+        w.writeStartElement("fills");
+        w.writeAttribute("count", QString::number(m_styles.size() + 2));
+        for (const char* pattern : {"none", "gray125"}) {
+            w.writeStartElement("fill");
+            w.writeEmptyElement("patternFill");
+            w.writeAttribute("patternType", pattern);
+            w.writeEndElement();
+        }
+        for (const Style& style : m_styles) {
+            w.writeStartElement("fill");
+            if (style.fill.isValid()) {
+                w.writeStartElement("patternFill");
+                w.writeAttribute("patternType", "solid");
+                w.writeEmptyElement("fgColor");
+                w.writeAttribute("rgb", argb(style.fill));
+                w.writeEmptyElement("bgColor");
+                w.writeAttribute("indexed", "64");
+                w.writeEndElement();
+            } else {
+                w.writeEmptyElement("patternFill");
+                w.writeAttribute("patternType", "none");
+            }
+            w.writeEndElement();
+        }
+        w.writeEndElement();
+
+        // 第0项无框线，第1项四周细框线
+        w.writeStartElement("borders");
+        w.writeAttribute("count", "2");
+        for (int thin = 0; thin < 2; ++thin) {
+            w.writeStartElement("border");
+            for (const char* side : {"left", "right", "top", "bottom"}) {
+                if (thin) {
+                    w.writeStartElement(side);
+                    w.writeAttribute("style", "thin");
+                    w.writeEmptyElement("color");
+                    w.writeAttribute("auto", "1");
+                    w.writeEndElement();
+                } else {
+                    w.writeEmptyElement(side);
+                }
+            }
+            w.writeEmptyElement("diagonal");
+            w.writeEndElement();
+        }
+        w.writeEndElement();
+
+        w.writeStartElement("cellStyleXfs");
+        w.writeAttribute("count", "1");
+        w.writeEmptyElement("xf");
+        w.writeAttribute("numFmtId", "0");
+        w.writeAttribute("fontId", "0");
+        w.writeAttribute("fillId", "0");
+        w.writeAttribute("borderId", "0");
+        w.writeEndElement();
+
+        w.writeStartElement("cellXfs");
+        w.writeAttribute("count", QString::number(m_styles.size()));
+        for (int i = 0; i < m_styles.size(); ++i) {
+            const Style& style = m_styles.at(i);
+            w.writeStartElement("xf");
+            w.writeAttribute("numFmtId", "0");
+            w.writeAttribute("fontId", QString::number(i));
+            w.writeAttribute("fillId", QString::number(style.fill.isValid() ? i + 2 : 0));
+            w.writeAttribute("borderId", style.border ? "1" : "0");
+            w.writeAttribute("xfId", "0");
+            if (i > 0) {
+                w.writeAttribute("applyFont", "1");
+                if (style.fill.isValid()) w.writeAttribute("applyFill", "1");
+                if (style.border) w.writeAttribute("applyBorder", "1");
+            }
+            if (style.center) {
+                w.writeAttribute("applyAlignment", "1");
+                w.writeEmptyElement("alignment");
+                w.writeAttribute("horizontal", "center");
+            }
+            w.writeEndElement();
+        }
+        w.writeEndElement();
+
+        w.writeStartElement("cellStyles");
+        w.writeAttribute("count", "1");
+        w.writeEmptyElement("cellStyle");
+        w.writeAttribute("name", "Normal");
+        w.writeAttribute("xfId", "0");
+        w.writeAttribute("builtinId", "0");
+        w.writeEndElement();
+
+        w.writeEndElement();
+        w.writeEndDocument();
+        return xml;
+    }
+
+    QVector<Style> m_styles;
+    QVector<Sheet> m_sheets;
+    QVector<ColumnWidth> m_columns;
+    QStringList m_merges;
+    QScopedPointer<QXmlStreamWriter> m_xml;
+    bool m_rowsStarted = false;
+    int m_lastRow = 0;
+};
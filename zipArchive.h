@@ -0,0 +1,518 @@
+// zipArchive.h头文件
+// 功能说明：读写 ZIP 压缩包（.xlsx 等 Office 文档的容器格式）
+// 写入（ZipWriter）：每个文件依次写出 [本地文件头][压缩数据]，全部写完后在末尾写出中央目录。
+// 压缩使用 Qt 自带的 zlib（qCompress 的结果去掉长度前缀、zlib 头与 Adler-32 校验值即为 ZIP 需要的 deflate 数据），
+// 压缩后没有变小的文件按不压缩方式保存。文件名使用 UTF-8（通用标志位 11），不支持超过 4GB 的文件（ZIP64）。
+// 读取（ZipReader）：按中央目录定位文件，deflate 数据由 Inflater 解压并核对 CRC-32。
+// 所有整数均以小端序保存。
+
+#pragma once
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QHash>
+#include <QIODevice>
+#include <QString>
+#include <QVector>
+#include <QtEndian>
+#include <QDebug>
+
+class ZipWriter
+{
+public:
+    explicit ZipWriter(QIODevice* device) : m_device(device) {}
+
+    // 向压缩包追加一个文件；name 使用 '/' 分隔目录
+    bool addFile(const QString& name, const QByteArray& data) {
+        if (m_finished || !m_device) return false;
+        if (static_cast<quint64>(data.size()) >= 0xFFFFFFFFull || m_offset >= 0xFFFFFFFFull) {
+            qDebug() << "压缩包过大：" << name;
+            return false;
+        }
+        Entry entry;
+        entry.name = name.toUtf8();
+        entry.crc = crc32(data.constData(), data.size());
+        entry.size = static_cast<quint32>(data.size());
+        entry.offset = static_cast<quint32>(m_offset);
+
+        QByteArray stored;
+        if (!data.isEmpty()) {
+            // qCompress：[4字节长度][2字节 zlib 头][deflate 数据][4字节 Adler-32]
+            const QByteArray compressed = qCompress(data, 6);
+            if (compressed.size() > 10 && compressed.size() - 10 < data.size()) {
+                stored = compressed.mid(6, compressed.size() - 10);
+                entry.method = METHOD_DEFLATE;
+            }
+        }
+        if (entry.method == METHOD_STORE) stored = data;
+        entry.compressedSize = static_cast<quint32>(stored.size());
+
+        QByteArray header(LOCAL_HEADER_SIZE, '\0');
+        uchar* h = reinterpret_cast<uchar*>(header.data());
+        qToLittleEndian<quint32>(0x04034b50, h);
+        qToLittleEndian<quint16>(VERSION_NEEDED, h + 4);
+        qToLittleEndian<quint16>(FLAG_UTF8, h + 6);
+        qToLittleEndian<quint16>(entry.method, h + 8);
+        qToLittleEndian<quint16>(m_dosTime, h + 10);
+        qToLittleEndian<quint16>(m_dosDate, h + 12);
+        qToLittleEndian<quint32>(entry.crc, h + 14);
+        qToLittleEndian<quint32>(entry.compressedSize, h + 18);
+        qToLittleEndian<quint32>(entry.size, h + 22);
+        qToLittleEndian<quint16>(static_cast<quint16>(entry.name.size()), h + 26);
+        qToLittleEndian<quint16>(0, h + 28);
+        header.append(entry.name);
+
+        if (!writeAll(header) || !writeAll(stored)) return false;
+        m_entries.append(entry);
+        return true;
+    }
+
+    // 写出中央目录，之后不能再追加文件
+    bool finish() {
+        if (m_finished || !m_device) return false;
+        m_finished = true;
+        const qint64 directoryOffset = m_offset;
+        QByteArray directory;
+        for (const Entry& entry : m_entries) {
+            QByteArray record(CENTRAL_HEADER_SIZE, '\0');
+            uchar* r = reinterpret_cast<uchar*>(record.data());
+            qToLittleEndian<quint32>(0x02014b50, r);
+            qToLittleEndian<quint16>(VERSION_NEEDED, r + 4);
+            qToLittleEndian<quint16>(VERSION_NEEDED, r + 6);
+            qToLittleEndian<quint16>(FLAG_UTF8, r + 8);
+            qToLittleEndian<quint16>(entry.method, r + 10);
+            qToLittleEndian<quint16>(m_dosTime, r + 12);
+            qToLittleEndian<quint16>(m_dosDate, r + 14);
+            qToLittleEndian<quint32>(entry.crc, r + 16);
+            qToLittleEndian<quint32>(entry.compressedSize, r + 20);
+            qToLittleEndian<quint32>(entry.size, r + 24);
+            qToLittleEndian<quint16>(static_cast<quint16>(entry.name.size()), r + 28);
+            // 附加字段、注释长度、磁盘号、内部 / 外部属性均为0
+            qToLittleEndian<quint32>(entry.offset, r + 42);
+            directory.append(record);
+            directory.append(entry.name);
+        }
+        QByteArray end(END_RECORD_SIZE, '\0');
+        uchar* e = reinterpret_cast<uchar*>(end.data());
+        qToLittleEndian<quint32>(0x06054b50, e);
+        qToLittleEndian<quint16>(static_cast<quint16>(m_entries.size()), e + 8);
+        qToLittleEndian<quint16>(static_cast<quint16>(m_entries.size()), e + 10);
+        qToLittleEndian<quint32>(static_cast<quint32>(directory.size()), e + 12);
+        qToLittleEndian<quint32>(static_cast<quint32>(directoryOffset), e + 16);
+        return writeAll(directory) && writeAll(end);
+    }
+
+    // ZIP 使用的 CRC-32（IEEE 802.3 多项式）
+    static quint32 crc32(const char* data, qint64 length, quint32 crc = 0) {
+        static const CrcTable table;
+        const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+        crc = ~crc;
+        for (qint64 i = 0; i < length; ++i) {
+            crc = table.values[(crc ^ p[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return ~crc;
+    }
+
+private:
+    static constexpr quint16 METHOD_STORE = 0;
+    static constexpr quint16 METHOD_DEFLATE = 8;
+    static constexpr quint16 VERSION_NEEDED = 20;     // 2.0：deflate
+    static constexpr quint16 FLAG_UTF8 = 0x0800;      // 文件名为 UTF-8
+    static constexpr int LOCAL_HEADER_SIZE = 30;
+    static constexpr int CENTRAL_HEADER_SIZE = 46;
+    static constexpr int END_RECORD_SIZE = 22;
+
+    struct Entry {
+        QByteArray name;
+        quint16 method = METHOD_STORE;
+        quint32 crc = 0;
+        quint32 compressedSize = 0;
+        quint32 size = 0;
+        quint32 offset = 0;
+    };
+
+    struct CrcTable {
+        quint32 values[256];
+        CrcTable() {
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 c = i;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+                }
+                values[i] = c;
+            }
+        }
+    };
+
+    bool writeAll(const QByteArray& bytes) {
+        if (bytes.isEmpty()) return true;
+        if (m_device->write(bytes) != bytes.size()) {
+            qDebug() << "写入压缩包时发生错误";
+            return false;
+        }
+        m_offset += bytes.size();
+        return true;
+    }
+
+    // MS-DOS 格式的修改时间（所有文件共用创建压缩包的时间）
+    static quint16 dosTime(const QTime& time) {
+        return static_cast<quint16>((time.hour() << 11) | (time.minute() << 5) | (time.second() / 2));
+    }
+    static quint16 dosDate(const QDate& date) {
+        return static_cast<quint16>(((qMax(date.year(), 1980) - 1980) << 9) | (date.month() << 5) | date.day());
+    }
+
+    QIODevice* m_device;
+    QVector<Entry> m_entries;
+    qint64 m_offset = 0;
+    bool m_finished = false;
+    const QDateTime m_created = QDateTime::currentDateTime();
+    const quint16 m_dosTime = dosTime(m_created.time());
+    const quint16 m_dosDate = dosDate(m_created.date());
+};
+
+// deflate 解压（RFC 1951）：ZIP 中的数据是不带 zlib 头与校验值的原始 deflate 流，qUncompress 无法直接解压，因此在此实现。
+// 按位读取输入，用范式哈夫曼码表（每种码长的码字个数 + 按码字排序的符号）逐位解码。
+class Inflater
+{
+public:
+    // 解压 data 中的完整 deflate 流；expectedSize 为已知的解压后长度（仅用于预分配），失败返回 false
+    static bool inflate(const char* data, qint64 size, QByteArray& out, qint64 expectedSize = 0) {
+        Inflater state(reinterpret_cast<const uchar*>(data), size);
+        out.resize(static_cast<int>(qBound<qint64>(1024, expectedSize, MAX_OUTPUT)));
+        state.m_out = &out;
+        state.m_outData = out.data();
+        bool last = false;
+        while (!last) {
+            last = state.bits(1) != 0;
+            const int type = state.bits(2);
+            bool ok = false;
+            if (type == 0) {
+                ok = state.storedBlock();
+            } else if (type == 1) {
+                ok = state.fixedBlock();
+            } else if (type == 2) {
+                ok = state.dynamicBlock();
+            }
+            if (!ok || state.m_error) {
+                out.clear();
+                return false;
+            }
+        }
+        out.resize(static_cast<int>(state.m_outSize));
+        return true;
+    }
+
+private:
+    static constexpr int MAX_BITS = 15;
+    static constexpr int MAX_LITERAL_CODES = 286;
+    static constexpr int MAX_DISTANCE_CODES = 30;
+    static constexpr int FIXED_LITERAL_CODES = 288;
+    static constexpr qint64 MAX_OUTPUT = 0x7FFFFFF0; // QByteArray 的长度上限
+
+    struct Huffman {
+        short count[MAX_BITS + 1];        // 每种码长的码字个数
+        short symbol[FIXED_LITERAL_CODES]; // 按码字顺序排列的符号
+    };
+
+    Inflater(const uchar* data, qint64 size) : m_in(data), m_inSize(size) {}
+
+    // 读取 count 位（低位在前）；输入不足时置错误标志
+    int bits(int count) {
+        while (m_bitCount < count) {
+            if (m_inPos >= m_inSize) {
+                m_error = true;
+                return 0;
+            }
+            m_bitBuffer |= static_cast<quint32>(m_in[m_inPos++]) << m_bitCount;
+            m_bitCount += 8;
+        }
+        const int value = static_cast<int>(m_bitBuffer & ((1u << count) - 1));
+        m_bitBuffer >>= count;
+        m_bitCount -= count;
+        return value;
+    }
+
+    bool put(uchar byte) {
+        if (m_outSize == m_out->size()) {
+            if (m_outSize >= MAX_OUTPUT) return false;
+            m_out->resize(static_cast<int>(qMin<qint64>(MAX_OUTPUT, m_outSize * 2)));
+            m_outData = m_out->data();
+        }
+        m_outData[m_outSize++] = static_cast<char>(byte);
+        return true;
+    }
+
+    // 未压缩块：丢弃当前字节的剩余位，随后为 [LEN][NLEN][数据]
+    bool storedBlock() {
+        m_bitBuffer = 0;
+        m_bitCount = 0;
+        if (m_inPos + 4 > m_inSize) return false;
+        const quint32 length = m_in[m_inPos] | (m_in[m_inPos + 1] << 8);
+        const quint32 check = m_in[m_inPos + 2] | (m_in[m_inPos + 3] << 8);
+        m_inPos += 4;
+        if (length != (~check & 0xFFFF) || m_inPos + length > m_inSize) return false;
+        for (quint32 i = 0; i < length; ++i) {
+            if (!put(m_in[m_inPos++])) return false;
+        }
+        return true;
+    }
+
+    // 由码长构造码表；码长超额分配时返回 false（码长不足的不完整码表在 deflate 中允许出现）
+    static bool build(Huffman& h, const short* lengths, int n) {
+        for (int len = 0; len <= MAX_BITS; ++len) h.count[len] = 0;
+        for (int s = 0; s < n; ++s) h.count[lengths[s]]++;
+        int left = 1;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            left <<= 1;
+            left -= h.count[len];
+            if (left < 0) return false;
+        }
+        short offsets[MAX_BITS + 1];
+        offsets[1] = 0;
+        for (int len = 1; len < MAX_BITS; ++len) {
+            offsets[len + 1] = offsets[len] + h.count[len];
+        }
+        for (int s = 0; s < n; ++s) {
+            if (lengths[s] != 0) h.symbol[offsets[lengths[s]]++] = static_cast<short>(s);
+        }
+        return true;
+    }
+
+    // 逐位解码一个符号；码字无效时返回 -1
+    int decode(const Huffman& h) {
+        int code = 0, first = 0, index = 0;
+        for (int len = 1; len <= MAX_BITS; ++len) {
+            code |= bits(1);
+            if (m_error) return -1;
+            const int count = h.count[len];
+            if (code - count < first) return h.symbol[index + (code - first)];
+            index += count;
+            first += count;
+            first <<= 1;
+            code <<= 1;
+        }
+        return -1;
+    }
+
+    // 解码一个压缩块的内容，直到块结束符（256）
+    bool codes(const Huffman& literals, const Huffman& distances) {
+        static const short lengthBase[29] = {
+            3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+            35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static const short lengthExtra[29] = {
+            0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static const short distanceBase[30] = {
+            1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+            257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static const short distanceExtra[30] = {
+            0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+        for (;;) {
+            int symbol = decode(literals);
+            if (symbol < 0) return false;
+            if (symbol < 256) {
+                if (!put(static_cast<uchar>(symbol))) return false;
+                continue;
+            }
+            if (symbol == 256) return true;
+            symbol -= 257;
+            if (symbol >= 29) return false;
+            const int length = lengthBase[symbol] + bits(lengthExtra[symbol]);
+            const int distanceCode = decode(distances);
+            if (distanceCode < 0 || distanceCode >= 30) return false;
+            const qint64 distance = distanceBase[distanceCode] + bits(distanceExtra[distanceCode]);
+            if (m_error || distance > m_outSize) return false;
+            // 复制之前输出的内容（源与目标可能重叠，须逐字节复制）
+            for (int i = 0; i < length; ++i) {
+                if (!put(static_cast<uchar>(m_outData[m_outSize - distance]))) return false;
+            }
+        }
+    }
+
+    bool fixedBlock() {
+        static const struct FixedTables {
+            Huffman literals, distances;
+            FixedTables() {
+                short lengths[FIXED_LITERAL_CODES];
+                int s = 0;
+                for (; s < 144; ++s) lengths[s] = 8;
+                for (; s < 256; ++s) lengths[s] = 9;
+                for (; s < 280; ++s) lengths[s] = 7;
+                for (; s < FIXED_LITERAL_CODES; ++s) lengths[s] = 8;
+                build(literals, lengths, FIXED_LITERAL_CODES);
+                for (s = 0; s < MAX_DISTANCE_CODES; ++s) lengths[s] = 5;
+                build(distances, lengths, MAX_DISTANCE_CODES);
+            }
+        } tables;
+        return codes(tables.literals, tables.distances);
+    }
+
+    bool dynamicBlock() {
+        static const short order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+        const int literalCount = bits(5) + 257;
+        const int distanceCount = bits(5) + 1;
+        const int codeLengthCount = bits(4) + 4;
+        if (m_error || literalCount > MAX_LITERAL_CODES || distanceCount > MAX_DISTANCE_CODES) return false;
+
+        short lengths[MAX_LITERAL_CODES + MAX_DISTANCE_CODES];
+        for (int i = 0; i < 19; ++i) lengths[order[i]] = i < codeLengthCount ? static_cast<short>(bits(3)) : 0;
+        Huffman lengthCode;
+        if (m_error || !build(lengthCode, lengths, 19)) return false;
+
+        // 码长序列：0~15 为码长本身，16 重复上一个码长 3~6 次，17 / 18 重复 0 共 3~10 / 11~138 次
+        const int total = literalCount + distanceCount;
+        for (int index = 0; index < total;) {
+            int symbol = decode(lengthCode);
+            if (symbol < 0) return false;
+            if (symbol < 16) {
+                lengths[index++] = static_cast<short>(symbol);
+                continue;
+            }
+            short value = 0;
+            int repeat;
+            if (symbol == 16) {
+                if (index == 0) return false;
+                value = lengths[index - 1];
+                repeat = 3 + bits(2);
+            } else if (symbol == 17) {
+                repeat = 3 + bits(3);
+            } else {
+                repeat = 11 + bits(7);
+            }
+            if (m_error || index + repeat > total) return false;
+            while (repeat--) lengths[index++] = value;
+        }
+        if (lengths[256] == 0) return false; // 必须有块结束符
+
+        Huffman literals, distances;
+        if (!build(literals, lengths, literalCount) || !build(distances, lengths + literalCount, distanceCount)) {
+            return false;
+        }
+        return codes(literals, distances);
+    }
+
+    const uchar* m_in;
+    qint64 m_inSize;
+    qint64 m_inPos = 0;
+    quint32 m_bitBuffer = 0;
+    int m_bitCount = 0;
+    bool m_error = false;
+    QByteArray* m_out = nullptr;
+    char* m_outData = nullptr;
+    qint64 m_outSize = 0;
+};
+
+// 读取 ZIP 压缩包：打开时读取末尾的中央目录，按文件名解压单个文件并核对 CRC-32
+class ZipReader
+{
+public:
+    bool open(const QString& path) {
+        m_entries.clear();
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qDebug() << "无法打开压缩包：" << path;
+            return false;
+        }
+        m_data = file.readAll();
+        file.close();
+        if (!readDirectory()) {
+            qDebug() << "压缩包格式不正确：" << path;
+            m_entries.clear();
+            return false;
+        }
+        return true;
+    }
+
+    bool contains(const QString& name) const {
+        return m_entries.contains(name);
+    }
+
+    // 解压指定文件；不存在、使用不支持的压缩方式或校验失败时返回 false
+    bool read(const QString& name, QByteArray& out) const {
+        const auto it = m_entries.constFind(name);
+        if (it == m_entries.constEnd()) return false;
+        const Entry& entry = it.value();
+        const uchar* base = reinterpret_cast<const uchar*>(m_data.constData());
+        const qint64 size = m_data.size();
+        if (entry.offset + LOCAL_HEADER_SIZE > size || qFromLittleEndian<quint32>(base + entry.offset) != 0x04034b50) {
+            return false;
+        }
+        // 本地文件头中的附加字段长度可能与中央目录不同，以本地文件头为准
+        const qint64 start = entry.offset + LOCAL_HEADER_SIZE
+                           + qFromLittleEndian<quint16>(base + entry.offset + 26)
+                           + qFromLittleEndian<quint16>(base + entry.offset + 28);
+        if (start + entry.compressedSize > size) return false;
+        const char* payload = m_data.constData() + start;
+        if (entry.method == 0) {
+            out = QByteArray(payload, static_cast<int>(entry.compressedSize));
+        } else if (entry.method == 8) {
+            if (!Inflater::inflate(payload, entry.compressedSize, out, entry.size)) return false;
+        } else {
+            qDebug() << "不支持的压缩方式：" << entry.method << name;
+            return false;
+        }
+        if (static_cast<quint64>(out.size()) != entry.size || ZipWriter::crc32(out.constData(), out.size()) != entry.crc) {
+            qDebug() << "压缩包内文件校验失败：" << name;
+            out.clear();
+            return false;
+        }
+        return true;
+    }
+
+private:
+    static constexpr int LOCAL_HEADER_SIZE = 30;
+    static constexpr int CENTRAL_HEADER_SIZE = 46;
+    static constexpr int END_RECORD_SIZE = 22;
+
+    struct Entry {
+        quint16 method;
+        quint32 crc;
+        quint64 compressedSize;
+        quint64 size;
+        qint64 offset;
+    };
+
+    // 从文件末尾向前查找中央目录结束记录（其后最多有 65535 字节的注释），再逐条读取中央目录
+    bool readDirectory() {
+        const uchar* base = reinterpret_cast<const uchar*>(m_data.constData());
+        const qint64 size = m_data.size();
+        qint64 end = -1;
+        for (qint64 pos = size - END_RECORD_SIZE; pos >= 0 && pos >= size - END_RECORD_SIZE - 0xFFFF; --pos) {
+            if (qFromLittleEndian<quint32>(base + pos) == 0x06054b50) {
+                end = pos;
+                break;
+            }
+        }
+        if (end < 0) return false;
+        const int count = qFromLittleEndian<quint16>(base + end + 10);
+        const qint64 directorySize = qFromLittleEndian<quint32>(base + end + 12);
+        qint64 pos = qFromLittleEndian<quint32>(base + end + 16);
+        if (pos + directorySize > end) return false; // 不支持 ZIP64
+        for (int k = 0; k < count; ++k) {
+            if (pos + CENTRAL_HEADER_SIZE > end || qFromLittleEndian<quint32>(base + pos) != 0x02014b50) return false;
+            const quint16 flags = qFromLittleEndian<quint16>(base + pos + 8);
+            Entry entry;
+            entry.method = qFromLittleEndian<quint16>(base + pos + 10);
+            entry.crc = qFromLittleEndian<quint32>(base + pos + 16);
+            entry.compressedSize = qFromLittleEndian<quint32>(base + pos + 20);
+            entry.size = qFromLittleEndian<quint32>(base + pos + 24);
+            const int nameLength = qFromLittleEndian<quint16>(base + pos + 28);
+            const int extraLength = qFromLittleEndian<quint16>(base + pos + 30);
+            const int commentLength = qFromLittleEndian<quint16>(base + pos + 32);
+            entry.offset = qFromLittleEndian<quint32>(base + pos + 42);
+            if (pos + CENTRAL_HEADER_SIZE + nameLength > end) return false;
+            const char* name = m_data.constData() + pos + CENTRAL_HEADER_SIZE;
+            // 加密的文件（标志位 0）无法读取，跳过
+            if (!(flags & 0x0001)) {
+                const QString fileName = (flags & 0x0800) ? QString::fromUtf8(name, nameLength)
+                                                          : QString::fromLocal8Bit(name, nameLength);
+                m_entries.insert(fileName, entry);
+            }
+            pos += CENTRAL_HEADER_SIZE + nameLength + extraLength + commentLength;
+        }
+        return true;
+    }
+
+    QByteArray m_data;
+    QHash<QString, Entry> m_entries;
+};